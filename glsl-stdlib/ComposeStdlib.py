@@ -96,8 +96,12 @@ def main():
         file.write("\n")
 
         file.write("namespace glsld {\n")
-        file.write("inline constinit SourceTextView GlslStdlibText = R\"glsl(\n")
-        file.write(builder.build())
+        file.write("inline constinit SourceTextView GlslStdlibCoreText = R\"glsl(\n")
+        file.write(builder.buildCore())
+        file.write(")glsl\";\n")
+        file.write("\n")
+        file.write("inline constinit SourceTextView GlslStdlibStageText = R\"glsl(\n")
+        file.write(builder.buildStageSegment())
         file.write(")glsl\";\n")
         file.write("} // namespace glsld\n")
         file.write("// clang-format on\n")
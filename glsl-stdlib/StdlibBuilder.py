@@ -172,11 +172,26 @@ class StdlibBuilder:
     def addSnippet(self, snippet: str):
         self.snippets.append(snippet)
 
-    def build(self):
+    # Snippets that declare builtins of specific shader stages. They are compiled as a separate segment on top of the
+    # core so that the core could be shared by all stages.
+    def isStageSnippet(self, snippet: str) -> bool:
+        return "__GLSLD_SHADER_STAGE_" in snippet
+
+    def buildStageSegment(self):
         buffer = ""
         for snippet in self.snippets:
-            buffer += snippet
-            buffer += "\n"
+            if self.isStageSnippet(snippet):
+                buffer += snippet
+                buffer += "\n"
+
+        return buffer
+
+    def buildCore(self):
+        buffer = ""
+        for snippet in self.snippets:
+            if not self.isStageSnippet(snippet):
+                buffer += snippet
+                buffer += "\n"
 
         for func in self.data:
             if len(func.guardMacros) > 0:
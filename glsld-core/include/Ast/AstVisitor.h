@@ -130,6 +130,12 @@ namespace glsld
     {                                                                                                                  \
         auto& visitor    = static_cast<Derived&>(*this);                                                               \
         auto visitPolicy = AstVisitPolicy::Traverse;                                                                   \
+        /* Halt if the visitor is cancelled */                                                                         \
+        if constexpr (requires { visitor.IsTraversalCancelled(); }) {                                                  \
+            if (visitor.IsTraversalCancelled()) {                                                                      \
+                return false;                                                                                          \
+            }                                                                                                          \
+        }                                                                                                              \
         /* Enter */                                                                                                    \
         if constexpr (requires { visitor.Enter##TYPE(node); }) {                                                       \
             visitPolicy = visitor.Enter##TYPE(node);                                                                   \
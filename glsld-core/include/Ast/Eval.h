@@ -1,12 +1,65 @@
 #pragma once
 #include "Ast/Expr.h"
 #include "Language/ConstValue.h"
+#include "Support/MemoryArena.h"
+
+#include <variant>
 
 namespace glsld
 {
     auto IsConstEvalFunction(StringView name) -> bool;
 
+    // The result of a constant evaluation. A value that is folded on the Ast is borrowed without being copied, so the
+    // result must not outlive the Ast. Otherwise, the value is evaluated on the fly and owned by the result.
+    class ConstEvalResult
+    {
+    private:
+        std::variant<ConstValue, const ConstValue*> value;
+
+    public:
+        ConstEvalResult() = default;
+        ConstEvalResult(ConstValue ownedValue) : value(std::move(ownedValue))
+        {
+        }
+        ConstEvalResult(const ConstValue* borrowedValue) : value(borrowedValue)
+        {
+        }
+
+        auto IsBorrowed() const noexcept -> bool
+        {
+            return std::holds_alternative<const ConstValue*>(value);
+        }
+
+        auto operator*() const noexcept -> const ConstValue&
+        {
+            if (auto borrowedValue = std::get_if<const ConstValue*>(&value)) {
+                return **borrowedValue;
+            }
+
+            return std::get<ConstValue>(value);
+        }
+        auto operator->() const noexcept -> const ConstValue*
+        {
+            return &**this;
+        }
+
+        // Returns the value that owns its buffer, which is cloned only if the value is borrowed.
+        auto TakeValue() && -> ConstValue
+        {
+            if (auto borrowedValue = std::get_if<const ConstValue*>(&value)) {
+                return (*borrowedValue)->Clone();
+            }
+
+            return std::move(std::get<ConstValue>(value));
+        }
+    };
+
     // Evaluates an expression Ast node into a compile-time primitive.
     // Returns errorous value if the expression is not a compile-time primitive.
-    auto EvalAstInitializer(const AstInitializer& expr) -> ConstValue;
+    auto EvalAstInitializer(const AstInitializer& expr) -> ConstEvalResult;
+
+    // Evaluates an initializer and caches the folded value on the Ast node, so later evaluations are O(1).
+    // Items of a constant aggregate are folded individually. Large payloads are allocated from the arena.
+    // This must only be called while the AST is being built since the Ast node is mutated.
+    auto FoldAstInitializer(MemoryArena& arena, AstInitializer& init) -> void;
 } // namespace glsld
\ No newline at end of file
@@ -24,6 +24,11 @@ namespace glsld
         // For expressions, this is the deduced type of the expression.
         const Type* deducedType = nullptr;
 
+        // [Payload]
+        // The folded value of this initializer if it has been evaluated while building the AST.
+        // Only non-aggregate constants are cached here. The value is allocated from the AST arena.
+        const ConstValue* foldedValue = nullptr;
+
     protected:
         AstInitializer() = default;
 
@@ -57,6 +62,14 @@ namespace glsld
         {
             return deducedType;
         }
+        auto SetFoldedValue(const ConstValue* foldedValue) noexcept -> void
+        {
+            this->foldedValue = foldedValue;
+        }
+        auto GetFoldedValue() const noexcept -> const ConstValue*
+        {
+            return foldedValue;
+        }
     };
 
     // Represents an initializer list like `{1, 2, 3}`.
@@ -82,6 +82,12 @@ namespace glsld
         // If the string is not found, an empty atom string will be returned.
         auto GetAtom(StringView s) const -> AtomString;
 
+        // NOTE the lookup table includes the atoms copied from the preamble AtomTable, but their strings are not.
+        auto GetMemoryUsage() const noexcept -> MemoryUsage
+        {
+            return arena.GetMemoryUsage() + MemoryUsage::Of(atomLookup);
+        }
+
     private:
         auto AddAtom(StringView s) -> AtomString;
     };
@@ -136,10 +136,10 @@ namespace glsld
         auto Overlaps(TextRange range) const noexcept -> bool
         {
             if (start < range.start) {
-                return Contains(range.end);
+                return range.start < end;
             }
             else {
-                return range.Contains(start);
+                return start < range.end;
             }
         }
 
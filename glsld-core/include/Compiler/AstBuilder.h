@@ -6,6 +6,7 @@
 #include "Basic/Common.h"
 #include "Compiler/AstContext.h"
 #include "Compiler/CompilerInvocationState.h"
+#include "Compiler/DiagnosticStream.h"
 #include "Compiler/SymbolTable.h"
 
 namespace glsld
@@ -25,13 +26,22 @@ namespace glsld
 
         SymbolTable& symbolTable;
 
+        DiagnosticReportor diagReporter;
+
         // Return type of the current function. `nullptr` if we are not in a function.
         const Type* returnType;
 
+        // True if all builtin symbols modeled by the stdlib are declared. Builtins of a specific shader stage are only
+        // declared if the stage is known, so unresolved builtins are not diagnosed otherwise. Even then, names of
+        // builtins from extensions and profiles that the stdlib doesn't model are only diagnosed as warnings.
+        bool hasCompleteBuiltins;
+
     public:
         AstBuilder(CompilerInvocationState& compiler)
             : astContext(compiler.GetAstContext()), arena(compiler.GetAstContext().GetArena()),
-              symbolTable(compiler.GetSymbolTable())
+              symbolTable(compiler.GetSymbolTable()), diagReporter(compiler.GetDiagnosticStream()),
+              hasCompleteBuiltins(!compiler.GetLanguageConfig().noStdlib &&
+                                  compiler.GetLanguageConfig().stage != GlslShaderStage::Unknown)
         {
         }
 
@@ -26,6 +26,11 @@ namespace glsld
             return arena;
         }
 
+        auto GetMemoryUsage() const noexcept -> MemoryUsage
+        {
+            return arena.GetMemoryUsage() + MemoryUsage::Of(arrayTypeCache);
+        }
+
         auto CreateStructType(AstStructDecl& decl) -> const Type*;
 
         auto CreateInterfaceBlockType(AstInterfaceBlockDecl& decl) -> const Type*;
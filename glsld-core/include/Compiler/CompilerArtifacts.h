@@ -2,6 +2,7 @@
 
 #include "Ast/Misc.h"
 #include "Compiler/SyntaxToken.h"
+#include "Support/MemoryUsage.h"
 #include <memory>
 
 namespace glsld
@@ -72,5 +73,12 @@ namespace glsld
         {
             return ast;
         }
+
+        // NOTE a reference artifact doesn't own any buffer, so its memory usage is always zero.
+        auto GetMemoryUsage() const noexcept -> MemoryUsage
+        {
+            return MemoryUsage::Of(syntaxTokenBuffer) + MemoryUsage::Of(commentTokenBuffer) +
+                   MemoryUsage::Of(preprocessedFiles);
+        }
     };
 } // namespace glsld
\ No newline at end of file
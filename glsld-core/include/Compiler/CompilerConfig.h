@@ -26,7 +26,7 @@ namespace glsld
         bool dumpAst = false;
 
         // While we only support source file encoded in utf-8, we may need count characters in utf-16 code points
-        // to satisfy the language server protocol spec.
+        // to satisfy the language server protocol spec, unless the client negotiates utf-8 positions.
         bool countUtf16Character = false;
 
         // The maximum number of nested include levels.
@@ -37,6 +37,8 @@ namespace glsld
 
         // The preprocessor definitions.
         std::vector<std::string> defines;
+
+        auto operator==(const CompilerConfig& other) const -> bool = default;
     };
 
     struct LanguageConfig
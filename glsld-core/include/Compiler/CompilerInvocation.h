@@ -11,6 +11,7 @@
 
 #include <chrono>
 #include <memory>
+#include <stop_token>
 #include <vector>
 #include <filesystem>
 
@@ -34,6 +35,9 @@ namespace glsld
 
         // Time spent on parsing
         Duration mainFileParsing;
+
+        // Whether the preamble is taken from the shared stdlib cache instead of being compiled
+        bool preambleCacheHit = false;
     };
 
     class CompilerInvocation final
@@ -52,6 +56,8 @@ namespace glsld
 
         CompilerInvocationStatistics statistics;
 
+        std::stop_token stopToken;
+
     public:
         CompilerInvocation();
         CompilerInvocation(std::shared_ptr<PrecompiledPreamble> preamble);
@@ -140,6 +146,13 @@ namespace glsld
             sourceManager.SetUserPreamble(content);
         }
 
+        // Once stop is requested, compilation of the main file is abandoned as soon as possible. The result is then
+        // incomplete and should be discarded. Preamble compilation is never stopped since the preamble may be shared.
+        auto SetStopToken(std::stop_token token) -> void
+        {
+            stopToken = std::move(token);
+        }
+
         auto SetMainFileFromFile(StringView path) -> void;
 
         // User should ensure that the source text outlive the CompilerInvocation
@@ -161,4 +174,8 @@ namespace glsld
         auto DoParse(CompilerInvocationState& compiler, TranslationUnitID id) -> void;
     };
 
+    // Returns the stdlib cores retained by the process-wide cache that are done compiling. They are shared by every
+    // stdlib preamble of the same version and profile, and are kept alive by the cache even if no document uses them.
+    auto GetCachedStdlibCores() -> std::vector<std::shared_ptr<PrecompiledPreamble>>;
+
 } // namespace glsld
\ No newline at end of file
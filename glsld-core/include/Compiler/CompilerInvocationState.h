@@ -13,6 +13,7 @@
 #include "Compiler/SymbolTable.h"
 
 #include <memory>
+#include <stop_token>
 
 namespace glsld
 {
@@ -49,12 +50,17 @@ namespace glsld
         std::unique_ptr<CompilerArtifact> userPreambleArtifacts;
         std::unique_ptr<CompilerArtifact> userFileArtifacts;
 
+        // Once stop is requested, the compilation is abandoned as soon as possible and the result is incomplete.
+        std::stop_token stopToken;
+
 #if defined(GLSLD_DEBUG)
         mutable CompilerTrace trace;
 #endif
 
         auto Initialize() -> void;
-        auto InitializeStdlib() -> void;
+        auto InitializeStdlib(bool coreOnly) -> void;
+        auto InitializeStdlibStageSegment() -> void;
+        auto DefineShaderStageMacro() -> void;
 
         auto TryDumpTokens(TranslationUnitID id, ArrayView<RawSyntaxToken> tokens) const -> void;
         auto TryDumpAst(TranslationUnitID id, const AstTranslationUnit* ast) const -> void;
@@ -69,12 +75,24 @@ namespace glsld
             Initialize();
             // stdlib imported from preamble if any.
         }
+        // If `stdlibCoreOnly` is true, only the stdlib core is set up as the system preamble. The stage segment could
+        // then be compiled on top of it with the constructor below.
         CompilerInvocationState(SourceManager& sourceManager, CompilerConfig compilerConfig,
-                                LanguageConfig languageConfig)
+                                LanguageConfig languageConfig, bool stdlibCoreOnly = false)
             : sourceManager(sourceManager), compilerConfig(compilerConfig), languageConfig(languageConfig)
         {
             Initialize();
-            InitializeStdlib();
+            InitializeStdlib(stdlibCoreOnly);
+        }
+        // Set up the stdlib stage segment of `languageConfig` as the user preamble on top of a precompiled stdlib core.
+        CompilerInvocationState(SourceManager& sourceManager, CompilerConfig compilerConfig,
+                                std::shared_ptr<PrecompiledPreamble> stdlibCore, LanguageConfig languageConfig)
+            : sourceManager(sourceManager), compilerConfig(compilerConfig), languageConfig(languageConfig),
+              preamble(std::move(stdlibCore))
+        {
+            GLSLD_ASSERT(this->preamble != nullptr);
+            Initialize();
+            InitializeStdlibStageSegment();
         }
 
         auto GetSourceManager() noexcept -> SourceManager&
@@ -111,6 +129,15 @@ namespace glsld
             return *diagStream;
         }
 
+        auto SetStopToken(std::stop_token token) noexcept -> void
+        {
+            stopToken = std::move(token);
+        }
+        auto IsStopRequested() const noexcept -> bool
+        {
+            return stopToken.stop_requested();
+        }
+
 #if defined(GLSLD_DEBUG)
         auto GetCompilerTrace() const noexcept -> CompilerTrace&
         {
@@ -144,13 +171,14 @@ namespace glsld
             return std::make_shared<PrecompiledPreamble>(
                 languageConfig, sourceManager.GetSystemPreamble(), sourceManager.GetUserPreamble(),
                 std::move(atomTable), std::move(macroTable), std::move(symbolTable), std::move(astContext),
-                std::move(systemPreambleArtifacts), std::move(userPreambleArtifacts));
+                std::move(systemPreambleArtifacts), std::move(userPreambleArtifacts), std::move(preamble));
         }
         auto CreateCompileResult() noexcept -> std::unique_ptr<CompilerResult>
         {
             return std::make_unique<CompilerResult>(std::move(preamble), std::move(atomTable), std::move(astContext),
                                                     std::move(systemPreambleArtifacts),
-                                                    std::move(userPreambleArtifacts), std::move(userFileArtifacts));
+                                                    std::move(userPreambleArtifacts), std::move(userFileArtifacts),
+                                                    std::move(diagStream));
         }
     };
 } // namespace glsld
\ No newline at end of file
@@ -5,6 +5,7 @@
 #include "Compiler/AstContext.h"
 #include "Compiler/CompilerArtifacts.h"
 #include "Compiler/CompilerConfig.h"
+#include "Compiler/DiagnosticStream.h"
 #include "Compiler/MacroTable.h"
 #include "Compiler/SymbolTable.h"
 
@@ -12,9 +13,13 @@
 
 namespace glsld
 {
+    // A preamble could be composed on top of a base preamble, e.g. the stdlib segment of a shader stage is compiled on
+    // top of the stdlib core shared by all stages. In that case, the system preamble is inherited from the base.
     class PrecompiledPreamble
     {
     private:
+        std::shared_ptr<const PrecompiledPreamble> basePreamble;
+
         LanguageConfig languageConfig;
 
         std::string systemPreambleText;
@@ -33,10 +38,12 @@ namespace glsld
                             std::unique_ptr<const AtomTable> atomTable, std::unique_ptr<const MacroTable> macroTable,
                             std::unique_ptr<SymbolTable> symbolTable, std::unique_ptr<const AstContext> astContext,
                             std::unique_ptr<const CompilerArtifact> systemPreambleArtifacts,
-                            std::unique_ptr<const CompilerArtifact> userPreambleArtifacts)
-            : languageConfig(languageConfig), systemPreambleText(systemPreamble), userPreambleText(userPreamble),
-              atomTable(std::move(atomTable)), macroTable(std::move(macroTable)), symbolTable(std::move(symbolTable)),
-              astContext(std::move(astContext)), systemPreambleArtifacts(std::move(systemPreambleArtifacts)),
+                            std::unique_ptr<const CompilerArtifact> userPreambleArtifacts,
+                            std::shared_ptr<const PrecompiledPreamble> basePreamble = nullptr)
+            : basePreamble(std::move(basePreamble)), languageConfig(languageConfig), systemPreambleText(systemPreamble),
+              userPreambleText(userPreamble), atomTable(std::move(atomTable)), macroTable(std::move(macroTable)),
+              symbolTable(std::move(symbolTable)), astContext(std::move(astContext)),
+              systemPreambleArtifacts(std::move(systemPreambleArtifacts)),
               userPreambleArtifacts(std::move(userPreambleArtifacts))
         {
         }
@@ -46,9 +53,21 @@ namespace glsld
             return languageConfig;
         }
 
+        auto GetBasePreamble() const noexcept -> const PrecompiledPreamble*
+        {
+            return basePreamble.get();
+        }
+
+        // Returns true if the user preamble is the stdlib segment of a shader stage rather than text from the user.
+        // Only such preambles are composed on top of a base preamble.
+        auto HasStdlibStageSegment() const noexcept -> bool
+        {
+            return basePreamble != nullptr;
+        }
+
         auto GetSystemPreamble() const noexcept -> SourceTextView
         {
-            return systemPreambleText;
+            return basePreamble ? basePreamble->GetSystemPreamble() : SourceTextView{systemPreambleText};
         }
 
         auto GetUserPreamble() const noexcept -> SourceTextView
@@ -81,6 +100,24 @@ namespace glsld
         {
             return *userPreambleArtifacts;
         }
+
+        // Returns the memory of the text of the preambles, excluding the base preamble.
+        auto GetSourceMemoryUsage() const noexcept -> MemoryUsage
+        {
+            return MemoryUsage::Of(systemPreambleText) + MemoryUsage::Of(userPreambleText);
+        }
+
+        // Returns the memory of the AST and the atoms, excluding the base preamble.
+        auto GetAstMemoryUsage() const noexcept -> MemoryUsage
+        {
+            return astContext->GetMemoryUsage() + atomTable->GetMemoryUsage();
+        }
+
+        // Returns the memory of the token buffers, excluding the base preamble.
+        auto GetTokenMemoryUsage() const noexcept -> MemoryUsage
+        {
+            return systemPreambleArtifacts->GetMemoryUsage() + userPreambleArtifacts->GetMemoryUsage();
+        }
     };
 
     class CompilerResult
@@ -95,15 +132,19 @@ namespace glsld
         std::unique_ptr<const CompilerArtifact> userPreambleArtifacts   = nullptr;
         std::unique_ptr<const CompilerArtifact> userFileArtifacts       = nullptr;
 
+        std::unique_ptr<const DiagnosticStream> diagStream = nullptr;
+
     public:
         CompilerResult(std::shared_ptr<PrecompiledPreamble> preamble, std::unique_ptr<const AtomTable> atomTable,
                        std::unique_ptr<const AstContext> astContext,
                        std::unique_ptr<const CompilerArtifact> systemPreambleArtifacts,
                        std::unique_ptr<const CompilerArtifact> userPreambleArtifacts,
-                       std::unique_ptr<const CompilerArtifact> userFileArtifacts)
+                       std::unique_ptr<const CompilerArtifact> userFileArtifacts,
+                       std::unique_ptr<const DiagnosticStream> diagStream)
             : preamble(std::move(preamble)), atomTable(std::move(atomTable)), astContext(std::move(astContext)),
               systemPreambleArtifacts(std::move(systemPreambleArtifacts)),
-              userPreambleArtifacts(std::move(userPreambleArtifacts)), userFileArtifacts(std::move(userFileArtifacts))
+              userPreambleArtifacts(std::move(userPreambleArtifacts)), userFileArtifacts(std::move(userFileArtifacts)),
+              diagStream(std::move(diagStream))
         {
         }
 
@@ -124,6 +165,25 @@ namespace glsld
         {
             return *userFileArtifacts;
         }
+
+        // Diagnostics reported during the compilation, including those of the preambles if they are not precompiled.
+        auto GetDiagnosticStream() const noexcept -> const DiagnosticStream&
+        {
+            return *diagStream;
+        }
+
+        // Returns the memory of the AST and the atoms, excluding the preamble which may be shared.
+        auto GetAstMemoryUsage() const noexcept -> MemoryUsage
+        {
+            return astContext->GetMemoryUsage() + atomTable->GetMemoryUsage();
+        }
+
+        // Returns the memory of the token buffers, excluding the preamble which may be shared.
+        auto GetTokenMemoryUsage() const noexcept -> MemoryUsage
+        {
+            return systemPreambleArtifacts->GetMemoryUsage() + userPreambleArtifacts->GetMemoryUsage() +
+                   userFileArtifacts->GetMemoryUsage();
+        }
     };
 
 } // namespace glsld
\ No newline at end of file
@@ -1,14 +1,18 @@
 #pragma once
+#include "Basic/SourceInfo.h"
 #include "Compiler/SyntaxToken.h"
-#include "SyntaxToken.h"
+#include "Support/ArraySpan.h"
 
+#include <variant>
 #include <vector>
 
 namespace glsld
 {
     struct DiagnosticMessage
     {
-        AstSyntaxRange range;
+        // Diagnostics from the parser and the type checker are reported on syntax tokens. However, the preprocessor
+        // doesn't produce syntax tokens for directives, so its diagnostics are reported on the spelled text instead.
+        std::variant<AstSyntaxRange, FileTextRange> range;
         std::string message;
     };
 
@@ -24,10 +28,30 @@ namespace glsld
             errorStream.push_back({range, std::move(message)});
         }
 
+        auto ReportError(FileTextRange range, std::string message) -> void
+        {
+            errorStream.push_back({range, std::move(message)});
+        }
+
         auto ReportWarning(AstSyntaxRange range, std::string message) -> void
         {
             warningStream.push_back({range, std::move(message)});
         }
+
+        auto ReportWarning(FileTextRange range, std::string message) -> void
+        {
+            warningStream.push_back({range, std::move(message)});
+        }
+
+        auto GetErrors() const noexcept -> ArrayView<DiagnosticMessage>
+        {
+            return errorStream;
+        }
+
+        auto GetWarnings() const noexcept -> ArrayView<DiagnosticMessage>
+        {
+            return warningStream;
+        }
     };
 
     class DiagnosticReportor
@@ -68,17 +92,47 @@ namespace glsld
         }
 
 #pragma region PP Diag
-        auto UnterminatedMacroExpansion(AstSyntaxRange range) -> void
+        auto ReportError(FileTextRange range, std::string message) -> void
+        {
+            stream.ReportError(range, std::move(message));
+        }
+
+        auto ReportWarning(FileTextRange range, std::string message) -> void
         {
+            stream.ReportWarning(range, std::move(message));
         }
 
-        auto UnterminatedPPRegion(AstSyntaxRange range) -> void
+        auto UnterminatedPPRegion(FileTextRange range) -> void
         {
+            stream.ReportError(range, "unterminated conditional directive");
         }
 #pragma endregion
 
 #pragma region Parse Diag
 
+#pragma endregion
+
+#pragma region Sema Diag
+        auto UndeclaredIdentifier(AstSyntaxRange range, StringView name) -> void
+        {
+            ReportError(range, "use of undeclared identifier '{}'", name);
+        }
+
+        auto NoMatchingFunction(AstSyntaxRange range, StringView name) -> void
+        {
+            ReportError(range, "no matching function for call to '{}'", name);
+        }
+
+        // The builtin may come from an extension or profile that isn't modeled by the stdlib, so it's not an error.
+        auto UnknownBuiltinIdentifier(AstSyntaxRange range, StringView name) -> void
+        {
+            ReportWarning(range, "use of unknown builtin identifier '{}'", name);
+        }
+
+        auto UnknownBuiltinFunction(AstSyntaxRange range, StringView name) -> void
+        {
+            ReportWarning(range, "no known builtin function matches the call to '{}'", name);
+        }
 #pragma endregion
     };
-} // namespace glsld
\ No newline at end of file
+} // namespace glsld
@@ -520,6 +520,34 @@ namespace glsld
             });
         }
 
+        // Report an error on the spelled text of a token.
+        auto ReportError(const PPToken& token, std::string message) -> void
+        {
+            diagReporter.ReportError(FileTextRange{token.spelledFile, token.spelledRange}, std::move(message));
+        }
+
+        // Report an error on the spelled text of the whole directive.
+        auto ReportDirectiveError(const PPTokenScanner& scanner, std::string message) -> void
+        {
+            diagReporter.ReportError(GetDirectiveRange(scanner), std::move(message));
+        }
+
+        // Report a warning on the spelled text of the whole directive.
+        auto ReportDirectiveWarning(const PPTokenScanner& scanner, std::string message) -> void
+        {
+            diagReporter.ReportWarning(GetDirectiveRange(scanner), std::move(message));
+        }
+
+        static auto GetDirectiveRange(const PPTokenScanner& scanner) -> FileTextRange
+        {
+            auto tokens = scanner.AllTokens();
+            GLSLD_ASSERT(!tokens.empty());
+            return FileTextRange{
+                .fileID = tokens.front().spelledFile,
+                .range  = TextRange{tokens.front().spelledRange.start, tokens.back().spelledRange.end},
+            };
+        }
+
         // Possible transitions:
         // - ExpectDirective -> Default (Empty directive parsed)
         // - ExpectDefaultDirectiveTail -> Default (A PP directive handled)
@@ -550,9 +578,10 @@ namespace glsld
 
         // Possible transitions:
         // - Default -> Halt (See the first token that is not comment nor part of preprocessor in version scanning mode)
+        // - Inactive -> Halt (See EOF in an unterminated inactive region)
         auto TransitionToHaltState() -> void
         {
-            GLSLD_ASSERT(state == PreprocessorState::Default);
+            GLSLD_ASSERT(state == PreprocessorState::Default || state == PreprocessorState::Inactive);
             state = PreprocessorState::Halt;
         }
 
@@ -607,6 +636,7 @@ namespace glsld
         auto HandleElifDirective(PPTokenScanner& scanner) -> void;
         auto HandleElseDirective(PPTokenScanner& scanner) -> void;
         auto HandleEndifDirective(PPTokenScanner& scanner) -> void;
+        auto HandleErrorDirective(PPTokenScanner& scanner) -> void;
         auto HandleExtensionDirective(PPTokenScanner& scanner) -> void;
         auto HandleVersionDirective(PPTokenScanner& scanner) -> void;
         auto HandlePragmaDirective(PPTokenScanner& scanner) -> void;
@@ -20,8 +20,12 @@ namespace glsld
 
     struct FunctionSymbolEntry
     {
+        // The declaration of this function, which is never null. For builtin functions, this is the prototype in the
+        // system preamble.
         const AstFunctionDecl* decl;
 
+        const Type* returnType;
+
         std::vector<FunctionParamSymbolEntry> paramEntries;
     };
 
@@ -152,8 +156,8 @@ namespace glsld
         // Find a declaration by name
         auto FindSymbol(StringView name) const -> const AstDecl*;
 
-        // Find a function declaration by name and argument types
+        // Find a function by name and argument types
         auto FindFunction(StringView name, const std::vector<const Type*>& argTypes, bool requireExactMatch) const
-            -> const AstFunctionDecl*;
+            -> const FunctionSymbolEntry*;
     };
 } // namespace glsld
\ No newline at end of file
@@ -299,6 +299,12 @@ namespace glsld
             return endID - 1;
         }
 
+        auto Contains(SyntaxTokenID id) const noexcept -> bool
+        {
+            return id.GetTU() == GetTranslationUnit() && beginID.GetTokenIndex() <= id.GetTokenIndex() &&
+                   id.GetTokenIndex() < endID.GetTokenIndex();
+        }
+
         auto begin() const noexcept -> Iterator
         {
             return Iterator{beginID};
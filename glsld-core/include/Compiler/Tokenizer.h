@@ -29,7 +29,8 @@ namespace glsld
         // The character offset in the current line of the current cursor position.
         int characterCounter = 0;
 
-        // Count in utf-16 code units instead of utf-8. LSP requires utf-16 code units.
+        // Count in utf-16 code units instead of utf-8. LSP defaults to utf-16 code units unless the client negotiates
+        // utf-8 positions.
         bool countUtf16Characters = false;
 
         std::vector<char> tokenTextBuffer;
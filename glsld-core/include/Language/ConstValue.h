@@ -2,6 +2,7 @@
 #include "Basic/Common.h"
 #include "Language/Semantic.h"
 #include "Language/Typing.h"
+#include "Support/MemoryArena.h"
 #include "Support/StringView.h"
 
 #include <algorithm>
@@ -28,6 +29,10 @@ namespace glsld
         // Column dimension. For scalar, this is 1. For error, this is 0.
         int16_t colSize;
 
+        // Whether `bufferPtr` is borrowed from an external storage (e.g. a memory arena) instead of owned by us.
+        // Borrowed buffers are never released by this value and must outlive it.
+        bool borrowedBuffer;
+
         // We do small buffer optimization here. If the constant value doesn't fit the buffer, we use heap memory.
         union
         {
@@ -36,12 +41,12 @@ namespace glsld
         };
 
     public:
-        ConstValue() : scalarType(0), arraySize(0), rowSize(0), colSize(0), localBuffer()
+        ConstValue() : scalarType(0), arraySize(0), rowSize(0), colSize(0), borrowedBuffer(false), localBuffer()
         {
         }
         ~ConstValue()
         {
-            if (UseHeapBuffer()) {
+            if (OwnsHeapBuffer()) {
                 GLSLD_ASSERT(bufferPtr != nullptr);
                 delete[] bufferPtr;
                 bufferPtr = nullptr;
@@ -53,22 +58,24 @@ namespace glsld
         ConstValue& operator=(const ConstValue& other) = delete;
 
         ConstValue(ConstValue&& other) noexcept
-            : scalarType(other.scalarType), arraySize(other.arraySize), rowSize(other.rowSize), colSize(other.colSize)
+            : scalarType(other.scalarType), arraySize(other.arraySize), rowSize(other.rowSize), colSize(other.colSize),
+              borrowedBuffer(other.borrowedBuffer)
         {
             std::ranges::copy(other.localBuffer, localBuffer);
             other.InitializeAsError();
         }
         ConstValue& operator=(ConstValue&& other) noexcept
         {
-            if (UseHeapBuffer()) {
+            if (OwnsHeapBuffer()) {
                 GLSLD_ASSERT(bufferPtr != nullptr);
                 delete[] bufferPtr;
             }
 
-            scalarType = other.scalarType;
-            arraySize  = other.arraySize;
-            rowSize    = other.rowSize;
-            colSize    = other.colSize;
+            scalarType     = other.scalarType;
+            arraySize      = other.arraySize;
+            rowSize        = other.rowSize;
+            colSize        = other.colSize;
+            borrowedBuffer = other.borrowedBuffer;
             std::ranges::copy(other.localBuffer, localBuffer);
             other.InitializeAsError();
             return *this;
@@ -192,6 +199,12 @@ namespace glsld
             return arraySize == 0;
         }
 
+        // Returns true if the buffer is borrowed from a storage that outlives this value, e.g. the arena of the Ast.
+        auto IsBufferBorrowed() const noexcept -> bool
+        {
+            return borrowedBuffer;
+        }
+
         auto IsScalar() const noexcept -> bool
         {
             return arraySize == 1;
@@ -284,8 +297,14 @@ namespace glsld
         auto GetScalarSize() const noexcept -> int;
 
         auto ToString() const -> std::string;
+
+        // Clone the constant value. The result always owns its buffer, even if the buffer of this value is borrowed.
         auto Clone() const -> ConstValue;
 
+        // Clone the constant value with any buffer that doesn't fit the local buffer allocated from the arena.
+        // The result borrows memory from the arena and must not outlive it.
+        auto CloneToArena(MemoryArena& arena) const -> ConstValue;
+
         // Cast the underlying scalar type to the given kind while keeping the shape.
         auto CastScalar(ScalarKind kind) const -> ConstValue;
         auto GetElement(int index) const -> ConstValue;
@@ -310,6 +329,9 @@ namespace glsld
         auto ElemwiseShiftLeft(const ConstValue& other) const -> ConstValue;
         auto ElemwiseShiftRight(const ConstValue& other) const -> ConstValue;
 
+        // Linear algebraic multiplication for `mat * mat`, `mat * vec` and `vec * mat`.
+        auto MatrixMul(const ConstValue& other) const -> ConstValue;
+
         auto ElemwiseEquals(const ConstValue& other) const -> ConstValue;
         auto ElemwiseNotEquals(const ConstValue& other) const -> ConstValue;
         auto ElemwiseLessThan(const ConstValue& other) const -> ConstValue;
@@ -383,46 +405,137 @@ namespace glsld
             }
         }
 
+        // Invoke `f` with `std::type_identity<T>` where `T` is the C++ type of the given scalar kind.
+        // Returns an error value for unsupported scalar kinds.
+        template <typename F>
+        static auto DispatchScalarKind(ScalarKind kind, F&& f) -> ConstValue
+        {
+            switch (kind) {
+            case ScalarKind::Bool:
+                return f(std::type_identity<bool>{});
+            case ScalarKind::Int:
+                return f(std::type_identity<int32_t>{});
+            case ScalarKind::Uint:
+                return f(std::type_identity<uint32_t>{});
+            case ScalarKind::Float:
+                return f(std::type_identity<float>{});
+            case ScalarKind::Double:
+                return f(std::type_identity<double>{});
+            case ScalarKind::Int8:
+                return f(std::type_identity<int8_t>{});
+            case ScalarKind::Int16:
+                return f(std::type_identity<int16_t>{});
+            case ScalarKind::Int64:
+                return f(std::type_identity<int64_t>{});
+            case ScalarKind::Uint8:
+                return f(std::type_identity<uint8_t>{});
+            case ScalarKind::Uint16:
+                return f(std::type_identity<uint16_t>{});
+            case ScalarKind::Uint64:
+                return f(std::type_identity<uint64_t>{});
+            case ScalarKind::Float16:
+                GLSLD_NO_IMPL();
+            default:
+                return ConstValue();
+            }
+        }
+
+        // The kernels below work on raw buffers with branch-free inner loops, so compilers could vectorize them.
+        // Scalar kinds and shapes must have been validated by the caller.
+
         template <typename T, typename U, typename F>
         auto ApplyElemwiseUnaryOpUnsafe(F f) const -> ConstValue
         {
             ConstValue result;
 
-            auto srcBuffer = GetBufferAs<T>();
-            auto dstBuffer = result.InitializeAs<U>(rowSize, colSize);
-
-            for (int i = 0; i < arraySize; ++i) {
-                dstBuffer[i] = f(srcBuffer[i]);
+            const T* src = GetBufferAs<T>().data();
+            U* dst       = result.InitializeAs<U>(rowSize, colSize).data();
+            const int n  = arraySize;
+            for (int i = 0; i < n; ++i) {
+                dst[i] = static_cast<U>(f(src[i]));
             }
             return result;
         }
 
-        template <typename T, typename F>
+        // Apply a binary operation element-wisely. If exactly one of the operands is a scalar, it is broadcast to
+        // the shape of the other operand. Otherwise, both operands must have the same shape.
+        template <typename T, typename U, typename F>
         auto ApplyElemwiseBinaryOpUnsafe(const ConstValue& other, F f) const -> ConstValue
         {
-            ConstValue result;
+            const bool broadcastLhs = IsScalar() && !other.IsScalar();
+            const bool broadcastRhs = !IsScalar() && other.IsScalar();
+            if (!broadcastLhs && !broadcastRhs && (rowSize != other.rowSize || colSize != other.colSize)) {
+                return ConstValue();
+            }
+
+            const ConstValue& shape = broadcastLhs ? other : *this;
 
-            auto srcBuffer1 = GetBufferAs<T>();
-            auto srcBuffer2 = other.GetBufferAs<T>();
-            auto dstBuffer  = result.InitializeAs<T>(rowSize, colSize);
+            ConstValue result;
 
-            for (int i = 0; i < arraySize; ++i) {
-                dstBuffer[i] = f(srcBuffer1[i], srcBuffer2[i]);
+            const T* lhs = GetBufferAs<T>().data();
+            const T* rhs = other.GetBufferAs<T>().data();
+            U* dst       = result.InitializeAs<U>(shape.rowSize, shape.colSize).data();
+            const int n  = shape.arraySize;
+            if (broadcastLhs) {
+                const T x = lhs[0];
+                for (int i = 0; i < n; ++i) {
+                    dst[i] = static_cast<U>(f(x, rhs[i]));
+                }
+            }
+            else if (broadcastRhs) {
+                const T y = rhs[0];
+                for (int i = 0; i < n; ++i) {
+                    dst[i] = static_cast<U>(f(lhs[i], y));
+                }
+            }
+            else {
+                for (int i = 0; i < n; ++i) {
+                    dst[i] = static_cast<U>(f(lhs[i], rhs[i]));
+                }
             }
             return result;
         }
 
-        template <typename T, typename F>
-        auto ApplyElemwiseComparisonOpUnsafe(const ConstValue& other, F f) const -> ConstValue
+        // Linear algebraic multiplication of matrices and vectors. Matrices are stored column-major, where `rowSize`
+        // is the number of columns and `colSize` is the number of rows. A vector is treated as a row vector on the
+        // left-hand side and a column vector on the right-hand side.
+        template <typename T>
+        auto ApplyMatrixMulUnsafe(const ConstValue& other) const -> ConstValue
         {
+            const int lhsCols = IsVector() ? colSize : rowSize;
+            const int lhsRows = IsVector() ? 1 : colSize;
+            const int rhsCols = other.IsVector() ? 1 : other.rowSize;
+            const int rhsRows = other.colSize;
+            if (lhsCols != rhsRows) {
+                return ConstValue();
+            }
+
             ConstValue result;
 
-            auto srcBuffer1 = GetBufferAs<T>();
-            auto srcBuffer2 = other.GetBufferAs<T>();
-            auto dstBuffer  = result.InitializeAs<bool>(rowSize, colSize);
+            const T* lhs = GetBufferAs<T>().data();
+            const T* rhs = other.GetBufferAs<T>().data();
+            T* dst       = nullptr;
+            if (IsVector()) {
+                dst = result.InitializeAs<T>(1, rhsCols).data();
+            }
+            else if (other.IsVector()) {
+                dst = result.InitializeAs<T>(1, lhsRows).data();
+            }
+            else {
+                dst = result.InitializeAs<T>(rhsCols, lhsRows).data();
+            }
 
-            for (int i = 0; i < arraySize; ++i) {
-                dstBuffer[i] = f(srcBuffer1[i], srcBuffer2[i]);
+            // dst[c][r] = sum(lhs[k][r] * rhs[c][k]), accumulated column by column so the inner loop is contiguous.
+            std::fill_n(dst, rhsCols * lhsRows, T{});
+            for (int c = 0; c < rhsCols; ++c) {
+                T* dstCol = dst + c * lhsRows;
+                for (int k = 0; k < lhsCols; ++k) {
+                    const T* lhsCol = lhs + k * lhsRows;
+                    const T factor  = rhs[c * rhsRows + k];
+                    for (int r = 0; r < lhsRows; ++r) {
+                        dstCol[r] += lhsCol[r] * factor;
+                    }
+                }
             }
             return result;
         }
@@ -430,166 +543,56 @@ namespace glsld
         template <typename TargetType>
         auto ApplyElemwiseCast() const -> ConstValue
         {
-            switch (GetScalarKind()) {
-            case ScalarKind::Bool:
-                return ApplyElemwiseUnaryOpUnsafe<bool, TargetType>([](bool x) { return static_cast<TargetType>(x); });
-            case ScalarKind::Int:
-                return ApplyElemwiseUnaryOpUnsafe<int32_t, TargetType>(
-                    [](int32_t x) { return static_cast<TargetType>(x); });
-            case ScalarKind::Uint:
-                return ApplyElemwiseUnaryOpUnsafe<uint32_t, TargetType>(
-                    [](uint32_t x) { return static_cast<TargetType>(x); });
-            case ScalarKind::Float:
-                return ApplyElemwiseUnaryOpUnsafe<float, TargetType>(
-                    [](float x) { return static_cast<TargetType>(x); });
-            case ScalarKind::Double:
-                return ApplyElemwiseUnaryOpUnsafe<double, TargetType>(
-                    [](double x) { return static_cast<TargetType>(x); });
-            case ScalarKind::Int8:
-                return ApplyElemwiseUnaryOpUnsafe<int8_t, TargetType>(
-                    [](int8_t x) { return static_cast<TargetType>(x); });
-            case ScalarKind::Int16:
-                return ApplyElemwiseUnaryOpUnsafe<int16_t, TargetType>(
-                    [](int16_t x) { return static_cast<TargetType>(x); });
-            case ScalarKind::Int64:
-                return ApplyElemwiseUnaryOpUnsafe<int64_t, TargetType>(
-                    [](int64_t x) { return static_cast<TargetType>(x); });
-            case ScalarKind::Uint8:
-                return ApplyElemwiseUnaryOpUnsafe<uint8_t, TargetType>(
-                    [](uint8_t x) { return static_cast<TargetType>(x); });
-            case ScalarKind::Uint16:
-                return ApplyElemwiseUnaryOpUnsafe<uint16_t, TargetType>(
-                    [](uint16_t x) { return static_cast<TargetType>(x); });
-            case ScalarKind::Uint64:
-                return ApplyElemwiseUnaryOpUnsafe<uint64_t, TargetType>(
-                    [](uint64_t x) { return static_cast<TargetType>(x); });
-            case ScalarKind::Float16:
-                GLSLD_NO_IMPL();
-            default:
-                return ConstValue();
-            }
+            return DispatchScalarKind(GetScalarKind(), [this]<typename T>(std::type_identity<T>) {
+                return ApplyElemwiseUnaryOpUnsafe<T, TargetType>([](T x) { return static_cast<TargetType>(x); });
+            });
         }
 
         template <typename F>
         auto ApplyElemwiseUnaryOp(F f) const -> ConstValue
         {
-#define SWITCH_CASE(CPPTYPE)                                                                                           \
-    if constexpr (requires(CPPTYPE x) { f(x); }) {                                                                     \
-        return ApplyElemwiseUnaryOpUnsafe<CPPTYPE, CPPTYPE>(f);                                                        \
-    }                                                                                                                  \
-    else {                                                                                                             \
-        return ConstValue();                                                                                           \
-    }
-            switch (static_cast<ScalarKind>(scalarType)) {
-            case ScalarKind::Bool:
-                SWITCH_CASE(bool)
-            case ScalarKind::Int:
-                SWITCH_CASE(int32_t)
-            case ScalarKind::Uint:
-                SWITCH_CASE(uint32_t)
-            case ScalarKind::Float:
-                SWITCH_CASE(float)
-            case ScalarKind::Double:
-                SWITCH_CASE(double)
-            case ScalarKind::Int8:
-                SWITCH_CASE(int8_t)
-            case ScalarKind::Int16:
-                SWITCH_CASE(int16_t)
-            case ScalarKind::Int64:
-                SWITCH_CASE(int64_t)
-            case ScalarKind::Uint8:
-                SWITCH_CASE(int8_t)
-            case ScalarKind::Uint16:
-                SWITCH_CASE(uint16_t)
-            case ScalarKind::Uint64:
-                SWITCH_CASE(uint64_t)
-            case ScalarKind::Float16:
-                GLSLD_NO_IMPL();
-            default:
-                return ConstValue();
-            }
-#undef SWITCH_CASE
+            return DispatchScalarKind(GetScalarKind(), [this, &f]<typename T>(std::type_identity<T>) {
+                if constexpr (requires(T x) { f(x); }) {
+                    return ApplyElemwiseUnaryOpUnsafe<T, T>(f);
+                }
+                else {
+                    return ConstValue();
+                }
+            });
         }
 
         template <typename F>
         auto ApplyElemwiseBinaryOp(const ConstValue& other, F f) const -> ConstValue
         {
-#define SWITCH_CASE(CPPTYPE)                                                                                           \
-    if constexpr (requires(CPPTYPE x) { f(x, x); }) {                                                                  \
-        return ApplyElemwiseBinaryOpUnsafe<CPPTYPE>(other, f);                                                         \
-    }                                                                                                                  \
-    else {                                                                                                             \
-        return ConstValue();                                                                                           \
-    }
-            switch (static_cast<ScalarKind>(scalarType)) {
-            case ScalarKind::Bool:
-                SWITCH_CASE(bool)
-            case ScalarKind::Int:
-                SWITCH_CASE(int32_t)
-            case ScalarKind::Uint:
-                SWITCH_CASE(uint32_t)
-            case ScalarKind::Float:
-                SWITCH_CASE(float)
-            case ScalarKind::Double:
-                SWITCH_CASE(double)
-            case ScalarKind::Int8:
-                SWITCH_CASE(int8_t)
-            case ScalarKind::Int16:
-                SWITCH_CASE(int16_t)
-            case ScalarKind::Int64:
-                SWITCH_CASE(int64_t)
-            case ScalarKind::Uint8:
-                SWITCH_CASE(int8_t)
-            case ScalarKind::Uint16:
-                SWITCH_CASE(uint16_t)
-            case ScalarKind::Uint64:
-                SWITCH_CASE(uint64_t)
-            case ScalarKind::Float16:
-                GLSLD_NO_IMPL();
-            default:
+            if (GetScalarKind() != other.GetScalarKind()) {
                 return ConstValue();
             }
-#undef SWITCH_CASE
+
+            return DispatchScalarKind(GetScalarKind(), [this, &other, &f]<typename T>(std::type_identity<T>) {
+                if constexpr (requires(T x) { f(x, x); }) {
+                    return ApplyElemwiseBinaryOpUnsafe<T, T>(other, f);
+                }
+                else {
+                    return ConstValue();
+                }
+            });
         }
 
         template <typename F>
         auto ApplyElemwiseComparisonOp(const ConstValue& other, F f) const -> ConstValue
         {
-#define SWITCH_CASE(CPPTYPE)                                                                                           \
-    if constexpr (requires(CPPTYPE x) { f(x, x); }) {                                                                  \
-        return ApplyElemwiseComparisonOpUnsafe<CPPTYPE>(other, f);                                                     \
-    }                                                                                                                  \
-    else {                                                                                                             \
-        return ConstValue();                                                                                           \
-    }
-            switch (static_cast<ScalarKind>(scalarType)) {
-            case ScalarKind::Bool:
-                SWITCH_CASE(bool)
-            case ScalarKind::Int:
-                SWITCH_CASE(int32_t)
-            case ScalarKind::Uint:
-                SWITCH_CASE(uint32_t)
-            case ScalarKind::Float:
-                SWITCH_CASE(float)
-            case ScalarKind::Double:
-                SWITCH_CASE(double)
-            case ScalarKind::Int8:
-                SWITCH_CASE(int8_t)
-            case ScalarKind::Int16:
-                SWITCH_CASE(int16_t)
-            case ScalarKind::Int64:
-                SWITCH_CASE(int64_t)
-            case ScalarKind::Uint8:
-                SWITCH_CASE(int8_t)
-            case ScalarKind::Uint16:
-                SWITCH_CASE(uint16_t)
-            case ScalarKind::Uint64:
-                SWITCH_CASE(uint64_t)
-            case ScalarKind::Float16:
-                GLSLD_NO_IMPL();
-            default:
+            if (GetScalarKind() != other.GetScalarKind()) {
                 return ConstValue();
             }
+
+            return DispatchScalarKind(GetScalarKind(), [this, &other, &f]<typename T>(std::type_identity<T>) {
+                if constexpr (requires(T x) { f(x, x); }) {
+                    return ApplyElemwiseBinaryOpUnsafe<T, bool>(other, f);
+                }
+                else {
+                    return ConstValue();
+                }
+            });
         }
 
         auto GetBufferSize() const noexcept -> size_t
@@ -612,13 +615,19 @@ namespace glsld
             return GetBufferSize() > sizeof(localBuffer);
         }
 
+        auto OwnsHeapBuffer() const noexcept -> bool
+        {
+            return UseHeapBuffer() && !borrowedBuffer;
+        }
+
         // Note this doesn't release the memory of existing heap pointer
         auto InitializeAsError() -> void
         {
-            scalarType = 0;
-            arraySize  = 0;
-            rowSize    = 0;
-            colSize    = 0;
+            scalarType     = 0;
+            arraySize      = 0;
+            rowSize        = 0;
+            colSize        = 0;
+            borrowedBuffer = false;
             std::ranges::fill(localBuffer, std::byte(0));
         }
 
@@ -2,7 +2,7 @@
 #include "Basic/SourceInfo.h"
 
 namespace glsld {
-inline constinit SourceTextView GlslStdlibText = R"glsl(
+inline constinit SourceTextView GlslStdlibCoreText = R"glsl(
 
 const int gl_MaxVertexAttribs = 16;
 const int gl_MaxVertexUniformVectors = 256;
@@ -82,153 +82,8 @@ const highp int gl_MaxInputAttachments = 1; // only present when targeting Vulka
 #endif
 
 
-#if __GLSLD_SHADER_STAGE_VERTEX
-
-#if __GLSLD_TARGET_API_OPENGL
-in int gl_VertexID;
-in int gl_InstanceID;
-#endif
-
-#if __GLSLD_TARGET_API_VULKAN
-in int gl_VertexIndex;
-in int gl_InstanceIndex;
-#endif
-
-in int gl_DrawID;
-in int gl_BaseVertex;
-in int gl_BaseInstance;
-
-out gl_PerVertex {
-    vec4 gl_Position;
-    float gl_PointSize;
-    float gl_ClipDistance[];
-    float gl_CullDistance[];
-};
-
-#endif
-
-
-
-#if __GLSLD_SHADER_STAGE_FRAGMENT
-
-in vec4  gl_FragCoord;
-in bool  gl_FrontFacing;
-in float gl_ClipDistance[];
-in float gl_CullDistance[];
-in vec2 gl_PointCoord;
-flat in int gl_PrimitiveID;
-flat in  int  gl_SampleID;
-in  vec2 gl_SamplePosition;
-flat in  int  gl_SampleMaskIn[];
-flat in int gl_Layer;
-flat in int gl_ViewportIndex;
-in bool gl_HelperInvocation;
-
-out float gl_FragDepth;
-out int  gl_SampleMask[];
-
-#endif
-
-
-#if __GLSLD_SHADER_STAGE_COMPUTE
-
-in    highp uvec3 gl_NumWorkGroups;
-const highp uvec3 gl_WorkGroupSize = uvec3(1,1,1);
-in highp uvec3 gl_WorkGroupID;
-in highp uvec3 gl_LocalInvocationID;
-in highp uvec3 gl_GlobalInvocationID;
-in highp uint gl_LocalInvocationIndex;
-
-#endif
-
-
-#if __GLSLD_SHADER_STAGE_GEOMETRY
-
-void EmitStreamVertex(int stream);
-void EndStreamPrimitive(int stream);
-void EmitVertex();
-void EndPrimitive();
-
-in gl_PerVertex {
-    vec4 gl_Position;
-    float gl_PointSize;
-    float gl_ClipDistance[];
-    float gl_CullDistance[];
-    // vec4 gl_SecondaryPositionNV;
-    // vec4 gl_PositionPerViewNV[];
-} gl_in[];
-in int gl_PrimitiveIDIn;
-out gl_PerVertex {
-    vec4 gl_Position;
-    float gl_PointSize;
-    float gl_ClipDistance[];
-    float gl_CullDistance[];
-};
-out int gl_PrimitiveID;
-out int gl_Layer;
-out int gl_ViewportIndex;
-
-#endif
-
-
-#if __GLSLD_SHADER_STAGE_TESS_CTRL
-
-in gl_PerVertex {
-    vec4 gl_Position;
-    float gl_PointSize;
-    float gl_ClipDistance[];
-    float gl_CullDistance[];
-} gl_in[gl_MaxPatchVertices];
-
-in int gl_PatchVerticesIn;
-in int gl_PrimitiveID;
-in int gl_InvocationID;
-
-out gl_PerVertex {
-    vec4 gl_Position;
-    float gl_PointSize;
-    float gl_ClipDistance[];
-    float gl_CullDistance[];
-    // int  gl_ViewportMask[];
-    // vec4 gl_SecondaryPositionNV;
-    // int  gl_SecondaryViewportMaskNV[];
-    // vec4 gl_PositionPerViewNV[];
-    // int  gl_ViewportMaskPerViewNV[];
-} gl_out[];
-patch out float gl_TessLevelOuter[4];
-patch out float gl_TessLevelInner[2];
-
-#endif
-
-
-#if __GLSLD_SHADER_STAGE_TESS_EVAL
-
-in gl_PerVertex {
-    vec4 gl_Position;
-    float gl_PointSize;
-    float gl_ClipDistance[];
-    float gl_CullDistance[];
-} gl_in[gl_MaxPatchVertices];
-
-in int gl_PatchVerticesIn;
-in int gl_PrimitiveID;
-in vec3 gl_TessCoord;
-patch in float gl_TessLevelOuter[4];
-patch in float gl_TessLevelInner[2];
-
-out gl_PerVertex {
-    vec4 gl_Position;
-    float gl_PointSize;
-    float gl_ClipDistance[];
-    float gl_CullDistance[];
-};
-
-#endif
-
-
-#if __GLSLD_FEATURE_ENABLE_RAY_TRACING_EXT
+#if __GLSLD_FEATURE_ENABLE_RAY_QUERY
 
-#if __GLSLD_SHADER_STAGE_RAY_GEN || __GLSLD_SHADER_STAGE_ANY_HIT || __GLSLD_SHADER_STAGE_CLOSEST_HIT || __GLSLD_SHADER_STAGE_RAY_INTERSECT || __GLSLD_SHADER_STAGE_RAY_MISS || __GLSLD_SHADER_STAGE_RAY_CALLABLE
 const uint gl_RayFlagsNoneEXT = 0U;
 const uint gl_RayFlagsOpaqueEXT = 1U;
 const uint gl_RayFlagsNoOpaqueEXT = 2U;
@@ -244,210 +99,63 @@ const uint gl_RayFlagsForceOpacityMicromap2StateEXT = 1024U;
 const uint gl_HitKindFrontFacingTriangleEXT = 254U;
 const uint gl_HitKindBackFacingTriangleEXT = 255U;
 
-in    uvec3  gl_LaunchIDEXT;
-in    uvec3  gl_LaunchSizeEXT;
-#endif
-
-#if __GLSLD_SHADER_STAGE_RAY_GEN || __GLSLD_SHADER_STAGE_CLOSEST_HIT || __GLSLD_SHADER_STAGE_RAY_MISS || __GLSLD_SHADER_STAGE_RAY_CALLABLE
-void executeCallableEXT(uint sbtRecordIndex, int callable);
-#endif
-
-#if __GLSLD_SHADER_STAGE_RAY_GEN || __GLSLD_SHADER_STAGE_CLOSEST_HIT || __GLSLD_SHADER_STAGE_RAY_MISS
-void traceRayEXT(accelerationStructureEXT topLevel,uint rayFlags,uint cullMask,uint sbtRecordOffset,uint sbtRecordStride,uint missIndex,vec3 origin,float tMin,vec3 direction,float tMax,int payload);
-#endif
-
-#if __GLSLD_SHADER_STAGE_ANY_HIT || __GLSLD_SHADER_STAGE_CLOSEST_HIT || __GLSLD_SHADER_STAGE_RAY_INTERSECT || __GLSLD_SHADER_STAGE_RAY_MISS
-in    vec3   gl_WorldRayOriginEXT;
-in    vec3   gl_WorldRayDirectionEXT;
-in    float  gl_RayTminEXT;
-in    float  gl_RayTmaxEXT;
-in    uint   gl_IncomingRayFlagsEXT;
-in    uint   gl_CullMaskEXT;
-#endif
-
-#if __GLSLD_SHADER_STAGE_ANY_HIT || __GLSLD_SHADER_STAGE_CLOSEST_HIT || __GLSLD_SHADER_STAGE_RAY_INTERSECT
-in     int   gl_PrimitiveID;
-in     int   gl_InstanceID;
-in     int   gl_InstanceCustomIndexEXT;
-in     int   gl_GeometryIndexEXT;
-in    vec3   gl_ObjectRayOriginEXT;
-in    vec3   gl_ObjectRayDirectionEXT;
-in    float  gl_HitTEXT;
-in    uint   gl_HitKindEXT;
-in    mat4x3 gl_ObjectToWorldEXT;
-in    mat3x4 gl_ObjectToWorld3x4EXT;
-in    mat4x3 gl_WorldToObjectEXT;
-in    mat3x4 gl_WorldToObject3x4EXT;
-#endif
+const uint gl_RayQueryCandidateIntersectionEXT = 0U;
+const uint gl_RayQueryCommittedIntersectionEXT = 1U;
+const uint gl_RayQueryCommittedIntersectionNoneEXT = 0U;
+const uint gl_RayQueryCommittedIntersectionTriangleEXT = 1U;
+const uint gl_RayQueryCommittedIntersectionGeneratedEXT = 2U;
+const uint gl_RayQueryCandidateIntersectionTriangleEXT = 0U;
+const uint gl_RayQueryCandidateIntersectionAABBEXT = 1U;
 
-#if __GLSLD_SHADER_STAGE_RAY_INTERSECT
-bool reportIntersectionEXT(float hitT, uint hitKind);
-#endif
+void rayQueryInitializeEXT(rayQueryEXT rayQuery, accelerationStructureEXT topLevel, uint rayFlags, uint cullMask, vec3 origin, float tMin, vec3 direction, float tMax);
+void rayQueryTerminateEXT(rayQueryEXT rayQuery);
+void rayQueryGenerateIntersectionEXT(rayQueryEXT rayQuery, float tHit);
+void rayQueryConfirmIntersectionEXT(rayQueryEXT rayQuery);
+bool rayQueryProceedEXT(rayQueryEXT rayQuery);
+uint rayQueryGetIntersectionTypeEXT(rayQueryEXT rayQuery, bool committed);
+float rayQueryGetRayTMinEXT(rayQueryEXT rayQuery);
+uint rayQueryGetRayFlagsEXT(rayQueryEXT rayQuery);
+vec3 rayQueryGetWorldRayOriginEXT(rayQueryEXT rayQuery);
+vec3 rayQueryGetWorldRayDirectionEXT(rayQueryEXT rayQuery);
+float rayQueryGetIntersectionTEXT(rayQueryEXT rayQuery, bool committed);
+int rayQueryGetIntersectionInstanceCustomIndexEXT(rayQueryEXT rayQuery, bool committed);
+int rayQueryGetIntersectionInstanceIdEXT(rayQueryEXT rayQuery, bool committed);
+uint rayQueryGetIntersectionInstanceShaderBindingTableRecordOffsetEXT(rayQueryEXT rayQuery, bool committed);
+int rayQueryGetIntersectionGeometryIndexEXT(rayQueryEXT rayQuery, bool committed);
+int rayQueryGetIntersectionPrimitiveIndexEXT(rayQueryEXT rayQuery, bool committed);
+vec2 rayQueryGetIntersectionBarycentricsEXT(rayQueryEXT rayQuery, bool committed);
+bool rayQueryGetIntersectionFrontFaceEXT(rayQueryEXT rayQuery, bool committed);
+bool rayQueryGetIntersectionCandidateAABBOpaqueEXT(rayQueryEXT rayQuery committed);
+vec3 rayQueryGetIntersectionObjectRayDirectionEXT(rayQueryEXT rayQuery, bool committed);
+vec3 rayQueryGetIntersectionObjectRayOriginEXT(rayQueryEXT rayQuery, bool committed);
+mat4x3 rayQueryGetIntersectionObjectToWorldEXT(rayQueryEXT rayQuery, bool committed);
+mat4x3 rayQueryGetIntersectionWorldToObjectEXT(rayQueryEXT rayQuery, bool committed);
 
 #endif
 
 
+#if __GLSLD_FEATURE_ENABLE_MEMORY_SCOPE_SEMANTICS
 
-#if __GLSLD_FEATURE_ENABLE_RAY_TRACING_NV
-
-#if __GLSLD_SHADER_STAGE_RAY_GEN || __GLSLD_SHADER_STAGE_ANY_HIT || __GLSLD_SHADER_STAGE_CLOSEST_HIT || __GLSLD_SHADER_STAGE_RAY_INTERSECT || __GLSLD_SHADER_STAGE_RAY_MISS || __GLSLD_SHADER_STAGE_RAY_CALLABLE
-const uint gl_RayFlagsNoneNV = 0U;
-const uint gl_RayFlagsOpaqueNV = 1U;
-const uint gl_RayFlagsNoOpaqueNV = 2U;
-const uint gl_RayFlagsTerminateOnFirstHitNV = 4U;
-const uint gl_RayFlagsSkipClosestHitShaderNV = 8U;
-const uint gl_RayFlagsCullBackFacingTrianglesNV = 16U;
-const uint gl_RayFlagsCullFrontFacingTrianglesNV = 32U;
-const uint gl_RayFlagsCullOpaqueNV = 64U;
-const uint gl_RayFlagsCullNoOpaqueNV = 128U;
+const int gl_ScopeDevice      = 1;
+const int gl_ScopeWorkgroup   = 2;
+const int gl_ScopeSubgroup    = 3;
+const int gl_ScopeInvocation  = 4;
+const int gl_ScopeQueueFamily = 5;
+const int gl_ScopeShaderCallEXT = 6;
 
-in    uvec3  gl_LaunchIDNV;
-in    uvec3  gl_LaunchSizeNV;
-#endif
+const int gl_SemanticsRelaxed         = 0x0;
+const int gl_SemanticsAcquire         = 0x2;
+const int gl_SemanticsRelease         = 0x4;
+const int gl_SemanticsAcquireRelease  = 0x8;
+const int gl_SemanticsMakeAvailable   = 0x2000;
+const int gl_SemanticsMakeVisible     = 0x4000;
+const int gl_SemanticsVolatile        = 0x8000;
 
-#if __GLSLD_SHADER_STAGE_RAY_GEN || __GLSLD_SHADER_STAGE_CLOSEST_HIT || __GLSLD_SHADER_STAGE_RAY_MISS || __GLSLD_SHADER_STAGE_RAY_CALLABLE
-void executeCallableNV(uint sbtRecordIndex, int callable);
-#endif
-
-#if __GLSLD_SHADER_STAGE_RAY_GEN || __GLSLD_SHADER_STAGE_CLOSEST_HIT || __GLSLD_SHADER_STAGE_RAY_MISS
-void traceNV(accelerationStructureNV topLevel,uint rayFlags,uint cullMask,uint sbtRecordOffset,uint sbtRecordStride,uint missIndex,vec3 origin,float tMin,vec3 direction,float tMax,int payload);
-void traceRayMotionNV(accelerationStructureNV topLevel,uint rayFlags,uint cullMask,uint sbtRecordOffset,uint sbtRecordStride,uint missIndex,vec3 origin,float tMin,vec3 direction,float tMax,float currentTime,int payload);
-#endif
-
-#if __GLSLD_SHADER_STAGE_ANY_HIT || __GLSLD_SHADER_STAGE_CLOSEST_HIT || __GLSLD_SHADER_STAGE_RAY_INTERSECT || __GLSLD_SHADER_STAGE_RAY_MISS
-in    vec3   gl_WorldRayOriginNV;
-in    vec3   gl_WorldRayDirectionNV;
-in    vec3   gl_ObjectRayOriginNV;
-in    vec3   gl_ObjectRayDirectionNV;
-in    float  gl_RayTminNV;
-in    float  gl_RayTmaxNV;
-in    uint   gl_IncomingRayFlagsNV;
-in    float  gl_CurrentRayTimeNV;
-#endif
-
-#if __GLSLD_SHADER_STAGE_ANY_HIT || __GLSLD_SHADER_STAGE_CLOSEST_HIT || __GLSLD_SHADER_STAGE_RAY_INTERSECT
-in     int   gl_PrimitiveID;
-in     int   gl_InstanceID;
-in     int   gl_InstanceCustomIndexNV;
-in    float  gl_HitTNV;
-in    uint   gl_HitKindNV;
-in    mat4x3 gl_ObjectToWorldNV;
-in    mat4x3 gl_WorldToObjectNV;
-#endif
-
-#if __GLSLD_SHADER_STAGE_ANY_HIT
-void ignoreIntersectionNV();
-void terminateRayNV();
-#endif
-
-
-#if __GLSLD_SHADER_STAGE_RAY_INTERSECT
-bool reportIntersectionNV(float hitT, uint hitKind);
-#endif
-
-#endif
-
-
-#if __GLSLD_FEATURE_ENABLE_RAY_QUERY
-
-const uint gl_RayFlagsNoneEXT = 0U;
-const uint gl_RayFlagsOpaqueEXT = 1U;
-const uint gl_RayFlagsNoOpaqueEXT = 2U;
-const uint gl_RayFlagsTerminateOnFirstHitEXT = 4U;
-const uint gl_RayFlagsSkipClosestHitShaderEXT = 8U;
-const uint gl_RayFlagsCullBackFacingTrianglesEXT = 16U;
-const uint gl_RayFlagsCullFrontFacingTrianglesEXT = 32U;
-const uint gl_RayFlagsCullOpaqueEXT = 64U;
-const uint gl_RayFlagsCullNoOpaqueEXT = 128U;
-const uint gl_RayFlagsSkipTrianglesEXT = 256U;
-const uint gl_RayFlagsSkipAABBEXT = 512U;
-const uint gl_RayFlagsForceOpacityMicromap2StateEXT = 1024U;
-const uint gl_HitKindFrontFacingTriangleEXT = 254U;
-const uint gl_HitKindBackFacingTriangleEXT = 255U;
-
-const uint gl_RayQueryCandidateIntersectionEXT = 0U;
-const uint gl_RayQueryCommittedIntersectionEXT = 1U;
-const uint gl_RayQueryCommittedIntersectionNoneEXT = 0U;
-const uint gl_RayQueryCommittedIntersectionTriangleEXT = 1U;
-const uint gl_RayQueryCommittedIntersectionGeneratedEXT = 2U;
-const uint gl_RayQueryCandidateIntersectionTriangleEXT = 0U;
-const uint gl_RayQueryCandidateIntersectionAABBEXT = 1U;
-
-void rayQueryInitializeEXT(rayQueryEXT rayQuery, accelerationStructureEXT topLevel, uint rayFlags, uint cullMask, vec3 origin, float tMin, vec3 direction, float tMax);
-void rayQueryTerminateEXT(rayQueryEXT rayQuery);
-void rayQueryGenerateIntersectionEXT(rayQueryEXT rayQuery, float tHit);
-void rayQueryConfirmIntersectionEXT(rayQueryEXT rayQuery);
-bool rayQueryProceedEXT(rayQueryEXT rayQuery);
-uint rayQueryGetIntersectionTypeEXT(rayQueryEXT rayQuery, bool committed);
-float rayQueryGetRayTMinEXT(rayQueryEXT rayQuery);
-uint rayQueryGetRayFlagsEXT(rayQueryEXT rayQuery);
-vec3 rayQueryGetWorldRayOriginEXT(rayQueryEXT rayQuery);
-vec3 rayQueryGetWorldRayDirectionEXT(rayQueryEXT rayQuery);
-float rayQueryGetIntersectionTEXT(rayQueryEXT rayQuery, bool committed);
-int rayQueryGetIntersectionInstanceCustomIndexEXT(rayQueryEXT rayQuery, bool committed);
-int rayQueryGetIntersectionInstanceIdEXT(rayQueryEXT rayQuery, bool committed);
-uint rayQueryGetIntersectionInstanceShaderBindingTableRecordOffsetEXT(rayQueryEXT rayQuery, bool committed);
-int rayQueryGetIntersectionGeometryIndexEXT(rayQueryEXT rayQuery, bool committed);
-int rayQueryGetIntersectionPrimitiveIndexEXT(rayQueryEXT rayQuery, bool committed);
-vec2 rayQueryGetIntersectionBarycentricsEXT(rayQueryEXT rayQuery, bool committed);
-bool rayQueryGetIntersectionFrontFaceEXT(rayQueryEXT rayQuery, bool committed);
-bool rayQueryGetIntersectionCandidateAABBOpaqueEXT(rayQueryEXT rayQuery committed);
-vec3 rayQueryGetIntersectionObjectRayDirectionEXT(rayQueryEXT rayQuery, bool committed);
-vec3 rayQueryGetIntersectionObjectRayOriginEXT(rayQueryEXT rayQuery, bool committed);
-mat4x3 rayQueryGetIntersectionObjectToWorldEXT(rayQueryEXT rayQuery, bool committed);
-mat4x3 rayQueryGetIntersectionWorldToObjectEXT(rayQueryEXT rayQuery, bool committed);
-
-#endif
-
-
-#if __GLSLD_FEATURE_ENABLE_MEMORY_SCOPE_SEMANTICS
-
-const int gl_ScopeDevice      = 1;
-const int gl_ScopeWorkgroup   = 2;
-const int gl_ScopeSubgroup    = 3;
-const int gl_ScopeInvocation  = 4;
-const int gl_ScopeQueueFamily = 5;
-const int gl_ScopeShaderCallEXT = 6;
-
-const int gl_SemanticsRelaxed         = 0x0;
-const int gl_SemanticsAcquire         = 0x2;
-const int gl_SemanticsRelease         = 0x4;
-const int gl_SemanticsAcquireRelease  = 0x8;
-const int gl_SemanticsMakeAvailable   = 0x2000;
-const int gl_SemanticsMakeVisible     = 0x4000;
-const int gl_SemanticsVolatile        = 0x8000;
-
-const int gl_StorageSemanticsNone     = 0x0;
-const int gl_StorageSemanticsBuffer   = 0x40;
-const int gl_StorageSemanticsShared   = 0x100;
-const int gl_StorageSemanticsImage    = 0x800;
-const int gl_StorageSemanticsOutput   = 0x1000;
-
-#endif
-
-
-#if __GLSLD_FEATURE_ENABLE_SHADER_SM_BUILTIN_NV
-
-#if __GLSLD_SHADER_STAGE_VERTEX || __GLSLD_SHADER_STAGE_GEOMETRY || __GLSLD_SHADER_STAGE_TESS_CTRL || __GLSLD_SHADER_STAGE_TESS_EVAL || __GLSLD_SHADER_STAGE_COMPUTE || __GLSLD_SHADER_STAGE_TASK || __GLSLD_SHADER_STAGE_MESH
-in highp   uint  gl_WarpsPerSMNV;
-in highp   uint  gl_SMCountNV;
-in highp   uint  gl_WarpIDNV;
-in highp   uint  gl_SMIDNV;
-#endif
-
-#if __GLSLD_SHADER_STAGE_FRAGMENT
-flat in highp   uint  gl_WarpsPerSMNV;
-flat in highp   uint  gl_SMCountNV;
-flat in highp   uint  gl_WarpIDNV;
-flat in highp   uint  gl_SMIDNV;
-#endif
-
-#if __GLSLD_SHADER_STAGE_RAY_GEN || __GLSLD_SHADER_STAGE_ANY_HIT || __GLSLD_SHADER_STAGE_CLOSEST_HIT || __GLSLD_SHADER_STAGE_RAY_INTERSECT || __GLSLD_SHADER_STAGE_RAY_MISS || __GLSLD_SHADER_STAGE_RAY_CALLABLE
-in highp    uint  gl_WarpsPerSMNV;
-in highp    uint  gl_SMCountNV;
-in highp volatile uint  gl_WarpIDNV;
-in highp volatile uint  gl_SMIDNV;
-#endif
+const int gl_StorageSemanticsNone     = 0x0;
+const int gl_StorageSemanticsBuffer   = 0x40;
+const int gl_StorageSemanticsShared   = 0x100;
+const int gl_StorageSemanticsImage    = 0x800;
+const int gl_StorageSemanticsOutput   = 0x1000;
 
 #endif
 
@@ -9389,6 +9097,301 @@ bool anyInvocation(bool value);
 bool allInvocations(bool value);
 // Returns true if value is the same for all active invocations in the group.
 bool allInvocationsEqual(bool value);
+)glsl";
+
+inline constinit SourceTextView GlslStdlibStageText = R"glsl(
+
+#if __GLSLD_SHADER_STAGE_VERTEX
+
+#if __GLSLD_TARGET_API_OPENGL
+in int gl_VertexID;
+in int gl_InstanceID;
+#endif
+
+#if __GLSLD_TARGET_API_VULKAN
+in int gl_VertexIndex;
+in int gl_InstanceIndex;
+#endif
+
+in int gl_DrawID;
+in int gl_BaseVertex;
+in int gl_BaseInstance;
+
+out gl_PerVertex {
+    vec4 gl_Position;
+    float gl_PointSize;
+    float gl_ClipDistance[];
+    float gl_CullDistance[];
+};
+
+#endif
+
+
+
+#if __GLSLD_SHADER_STAGE_FRAGMENT
+
+in vec4  gl_FragCoord;
+in bool  gl_FrontFacing;
+in float gl_ClipDistance[];
+in float gl_CullDistance[];
+in vec2 gl_PointCoord;
+flat in int gl_PrimitiveID;
+flat in  int  gl_SampleID;
+in  vec2 gl_SamplePosition;
+flat in  int  gl_SampleMaskIn[];
+flat in int gl_Layer;
+flat in int gl_ViewportIndex;
+in bool gl_HelperInvocation;
+
+out float gl_FragDepth;
+out int  gl_SampleMask[];
+
+#endif
+
+
+#if __GLSLD_SHADER_STAGE_COMPUTE
+
+in    highp uvec3 gl_NumWorkGroups;
+const highp uvec3 gl_WorkGroupSize = uvec3(1,1,1);
+in highp uvec3 gl_WorkGroupID;
+in highp uvec3 gl_LocalInvocationID;
+in highp uvec3 gl_GlobalInvocationID;
+in highp uint gl_LocalInvocationIndex;
+
+#endif
+
+
+#if __GLSLD_SHADER_STAGE_GEOMETRY
+
+void EmitStreamVertex(int stream);
+void EndStreamPrimitive(int stream);
+void EmitVertex();
+void EndPrimitive();
+
+in gl_PerVertex {
+    vec4 gl_Position;
+    float gl_PointSize;
+    float gl_ClipDistance[];
+    float gl_CullDistance[];
+    // vec4 gl_SecondaryPositionNV;
+    // vec4 gl_PositionPerViewNV[];
+} gl_in[];
+in int gl_PrimitiveIDIn;
+out gl_PerVertex {
+    vec4 gl_Position;
+    float gl_PointSize;
+    float gl_ClipDistance[];
+    float gl_CullDistance[];
+};
+out int gl_PrimitiveID;
+out int gl_Layer;
+out int gl_ViewportIndex;
+
+#endif
+
+
+#if __GLSLD_SHADER_STAGE_TESS_CTRL
+
+in gl_PerVertex {
+    vec4 gl_Position;
+    float gl_PointSize;
+    float gl_ClipDistance[];
+    float gl_CullDistance[];
+} gl_in[gl_MaxPatchVertices];
+
+in int gl_PatchVerticesIn;
+in int gl_PrimitiveID;
+in int gl_InvocationID;
+
+out gl_PerVertex {
+    vec4 gl_Position;
+    float gl_PointSize;
+    float gl_ClipDistance[];
+    float gl_CullDistance[];
+    // int  gl_ViewportMask[];
+    // vec4 gl_SecondaryPositionNV;
+    // int  gl_SecondaryViewportMaskNV[];
+    // vec4 gl_PositionPerViewNV[];
+    // int  gl_ViewportMaskPerViewNV[];
+} gl_out[];
+patch out float gl_TessLevelOuter[4];
+patch out float gl_TessLevelInner[2];
+
+#endif
+
+
+#if __GLSLD_SHADER_STAGE_TESS_EVAL
+
+in gl_PerVertex {
+    vec4 gl_Position;
+    float gl_PointSize;
+    float gl_ClipDistance[];
+    float gl_CullDistance[];
+} gl_in[gl_MaxPatchVertices];
+
+in int gl_PatchVerticesIn;
+in int gl_PrimitiveID;
+in vec3 gl_TessCoord;
+patch in float gl_TessLevelOuter[4];
+patch in float gl_TessLevelInner[2];
+
+out gl_PerVertex {
+    vec4 gl_Position;
+    float gl_PointSize;
+    float gl_ClipDistance[];
+    float gl_CullDistance[];
+};
+
+#endif
+
+
+#if __GLSLD_FEATURE_ENABLE_RAY_TRACING_EXT
+
+#if __GLSLD_SHADER_STAGE_RAY_GEN || __GLSLD_SHADER_STAGE_ANY_HIT || __GLSLD_SHADER_STAGE_CLOSEST_HIT || __GLSLD_SHADER_STAGE_RAY_INTERSECT || __GLSLD_SHADER_STAGE_RAY_MISS || __GLSLD_SHADER_STAGE_RAY_CALLABLE
+const uint gl_RayFlagsNoneEXT = 0U;
+const uint gl_RayFlagsOpaqueEXT = 1U;
+const uint gl_RayFlagsNoOpaqueEXT = 2U;
+const uint gl_RayFlagsTerminateOnFirstHitEXT = 4U;
+const uint gl_RayFlagsSkipClosestHitShaderEXT = 8U;
+const uint gl_RayFlagsCullBackFacingTrianglesEXT = 16U;
+const uint gl_RayFlagsCullFrontFacingTrianglesEXT = 32U;
+const uint gl_RayFlagsCullOpaqueEXT = 64U;
+const uint gl_RayFlagsCullNoOpaqueEXT = 128U;
+const uint gl_RayFlagsSkipTrianglesEXT = 256U;
+const uint gl_RayFlagsSkipAABBEXT = 512U;
+const uint gl_RayFlagsForceOpacityMicromap2StateEXT = 1024U;
+const uint gl_HitKindFrontFacingTriangleEXT = 254U;
+const uint gl_HitKindBackFacingTriangleEXT = 255U;
+
+in    uvec3  gl_LaunchIDEXT;
+in    uvec3  gl_LaunchSizeEXT;
+#endif
+
+#if __GLSLD_SHADER_STAGE_RAY_GEN || __GLSLD_SHADER_STAGE_CLOSEST_HIT || __GLSLD_SHADER_STAGE_RAY_MISS || __GLSLD_SHADER_STAGE_RAY_CALLABLE
+void executeCallableEXT(uint sbtRecordIndex, int callable);
+#endif
+
+#if __GLSLD_SHADER_STAGE_RAY_GEN || __GLSLD_SHADER_STAGE_CLOSEST_HIT || __GLSLD_SHADER_STAGE_RAY_MISS
+void traceRayEXT(accelerationStructureEXT topLevel,uint rayFlags,uint cullMask,uint sbtRecordOffset,uint sbtRecordStride,uint missIndex,vec3 origin,float tMin,vec3 direction,float tMax,int payload);
+#endif
+
+#if __GLSLD_SHADER_STAGE_ANY_HIT || __GLSLD_SHADER_STAGE_CLOSEST_HIT || __GLSLD_SHADER_STAGE_RAY_INTERSECT || __GLSLD_SHADER_STAGE_RAY_MISS
+in    vec3   gl_WorldRayOriginEXT;
+in    vec3   gl_WorldRayDirectionEXT;
+in    float  gl_RayTminEXT;
+in    float  gl_RayTmaxEXT;
+in    uint   gl_IncomingRayFlagsEXT;
+in    uint   gl_CullMaskEXT;
+#endif
+
+#if __GLSLD_SHADER_STAGE_ANY_HIT || __GLSLD_SHADER_STAGE_CLOSEST_HIT || __GLSLD_SHADER_STAGE_RAY_INTERSECT
+in     int   gl_PrimitiveID;
+in     int   gl_InstanceID;
+in     int   gl_InstanceCustomIndexEXT;
+in     int   gl_GeometryIndexEXT;
+in    vec3   gl_ObjectRayOriginEXT;
+in    vec3   gl_ObjectRayDirectionEXT;
+in    float  gl_HitTEXT;
+in    uint   gl_HitKindEXT;
+in    mat4x3 gl_ObjectToWorldEXT;
+in    mat3x4 gl_ObjectToWorld3x4EXT;
+in    mat4x3 gl_WorldToObjectEXT;
+in    mat3x4 gl_WorldToObject3x4EXT;
+#endif
+
+#if __GLSLD_SHADER_STAGE_RAY_INTERSECT
+bool reportIntersectionEXT(float hitT, uint hitKind);
+#endif
+
+#endif
+
+
+
+#if __GLSLD_FEATURE_ENABLE_RAY_TRACING_NV
+
+#if __GLSLD_SHADER_STAGE_RAY_GEN || __GLSLD_SHADER_STAGE_ANY_HIT || __GLSLD_SHADER_STAGE_CLOSEST_HIT || __GLSLD_SHADER_STAGE_RAY_INTERSECT || __GLSLD_SHADER_STAGE_RAY_MISS || __GLSLD_SHADER_STAGE_RAY_CALLABLE
+const uint gl_RayFlagsNoneNV = 0U;
+const uint gl_RayFlagsOpaqueNV = 1U;
+const uint gl_RayFlagsNoOpaqueNV = 2U;
+const uint gl_RayFlagsTerminateOnFirstHitNV = 4U;
+const uint gl_RayFlagsSkipClosestHitShaderNV = 8U;
+const uint gl_RayFlagsCullBackFacingTrianglesNV = 16U;
+const uint gl_RayFlagsCullFrontFacingTrianglesNV = 32U;
+const uint gl_RayFlagsCullOpaqueNV = 64U;
+const uint gl_RayFlagsCullNoOpaqueNV = 128U;
+
+in    uvec3  gl_LaunchIDNV;
+in    uvec3  gl_LaunchSizeNV;
+#endif
+
+#if __GLSLD_SHADER_STAGE_RAY_GEN || __GLSLD_SHADER_STAGE_CLOSEST_HIT || __GLSLD_SHADER_STAGE_RAY_MISS || __GLSLD_SHADER_STAGE_RAY_CALLABLE
+void executeCallableNV(uint sbtRecordIndex, int callable);
+#endif
+
+#if __GLSLD_SHADER_STAGE_RAY_GEN || __GLSLD_SHADER_STAGE_CLOSEST_HIT || __GLSLD_SHADER_STAGE_RAY_MISS
+void traceNV(accelerationStructureNV topLevel,uint rayFlags,uint cullMask,uint sbtRecordOffset,uint sbtRecordStride,uint missIndex,vec3 origin,float tMin,vec3 direction,float tMax,int payload);
+void traceRayMotionNV(accelerationStructureNV topLevel,uint rayFlags,uint cullMask,uint sbtRecordOffset,uint sbtRecordStride,uint missIndex,vec3 origin,float tMin,vec3 direction,float tMax,float currentTime,int payload);
+#endif
+
+#if __GLSLD_SHADER_STAGE_ANY_HIT || __GLSLD_SHADER_STAGE_CLOSEST_HIT || __GLSLD_SHADER_STAGE_RAY_INTERSECT || __GLSLD_SHADER_STAGE_RAY_MISS
+in    vec3   gl_WorldRayOriginNV;
+in    vec3   gl_WorldRayDirectionNV;
+in    vec3   gl_ObjectRayOriginNV;
+in    vec3   gl_ObjectRayDirectionNV;
+in    float  gl_RayTminNV;
+in    float  gl_RayTmaxNV;
+in    uint   gl_IncomingRayFlagsNV;
+in    float  gl_CurrentRayTimeNV;
+#endif
+
+#if __GLSLD_SHADER_STAGE_ANY_HIT || __GLSLD_SHADER_STAGE_CLOSEST_HIT || __GLSLD_SHADER_STAGE_RAY_INTERSECT
+in     int   gl_PrimitiveID;
+in     int   gl_InstanceID;
+in     int   gl_InstanceCustomIndexNV;
+in    float  gl_HitTNV;
+in    uint   gl_HitKindNV;
+in    mat4x3 gl_ObjectToWorldNV;
+in    mat4x3 gl_WorldToObjectNV;
+#endif
+
+#if __GLSLD_SHADER_STAGE_ANY_HIT
+void ignoreIntersectionNV();
+void terminateRayNV();
+#endif
+
+
+#if __GLSLD_SHADER_STAGE_RAY_INTERSECT
+bool reportIntersectionNV(float hitT, uint hitKind);
+#endif
+
+#endif
+
+
+#if __GLSLD_FEATURE_ENABLE_SHADER_SM_BUILTIN_NV
+
+#if __GLSLD_SHADER_STAGE_VERTEX || __GLSLD_SHADER_STAGE_GEOMETRY || __GLSLD_SHADER_STAGE_TESS_CTRL || __GLSLD_SHADER_STAGE_TESS_EVAL || __GLSLD_SHADER_STAGE_COMPUTE || __GLSLD_SHADER_STAGE_TASK || __GLSLD_SHADER_STAGE_MESH
+in highp   uint  gl_WarpsPerSMNV;
+in highp   uint  gl_SMCountNV;
+in highp   uint  gl_WarpIDNV;
+in highp   uint  gl_SMIDNV;
+#endif
+
+#if __GLSLD_SHADER_STAGE_FRAGMENT
+flat in highp   uint  gl_WarpsPerSMNV;
+flat in highp   uint  gl_SMCountNV;
+flat in highp   uint  gl_WarpIDNV;
+flat in highp   uint  gl_SMIDNV;
+#endif
+
+#if __GLSLD_SHADER_STAGE_RAY_GEN || __GLSLD_SHADER_STAGE_ANY_HIT || __GLSLD_SHADER_STAGE_CLOSEST_HIT || __GLSLD_SHADER_STAGE_RAY_INTERSECT || __GLSLD_SHADER_STAGE_RAY_MISS || __GLSLD_SHADER_STAGE_RAY_CALLABLE
+in highp    uint  gl_WarpsPerSMNV;
+in highp    uint  gl_SMCountNV;
+in highp volatile uint  gl_WarpIDNV;
+in highp volatile uint  gl_SMIDNV;
+#endif
+
+#endif
+
 )glsl";
 } // namespace glsld
 // clang-format on
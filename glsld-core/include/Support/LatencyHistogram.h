@@ -0,0 +1,119 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+namespace glsld
+{
+    // A histogram of latencies in microseconds with a bounded relative error, in the manner of HdrHistogram. Values
+    // are grouped by their power of two, and each group is split into linear sub-buckets, so percentiles are accurate
+    // to 1/16 of the value. Recording is lock-free and could be done from multiple threads.
+    class LatencyHistogram
+    {
+    public:
+        using Duration = std::chrono::microseconds;
+
+    private:
+        static constexpr uint32_t SubBucketBits  = 4;
+        static constexpr uint32_t SubBucketCount = 1 << SubBucketBits;
+
+        // Values are clamped to this, which is a bit more than an hour.
+        static constexpr uint64_t MaxValue = (uint64_t{1} << 32) - 1;
+
+        // Exact buckets for values below `2 * SubBucketCount`, then `SubBucketCount` buckets per power of two.
+        static constexpr size_t BucketCount = (std::bit_width(MaxValue) - SubBucketBits + 1) * SubBucketCount;
+
+        std::array<std::atomic<uint64_t>, BucketCount> buckets = {};
+        std::atomic<uint64_t> count   = 0;
+        std::atomic<uint64_t> total   = 0;
+        std::atomic<uint64_t> maximum = 0;
+
+        // Values below twice the sub-bucket count are counted exactly. Beyond that, a value is bucketed by its
+        // highest `SubBucketBits + 1` bits.
+        static constexpr auto GetBucketIndex(uint64_t value) noexcept -> size_t
+        {
+            if (value < 2 * SubBucketCount) {
+                return value;
+            }
+
+            auto shift = std::bit_width(value) - SubBucketBits - 1;
+            return (shift + 1) * SubBucketCount + ((value >> shift) - SubBucketCount);
+        }
+
+        // Returns the largest value that falls into the bucket.
+        static constexpr auto GetBucketUpperBound(size_t index) noexcept -> uint64_t
+        {
+            if (index < 2 * SubBucketCount) {
+                return index;
+            }
+
+            auto shift = index / SubBucketCount - 1;
+            auto top   = index % SubBucketCount + SubBucketCount;
+            return ((top + 1) << shift) - 1;
+        }
+
+    public:
+        LatencyHistogram() = default;
+
+        LatencyHistogram(const LatencyHistogram&)                    = delete;
+        auto operator=(const LatencyHistogram&) -> LatencyHistogram& = delete;
+
+        template <typename Rep, typename Period>
+        auto Record(std::chrono::duration<Rep, Period> latency) noexcept -> void
+        {
+            auto micros = std::chrono::duration_cast<Duration>(latency).count();
+            auto value  = std::min(static_cast<uint64_t>(std::max<int64_t>(micros, 0)), MaxValue);
+
+            buckets[GetBucketIndex(value)].fetch_add(1, std::memory_order_relaxed);
+            count.fetch_add(1, std::memory_order_relaxed);
+            total.fetch_add(value, std::memory_order_relaxed);
+
+            auto currentMaximum = maximum.load(std::memory_order_relaxed);
+            while (value > currentMaximum &&
+                   !maximum.compare_exchange_weak(currentMaximum, value, std::memory_order_relaxed)) {
+            }
+        }
+
+        auto GetCount() const noexcept -> uint64_t
+        {
+            return count.load(std::memory_order_relaxed);
+        }
+
+        auto GetMax() const noexcept -> Duration
+        {
+            return Duration{maximum.load(std::memory_order_relaxed)};
+        }
+
+        auto GetMean() const noexcept -> Duration
+        {
+            auto n = GetCount();
+            return n != 0 ? Duration{total.load(std::memory_order_relaxed) / n} : Duration::zero();
+        }
+
+        // Returns the latency that the given fraction of the recorded values are less than or equal to, rounded up to
+        // the bucket boundary. `fraction` is in [0, 1].
+        auto GetPercentile(double fraction) const noexcept -> Duration
+        {
+            auto n = GetCount();
+            if (n == 0) {
+                return Duration::zero();
+            }
+
+            auto rank     = std::max<uint64_t>(static_cast<uint64_t>(std::ceil(fraction * n)), 1);
+            uint64_t seen = 0;
+            for (size_t i = 0; i < BucketCount; ++i) {
+                seen += buckets[i].load(std::memory_order_relaxed);
+                if (seen >= rank) {
+                    return std::min(Duration{GetBucketUpperBound(i)}, GetMax());
+                }
+            }
+
+            return GetMax();
+        }
+    };
+} // namespace glsld
@@ -1,5 +1,6 @@
 #pragma once
 #include "Basic/Common.h"
+#include "Support/MemoryUsage.h"
 
 #include <deque>
 
@@ -80,6 +81,11 @@ namespace glsld
                 }
                 destructHandles.clear();
             }
+
+            auto GetDestructHandleMemoryUsage() const noexcept -> MemoryUsage
+            {
+                return MemoryUsage::Of(destructHandles);
+            }
         };
     } // namespace detail
 
@@ -192,6 +198,25 @@ namespace glsld
             return reinterpret_cast<ElemType*>(ptr);
         }
 
+        // Returns the bytes handed out by this arena and the bytes of all pages it has obtained. The difference is the
+        // unused tail of each page and the page headers.
+        auto GetMemoryUsage() const noexcept -> MemoryUsage
+        {
+            MemoryUsage result;
+            for (auto head : {regularPageHead, largePageHead}) {
+                for (auto p = head; p != nullptr; p = p->next) {
+                    result.allocatedBytes += p->used;
+                    result.committedBytes += sizeof(BufferPageHeader) + p->size;
+                }
+            }
+
+            if constexpr (EnableAutomaticDestruct) {
+                result += BaseType::GetDestructHandleMemoryUsage();
+            }
+
+            return result;
+        }
+
     private:
         auto Clear() -> void
         {
@@ -0,0 +1,80 @@
+#pragma once
+#include <cstddef>
+#include <deque>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace glsld
+{
+    // Memory held by a data structure. The numbers of node-based containers are estimated from their element count,
+    // since the allocator overhead of each node is not observable.
+    struct MemoryUsage
+    {
+        // Bytes that are actually used to store data.
+        size_t allocatedBytes = 0;
+
+        // Bytes that are obtained from the allocator, including the unused capacity and the bookkeeping overhead.
+        size_t committedBytes = 0;
+
+        auto operator+=(const MemoryUsage& other) noexcept -> MemoryUsage&
+        {
+            allocatedBytes += other.allocatedBytes;
+            committedBytes += other.committedBytes;
+            return *this;
+        }
+
+        friend auto operator+(MemoryUsage lhs, const MemoryUsage& rhs) noexcept -> MemoryUsage
+        {
+            return lhs += rhs;
+        }
+
+        friend auto operator==(const MemoryUsage&, const MemoryUsage&) -> bool = default;
+
+        static auto Of(const std::string& s) noexcept -> MemoryUsage
+        {
+            // Short strings are stored inline, which doesn't allocate.
+            if (s.capacity() <= std::string{}.capacity()) {
+                return {};
+            }
+
+            return MemoryUsage{.allocatedBytes = s.size() + 1, .committedBytes = s.capacity() + 1};
+        }
+
+        template <typename T>
+        static auto Of(const std::vector<T>& v) noexcept -> MemoryUsage
+        {
+            return MemoryUsage{.allocatedBytes = v.size() * sizeof(T), .committedBytes = v.capacity() * sizeof(T)};
+        }
+
+        template <typename T>
+        static auto Of(const std::deque<T>& d) noexcept -> MemoryUsage
+        {
+            // A deque allocates blocks of about 512 bytes, with a spare one at the end.
+            constexpr size_t blockLength = sizeof(T) < 512 ? 512 / sizeof(T) : 1;
+            auto blockCount              = d.size() / blockLength + 1;
+            return MemoryUsage{.allocatedBytes = d.size() * sizeof(T),
+                               .committedBytes = blockCount * blockLength * sizeof(T)};
+        }
+
+        template <typename K, typename V, typename... Ts>
+        static auto Of(const std::map<K, V, Ts...>& m) noexcept -> MemoryUsage
+        {
+            // Each node carries a color and three pointers.
+            constexpr size_t nodeOverhead = 4 * sizeof(void*);
+            return MemoryUsage{.allocatedBytes = m.size() * sizeof(std::pair<const K, V>),
+                               .committedBytes = m.size() * (sizeof(std::pair<const K, V>) + nodeOverhead)};
+        }
+
+        template <typename K, typename V, typename... Ts>
+        static auto Of(const std::unordered_map<K, V, Ts...>& m) noexcept -> MemoryUsage
+        {
+            // Each node carries a next pointer and the cached hash code, and each bucket is a pointer.
+            constexpr size_t nodeOverhead = 2 * sizeof(void*);
+            return MemoryUsage{.allocatedBytes = m.size() * sizeof(std::pair<const K, V>),
+                               .committedBytes = m.size() * (sizeof(std::pair<const K, V>) + nodeOverhead) +
+                                                 m.bucket_count() * sizeof(void*)};
+        }
+    };
+} // namespace glsld
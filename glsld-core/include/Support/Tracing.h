@@ -0,0 +1,257 @@
+#pragma once
+#include "Support/StringMap.h"
+#include "Support/StringView.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <utility>
+#include <variant>
+#include <vector>
+
+namespace glsld
+{
+    struct TraceEvent
+    {
+        // The category of the span, e.g. "compiler" or "server".
+        const char* category;
+
+        // The name of the span, e.g. the compiler phase or the method of a request.
+        const char* name;
+
+        // Additional info of the span, e.g. the URI of the document. Could be empty.
+        const char* detail;
+
+        // The start time and the duration in microseconds. The time is relative to when tracing is enabled.
+        int64_t startUs;
+        int64_t durationUs;
+
+        // The thread that records the span.
+        uint32_t threadId;
+
+        // The ID of an async span, which may start and end on different threads, e.g. the ID of a request. Spans
+        // without an ID are nested within their threads.
+        std::optional<int64_t> asyncId;
+    };
+
+    // A process-wide recorder of timed spans, which could be exported as a timeline. Recording is disabled by default,
+    // in which case a span costs no more than a relaxed atomic load.
+    //
+    // Each thread records into its own buffer, so recording threads don't contend with each other. Strings of an event
+    // are never copied. Names are string literals, and details are interned, which is only a lookup in a thread-local
+    // cache once a string is seen by the thread.
+    class TraceRecorder
+    {
+    public:
+        using Clock = std::chrono::steady_clock;
+
+    private:
+        // The number of events to retain per thread, which is about 1 MB. Once a buffer is full, its oldest events are
+        // overwritten, so that a long session keeps the latest timeline with bounded memory.
+        static constexpr size_t MaxEventCountPerThread = 1 << 14;
+
+        static inline std::atomic<bool> enabled = false;
+
+        // The source of the thread IDs, which are assigned on the first span recorded by each thread.
+        static inline std::atomic<uint32_t> nextThreadId = 1;
+
+        struct ThreadBuffer
+        {
+            uint32_t threadId;
+
+            // Only contended when the events are taken.
+            std::mutex mutex;
+
+            // A ring buffer of the recorded events. `nextIndex` is the slot to write next, which is also the oldest
+            // event once the buffer is full.
+            std::vector<TraceEvent> events;
+            size_t nextIndex = 0;
+        };
+
+        // Guards the list of thread buffers and enabling/disabling.
+        std::mutex mutex;
+
+        std::atomic<Clock::time_point> origin = Clock::time_point{};
+
+        // Buffers are never removed, since a thread may record again until it exits.
+        std::vector<std::unique_ptr<ThreadBuffer>> threadBuffers;
+
+        // The owner of the interned strings. Keys are never moved once inserted.
+        std::mutex internMutex;
+        UnorderedStringMap<std::monostate> internedStrings;
+
+        static auto ToMicroseconds(Clock::duration duration) -> int64_t
+        {
+            return std::chrono::duration_cast<std::chrono::microseconds>(duration).count();
+        }
+
+        auto GetThreadBuffer() -> ThreadBuffer&
+        {
+            static thread_local ThreadBuffer* buffer = nullptr;
+            if (!buffer) {
+                std::lock_guard<std::mutex> lock{mutex};
+                threadBuffers.push_back(std::make_unique<ThreadBuffer>());
+                buffer           = threadBuffers.back().get();
+                buffer->threadId = GetCurrentThreadId();
+            }
+
+            return *buffer;
+        }
+
+    public:
+        static auto Get() -> TraceRecorder&
+        {
+            static TraceRecorder recorder;
+            return recorder;
+        }
+
+        static auto IsEnabled() noexcept -> bool
+        {
+            return enabled.load(std::memory_order_relaxed);
+        }
+
+        // Returns the current time if tracing is enabled. Otherwise, the clock is not read and a default time point is
+        // returned, which is ignored when recorded.
+        static auto Now() noexcept -> Clock::time_point
+        {
+            return IsEnabled() ? Clock::now() : Clock::time_point{};
+        }
+
+        static auto GetCurrentThreadId() noexcept -> uint32_t
+        {
+            static thread_local uint32_t threadId = nextThreadId.fetch_add(1, std::memory_order_relaxed);
+            return threadId;
+        }
+
+        // Returns a copy of the string that lives as long as the process. Equal strings are interned only once.
+        auto InternString(StringView text) -> const char*
+        {
+            if (text.empty()) {
+                return "";
+            }
+
+            static thread_local UnorderedStringMap<const char*> localCache;
+            if (auto it = localCache.Find(text); it != localCache.end()) {
+                return it->second;
+            }
+
+            const char* result = nullptr;
+            {
+                std::lock_guard<std::mutex> lock{internMutex};
+                auto it = internedStrings.Find(text);
+                if (it == internedStrings.end()) {
+                    it = internedStrings.Insert({text.Str(), std::monostate{}}).first;
+                }
+                result = it->first.c_str();
+            }
+            localCache.Insert({text.Str(), result});
+            return result;
+        }
+
+        auto Enable() -> void
+        {
+            std::lock_guard<std::mutex> lock{mutex};
+            if (!IsEnabled()) {
+                origin.store(Clock::now(), std::memory_order_relaxed);
+                enabled.store(true, std::memory_order_release);
+            }
+        }
+
+        // Stop recording. Events recorded so far are kept until taken.
+        auto Disable() -> void
+        {
+            std::lock_guard<std::mutex> lock{mutex};
+            enabled.store(false, std::memory_order_release);
+        }
+
+        // Record a span from `start` to `end` on the current thread. Nothing is recorded if tracing is disabled or the
+        // span starts before tracing is enabled.
+        // NOTE `name` must outlive the recorder, which is usually a string literal.
+        auto Record(const char* category, const char* name, Clock::time_point start, Clock::time_point end,
+                    StringView detail = {}, std::optional<int64_t> asyncId = std::nullopt) -> void
+        {
+            if (!enabled.load(std::memory_order_acquire) || start == Clock::time_point{}) {
+                return;
+            }
+
+            auto startOrigin = origin.load(std::memory_order_relaxed);
+            if (start < startOrigin) {
+                return;
+            }
+
+            auto& buffer = GetThreadBuffer();
+            TraceEvent event{
+                .category   = category,
+                .name       = name,
+                .detail     = InternString(detail),
+                .startUs    = ToMicroseconds(start - startOrigin),
+                .durationUs = ToMicroseconds(end - start),
+                .threadId   = buffer.threadId,
+                .asyncId    = asyncId,
+            };
+
+            std::lock_guard<std::mutex> lock{buffer.mutex};
+            if (buffer.events.size() < MaxEventCountPerThread) {
+                buffer.events.push_back(event);
+            }
+            else {
+                buffer.events[buffer.nextIndex] = event;
+            }
+            buffer.nextIndex = (buffer.nextIndex + 1) % MaxEventCountPerThread;
+        }
+
+        // Returns the recorded events of all threads ordered by when they end, and clears the buffers.
+        auto TakeEvents() -> std::vector<TraceEvent>
+        {
+            std::vector<TraceEvent> result;
+            {
+                std::lock_guard<std::mutex> lock{mutex};
+                for (const auto& buffer : threadBuffers) {
+                    std::lock_guard<std::mutex> bufferLock{buffer->mutex};
+                    auto events = std::exchange(buffer->events, {});
+                    if (events.size() == MaxEventCountPerThread) {
+                        std::ranges::rotate(events, events.begin() + buffer->nextIndex);
+                    }
+                    buffer->nextIndex = 0;
+
+                    result.insert(result.end(), events.begin(), events.end());
+                }
+            }
+
+            std::ranges::stable_sort(result, {},
+                                     [](const TraceEvent& event) { return event.startUs + event.durationUs; });
+            return result;
+        }
+    };
+
+    // Records a span on the current thread from construction to destruction, if tracing is enabled.
+    class TraceSpan
+    {
+    private:
+        const char* category;
+        const char* name;
+        StringView detail;
+        TraceRecorder::Clock::time_point start;
+
+    public:
+        // NOTE `name` must outlive the recorder, which is usually a string literal. `detail` must outlive the span, and
+        // it's interned only if tracing is enabled.
+        TraceSpan(const char* category, const char* name, StringView detail = {})
+            : category(category), name(name), detail(detail), start(TraceRecorder::Now())
+        {
+        }
+        ~TraceSpan()
+        {
+            if (start != TraceRecorder::Clock::time_point{}) {
+                TraceRecorder::Get().Record(category, name, start, TraceRecorder::Clock::now(), detail);
+            }
+        }
+
+        TraceSpan(const TraceSpan&)                    = delete;
+        auto operator=(const TraceSpan&) -> TraceSpan& = delete;
+    };
+} // namespace glsld
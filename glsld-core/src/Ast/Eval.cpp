@@ -11,7 +11,8 @@ namespace glsld
     class LazyConstEvalResult
     {
     private:
-        std::variant<ConstValue, ArrayView<const AstInitializer*>> result;
+        // A value is borrowed if it's folded on the Ast, so looking it up doesn't copy its buffer.
+        std::variant<ConstValue, const ConstValue*, ArrayView<const AstInitializer*>> result;
 
     public:
         LazyConstEvalResult() : result(ConstValue{})
@@ -20,6 +21,9 @@ namespace glsld
         LazyConstEvalResult(ConstValue value) : result(std::move(value))
         {
         }
+        LazyConstEvalResult(const ConstValue* borrowedValue) : result(borrowedValue)
+        {
+        }
         LazyConstEvalResult(ArrayView<const AstInitializer*> lazyAggregate) : result(lazyAggregate)
         {
         }
@@ -34,17 +38,32 @@ namespace glsld
 
         auto IsConstValue() const -> bool
         {
-            return std::holds_alternative<ConstValue>(result);
+            return !std::holds_alternative<ArrayView<const AstInitializer*>>(result);
         }
         auto IsLazyAggregate() const -> bool
         {
             return !IsConstValue();
         }
 
-        auto AsConstValue() const -> ConstValue
+        auto AsConstValue() const& -> const ConstValue&
         {
+            static const ConstValue errorValue;
+
+            if (auto borrowedValue = std::get_if<const ConstValue*>(&result)) {
+                return **borrowedValue;
+            }
+
             auto value = std::get_if<ConstValue>(&result);
-            return value ? value->Clone() : ConstValue{};
+            return value ? *value : errorValue;
+        }
+        auto ToEvalResult() && -> ConstEvalResult
+        {
+            if (auto borrowedValue = std::get_if<const ConstValue*>(&result)) {
+                return ConstEvalResult{*borrowedValue};
+            }
+
+            auto value = std::get_if<ConstValue>(&result);
+            return value ? ConstEvalResult{std::move(*value)} : ConstEvalResult{};
         }
         auto AsLazyAggregate() const -> ArrayView<const AstInitializer*>
         {
@@ -107,6 +126,10 @@ namespace glsld
         case BinaryOp::Minus:
             return lhs.ElemwiseMinus(rhs);
         case BinaryOp::Mul:
+            if ((lhs.IsMatrix() || rhs.IsMatrix()) && lhs.IsVectorOrMatrix() && rhs.IsVectorOrMatrix()) {
+                // `mat * mat`, `mat * vec` and `vec * mat` are linear algebraic multiplications.
+                return lhs.MatrixMul(rhs);
+            }
             return lhs.ElemwiseMul(rhs);
         case BinaryOp::Div:
             return lhs.ElemwiseDiv(rhs);
@@ -162,63 +185,63 @@ namespace glsld
     static auto EvalBuiltinFunction1(StringView funcName, const AstExpr* firstArg) -> ConstValue
     {
         auto firstArgResult = EvalAstInitializer(*firstArg);
-        if (firstArgResult.IsError()) {
+        if (firstArgResult->IsError()) {
             return ConstValue{};
         }
 
         if (funcName == "radians") {
-            return firstArgResult.ElemwiseRadians();
+            return firstArgResult->ElemwiseRadians();
         }
         else if (funcName == "degrees") {
-            return firstArgResult.ElemwiseDegrees();
+            return firstArgResult->ElemwiseDegrees();
         }
         else if (funcName == "sin") {
-            return firstArgResult.ElemwiseSin();
+            return firstArgResult->ElemwiseSin();
         }
         else if (funcName == "cos") {
-            return firstArgResult.ElemwiseCos();
+            return firstArgResult->ElemwiseCos();
         }
         else if (funcName == "asin") {
-            return firstArgResult.ElemwiseAsin();
+            return firstArgResult->ElemwiseAsin();
         }
         else if (funcName == "acos") {
-            return firstArgResult.ElemwiseAcos();
+            return firstArgResult->ElemwiseAcos();
         }
         else if (funcName == "exp") {
-            return firstArgResult.ElemwiseExp();
+            return firstArgResult->ElemwiseExp();
         }
         else if (funcName == "log") {
-            return firstArgResult.ElemwiseLog();
+            return firstArgResult->ElemwiseLog();
         }
         else if (funcName == "exp2") {
-            return firstArgResult.ElemwiseExp2();
+            return firstArgResult->ElemwiseExp2();
         }
         else if (funcName == "log2") {
-            return firstArgResult.ElemwiseLog2();
+            return firstArgResult->ElemwiseLog2();
         }
         else if (funcName == "sqrt") {
-            return firstArgResult.ElemwiseSqrt();
+            return firstArgResult->ElemwiseSqrt();
         }
         else if (funcName == "inversesqrt") {
-            return firstArgResult.ElemwiseInverseSqrt();
+            return firstArgResult->ElemwiseInverseSqrt();
         }
         else if (funcName == "abs") {
-            return firstArgResult.ElemwiseAbs();
+            return firstArgResult->ElemwiseAbs();
         }
         else if (funcName == "sign") {
-            return firstArgResult.ElemwiseSign();
+            return firstArgResult->ElemwiseSign();
         }
         else if (funcName == "floor") {
-            return firstArgResult.ElemwiseFloor();
+            return firstArgResult->ElemwiseFloor();
         }
         else if (funcName == "trunc") {
-            return firstArgResult.ElemwiseTrunc();
+            return firstArgResult->ElemwiseTrunc();
         }
         else if (funcName == "round") {
-            return firstArgResult.ElemwiseRound();
+            return firstArgResult->ElemwiseRound();
         }
         else if (funcName == "ceil") {
-            return firstArgResult.ElemwiseCeil();
+            return firstArgResult->ElemwiseCeil();
         }
 
         return ConstValue{};
@@ -228,18 +251,18 @@ namespace glsld
     {
         auto firstArgResult  = EvalAstInitializer(*firstArg);
         auto secondArgResult = EvalAstInitializer(*secondArg);
-        if (firstArgResult.IsError() || secondArgResult.IsError()) {
+        if (firstArgResult->IsError() || secondArgResult->IsError()) {
             return ConstValue{};
         }
 
         if (funcName == "min") {
-            return firstArgResult.ElemwiseMin(secondArgResult);
+            return firstArgResult->ElemwiseMin(*secondArgResult);
         }
         else if (funcName == "max") {
-            return firstArgResult.ElemwiseMax(secondArgResult);
+            return firstArgResult->ElemwiseMax(*secondArgResult);
         }
         else if (funcName == "pow") {
-            return firstArgResult.ElemwisePow(secondArgResult);
+            return firstArgResult->ElemwisePow(*secondArgResult);
         }
 
         return ConstValue{};
@@ -250,12 +273,12 @@ namespace glsld
         auto firstArgResult  = EvalAstInitializer(*firstArg);
         auto secondArgResult = EvalAstInitializer(*secondArg);
         auto thirdArgResult  = EvalAstInitializer(*thirdArg);
-        if (firstArgResult.IsError() || secondArgResult.IsError() || thirdArgResult.IsError()) {
+        if (firstArgResult->IsError() || secondArgResult->IsError() || thirdArgResult->IsError()) {
             return ConstValue{};
         }
 
         if (funcName == "clamp") {
-            return firstArgResult.ElemwiseClamp(secondArgResult, thirdArgResult);
+            return firstArgResult->ElemwiseClamp(*secondArgResult, *thirdArgResult);
         }
 
         return ConstValue{};
@@ -275,6 +298,10 @@ namespace glsld
             return LazyConstEvalResult{};
         }
 
+        if (auto foldedValue = init.GetFoldedValue(); foldedValue) {
+            return LazyConstEvalResult{foldedValue};
+        }
+
         if (auto ilist = init.As<AstInitializerList>(); ilist) {
             return LazyConstEvalResult{ilist->GetItems()};
         }
@@ -282,7 +309,7 @@ namespace glsld
             return LazyConstEvalResult{};
         }
         else if (auto literalExpr = init.As<AstLiteralExpr>(); literalExpr) {
-            return LazyConstEvalResult{literalExpr->GetValue().Clone()};
+            return LazyConstEvalResult{&literalExpr->GetValue()};
         }
         else if (auto nameAccessExpr = init.As<AstNameAccessExpr>(); nameAccessExpr) {
             if (auto decl = nameAccessExpr->GetResolvedDecl(); decl) {
@@ -305,13 +332,13 @@ namespace glsld
         else if (auto swizzleAccessExpr = init.As<AstSwizzleAccessExpr>(); swizzleAccessExpr) {
             // All swizzle access should be evaluated eagerly
             return EvalAstInitializer(*swizzleAccessExpr->GetBaseExpr())
-                .GetSwizzle(swizzleAccessExpr->GetSwizzleDesc());
+                ->GetSwizzle(swizzleAccessExpr->GetSwizzleDesc());
         }
         else if (auto indexAccessExpr = init.As<AstIndexAccessExpr>(); indexAccessExpr) {
             auto baseResult  = EvalAstInitializerLazy(*indexAccessExpr->GetBaseExpr());
             auto indexResult = EvalAstInitializer(*indexAccessExpr->GetIndexExpr());
-            if (indexResult.IsScalarInt32()) {
-                return UnwrapConstEvalResult(baseResult, indexResult.GetInt32Value());
+            if (indexResult->IsScalarInt32()) {
+                return UnwrapConstEvalResult(baseResult, indexResult->GetInt32Value());
             }
             else {
                 return LazyConstEvalResult{};
@@ -336,19 +363,19 @@ namespace glsld
                 }
             }
             else {
-                return EvalUnaryConstExpr(unaryExpr->GetOpcode(), EvalAstInitializer(*unaryExpr->GetOperand()));
+                return EvalUnaryConstExpr(unaryExpr->GetOpcode(), *EvalAstInitializer(*unaryExpr->GetOperand()));
             }
         }
         else if (auto binaryExpr = init.As<AstBinaryExpr>(); binaryExpr) {
             // All binary expression should be evaluated eagerly.
             // That is, aggregate cannot be operand of binary expression.
-            return EvalBinaryConstExpr(binaryExpr->GetOpcode(), EvalAstInitializer(*binaryExpr->GetLhsOperand()),
-                                       EvalAstInitializer(*binaryExpr->GetRhsOperand()));
+            return EvalBinaryConstExpr(binaryExpr->GetOpcode(), *EvalAstInitializer(*binaryExpr->GetLhsOperand()),
+                                       *EvalAstInitializer(*binaryExpr->GetRhsOperand()));
         }
         else if (auto selectExpr = init.As<AstSelectExpr>(); selectExpr) {
             auto conditionResult = EvalAstInitializer(*selectExpr->GetCondition());
-            if (conditionResult.IsScalarBool()) {
-                return EvalAstInitializerLazy(conditionResult.GetBoolValue() ? *selectExpr->GetTrueExpr()
+            if (conditionResult->IsScalarBool()) {
+                return EvalAstInitializerLazy(conditionResult->GetBoolValue() ? *selectExpr->GetTrueExpr()
                                                                              : *selectExpr->GetFalseExpr());
             }
         }
@@ -357,17 +384,17 @@ namespace glsld
             auto targetType = implicitCastExpr->GetDeducedType();
             auto result     = EvalAstInitializer(*implicitCastExpr->GetOperand());
 
-            if (auto toScalarDesc = targetType->GetScalarDesc(); result.IsScalar() && toScalarDesc) {
-                return result.CastScalar(toScalarDesc->type);
+            if (auto toScalarDesc = targetType->GetScalarDesc(); result->IsScalar() && toScalarDesc) {
+                return result->CastScalar(toScalarDesc->type);
             }
             else if (auto toVectorDesc = targetType->GetVectorDesc();
-                     result.IsVector() && toVectorDesc && result.GetArraySize() == toVectorDesc->vectorSize) {
-                return result.CastScalar(toVectorDesc->scalarType);
+                     result->IsVector() && toVectorDesc && result->GetArraySize() == toVectorDesc->vectorSize) {
+                return result->CastScalar(toVectorDesc->scalarType);
             }
-            else if (auto toMatrixDesc = targetType->GetMatrixDesc(); result.IsMatrix() && toMatrixDesc &&
-                                                                      result.GetRowSize() == toMatrixDesc->dimRow &&
-                                                                      result.GetColumnSize() == toMatrixDesc->dimCol) {
-                return result.CastScalar(toMatrixDesc->scalarType);
+            else if (auto toMatrixDesc = targetType->GetMatrixDesc(); result->IsMatrix() && toMatrixDesc &&
+                                                                      result->GetRowSize() == toMatrixDesc->dimRow &&
+                                                                      result->GetColumnSize() == toMatrixDesc->dimCol) {
+                return result->CastScalar(toMatrixDesc->scalarType);
             }
             else {
                 return ConstValue{};
@@ -394,20 +421,20 @@ namespace glsld
                 // 2. if the argument is a vector or matrix, we returns the first scalar casted to the target type
                 if (ctorCallExpr->GetArgs().size() == 1) {
                     auto arg = EvalAstInitializer(*ctorCallExpr->GetArgs()[0]);
-                    return ConstValue::ConstructScalar(arg, scalarDesc->type);
+                    return ConstValue::ConstructScalar(*arg, scalarDesc->type);
                 }
             }
             else if (auto vectorDesc = targetType->GetVectorDesc(); vectorDesc) {
                 if (ctorCallExpr->GetArgs().size() == 1) {
                     auto arg = EvalAstInitializer(*ctorCallExpr->GetArgs()[0]);
-                    return ConstValue::ConstructVector(arg, vectorDesc->scalarType, vectorDesc->vectorSize);
+                    return ConstValue::ConstructVector(*arg, vectorDesc->scalarType, vectorDesc->vectorSize);
                 }
                 else {
                     static constexpr size_t MaxVectorSize = 4;
                     std::array<ConstValue, MaxVectorSize> buffer;
                     if (ctorCallExpr->GetArgs().size() <= MaxVectorSize) {
                         for (size_t i = 0; i < ctorCallExpr->GetArgs().size(); ++i) {
-                            buffer[i] = EvalAstInitializer(*ctorCallExpr->GetArgs()[i]);
+                            buffer[i] = EvalAstInitializer(*ctorCallExpr->GetArgs()[i]).TakeValue();
                         }
 
                         return ConstValue::ComposeVector({buffer.data(), ctorCallExpr->GetArgs().size()},
@@ -418,7 +445,7 @@ namespace glsld
             else if (auto matrixDesc = targetType->GetMatrixDesc(); matrixDesc) {
                 if (ctorCallExpr->GetArgs().size() == 1) {
                     auto arg = EvalAstInitializer(*ctorCallExpr->GetArgs()[0]);
-                    return ConstValue::ConstructMatrix(arg, matrixDesc->scalarType, matrixDesc->dimRow,
+                    return ConstValue::ConstructMatrix(*arg, matrixDesc->scalarType, matrixDesc->dimRow,
                                                        matrixDesc->dimCol);
                 }
                 else {
@@ -426,7 +453,7 @@ namespace glsld
                     std::array<ConstValue, MaxMatrixSize> buffer;
                     if (ctorCallExpr->GetArgs().size() <= MaxMatrixSize) {
                         for (size_t i = 0; i < ctorCallExpr->GetArgs().size(); ++i) {
-                            buffer[i] = EvalAstInitializer(*ctorCallExpr->GetArgs()[i]);
+                            buffer[i] = EvalAstInitializer(*ctorCallExpr->GetArgs()[i]).TakeValue();
                         }
 
                         return ConstValue::ComposeMatrix({buffer.data(), ctorCallExpr->GetArgs().size()},
@@ -443,9 +470,26 @@ namespace glsld
         return LazyConstEvalResult{};
     }
 
-    auto EvalAstInitializer(const AstInitializer& initializer) -> ConstValue
+    auto EvalAstInitializer(const AstInitializer& initializer) -> ConstEvalResult
+    {
+        return EvalAstInitializerLazy(initializer).ToEvalResult();
+    }
+
+    auto FoldAstInitializer(MemoryArena& arena, AstInitializer& init) -> void
     {
-        return EvalAstInitializerLazy(initializer).AsConstValue();
+        if (!init.IsConst() || init.GetFoldedValue() != nullptr) {
+            return;
+        }
+
+        auto result = EvalAstInitializerLazy(init);
+        if (result.IsConstValue()) {
+            init.SetFoldedValue(arena.Construct<ConstValue>(result.AsConstValue().CloneToArena(arena)));
+        }
+        else {
+            for (auto item : result.AsLazyAggregate()) {
+                FoldAstInitializer(arena, const_cast<AstInitializer&>(*item));
+            }
+        }
     }
 
 } // namespace glsld
\ No newline at end of file
@@ -22,6 +22,7 @@ namespace glsld
         for (auto& sizeExpr : sizes) {
             if (sizeExpr) {
                 sizeExpr = TryMakeImplicitCast(sizeExpr, Type::GetBuiltinType(GlslBuiltinType::Ty_int));
+                FoldAstInitializer(arena, *sizeExpr);
             }
         }
 
@@ -125,6 +126,21 @@ namespace glsld
         return result;
     }
 
+    // Returns true if the name looks like a builtin of an extension or profile that the stdlib doesn't model, e.g.
+    // subgroup operations or the texture functions and variables of the compatibility profile. Such names may be valid
+    // even if they are not declared, so they are only diagnosed as warnings.
+    static auto IsUnmodeledBuiltinName(StringView name) -> bool
+    {
+        for (StringView prefix : {"gl_", "subgroup", "texture1D", "texture2D", "texture3D", "textureCube", "shadow1D",
+                                  "shadow2D"}) {
+            if (name.StartWith(prefix)) {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
     auto AstBuilder::BuildNameAccessExpr(AstSyntaxRange range, AstSyntaxToken idToken) -> AstNameAccessExpr*
     {
         auto result = CreateAstNode<AstNameAccessExpr>(range, idToken);
@@ -162,6 +178,12 @@ namespace glsld
 
                 result->SetResolvedDecl(symbolDecl);
             }
+            else if (!IsUnmodeledBuiltinName(idToken.text.StrView())) {
+                diagReporter.UndeclaredIdentifier(idToken.GetSyntaxRange(), idToken.text.StrView());
+            }
+            else if (hasCompleteBuiltins) {
+                diagReporter.UnknownBuiltinIdentifier(idToken.GetSyntaxRange(), idToken.text.StrView());
+            }
         }
 
         return result;
@@ -842,12 +864,22 @@ namespace glsld
                     // FIXME: this is a loose check. Is it good enough?
                     isConst = true;
                 }
-                deducedType      = function->GetReturnType()->GetResolvedType();
-                resolvedFunction = function;
+                GLSLD_ASSERT(function->decl != nullptr);
+                deducedType      = function->returnType;
+                resolvedFunction = function->decl;
 
                 for (size_t i = 0; i < args.size(); ++i) {
                     // Construct implicit cast if needed
-                    args[i] = TryMakeImplicitCast(args[i], function->GetParams()[i]->GetResolvedType());
+                    args[i] = TryMakeImplicitCast(args[i], function->paramEntries[i].type);
+                }
+            }
+            else if (hasCompleteBuiltins && std::ranges::none_of(argTypes, &Type::IsError)) {
+                // Skip if any argument failed to type check, which is likely a cascading error.
+                if (IsUnmodeledBuiltinName(functionNameText)) {
+                    diagReporter.UnknownBuiltinFunction(functionName.GetSyntaxRange(), functionNameText);
+                }
+                else {
+                    diagReporter.NoMatchingFunction(functionName.GetSyntaxRange(), functionNameText);
                 }
             }
         }
@@ -1022,11 +1054,18 @@ namespace glsld
             }
 
             // FIXME: avoids const_cast
-            declaratorNodes[i] = CreateAstNode<AstVariableDeclaratorDecl>(
-                range, declarator.nameToken, declarator.arraySpec,
-                TryMakeImplicitCast(const_cast<AstInitializer*>(declarator.initializer), resolvedType), qualType);
+            auto initializer =
+                TryMakeImplicitCast(const_cast<AstInitializer*>(declarator.initializer), resolvedType);
+            declaratorNodes[i] = CreateAstNode<AstVariableDeclaratorDecl>(range, declarator.nameToken,
+                                                                          declarator.arraySpec, initializer, qualType);
             declaratorNodes[i]->SetScope(GetCurrentScope());
             declaratorNodes[i]->SetResolvedType(resolvedType);
+
+            // Fold initializers of const variables once so that later references to them don't re-evaluate the
+            // whole expression tree.
+            if (initializer && declaratorNodes[i]->IsConstVariable()) {
+                FoldAstInitializer(arena, *initializer);
+            }
         }
 
         auto result = CreateAstNode<AstVariableDecl>(range, qualType, declaratorNodes);
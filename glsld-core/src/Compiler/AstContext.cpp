@@ -79,9 +79,9 @@ namespace glsld
             for (auto arrayDim : arraySpec->GetSizeList()) {
                 int dimSizeValue = 0;
                 if (arrayDim != nullptr) {
-                    const auto& dimSize = EvalAstInitializer(*arrayDim);
-                    if (dimSize.IsScalarInt32()) {
-                        dimSizeValue = dimSize.GetInt32Value();
+                    auto dimSize = EvalAstInitializer(*arrayDim);
+                    if (dimSize->IsScalarInt32()) {
+                        dimSizeValue = dimSize->GetInt32Value();
                     }
                 }
 
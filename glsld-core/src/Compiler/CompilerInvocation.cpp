@@ -1,6 +1,7 @@
 #include "Basic/Common.h"
 #include "Support/ScopeExit.h"
 #include "Support/SimpleTimer.h"
+#include "Support/Tracing.h"
 #include "Compiler/CompilerInvocation.h"
 #include "Compiler/CompilerInvocationState.h"
 #include "Compiler/CompilerResult.h"
@@ -8,10 +9,201 @@
 #include "Compiler/Parser.h"
 #include "Compiler/SyntaxToken.h"
 
+#include <algorithm>
+#include <exception>
+#include <future>
 #include <memory>
+#include <mutex>
+#include <vector>
 
 namespace glsld
 {
+    static auto GetTraceDetail(TranslationUnitID id) -> const char*
+    {
+        switch (id) {
+        case TranslationUnitID::SystemPreamble:
+            return "system preamble";
+        case TranslationUnitID::UserPreamble:
+            return "user preamble";
+        case TranslationUnitID::UserFile:
+            return "main file";
+        }
+
+        GLSLD_UNREACHABLE();
+    }
+
+    static auto GetTraceDetail(FileID file) -> const char*
+    {
+        if (file.IsSystemPreamble()) {
+            return GetTraceDetail(TranslationUnitID::SystemPreamble);
+        }
+        else if (file.IsUserPreamble()) {
+            return GetTraceDetail(TranslationUnitID::UserPreamble);
+        }
+        else {
+            return GetTraceDetail(TranslationUnitID::UserFile);
+        }
+    }
+
+    static auto CompileStdlibSegment(CompilerInvocationState& compiler, FileID file, TranslationUnitID id,
+                                     PPCallback* ppCallback) -> std::shared_ptr<PrecompiledPreamble>
+    {
+        TraceSpan span{"compiler", "compileStdlib", GetTraceDetail(id)};
+        Preprocessor{compiler, file, ppCallback, false}.DoPreprocess();
+        Parser{compiler, id, compiler.GetArtifact(id)->GetTokens()}.DoParse();
+        return compiler.CreatePreamble();
+    }
+
+    // The maximum number of stdlib cores to retain. Each one holds the AST of the whole stdlib, and a session usually
+    // only uses one or two versions.
+    static constexpr size_t MaxCachedStdlibCoreCount = 4;
+
+    struct CachedStdlibCore
+    {
+        CompilerConfig compilerConfig;
+        LanguageConfig languageConfig;
+
+        // Becomes ready once the thread that first requested the core finishes compiling it.
+        std::shared_future<std::shared_ptr<PrecompiledPreamble>> core;
+    };
+
+    // Cached stdlib cores, ordered from the least recently used to the most recently used.
+    static std::mutex stdlibCoreCacheMutex;
+    static std::vector<CachedStdlibCore> cachedStdlibCores;
+
+    struct CachedStdlibPreamble
+    {
+        CompilerConfig compilerConfig;
+        std::weak_ptr<PrecompiledPreamble> preamble;
+    };
+
+    // Returns the stdlib core for the config, compiling it if needed. Each core is compiled only once. Other threads
+    // requesting the same core wait for it, while requests of other cores are not blocked.
+    static auto GetStdlibCore(const CompilerConfig& compilerConfig, const LanguageConfig& coreConfig)
+        -> std::shared_ptr<PrecompiledPreamble>
+    {
+        auto isSameCore = [&](const CachedStdlibCore& cachedCore) {
+            return cachedCore.compilerConfig == compilerConfig && cachedCore.languageConfig == coreConfig;
+        };
+
+        std::promise<std::shared_ptr<PrecompiledPreamble>> promise;
+        std::shared_future<std::shared_ptr<PrecompiledPreamble>> pendingCore;
+        {
+            std::lock_guard<std::mutex> lock{stdlibCoreCacheMutex};
+            auto it = std::ranges::find_if(cachedStdlibCores, isSameCore);
+            if (it != cachedStdlibCores.end()) {
+                std::rotate(it, it + 1, cachedStdlibCores.end());
+                pendingCore = cachedStdlibCores.back().core;
+            }
+            else {
+                cachedStdlibCores.push_back(CachedStdlibCore{
+                    .compilerConfig = compilerConfig,
+                    .languageConfig = coreConfig,
+                    .core           = promise.get_future().share(),
+                });
+                if (cachedStdlibCores.size() > MaxCachedStdlibCoreCount) {
+                    // Preambles that are composed on an evicted core keep it alive.
+                    cachedStdlibCores.erase(cachedStdlibCores.begin());
+                }
+            }
+        }
+
+        if (pendingCore.valid()) {
+            return pendingCore.get();
+        }
+
+        try {
+            SourceManager sourceManager;
+            CompilerInvocationState compiler{sourceManager, compilerConfig, coreConfig, true};
+            auto core =
+                CompileStdlibSegment(compiler, FileID::SystemPreamble(), TranslationUnitID::SystemPreamble, nullptr);
+            promise.set_value(core);
+            return core;
+        }
+        catch (...) {
+            // The failed entry is dropped so that the next request compiles the core again. Threads already waiting on
+            // it get the exception instead of waiting forever.
+            {
+                std::lock_guard<std::mutex> lock{stdlibCoreCacheMutex};
+                std::erase_if(cachedStdlibCores, isSameCore);
+            }
+            promise.set_exception(std::current_exception());
+            throw;
+        }
+    }
+
+    auto GetCachedStdlibCores() -> std::vector<std::shared_ptr<PrecompiledPreamble>>
+    {
+        std::vector<std::shared_ptr<PrecompiledPreamble>> result;
+        std::lock_guard<std::mutex> lock{stdlibCoreCacheMutex};
+        for (const auto& cachedCore : cachedStdlibCores) {
+            // Cores that are still being compiled are skipped. Failed ones are already removed from the cache.
+            if (cachedCore.core.wait_for(std::chrono::seconds::zero()) == std::future_status::ready) {
+                result.push_back(cachedCore.core.get());
+            }
+        }
+
+        return result;
+    }
+
+    // The stdlib is compiled in two segments. The core, which is everything but the builtins of specific shader stages,
+    // only depends on the version and profile. The stage segment is compiled on top of it into the user preamble. Both
+    // are cached for the whole process, keyed on the compiler config as well, so that all preambles share the core AST,
+    // and a config change only compiles the segments that are missing. `cacheHit` is set if the preamble is found in
+    // the cache.
+    static auto GetStdlibPreamble(const CompilerConfig& compilerConfig, const LanguageConfig& languageConfig,
+                                  PPCallback* ppCallback, bool& cacheHit) -> std::shared_ptr<PrecompiledPreamble>
+    {
+        static std::mutex cacheMutex;
+        static std::vector<CachedStdlibPreamble> cachedPreambles;
+
+        auto findCachedPreamble = [&]() -> std::shared_ptr<PrecompiledPreamble> {
+            for (const auto& cachedPreamble : cachedPreambles) {
+                if (auto result = cachedPreamble.preamble.lock();
+                    result && cachedPreamble.compilerConfig == compilerConfig &&
+                    result->GetLanguageConfig() == languageConfig) {
+                    return result;
+                }
+            }
+
+            return nullptr;
+        };
+
+        // The callback has to observe the stage segment being preprocessed, so a cached preamble cannot be used.
+        if (!ppCallback) {
+            std::lock_guard<std::mutex> lock{cacheMutex};
+            if (auto result = findCachedPreamble()) {
+                cacheHit = true;
+                return result;
+            }
+        }
+
+        // The stage segment is small, so it's compiled without holding the lock. Concurrent requests of the same config
+        // may compile it more than once, in which case the first one published is shared.
+        LanguageConfig coreConfig = {
+            .version = languageConfig.version,
+            .profile = languageConfig.profile,
+        };
+        SourceManager sourceManager;
+        CompilerInvocationState compiler{sourceManager, compilerConfig, GetStdlibCore(compilerConfig, coreConfig),
+                                         languageConfig};
+        auto result =
+            CompileStdlibSegment(compiler, FileID::UserPreamble(), TranslationUnitID::UserPreamble, ppCallback);
+
+        std::lock_guard<std::mutex> lock{cacheMutex};
+        if (auto cachedResult = findCachedPreamble()) {
+            return ppCallback ? result : cachedResult;
+        }
+
+        std::erase_if(cachedPreambles,
+                      [](const CachedStdlibPreamble& cachedPreamble) { return cachedPreamble.preamble.expired(); });
+        cachedPreambles.push_back(CachedStdlibPreamble{
+            .compilerConfig = compilerConfig,
+            .preamble       = result,
+        });
+        return result;
+    }
+
     CompilerInvocation::CompilerInvocation() = default;
     CompilerInvocation::CompilerInvocation(std::shared_ptr<PrecompiledPreamble> preamble)
     {
@@ -37,6 +229,7 @@ namespace glsld
             return;
         }
 
+        TraceSpan span{"compiler", "scanVersion"};
         ScopeExit _{[this, timer = SimpleTimer{}] {
             auto elapsedTime = timer.GetElapsedTime<CompilerInvocationStatistics::Duration>();
             statistics.totalCompileTime += elapsedTime;
@@ -51,11 +244,18 @@ namespace glsld
     {
         GLSLD_REQUIRE(!preamble);
 
+        TraceSpan span{"compiler", "compilePreamble"};
         ScopeExit _{[this, timer = SimpleTimer{}]() {
             auto elapsedTime = timer.GetElapsedTime<CompilerInvocationStatistics::Duration>();
             statistics.totalCompileTime += elapsedTime;
         }};
 
+        // The user preamble slot is taken by the stdlib stage segment, so only compose from the shared stdlib segments
+        // if there's no user preamble.
+        if (!languageConfig.noStdlib && StringView{sourceManager.GetUserPreamble()}.empty()) {
+            return GetStdlibPreamble(compilerConfig, languageConfig, ppCallback, statistics.preambleCacheHit);
+        }
+
         auto compiler = InitializeCompilation();
 
         if (compiler->GetArtifact(TranslationUnitID::SystemPreamble)->GetAst() == nullptr) {
@@ -79,6 +279,7 @@ namespace glsld
             return nullptr;
         }
 
+        TraceSpan span{"compiler", "compileMainFile"};
         ScopeExit _{[this, timer = SimpleTimer{}]() {
             auto elapsedTime = timer.GetElapsedTime<CompilerInvocationStatistics::Duration>();
             statistics.totalCompileTime += elapsedTime;
@@ -100,6 +301,9 @@ namespace glsld
             DoParse(*compiler, TranslationUnitID::SystemPreamble);
             DoParse(*compiler, TranslationUnitID::UserPreamble);
         }
+
+        // Only the main file stage could be stopped. Preambles parsed above are part of the result and must be complete.
+        compiler->SetStopToken(stopToken);
         DoParse(*compiler, TranslationUnitID::UserFile);
 
         return compiler->CreateCompileResult();
@@ -119,6 +323,8 @@ namespace glsld
     {
         GLSLD_REQUIRE(file.IsValid());
 
+        // NOTE lexing is driven by the preprocessor on demand, so it's included in this span.
+        TraceSpan span{"compiler", "preprocess", GetTraceDetail(file)};
         ScopeExit _{[this, file, timer = SimpleTimer{}]() {
             auto elapsedTime = timer.GetElapsedTime<CompilerInvocationStatistics::Duration>();
             if (file.IsPreamble()) {
@@ -133,6 +339,7 @@ namespace glsld
     }
     auto CompilerInvocation::DoParse(CompilerInvocationState& compiler, TranslationUnitID id) -> void
     {
+        TraceSpan span{"compiler", "parse", GetTraceDetail(id)};
         ScopeExit _{[this, timer = SimpleTimer{}]() {
             auto elapsedTime = timer.GetElapsedTime<CompilerInvocationStatistics::Duration>();
             statistics.mainFileParsing += elapsedTime;
@@ -7,9 +7,18 @@
 #include "Language/Stdlib.Generated.h"
 
 #include <memory>
+#include <string>
 
 namespace glsld
 {
+    // The stdlib text compiled as a whole, i.e. the stage segment appended to the core.
+    static auto GetStdlibFullText() -> SourceTextView
+    {
+        static const std::string fullText =
+            StringView{GlslStdlibCoreText}.Str() + StringView{GlslStdlibStageText}.Str();
+        return fullText;
+    }
+
     auto CompilerInvocationState::Initialize() -> void
     {
         if (preamble) {
@@ -34,14 +43,14 @@ namespace glsld
         userFileArtifacts = std::make_unique<CompilerArtifact>(TranslationUnitID::UserFile);
     }
 
-    auto CompilerInvocationState::InitializeStdlib() -> void
+    auto CompilerInvocationState::InitializeStdlib(bool coreOnly) -> void
     {
         // FIXME: don't run this when scanning for version and extensions
         GLSLD_ASSERT(preamble == nullptr);
 
         // Initialize system preamble
         if (!languageConfig.noStdlib) {
-            sourceManager.SetSystemPreamble(GlslStdlibText);
+            sourceManager.SetSystemPreamble(coreOnly ? GlslStdlibCoreText : GetStdlibFullText());
         }
 
         // Initialize feature macros
@@ -63,6 +72,40 @@ namespace glsld
             defineFeatureMacro("__GLSLD_LANGUAGE_PROFILE_CORE");
             break;
         }
+        // FIXME: define more feature macros based on extensions
+        defineFeatureMacro("__GLSLD_FEATURE_ENABLE_INT8_TYPE");
+        defineFeatureMacro("__GLSLD_FEATURE_ENABLE_INT16_TYPE");
+        defineFeatureMacro("__GLSLD_FEATURE_ENABLE_INT32_TYPE");
+        defineFeatureMacro("__GLSLD_FEATURE_ENABLE_INT64_TYPE");
+        defineFeatureMacro("__GLSLD_FEATURE_ENABLE_FLOAT16_TYPE");
+        defineFeatureMacro("__GLSLD_FEATURE_ENABLE_FLOAT32_TYPE");
+        defineFeatureMacro("__GLSLD_FEATURE_ENABLE_FLOAT64_TYPE");
+        defineFeatureMacro("__GLSLD_FEATURE_ENABLE_SHADER_SM_BUILTIN_NV");
+        defineFeatureMacro("__GLSLD_FEATURE_ENABLE_MEMORY_SCOPE_SEMANTICS");
+        defineFeatureMacro("__GLSLD_FEATURE_ENABLE_RAY_QUERY");
+        defineFeatureMacro("__GLSLD_FEATURE_ENABLE_RAY_TRACING_EXT");
+        defineFeatureMacro("__GLSLD_FEATURE_ENABLE_RAY_TRACING_NV");
+
+        if (!coreOnly) {
+            DefineShaderStageMacro();
+        }
+    }
+
+    auto CompilerInvocationState::InitializeStdlibStageSegment() -> void
+    {
+        GLSLD_ASSERT(preamble != nullptr && !languageConfig.noStdlib);
+
+        // The stdlib core is imported from the preamble, so only the stage segment is left to compile
+        sourceManager.SetUserPreamble(GlslStdlibStageText);
+        DefineShaderStageMacro();
+    }
+
+    auto CompilerInvocationState::DefineShaderStageMacro() -> void
+    {
+        auto defineFeatureMacro = [this, one = atomTable->GetAtom("1")](StringView name) {
+            macroTable->DefineFeatureMacro(atomTable->GetAtom(name), one);
+        };
+
         switch (languageConfig.stage) {
         case GlslShaderStage::Vertex:
             defineFeatureMacro("__GLSLD_SHADER_STAGE_VERTEX");
@@ -110,20 +153,6 @@ namespace glsld
             defineFeatureMacro("__GLSLD_SHADER_STAGE_UNKNOWN");
             break;
         }
-
-        // FIXME: define more feature macros based on extensions
-        defineFeatureMacro("__GLSLD_FEATURE_ENABLE_INT8_TYPE");
-        defineFeatureMacro("__GLSLD_FEATURE_ENABLE_INT16_TYPE");
-        defineFeatureMacro("__GLSLD_FEATURE_ENABLE_INT32_TYPE");
-        defineFeatureMacro("__GLSLD_FEATURE_ENABLE_INT64_TYPE");
-        defineFeatureMacro("__GLSLD_FEATURE_ENABLE_FLOAT16_TYPE");
-        defineFeatureMacro("__GLSLD_FEATURE_ENABLE_FLOAT32_TYPE");
-        defineFeatureMacro("__GLSLD_FEATURE_ENABLE_FLOAT64_TYPE");
-        defineFeatureMacro("__GLSLD_FEATURE_ENABLE_SHADER_SM_BUILTIN_NV");
-        defineFeatureMacro("__GLSLD_FEATURE_ENABLE_MEMORY_SCOPE_SEMANTICS");
-        defineFeatureMacro("__GLSLD_FEATURE_ENABLE_RAY_QUERY");
-        defineFeatureMacro("__GLSLD_FEATURE_ENABLE_RAY_TRACING_EXT");
-        defineFeatureMacro("__GLSLD_FEATURE_ENABLE_RAY_TRACING_NV");
     }
 
     auto CompilerInvocationState::TryDumpTokens(TranslationUnitID id, ArrayView<RawSyntaxToken> tokens) const -> void
@@ -28,6 +28,12 @@ namespace glsld
         std::vector<AstDecl*> decls;
         while (true) {
             while (!Eof()) {
+                if (compiler.IsStopRequested()) {
+                    // The compilation is cancelled. Skip to the final EOF so that the AST is still well-formed.
+                    currentTok = &tokens.back();
+                    break;
+                }
+
                 decls.push_back(ParseDeclAndTryRecover(nullptr, true));
             }
 
@@ -4,6 +4,7 @@
 #include "Compiler/SyntaxToken.h"
 #include "Language/ShaderTarget.h"
 #include "Support/ScopeExit.h"
+#include "Support/Tracing.h"
 
 #include <string>
 
@@ -323,6 +324,9 @@ namespace glsld
 #endif
             if (token.klass == TokenKlass::Eof) {
                 FeedPPToken(token);
+                if (!conditionalStack.empty()) {
+                    diagReporter.UnterminatedPPRegion(FileTextRange{token.spelledFile, token.spelledRange});
+                }
                 break;
             }
 
@@ -391,7 +395,7 @@ namespace glsld
     auto PreprocessStateMachine::AcceptOnInactiveState(const PPToken& token) -> void
     {
         if (token.klass == TokenKlass::Eof) {
-            // FIXME: Unterminated inactive region. Report error.
+            // Unterminated inactive region is reported after the whole file is processed.
         }
         else if (token.klass == TokenKlass::Hash && token.isFirstTokenOfLine) {
             TransitionToExpectDirectiveState(token);
@@ -500,7 +504,7 @@ namespace glsld
             HandleEndifDirective(scanner);
         }
         else if (directiveToken.text == atoms.miscs.directiveError) {
-            // FIXME: report error
+            HandleErrorDirective(scanner);
         }
         else if (directiveToken.text == atoms.miscs.directiveExtension) {
             HandleExtensionDirective(scanner);
@@ -515,7 +519,8 @@ namespace glsld
             HandleLineDirective(scanner);
         }
         else {
-            // FIXME: warn about unknown directives
+            ReportDirectiveWarning(scanner,
+                                   fmt::format("unknown preprocessor directive '{}'", directiveToken.text.StrView()));
         }
 
         if (versionScanningMode) {
@@ -531,23 +536,26 @@ namespace glsld
     {
         const auto& compilerConfig = compiler.GetCompilerConfig();
         if (includeDepth >= compilerConfig.maxIncludeDepth) {
-            // FIXME: report error, too many nested include files
+            ReportDirectiveError(scanner, "#include nested too deeply");
             return;
         }
 
         if (auto headerNameToken = scanner.TryConsumeToken(TokenKlass::UserHeaderName, TokenKlass::SystemHeaderName)) {
             if (!scanner.CursorAtEnd()) {
-                // FIXME: report warning, extra tokens after the header file name
+                ReportDirectiveWarning(scanner, "extra tokens at end of #include directive");
             }
 
             // Search for the header file in the include paths and load the source text.
             StringView headerName = headerNameToken->text.StrView().Drop(1).DropBack(1);
             FileID includeFile;
-            for (const auto& includePath : compilerConfig.includePaths) {
-                // TODO: distinguish between system include and user include
-                includeFile = sourceManager.OpenFromFile(includePath / headerName.StdStrView());
-                if (includeFile.IsValid()) {
-                    break;
+            {
+                TraceSpan span{"compiler", "openInclude", headerName};
+                for (const auto& includePath : compilerConfig.includePaths) {
+                    // TODO: distinguish between system include and user include
+                    includeFile = sourceManager.OpenFromFile(includePath / headerName.StdStrView());
+                    if (includeFile.IsValid()) {
+                        break;
+                    }
                 }
             }
 
@@ -558,7 +566,7 @@ namespace glsld
             }
 
             if (!includeFile.IsValid()) {
-                // FIXME: report error, cannot find the header file
+                ReportError(*headerNameToken, fmt::format("cannot find header file '{}'", headerName));
                 return;
             }
 
@@ -584,7 +592,7 @@ namespace glsld
 #endif
         }
         else {
-            // FIXME: report error, expected a header file name
+            ReportDirectiveError(scanner, "expected a header file name");
         }
     }
 
@@ -596,7 +604,7 @@ namespace glsld
             macroName = *tok;
         }
         else {
-            // FIXME: report error, expected a macro name
+            ReportDirectiveError(scanner, "expected a macro name");
             return;
         }
 
@@ -632,7 +640,7 @@ namespace glsld
                             break;
                         }
                         else {
-                            // FIXME: report error, expected a comma or a terminating ')'
+                            ReportDirectiveError(scanner, "expected ',' or ')' in macro parameter list");
                             return;
                         }
                     }
@@ -646,16 +654,16 @@ namespace glsld
                             auto tok2 = scanner.TryConsumeToken(TokenKlass::Dot);
                             auto tok3 = scanner.TryConsumeToken(TokenKlass::Dot);
                             if (tok1 && tok2 && tok3 && !tok2->hasLeadingWhitespace && !tok3->hasLeadingWhitespace) {
-                                // FIXME: report error, variadic macro is not supported yet
+                                ReportDirectiveError(scanner, "variadic macros are not supported");
                             }
                             else {
-                                // FIXME: report error, expected a macro parameter name
+                                ReportDirectiveError(scanner, "expected a macro parameter name");
                             }
 
                             return;
                         }
                         else {
-                            // FIXME: report error, expected a macro parameter name
+                            ReportDirectiveError(scanner, "expected a macro parameter name");
                             return;
                         }
                     }
@@ -691,12 +699,12 @@ namespace glsld
             macroName = *tok;
         }
         else {
-            // FIXME: report error, expected a macro name
+            ReportDirectiveError(scanner, "expected a macro name");
             return;
         }
 
         if (!scanner.CursorAtEnd()) {
-            // FIXME: report warning, expected no more tokens after the macro name.
+            ReportDirectiveWarning(scanner, "extra tokens at end of directive");
         }
 
         // Run PP callback event if any
@@ -748,12 +756,12 @@ namespace glsld
             macroName = *tok;
         }
         else {
-            // FIXME: report error, expected a macro name
+            ReportDirectiveError(scanner, "expected a macro name");
             return;
         }
 
         if (!scanner.CursorAtEnd()) {
-            // FIXME: report warning, expected no more tokens after the macro name.
+            ReportDirectiveWarning(scanner, "extra tokens at end of directive");
         }
 
         bool isActive = macroTable.IsMacroDefined(macroName.text) != isNDef;
@@ -783,13 +791,13 @@ namespace glsld
         bool evalToTrue = EvaluatePPExpression(scanner);
 
         if (conditionalStack.empty()) {
-            // FIXME: report warning, standalone #elif directive
+            ReportDirectiveWarning(scanner, "#elif without #if");
             return;
         }
 
         auto& conditionalInfo = conditionalStack.back();
         if (conditionalInfo.seenElse) {
-            // FIXME: report error, #elif directive after #else directive
+            ReportDirectiveError(scanner, "#elif after #else");
             return;
         }
 
@@ -813,17 +821,17 @@ namespace glsld
         }
 
         if (!scanner.CursorAtEnd()) {
-            // FIXME: report warning, expected no more tokens after the directive.
+            ReportDirectiveWarning(scanner, "extra tokens at end of directive");
         }
 
         if (conditionalStack.empty()) {
-            // FIXME: report warning, standalone #else directive
+            ReportDirectiveWarning(scanner, "#else without #if");
             return;
         }
 
         auto& conditionalInfo = conditionalStack.back();
         if (conditionalInfo.seenElse) {
-            // FIXME: report error, an extraous #else directive
+            ReportDirectiveError(scanner, "#else after #else");
             return;
         }
 
@@ -851,11 +859,11 @@ namespace glsld
         }
 
         if (!scanner.CursorAtEnd()) {
-            // FIXME: report warning, expected no more tokens after the directive.
+            ReportDirectiveWarning(scanner, "extra tokens at end of directive");
         }
 
         if (conditionalStack.empty()) {
-            // FIXME: report warning, unmatched #endif directive
+            ReportDirectiveWarning(scanner, "#endif without #if");
             return;
         }
 
@@ -867,6 +875,19 @@ namespace glsld
         conditionalStack.pop_back();
     }
 
+    auto PreprocessStateMachine::HandleErrorDirective(PPTokenScanner& scanner) -> void
+    {
+        // Report the message spelled by the remaining tokens
+        std::string message = "#error";
+        while (!scanner.CursorAtEnd()) {
+            const auto& token = scanner.ConsumeToken();
+            message += ' ';
+            message += token.text.StrView().StdStrView();
+        }
+
+        ReportDirectiveError(scanner, std::move(message));
+    }
+
     auto PreprocessStateMachine::ParseExtensionBehavior(const PPToken& toggle) -> std::optional<ExtensionBehavior>
     {
         GLSLD_ASSERT(toggle.klass == TokenKlass::Identifier);
@@ -890,28 +911,30 @@ namespace glsld
     auto PreprocessStateMachine::HandleExtensionDirective(PPTokenScanner& scanner) -> void
     {
         if (!scanner.TryTestToken(TokenKlass::Identifier)) {
-            // FIXME: report error, expected an extension name
+            ReportDirectiveError(scanner, "expected an extension name");
             return;
         }
         auto extensionNameTok = scanner.ConsumeToken();
         auto extension        = ParseExtensionName(extensionNameTok.text.StrView());
         if (!extension) {
-            // FIXME: report error, invalid extension name
+            ReportDirectiveWarning(scanner,
+                                   fmt::format("unknown extension '{}'", extensionNameTok.text.StrView()));
             return;
         }
 
         if (!scanner.TryConsumeToken(TokenKlass::Colon)) {
-            // FIXME: report error, expected a colon
+            ReportDirectiveError(scanner, "expected ':' after the extension name");
             return;
         }
         if (!scanner.TryTestToken(TokenKlass::Identifier)) {
-            // FIXME: report error, expected an extension toggle
+            ReportDirectiveError(scanner, "expected an extension behavior");
             return;
         }
         auto extensionBehaviorTok = scanner.ConsumeToken();
         auto behavior             = ParseExtensionBehavior(extensionBehaviorTok);
         if (!behavior) {
-            // FIXME: report error, invalid extension toggle
+            ReportDirectiveError(scanner, fmt::format("invalid extension behavior '{}'",
+                                                      extensionBehaviorTok.text.StrView()));
             return;
         }
 
@@ -1019,13 +1042,13 @@ namespace glsld
     auto PreprocessStateMachine::HandleVersionDirective(PPTokenScanner& scanner) -> void
     {
         if (scanner.CursorAtEnd()) {
-            // FIXME: report error, expect version number
+            ReportDirectiveError(scanner, "expected a version number");
             return;
         }
         PPToken versionTok                 = scanner.ConsumeToken();
         std::optional<GlslVersion> version = ParseGlslVersion(versionTok);
         if (!version) {
-            // FIXME: report error
+            ReportError(versionTok, fmt::format("invalid version number '{}'", versionTok.text.StrView()));
             return;
         }
 
@@ -1035,7 +1058,7 @@ namespace glsld
             profileTok = scanner.ConsumeToken();
             profile    = ParseGlslProfile(profileTok);
             if (!profile) {
-                // FIXME: report error
+                ReportError(profileTok, fmt::format("invalid profile '{}'", profileTok.text.StrView()));
                 return;
             }
         }
@@ -3,6 +3,24 @@
 
 namespace glsld
 {
+    static auto CreateFunctionSymbolEntry(const AstFunctionDecl& decl) -> FunctionSymbolEntry
+    {
+        std::vector<FunctionParamSymbolEntry> paramEntries;
+        for (auto paramDecl : decl.GetParams()) {
+            paramEntries.push_back(FunctionParamSymbolEntry{
+                .type     = paramDecl->GetResolvedType(),
+                .isInput  = paramDecl->IsInputParam(),
+                .isOutput = paramDecl->IsOutputParam(),
+            });
+        }
+
+        return FunctionSymbolEntry{
+            .decl         = &decl,
+            .returnType   = decl.GetReturnType()->GetResolvedType(),
+            .paramEntries = std::move(paramEntries),
+        };
+    }
+
     auto SymbolTableLevel::AddFunctionDecl(AstFunctionDecl& decl) -> void
     {
         if (!decl.GetNameToken().IsIdentifier()) {
@@ -12,17 +30,7 @@ namespace glsld
         // FIXME: we need to deduplicate since a function could be declared multiple times
         auto name = decl.GetNameToken().text.Str();
         if (!name.empty()) {
-            std::vector<FunctionParamSymbolEntry> paramEntries;
-            for (auto paramDecl : decl.GetParams()) {
-                auto quals = paramDecl->GetQualType()->GetQualifiers();
-                paramEntries.push_back(FunctionParamSymbolEntry{
-                    .type     = paramDecl->GetResolvedType(),
-                    .isInput  = paramDecl->IsInputParam(),
-                    .isOutput = paramDecl->IsOutputParam(),
-                });
-            }
-            funcDeclLookup.Insert(
-                {std::move(name), FunctionSymbolEntry{.decl = &decl, .paramEntries = std::move(paramEntries)}});
+            funcDeclLookup.Insert({std::move(name), CreateFunctionSymbolEntry(decl)});
         }
     }
 
@@ -112,44 +120,52 @@ namespace glsld
     }
 
     auto SymbolTable::FindFunction(StringView name, const std::vector<const Type*>& argTypes,
-                                   bool requireExactMatch) const -> const AstFunctionDecl*
+                                   bool requireExactMatch) const -> const FunctionSymbolEntry*
     {
         // First pass: filter out candidates that's invocable with the given argument types
         std::vector<const FunctionSymbolEntry*> candidateList;
-        for (auto level : GetGlobalLevels()) {
-            for (auto candidate : level->FindFunctionCandidate(name)) {
-                if (candidate->paramEntries.size() == argTypes.size()) {
-                    // Fast path for exact match
-                    if (std::ranges::equal(candidate->paramEntries, argTypes,
-                                           [](const FunctionParamSymbolEntry& entry, const Type* argType) {
-                                               return entry.type->IsSameWith(argType);
-                                           })) {
-                        return candidate->decl;
-                    }
+        auto testCandidate = [&](const FunctionSymbolEntry* candidate) -> bool {
+            if (candidate->paramEntries.size() != argTypes.size()) {
+                return false;
+            }
 
-                    auto convertible = true;
-                    for (size_t i = 0; i < argTypes.size(); ++i) {
-                        if (candidate->paramEntries[i].isInput &&
-                            !argTypes[i]->IsConvertibleTo(candidate->paramEntries[i].type)) {
-                            convertible = false;
-                            break;
-                        }
-                        if (candidate->paramEntries[i].isOutput &&
-                            !candidate->paramEntries[i].type->IsConvertibleTo(argTypes[i])) {
-                            convertible = false;
-                            break;
-                        }
-                    }
+            // Fast path for exact match
+            if (std::ranges::equal(candidate->paramEntries, argTypes,
+                                   [](const FunctionParamSymbolEntry& entry, const Type* argType) {
+                                       return entry.type->IsSameWith(argType);
+                                   })) {
+                return true;
+            }
 
-                    if (convertible && !requireExactMatch) {
-                        candidateList.push_back(candidate);
-                    }
+            auto convertible = true;
+            for (size_t i = 0; i < argTypes.size(); ++i) {
+                if (candidate->paramEntries[i].isInput &&
+                    !argTypes[i]->IsConvertibleTo(candidate->paramEntries[i].type)) {
+                    convertible = false;
+                    break;
+                }
+                if (candidate->paramEntries[i].isOutput &&
+                    !candidate->paramEntries[i].type->IsConvertibleTo(argTypes[i])) {
+                    convertible = false;
+                    break;
+                }
+            }
+
+            if (convertible && !requireExactMatch) {
+                candidateList.push_back(candidate);
+            }
+            return false;
+        };
+        for (auto level : GetGlobalLevels()) {
+            for (auto candidate : level->FindFunctionCandidate(name)) {
+                if (testCandidate(candidate)) {
+                    return candidate;
                 }
             }
         }
 
         // Second pass: find the single best candidate if any
-        const AstFunctionDecl* bestCandidate = nullptr;
+        const FunctionSymbolEntry* bestCandidate = nullptr;
         for (auto candidate : candidateList) {
             bool isAlwaysBetter = true;
             for (auto otherCandidate : candidateList) {
@@ -190,7 +206,7 @@ namespace glsld
                     break;
                 }
                 else {
-                    bestCandidate = candidate->decl;
+                    bestCandidate = candidate;
                 }
             }
         }
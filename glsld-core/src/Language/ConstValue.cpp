@@ -3,6 +3,7 @@
 #include <charconv>
 #include <concepts>
 #include <functional>
+#include <limits>
 #include <numbers>
 
 #if GLSLD_COMPILER_MSVC
@@ -413,14 +414,33 @@ namespace glsld
 
     auto ConstValue::Clone() const -> ConstValue
     {
+        // A borrowed buffer is always copied, since the clone may outlive the storage it's borrowed from, e.g. the arena
+        // of a compilation that is released.
         ConstValue result;
-
         auto blob = result.InitializeAsBlob(static_cast<ScalarKind>(scalarType), rowSize, colSize);
         std::ranges::copy(GetBufferAsBlob(), blob.begin());
 
         return result;
     }
 
+    auto ConstValue::CloneToArena(MemoryArena& arena) const -> ConstValue
+    {
+        if (!UseHeapBuffer()) {
+            return Clone();
+        }
+
+        ConstValue result;
+        result.scalarType     = scalarType;
+        result.arraySize      = arraySize;
+        result.rowSize        = rowSize;
+        result.colSize        = colSize;
+        result.borrowedBuffer = true;
+        result.bufferPtr      = static_cast<std::byte*>(arena.Allocate(GetBufferSize()));
+        std::ranges::copy(GetBufferAsBlob(), result.bufferPtr);
+
+        return result;
+    }
+
     auto ConstValue::CastScalar(ScalarKind kind) const -> ConstValue
     {
         if (IsError()) {
@@ -533,6 +553,69 @@ namespace glsld
 
         template <typename F>
         using ExcludingBoolFloat = ExcludingTypes<F, bool, float, double>;
+
+        template <typename T>
+        concept NonBoolIntegral = std::integral<T> && !std::is_same_v<T, bool>;
+
+        // Integer division by zero and `INT_MIN / -1` trap on the host. GLSL leaves the result undefined, so we
+        // substitute the divisor with 1 instead, which keeps the kernel free of branches.
+        template <NonBoolIntegral T>
+        auto SanitizeDivisor(T lhs, T rhs) -> T
+        {
+            bool invalid = rhs == 0;
+            if constexpr (std::is_signed_v<T>) {
+                invalid |= lhs == std::numeric_limits<T>::min() && rhs == static_cast<T>(-1);
+            }
+            return invalid ? static_cast<T>(1) : rhs;
+        }
+
+        struct Divides
+        {
+            template <std::floating_point T>
+            auto operator()(T lhs, T rhs) const -> T
+            {
+                return lhs / rhs;
+            }
+
+            template <NonBoolIntegral T>
+            auto operator()(T lhs, T rhs) const -> T
+            {
+                return static_cast<T>(lhs / SanitizeDivisor(lhs, rhs));
+            }
+        };
+
+        struct Modulus
+        {
+            template <NonBoolIntegral T>
+            auto operator()(T lhs, T rhs) const -> T
+            {
+                return static_cast<T>(lhs % SanitizeDivisor(lhs, rhs));
+            }
+        };
+
+        // Shifting by a negative value or by at least the bit width is undefined in GLSL. We mask the shift amount
+        // to avoid undefined behavior on the host.
+        struct ShiftLeft
+        {
+            template <NonBoolIntegral T>
+            auto operator()(T lhs, T rhs) const -> T
+            {
+                using UnsignedType = std::make_unsigned_t<T>;
+                constexpr auto mask = static_cast<UnsignedType>(sizeof(T) * 8 - 1);
+                return static_cast<T>(static_cast<UnsignedType>(lhs) << (static_cast<UnsignedType>(rhs) & mask));
+            }
+        };
+
+        struct ShiftRight
+        {
+            template <NonBoolIntegral T>
+            auto operator()(T lhs, T rhs) const -> T
+            {
+                using UnsignedType = std::make_unsigned_t<T>;
+                constexpr auto mask = static_cast<UnsignedType>(sizeof(T) * 8 - 1);
+                return static_cast<T>(lhs >> (static_cast<UnsignedType>(rhs) & mask));
+            }
+        };
     } // namespace
 
     auto ConstValue::ElemwiseNegate() const -> ConstValue
@@ -573,11 +656,11 @@ namespace glsld
     }
     auto ConstValue::ElemwiseDiv(const ConstValue& other) const -> ConstValue
     {
-        return ApplyElemwiseBinaryOp(other, ExcludingBool<std::divides<>>{});
+        return ApplyElemwiseBinaryOp(other, Divides{});
     }
     auto ConstValue::ElemwiseMod(const ConstValue& other) const -> ConstValue
     {
-        return ApplyElemwiseBinaryOp(other, ExcludingBoolFloat<std::modulus<>>{});
+        return ApplyElemwiseBinaryOp(other, Modulus{});
     }
     auto ConstValue::ElemwiseBitAnd(const ConstValue& other) const -> ConstValue
     {
@@ -613,13 +696,36 @@ namespace glsld
     }
     auto ConstValue::ElemwiseShiftLeft(const ConstValue& other) const -> ConstValue
     {
-        // FIXME: implement this
-        return ConstValue();
+        // GLSL allows operands of shift to have different signedness. The result has the type of the lhs.
+        if (other.IsError()) {
+            return ConstValue();
+        }
+        return ApplyElemwiseBinaryOp(other.CastScalar(GetScalarKind()), ShiftLeft{});
     }
     auto ConstValue::ElemwiseShiftRight(const ConstValue& other) const -> ConstValue
     {
-        // FIXME: implement this
-        return ConstValue();
+        // GLSL allows operands of shift to have different signedness. The result has the type of the lhs.
+        if (other.IsError()) {
+            return ConstValue();
+        }
+        return ApplyElemwiseBinaryOp(other.CastScalar(GetScalarKind()), ShiftRight{});
+    }
+
+    auto ConstValue::MatrixMul(const ConstValue& other) const -> ConstValue
+    {
+        if (GetScalarKind() != other.GetScalarKind() || !(IsMatrix() || other.IsMatrix()) ||
+            !(IsVectorOrMatrix() && other.IsVectorOrMatrix())) {
+            return ConstValue();
+        }
+
+        return DispatchScalarKind(GetScalarKind(), [this, &other]<typename T>(std::type_identity<T>) {
+            if constexpr (std::is_same_v<T, bool>) {
+                return ConstValue();
+            }
+            else {
+                return ApplyMatrixMulUnsafe<T>(other);
+            }
+        });
     }
 
     auto ConstValue::ElemwiseEquals(const ConstValue& other) const -> ConstValue
@@ -7,13 +7,26 @@ namespace glsld
 {
     auto GetCompletionOptions(const CompletionConfig& config) -> std::optional<lsp::CompletionOptions>;
 
+    // An entry of the completion index. Entries are sorted by label, so that an item could be resolved by its label.
+    struct CompletionIndexEntry
+    {
+        std::string label;
+        lsp::CompletionItemKind kind;
+
+        // The declaration of the symbol, which is used to resolve the documentation lazily.
+        const AstDecl* decl = nullptr;
+    };
+
     struct CompletionState
     {
-        std::shared_ptr<PrecompiledPreamble> preamble            = nullptr;
-        std::vector<lsp::CompletionItem> preambleCompletionItems = {};
+        std::shared_ptr<PrecompiledPreamble> preamble             = nullptr;
+        std::vector<CompletionIndexEntry> preambleCompletionIndex = {};
     };
 
     auto HandleCompletion(const CompletionConfig& config, const LanguageQueryInfo& queryInfo, CompletionState& state,
                           const lsp::CompletionParams& params) -> lsp::CompletionList;
 
+    auto HandleCompletionResolve(const CompletionConfig& config, const LanguageQueryInfo& queryInfo,
+                                 CompletionState& state, const lsp::CompletionItem& item) -> lsp::CompletionItem;
+
 } // namespace glsld
\ No newline at end of file
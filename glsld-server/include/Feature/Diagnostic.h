@@ -1,12 +1,20 @@
 #pragma once
 #include "Compiler/CompilerConfig.h"
 #include "Server/Config.h"
+#include "Server/LanguageQueryInfo.h"
 #include "Server/Protocol.h"
 #include "Support/StringView.h"
 
 namespace glsld
 {
-    auto HandleDiagnostic(const DiagnosticConfig& config, StringView uri, int version,
-                          const LanguageConfig& languageConfig, StringView sourceBuffer)
-        -> lsp::PublishDiagnosticParams;
-} // namespace glsld
\ No newline at end of file
+    // Collects the diagnostics reported by the compiler while compiling the main file.
+    auto HandleDiagnostic(const DiagnosticConfig& config, const LanguageQueryInfo& info)
+        -> std::vector<lsp::Diagnostic>;
+
+    // True if glsld is built with glslang, which could be used as an extra validation pass.
+    auto IsGlslangValidationAvailable() -> bool;
+
+    // Runs glslang over the main file as an extra validation pass.
+    auto HandleGlslangDiagnostic(const DiagnosticConfig& config, const LanguageConfig& languageConfig,
+                                 StringView sourceBuffer) -> std::vector<lsp::Diagnostic>;
+} // namespace glsld
@@ -0,0 +1,13 @@
+#pragma once
+#include "Server/Config.h"
+#include "Server/LanguageQueryInfo.h"
+#include "Server/Protocol.h"
+
+namespace glsld
+{
+    auto GetDocumentHighlightOptions(const DocumentHighlightConfig& config)
+        -> std::optional<lsp::DocumentHighlightOptions>;
+
+    auto HandleDocumentHighlight(const DocumentHighlightConfig& config, const LanguageQueryInfo& info,
+                                 const lsp::DocumentHighlightParams& params) -> std::vector<lsp::DocumentHighlight>;
+} // namespace glsld
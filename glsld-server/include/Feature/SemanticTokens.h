@@ -50,6 +50,10 @@ namespace glsld
     auto CollectSemanticTokens(const SemanticTokenConfig& config, const LanguageQueryInfo& info)
         -> std::vector<SemanticTokenInfo>;
 
+    // Collects the semantic tokens that overlap the specified range only.
+    auto CollectSemanticTokens(const SemanticTokenConfig& config, const LanguageQueryInfo& info, TextRange range)
+        -> std::vector<SemanticTokenInfo>;
+
     auto GetSemanticTokensOptions(const SemanticTokenConfig& config) -> std::optional<lsp::SemanticTokensOptions>;
 
     struct SemanticTokenState
@@ -65,5 +69,7 @@ namespace glsld
     auto HandleSemanticTokensDelta(const SemanticTokenConfig& config, const LanguageQueryInfo& info,
                                    SemanticTokenState& state, const lsp::SemanticTokensDeltaParams& params)
         -> std::variant<lsp::SemanticTokens, lsp::SemanticTokensDelta>;
+    auto HandleSemanticTokensRange(const SemanticTokenConfig& config, const LanguageQueryInfo& info,
+                                   const lsp::SemanticTokensRangeParams& params) -> lsp::SemanticTokens;
 
 } // namespace glsld
\ No newline at end of file
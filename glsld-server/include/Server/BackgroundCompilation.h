@@ -2,10 +2,13 @@
 #include "Compiler/CompilerConfig.h"
 #include "Compiler/CompilerResult.h"
 #include "Server/LanguageQueryInfo.h"
+#include "Server/TextDocumentBuffer.h"
 #include "Support/AsyncLatch.h"
 
 #include <atomic>
 #include <memory>
+#include <stop_token>
+#include <vector>
 
 namespace glsld
 {
@@ -15,7 +18,7 @@ namespace glsld
         // Document version
         const int version;
         const std::string uri;
-        const std::string sourceString;
+        const TextDocumentBuffer buffer;
         const LanguageConfig languageConfig;
         const std::shared_ptr<PrecompiledPreamble> preamble = nullptr;
 
@@ -30,23 +33,52 @@ namespace glsld
         // set.
         LanguageConfig nextConfig;
 
+        // Contiguous text of the buffer, which is assembled when the compilation starts. This is available and
+        // immutable after `isAvailable` is set.
+        std::string sourceString;
+
         // Compilation result. This is available and immutable after `isAvailable` is set.
         std::unique_ptr<LanguageQueryInfo> info = nullptr;
 
+        // Committed bytes of the compilation result and the contiguous text. This is available and immutable after
+        // `isAvailable` is set.
+        size_t resultMemorySize = 0;
+
+        // Whether the preamble is reused from the previous compilation or the shared stdlib cache instead of being
+        // compiled. This is available and immutable after `isPreambleAvailable` is set.
+        bool preambleCacheHit = false;
+
         // Set when the preamble is available
         std::atomic<bool> isPreambleAvailable = false;
 
         // Set when the compilation result is available
         std::atomic<bool> isAvailable = false;
 
-        // Set if the compilation is expired by a newer version
-        std::atomic<bool> isExpired = false;
+        // Set when `Run` starts, or when this compilation is coalesced into a newer one, whichever comes first.
+        std::atomic<bool> isStarted = false;
+
+        // The newer compilation that this one is coalesced into, if any. This is set before the latch is released.
+        std::shared_ptr<BackgroundCompilation> successor = nullptr;
+
+        // Older compilations that are coalesced into this one. Their waiters are released together with ours.
+        std::vector<std::shared_ptr<BackgroundCompilation>> coalescedCompilations;
+
+        // The newer compilation that supersedes this one after it's started, if any. This is set before the stop is
+        // requested, so it's visible to anyone who observes the expiration.
+        std::shared_ptr<BackgroundCompilation> replacement = nullptr;
+
+        // Stop is requested if the compilation is expired by a newer version or the document is closed. A running
+        // compilation is abandoned as soon as possible, and so are language queries on it.
+        std::stop_source stopSource;
+
+        // Compile the source and set the result. This may be abandoned halfway if the compilation is expired.
+        auto Compile() -> void;
 
     public:
-        BackgroundCompilation(int version, std::string uri, std::string sourceString, LanguageConfig languageConfig,
+        BackgroundCompilation(int version, std::string uri, TextDocumentBuffer buffer, LanguageConfig languageConfig,
                               std::shared_ptr<PrecompiledPreamble> preamble)
-            : version(version), uri(std::move(uri)), sourceString(std::move(sourceString)),
-              languageConfig(languageConfig), preamble(std::move(preamble))
+            : version(version), uri(std::move(uri)), buffer(std::move(buffer)), languageConfig(languageConfig),
+              preamble(std::move(preamble))
         {
             GLSLD_ASSERT(this->preamble == nullptr || languageConfig == this->preamble->GetLanguageConfig());
         }
@@ -57,10 +89,29 @@ namespace glsld
         BackgroundCompilation& operator=(const BackgroundCompilation&) = delete;
         BackgroundCompilation& operator=(BackgroundCompilation&&)      = delete;
 
+        // Try to coalesce a compilation that is not yet started into the next one, which must not be started either.
+        // If succeeded, the previous compilation is expired and never runs. Its waiters are released when the next
+        // compilation is done, and should query the result of `ResolveCoalesced()` instead.
+        static auto TryCoalesce(const std::shared_ptr<BackgroundCompilation>& previous,
+                                const std::shared_ptr<BackgroundCompilation>& next) -> bool;
+
         // Synchronously run the compilation.
-        // Once it is done, set the flag and release the latch to signal availability.
+        // Once it is done, set the flag and release the latch to signal availability. If the compilation is already
+        // expired, the latch is released without the result being available.
         auto Run() -> void;
 
+        // Returns the compilation that actually runs for this version, following the chain of coalescing.
+        // NOTE this must be called after availability is signaled
+        auto ResolveCoalesced() -> BackgroundCompilation&
+        {
+            BackgroundCompilation* result = this;
+            while (result->successor) {
+                result = result->successor.get();
+            }
+
+            return *result;
+        }
+
         auto AsyncWaitAvailable()
         {
             return latchCompilation.AsyncWait();
@@ -71,6 +122,13 @@ namespace glsld
             return isPreambleAvailable.load(std::memory_order_acquire);
         }
 
+        // NOTE this must be called after the preamble is available
+        auto IsPreambleCacheHit() const -> bool
+        {
+            GLSLD_ASSERT(IsPreambleAvailable());
+            return preambleCacheHit;
+        }
+
         auto IsAvailable() const -> bool
         {
             return isAvailable.load(std::memory_order_acquire);
@@ -78,12 +136,45 @@ namespace glsld
 
         auto SetExpired() -> void
         {
-            isExpired.store(true, std::memory_order_relaxed);
+            stopSource.request_stop();
+        }
+
+        // Expire this compilation in favor of the next version, since it's already started and cannot be coalesced.
+        // Language queries that are still waiting on it should be answered by `GetReplacement()` instead.
+        auto Supersede(std::shared_ptr<BackgroundCompilation> next) -> void
+        {
+            GLSLD_ASSERT(replacement == nullptr && next != nullptr);
+            replacement = std::move(next);
+            SetExpired();
+        }
+
+        // Returns the compilation that supersedes this one, or nullptr if it's not superseded, e.g. it's expired
+        // because the document is closed.
+        // NOTE this must be called after the compilation is observed to be expired
+        auto GetReplacement() const -> const std::shared_ptr<BackgroundCompilation>&
+        {
+            GLSLD_ASSERT(IsExpired());
+            return replacement;
+        }
+
+        // Returns true if this compilation is expired by a newer version, either coalesced before running or
+        // superseded while running. Otherwise, it's abandoned because the document is closed.
+        // NOTE this must be called after the compilation is observed to be expired
+        auto IsSuperseded() const -> bool
+        {
+            GLSLD_ASSERT(IsExpired());
+            return successor != nullptr || replacement != nullptr;
         }
 
+        // NOTE the compilation result may be unavailable or incomplete if the compilation is expired
         auto IsExpired() const -> bool
         {
-            return isExpired.load(std::memory_order_relaxed);
+            return stopSource.stop_requested();
+        }
+
+        auto GetStopToken() const -> std::stop_token
+        {
+            return stopSource.get_token();
         }
 
         auto GetVersion() const -> int
@@ -96,9 +187,29 @@ namespace glsld
             return uri;
         }
 
-        auto GetBuffer() const -> StringView
+        auto GetBuffer() const -> const TextDocumentBuffer&
+        {
+            return buffer;
+        }
+
+        // NOTE this must be called after availability is signaled
+        auto GetSourceText() const -> StringView
+        {
+            GLSLD_ASSERT(IsAvailable());
+            return StringView{sourceString};
+        }
+
+        // Returns the committed bytes of the compilation result and the contiguous text, excluding the preamble and the
+        // text buffer. This is the memory released once the compilation is dropped. Zero if not available.
+        auto GetResultMemorySize() const -> size_t
+        {
+            return IsAvailable() ? resultMemorySize : 0;
+        }
+
+        // Returns the memory of the text buffer, and the contiguous text if the compilation is available.
+        auto GetSourceMemoryUsage() const -> MemoryUsage
         {
-            return sourceString;
+            return IsAvailable() ? buffer.GetMemoryUsage() + MemoryUsage::Of(sourceString) : buffer.GetMemoryUsage();
         }
 
         auto GetLanguageConfig() const -> const LanguageConfig&
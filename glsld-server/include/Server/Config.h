@@ -23,6 +23,20 @@ namespace glsld
     {
         // Master toggle for reference.
         bool enable = false;
+
+        // The time budget of a request in milliseconds, after which the request is cancelled since the references found
+        // so far would look complete. Zero means no limit.
+        size_t timeBudgetMs = 0;
+    };
+
+    struct DocumentHighlightConfig
+    {
+        // Master toggle for document highlight.
+        bool enable = false;
+
+        // The time budget of a request in milliseconds, after which the request is cancelled since the highlights found
+        // so far would look complete. Zero means no limit.
+        size_t timeBudgetMs = 0;
     };
 
     struct HoverConfig
@@ -35,18 +49,33 @@ namespace glsld
     {
         // Master toggle for folding range.
         bool enable = false;
+
+        // The time budget of a request in milliseconds, after which the request is cancelled since partial ranges would
+        // leave the rest of the document unfoldable. Zero means no limit.
+        size_t timeBudgetMs = 0;
     };
 
     struct DocumentSymbolConfig
     {
         // Master toggle for document symbol.
         bool enable = false;
+
+        // The time budget of a request in milliseconds, after which the request is cancelled since a partial outline
+        // would miss symbols. Zero means no limit.
+        size_t timeBudgetMs = 0;
     };
 
     struct SemanticTokenConfig
     {
         // Master toggle for semantic token.
         bool enable = false;
+
+        // Only collect tokens from the lexer and the preprocessor, which doesn't traverse the AST.
+        bool lexicalOnly = false;
+
+        // The time budget of a request in milliseconds, after which the request is cancelled since partial tokens
+        // would leave the rest of the document unhighlighted. Zero means no limit.
+        size_t timeBudgetMs = 0;
     };
 
     struct InlayHintConfig
@@ -66,18 +95,33 @@ namespace glsld
 
         // The threshold of lines to show the block end hint.
         size_t blockEndHintLineThreshold = 0;
+
+        // The time budget of a request in milliseconds, after which the request is cancelled since the client would
+        // drop the hints shown for the rest of the document. Zero means no limit.
+        size_t timeBudgetMs = 0;
     };
 
     struct CompletionConfig
     {
         // Master toggle for completion.
         bool enable = false;
+
+        // The maximum number of items returned by a completion request. The list is marked incomplete if truncated.
+        // Zero means no limit.
+        size_t maxItemCount = 0;
+
+        // The time budget of a request in milliseconds, after which the items found so far are responded as an
+        // incomplete list. Zero means no limit.
+        size_t timeBudgetMs = 0;
     };
 
     struct DiagnosticConfig
     {
         // Master toggle for diagnostic.
         bool enable = false;
+
+        // Run glslang over the document as an extra validation pass. Only available if glsld is built with glslang.
+        bool enableGlslangValidation = false;
     };
 
     struct SignatureHelpConfig
@@ -86,11 +130,40 @@ namespace glsld
         bool enable = false;
     };
 
+    // Documents exceeding any of the thresholds are handled in degraded mode, where semantic tokens are lexical only,
+    // inlay hints are disabled, glslang validation only runs when the document is saved and the coalescing window is
+    // longer.
+    struct LargeDocumentConfig
+    {
+        // The threshold of the document size in bytes. Zero means no limit.
+        size_t maxSize = 0;
+
+        // The threshold of the number of lines. Zero means no limit.
+        size_t maxLineCount = 0;
+
+        // The threshold of the recent compile time in milliseconds. Zero means no limit.
+        size_t maxCompileTimeMs = 0;
+
+        // The coalescing window in milliseconds of documents in degraded mode.
+        size_t coalescingWindowMs = 0;
+    };
+
+    // Once compiled documents hold more memory than the budget, the least recently used ones are evicted. An evicted
+    // document only keeps its text, and is compiled again the next time it's queried. The budget is shared by all
+    // language services in the process, e.g. the connections of a socket server.
+    struct MemoryBudgetConfig
+    {
+        // The budget in megabytes of the memory held by compiled documents, the preambles they use and the stdlib
+        // cores cached by the process. Zero means no limit.
+        size_t maxMemoryMb = 0;
+    };
+
     struct LanguageServiceConfig
     {
         // DeclarationConfig declaration;
         DefinitionConfig definition;
         ReferenceConfig reference;
+        DocumentHighlightConfig documentHighlight;
         HoverConfig hover;
         FoldingRangeConfig foldingRange;
         DocumentSymbolConfig documentSymbol;
@@ -99,6 +172,8 @@ namespace glsld
         CompletionConfig completion;
         DiagnosticConfig diagnostic;
         SignatureHelpConfig signatureHelp;
+        LargeDocumentConfig largeDocument;
+        MemoryBudgetConfig memoryBudget;
     };
 
     enum class LoggingLevel
@@ -8,6 +8,12 @@
 #include "Compiler/SyntaxToken.h"
 #include "Server/PreprocessSymbolStore.h"
 
+#include <atomic>
+#include <mutex>
+#include <stop_token>
+#include <unordered_map>
+#include <vector>
+
 namespace glsld
 {
     enum class SymbolDeclType
@@ -80,6 +86,30 @@ namespace glsld
         bool isDeclaration = false;
     };
 
+    struct DeclOccurrence
+    {
+        // The identifier token that refers to the declaration.
+        SyntaxTokenID tokenID;
+
+        // True if the token is from the declaration itself. e.g. `a` in `int a;`
+        bool isDeclaration = false;
+
+        // True if the declared entity is written here, i.e. a declaration with an initializer, or the target of an
+        // assignment or an increment. e.g. `a` in `int a = 1;` and `a = 2;`
+        bool isWrite = false;
+    };
+
+    // An AST node in the main file, as recorded in the position index of `LanguageQueryInfo`.
+    struct IndexedAstNode
+    {
+        static constexpr uint32_t NoParent = static_cast<uint32_t>(-1);
+
+        const AstNode* node;
+
+        // The index of the parent in the position index, or `NoParent` for the translation unit.
+        uint32_t parentIndex;
+    };
+
     class LanguageQueryInfo
     {
     private:
@@ -91,10 +121,46 @@ namespace glsld
         // The preprocessor info collected during the compilation.
         std::unique_ptr<PreprocessInfoStore> ppInfoStore = nullptr;
 
+        // Stop is requested once the compilation is stale, e.g. superseded by a newer version of the document.
+        std::stop_token stopToken;
+
+        // The AST nodes in the main file in pre-order, each with the index of its parent.
+        mutable std::vector<IndexedAstNode> nodeIndex;
+
+        // The innermost AST node of each token in the main file as an index into `nodeIndex`, or `NoParent` if none.
+        mutable std::vector<uint32_t> tokenNodeIndex;
+
+        // The position index is built on the first position query, so that position-based queries don't need to
+        // traverse the AST from the root, while compilations that are never queried don't pay for it.
+        mutable std::once_flag positionIndexFlag;
+        mutable std::atomic<bool> hasPositionIndex = false;
+
+        auto BuildPositionIndex() const -> void;
+
+        // The occurrences of each declaration in the main file, in the order of appearance. This is built on the first
+        // reference query, since most compilations are never queried for references.
+        mutable std::unordered_map<const AstDecl*, std::vector<DeclOccurrence>> declOccurrenceIndex;
+        mutable std::mutex declOccurrenceIndexMutex;
+
+        // Set once the occurrence index is completely built, so that it could be inspected without building it.
+        mutable std::atomic<bool> hasDeclOccurrenceIndex = false;
+
+        // Build the occurrence index if it's not built yet. The build is halted if the compilation is stale or the
+        // query runs out of its time budget, in which case the partial index is discarded so that a later query builds
+        // it again. Returns true if the index is built.
+        auto EnsureDeclOccurrenceIndex() const -> bool;
+
     public:
-        LanguageQueryInfo(std::unique_ptr<CompilerResult> result, std::unique_ptr<PreprocessInfoStore> ppInfoStore)
-            : compilerResult(std::move(result)), ppInfoStore(std::move(ppInfoStore))
+        LanguageQueryInfo(std::unique_ptr<CompilerResult> result, std::unique_ptr<PreprocessInfoStore> ppInfoStore,
+                          std::stop_token stopToken = {})
+            : compilerResult(std::move(result)), ppInfoStore(std::move(ppInfoStore)), stopToken(std::move(stopToken))
+        {
+        }
+
+        // Returns true if the compilation is stale and any query on it should be abandoned.
+        auto IsCancellationRequested() const -> bool
         {
+            return stopToken.stop_requested();
         }
 
         auto GetCompilerResult() const -> const CompilerResult&
@@ -112,6 +178,9 @@ namespace glsld
             return *ppInfoStore;
         }
 
+        // Returns the memory of the indexes built for queries. Only indexes that are already built are counted.
+        auto GetIndexMemoryUsage() const -> MemoryUsage;
+
         auto LookupArtifact(TranslationUnitID id) const -> const CompilerArtifact*
         {
             switch (id) {
@@ -140,6 +209,21 @@ namespace glsld
         // Returns the token entries that is expanded to the specified line.
         auto LookupTokenByLine(uint32_t lineNum) const -> ArrayView<RawSyntaxToken>;
 
+        // Returns the token in the main file whose expanded range, including the trailing whitespace, contains the
+        // specified position.
+        auto LookupTokenIDByPosition(TextPosition position) const -> std::optional<SyntaxTokenID>;
+
+        // Returns the innermost AST node in the main file whose syntax range contains the specified token.
+        auto LookupInnermostNode(SyntaxTokenID id) const -> const IndexedAstNode*;
+
+        // Returns the parent of an AST node returned by `LookupInnermostNode`. Returns nullptr for the translation
+        // unit.
+        auto LookupParentNode(const IndexedAstNode& node) const -> const IndexedAstNode*;
+
+        // Returns the occurrences of a declaration in the main file, including the declaration itself. Nothing is
+        // returned if the query runs out of its time budget before the occurrence index is built.
+        auto LookupDeclOccurrences(const AstDecl& decl) const -> ArrayView<DeclOccurrence>;
+
         auto LookupPreceedingComment(SyntaxTokenID id) const -> ArrayView<RawCommentToken>;
 
         auto LookupSpelledFile(SyntaxTokenID id) const -> FileID;
@@ -2,6 +2,7 @@
 #include "Ast/AstVisitor.h"
 
 #include "Server/LanguageQueryInfo.h"
+#include "Server/QueryDeadline.h"
 
 namespace glsld
 {
@@ -21,10 +22,17 @@ namespace glsld
             return info;
         }
 
+        // Traversal is halted once the compilation is stale, since the query result would be discarded anyway. It's
+        // also halted once the query runs out of its time budget, in which case the result is partial.
+        auto IsTraversalCancelled() const -> bool
+        {
+            return info.IsCancellationRequested() || QueryDeadline::PollCurrent();
+        }
+
     protected:
+        // NOTE queries that only care about the nodes containing a position should use `TraverseAstAtPosition`.
         auto TraverseNodeContains(const AstNode& node, TextPosition position) const -> AstVisitPolicy
         {
-            // TODO: pre-convert position to a token index for performance
             if (info.ContainsPositionExtended(node, position)) {
                 return AstVisitPolicy::Traverse;
             }
@@ -61,4 +69,37 @@ namespace glsld
             }
         }
     };
-} // namespace glsld
\ No newline at end of file
+
+    // Visit the AST nodes in the main file that contain the specified position, from the innermost one up to the
+    // translation unit. Different from traversing from the root, this is a binary search plus a parent walk on the
+    // position index of `LanguageQueryInfo`. The visitor should return `AstVisitPolicy::Visit` on entering a node since
+    // children are not meant to be traversed, or `AstVisitPolicy::Halt` to stop the walk.
+    template <AstVisitorT VisitorType>
+    inline auto TraverseAstAtPosition(VisitorType&& visitor, const LanguageQueryInfo& info, TextPosition position)
+    {
+        // Returns false if the walk is halted. Stops before visiting an ancestor that contains `stopTokenID`.
+        auto walkAncestors = [&](SyntaxTokenID tokenID, std::optional<SyntaxTokenID> stopTokenID) -> bool {
+            for (auto entry = info.LookupInnermostNode(tokenID); entry; entry = info.LookupParentNode(*entry)) {
+                if (stopTokenID && entry->node->GetSyntaxRange().Contains(*stopTokenID)) {
+                    break;
+                }
+                if (!visitor.Traverse(*entry->node)) {
+                    return false;
+                }
+            }
+            return true;
+        };
+
+        if (auto tokenID = info.LookupTokenIDByPosition(position); tokenID) {
+            // A position at the start of a token is also at the end of the extended range of the previous token
+            if (walkAncestors(*tokenID, std::nullopt) && tokenID->GetTokenIndex() > 0 &&
+                info.LookupExpandedTextRange(*tokenID).start == position) {
+                walkAncestors(*tokenID - 1, *tokenID);
+            }
+        }
+
+        if constexpr (requires { visitor.Finish(); }) {
+            return visitor.Finish();
+        }
+    }
+} // namespace glsld
@@ -4,7 +4,11 @@
 #include "Support/JsonSerializer.h"
 #include "Support/StringMap.h"
 #include "Support/StringView.h"
+#include "Support/Tracing.h"
 #include "Server/Config.h"
+#include "Server/MessageWriter.h"
+#include "Server/Protocol.h"
+#include "Server/ServerStatistics.h"
 #include "Server/TextTransport.h"
 
 #include <nlohmann/json.hpp>
@@ -13,11 +17,18 @@
 #include <cstdio>
 #include <memory>
 #include <functional>
+#include <mutex>
+#include <optional>
 #include <stop_token>
+#include <unordered_map>
 
 namespace glsld
 {
     class LanguageService;
+    struct LanguageServiceExecutor;
+
+    // Creates the worker threads and the timer thread of language services, which could be shared by multiple servers.
+    auto CreateLanguageServiceExecutor() -> std::shared_ptr<LanguageServiceExecutor>;
 
     // handles jsonrpc
     class LanguageServer
@@ -32,22 +43,67 @@ namespace glsld
         // while replay file is loaded.
         UniqueFile replayDumpFile;
 
+        // The envelope of a JSON-RPC message from the client. `params` is the raw JSON text in the message payload,
+        // which is deserialized by the handler straight into the parameter struct.
+        struct ClientMessage
+        {
+            std::string method;
+            std::optional<int> requestId;
+            StringView params = "null";
+
+            // When the message is received.
+            TraceRecorder::Clock::time_point receiveTime;
+        };
+
         using ClientMessageHandlerType =
-            std::function<auto(LanguageServer& server, const nlohmann::json& rpcBlob)->void>;
+            std::function<auto(LanguageServer& server, const ClientMessage& message)->void>;
         UnorderedStringMap<ClientMessageHandlerType> handlerDispatchMap;
 
-        std::unique_ptr<LanguageService> language;
+        // Declared before the language service, so it outlives the workers that record into it.
+        ServerStatistics statistics;
+
         std::unique_ptr<TextTransport> transport;
 
+        // While server is always listening in the main thread, outgoing messages may be sent from different threads.
+        // They are queued and written by the message writer in its own thread.
+        std::unique_ptr<MessageWriter> messageWriter;
+
+        // Declared after the transport and the message writer, so it's destroyed before them while its workers may
+        // still be sending messages.
+        std::unique_ptr<LanguageService> language;
+
         // This controls the server listening loop.
         std::stop_source serverStopSource;
 
-        // While server is always listening in the main thread, outgoing messages may be sent from different threads.
-        // This mutex protects the output to be thread-safe.
-        std::mutex serverOutputMutex;
+        struct PendingRequest
+        {
+            // Stop is requested when the request is cancelled, either by the client or because its result is stale.
+            std::stop_source stopSource;
+
+            // The error code to respond with if the request is cancelled.
+            lsp::ErrorCodes cancelReason = lsp::ErrorCodes::RequestCancelled;
+
+            // The statistics of the request method, into which the latencies of the request are recorded.
+            RequestStatistics* statistics = nullptr;
+
+            // When the request is received.
+            TraceRecorder::Clock::time_point receiveTime;
+
+            // The interned method of the request, which is only kept if tracing is enabled. The request is traced as a
+            // span from receipt to response.
+            const char* method = "";
+        };
+
+        // Requests that are received but not yet responded to, keyed by the request ID.
+        // Requests are responded from different worker threads. This mutex protects the map to be thread-safe.
+        std::mutex pendingRequestMutex;
+        std::unordered_map<int, PendingRequest> pendingRequests;
 
     public:
-        LanguageServer(const LanguageServerConfig& config);
+        // Creates a server that talks to a client through the given transport, or stdio if it's null. Background work
+        // runs on the given executor, or on an executor owned by this server if it's null.
+        LanguageServer(const LanguageServerConfig& config, std::unique_ptr<TextTransport> transport = nullptr,
+                       std::shared_ptr<LanguageServiceExecutor> executor = nullptr);
         ~LanguageServer();
 
         auto InitializeReplayDumpFile(UniqueFile dumpFile) -> void;
@@ -56,11 +112,36 @@ namespace glsld
 
         auto Replay(std::string replayCommands) -> void;
 
+        // Block until the background work on open documents is finished. This should be called in the listening
+        // thread.
+        auto WaitForPendingTasks() -> void;
+
+        // Collect the memory held by open documents and preambles. This should be called in the listening thread.
+        auto CollectMemoryUsage() -> lsp::MemoryUsageResult;
+
+        auto GetStatistics() -> ServerStatistics&
+        {
+            return statistics;
+        }
+
+        // Returns the statistics of the method of a pending request, or nullptr if the request is already responded.
+        // This function is thread-safe.
+        auto GetRequestStatistics(int requestId) -> RequestStatistics*;
+
         auto Shutdown() -> void
         {
             serverStopSource.request_stop();
         }
 
+        auto IsShutdownRequested() const -> bool
+        {
+            return serverStopSource.stop_requested();
+        }
+
+        // Handle a client message that is already received. This is used when messages are read by an external event
+        // loop instead of Run(). This should be called in a single thread.
+        auto HandleClientMessage(StringView messagePayload) -> void;
+
         auto GetConfig() const -> const LanguageServerConfig&
         {
             return config;
@@ -71,15 +152,47 @@ namespace glsld
         template <typename T>
         auto SendServerResponse(int requestId, const T& result, bool isError) -> void
         {
-            SendTypeErasedServerResponse(requestId, JsonSerializer<T>::Serialize(result), isError);
+            if (auto cancelReason = FinishRequest(requestId); cancelReason && !isError) {
+                SendRequestCancelledError(requestId, *cancelReason);
+                return;
+            }
+
+            auto& writer = BeginServerMessage();
+            writer.WriteKey("id");
+            writer.WriteInteger(requestId);
+            writer.WriteKey(isError ? "error" : "result");
+            JsonSerializer<T>::Serialize(result, writer);
+            FinishServerMessage(writer);
         }
 
+        // Returns a token that is requested to stop once the request is cancelled.
+        // This function is thread-safe.
+        auto GetRequestStopToken(int requestId) -> std::stop_token;
+
+        // Cancel a pending request, so its response is replaced by an error with the given code. Nothing happens if the
+        // request is already cancelled or responded to.
+        // This function is thread-safe.
+        auto CancelRequest(int requestId, lsp::ErrorCodes reason = lsp::ErrorCodes::RequestCancelled) -> void;
+
+        // Respond to a request that is cancelled with the error of its cancellation reason.
+        // This function is thread-safe.
+        auto SendCancelledResponse(int requestId) -> void;
+
+        // Respond to a request that cannot be served with an error.
+        // This function is thread-safe.
+        auto SendErrorResponse(int requestId, lsp::ErrorCodes code, std::string message) -> void;
+
         // Dispatch a notification from the language server to the client.
         // This function is thread-safe.
         template <typename T>
         auto SendServerNotification(const char* method, const T& params) -> void
         {
-            SendTypeErasedServerNotification(method, JsonSerializer<T>::Serialize(params));
+            auto& writer = BeginServerMessage();
+            writer.WriteKey("method");
+            writer.WriteString(method);
+            writer.WriteKey("params");
+            JsonSerializer<T>::Serialize(params, writer);
+            FinishServerMessage(writer);
         }
 
         auto ShouldLog(LoggingLevel requiredLevel) const -> bool
@@ -145,14 +258,25 @@ namespace glsld
         // Returns true if a message is successfully pulled.
         auto PullMessage() -> bool;
 
-        // Synchronously push a server message to the output transport.
-        // Because this may be called from different worker threads, this function locks the output mutex.
-        // Returns true if a message is successfully pushed.
-        auto PushMessage(StringView payload) -> bool;
+        // Queue a server message to be written to the output transport. This never blocks on I/O.
+        // This function is thread-safe.
+        auto PushMessage(std::string&& payload) -> void;
 
-        auto HandleClientMessage(StringView messagePayload) -> void;
-        auto SendTypeErasedServerResponse(int requestId, nlohmann::json result, bool isError) -> void;
-        auto SendTypeErasedServerNotification(const char* method, nlohmann::json params) -> void;
+        // Register a request that is received, which is pending until it is responded to.
+        auto BeginRequest(const ClientMessage& message) -> void;
+
+        // Unregister a request that is being responded to. Returns the cancellation reason if it is cancelled.
+        auto FinishRequest(int requestId) -> std::optional<lsp::ErrorCodes>;
+
+        // The client should never see the result of a cancelled request. This responds with the error instead.
+        auto SendRequestCancelledError(int requestId, lsp::ErrorCodes cancelReason) -> void;
+
+        // Returns the JSON writer of the current thread with the envelope of a server message opened. Messages are
+        // serialized straight into the reused buffer of the writer without building a DOM.
+        auto BeginServerMessage() -> JsonWriter&;
+
+        // Closes the envelope of the server message and pushes it to the client.
+        auto FinishServerMessage(JsonWriter& writer) -> void;
 
         auto InitializeClientMessageHandlers() -> void;
     };
@@ -4,18 +4,36 @@
 #include "Server/Protocol.h"
 #include "Server/LanguageServer.h"
 #include "Server/LanguageQueryInfo.h"
+#include "Server/QueryDeadline.h"
 #include "Support/AsyncMutex.h"
+#include "Support/SimpleTimer.h"
 #include "Support/StringView.h"
+#include "Support/Tracing.h"
 
 #include <exec/async_scope.hpp>
 #include <exec/static_thread_pool.hpp>
 #include <exec/timed_thread_scheduler.hpp>
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <memory>
+#include <mutex>
 #include <cstddef>
+#include <cstdint>
+#include <stop_token>
+#include <utility>
 
 namespace glsld
 {
+    // The threads that run the background work of language services. A socket server shares one executor among the
+    // services of all its connections, so that the number of threads doesn't grow with the number of clients.
+    struct LanguageServiceExecutor
+    {
+        exec::timed_thread_context timedSchedulerCtx{};
+        exec::static_thread_pool backgroundWorkerCtx{};
+    };
+
     class LanguageService
     {
     private:
@@ -23,8 +41,11 @@ namespace glsld
 
         bool enableGlsldExtensions = false;
 
-        exec::timed_thread_context timedSchedulerCtx{};
-        exec::static_thread_pool backgroundWorkerCtx{};
+        // Whether LSP columns count UTF-16 code units instead of UTF-8 bytes, as negotiated in `initialize`.
+        bool countUtf16Characters = true;
+
+        // The executor may be shared with other services, so it keeps running after this service is destroyed.
+        std::shared_ptr<LanguageServiceExecutor> executor;
 
         struct FeatureStateObject
         {
@@ -46,9 +67,24 @@ namespace glsld
             // The latest background compilation for this document.
             std::shared_ptr<BackgroundCompilation> backgroundCompilation = nullptr;
 
+            // Moving average of the recent compile time of this document. This is updated by background workers.
+            std::atomic<SimpleTimer::Duration> averageCompileTime = SimpleTimer::Duration::zero();
+
+            // Whether the document is too large to be handled normally. This is updated by both the main thread and
+            // background workers.
+            std::atomic<bool> degraded = false;
+
             // This map holds the state objects for different language features.
             std::map<void*, FeatureStateObject> stateLookup = {};
 
+            // When the document is last used, in ticks of the process-wide memory accountant, so that documents of
+            // different services are comparable. This is guarded by `LanguageService::documentMutex`.
+            uint64_t lastAccessTick = 0;
+
+            // Whether the compilation result is dropped to stay within the memory budget. The current compilation is
+            // then not yet scheduled. This is guarded by `LanguageService::documentMutex`.
+            bool evicted = false;
+
             template <typename T>
             static auto GetTypeId() noexcept -> void*
             {
@@ -58,12 +94,18 @@ namespace glsld
 
             auto InferShaderStageFromUri(StringView uri) -> GlslShaderStage;
 
-            auto InitializeTextDocument(const lsp::DidOpenTextDocumentParams& params) -> void;
+            auto InitializeTextDocument(const lsp::DidOpenTextDocumentParams& params, bool countUtf16Characters)
+                -> void;
+
+            // Create a compilation of the given version of the document, which inherits the language config and the
+            // preamble from the current compilation.
+            auto CreateNextCompilation(int version, TextDocumentBuffer buffer) const
+                -> std::shared_ptr<BackgroundCompilation>;
 
         public:
-            TextDocumentContext(const lsp::DidOpenTextDocumentParams& params)
+            TextDocumentContext(const lsp::DidOpenTextDocumentParams& params, bool countUtf16Characters)
             {
-                InitializeTextDocument(params);
+                InitializeTextDocument(params, countUtf16Characters);
             }
 
             auto GetAsyncScope() -> exec::async_scope&
@@ -78,6 +120,67 @@ namespace glsld
 
             auto UpdateTextDocument(const lsp::DidChangeTextDocumentParams& params) -> void;
 
+            // Drop the result of the current compilation, keeping only the text and the version. Queries that are
+            // already running keep the result alive until they finish. The document must be compiled again before it's
+            // queried.
+            auto Evict() -> void;
+
+            auto IsEvicted() const -> bool
+            {
+                return evicted;
+            }
+
+            // Returns true if the document was evicted, in which case the caller must schedule the compilation.
+            auto ResetEvicted() -> bool
+            {
+                return std::exchange(evicted, false);
+            }
+
+            auto GetLastAccessTick() const -> uint64_t
+            {
+                return lastAccessTick;
+            }
+
+            auto SetLastAccessTick(uint64_t tick) -> void
+            {
+                lastAccessTick = tick;
+            }
+
+            // Changes arriving within this window are coalesced into a single compilation. The window adapts to the
+            // recent compile time, so that we don't compile faster than the results could be consumed.
+            auto GetCoalescingWindow() const -> std::chrono::milliseconds
+            {
+                // Cap the window so that results of a very slow compilation are not delayed too much.
+                constexpr auto maxCoalescingWindow = std::chrono::milliseconds{200};
+                auto average                       = averageCompileTime.load(std::memory_order_relaxed);
+                return std::min(std::chrono::duration_cast<std::chrono::milliseconds>(average), maxCoalescingWindow);
+            }
+
+            auto RecordCompileTime(SimpleTimer::Duration compileTime) -> void
+            {
+                // Exponential moving average, weighing the latest sample by 1/4. Racing updates only lose a sample.
+                auto average = averageCompileTime.load(std::memory_order_relaxed);
+                averageCompileTime.store(average == SimpleTimer::Duration::zero() ? compileTime
+                                                                                    : (average * 3 + compileTime) / 4,
+                                         std::memory_order_relaxed);
+            }
+
+            auto GetAverageCompileTime() const -> SimpleTimer::Duration
+            {
+                return averageCompileTime.load(std::memory_order_relaxed);
+            }
+
+            auto IsDegraded() const -> bool
+            {
+                return degraded.load(std::memory_order_relaxed);
+            }
+
+            // Returns true if the mode is changed by this call.
+            auto SetDegraded(bool value) -> bool
+            {
+                return degraded.exchange(value, std::memory_order_relaxed) != value;
+            }
+
             template <typename StateType>
             auto GetLanguageFeatureState() -> FeatureStateObject&
             {
@@ -89,42 +192,104 @@ namespace glsld
 
                 return stateObject;
             }
+
+            // Returns the state object of a language feature if it's ever been used, without creating it.
+            template <typename StateType>
+            auto FindLanguageFeatureState() -> FeatureStateObject*
+            {
+                auto it = stateLookup.find(GetTypeId<std::remove_cvref_t<StateType>>());
+                return it != stateLookup.end() ? &it->second : nullptr;
+            }
         };
 
+        // Guards the open documents and their current compilations. The main thread holds it while handling a client
+        // message, and background workers hold it to enforce the memory budget once a compilation is published.
+        std::mutex documentMutex;
+
         // uri -> document context
         StringMap<std::unique_ptr<TextDocumentContext>> documentContexts;
 
-        // Schedule a background compilation for the given TextDocumentContext instance.
-        auto ScheduleBackgroundCompilation(TextDocumentContext& ctx) -> void;
+        // Closed documents are kept alive in this scope until the tasks in their own scope are finished.
+        exec::async_scope closingScope;
+
+        // Mark the document as the most recently used one. If compiled documents then exceed the memory budget, the
+        // least recently used ones are evicted.
+        auto TouchDocument(TextDocumentContext& ctx) -> void;
+
+        // Evict the least recently used documents until the memory held by the process fits in the budget. The budget
+        // is shared by all services in the process, e.g. the connections of a socket server, so documents of other
+        // services may be evicted as well. It covers the compiled documents, the preambles they use and the stdlib
+        // cache. The most recently used document is never evicted. The caller must hold `documentMutex`.
+        auto EnforceMemoryBudget() -> void;
+
+        // If the document is evicted, schedule its compilation right away so that it could be queried again.
+        auto RestoreEvictedDocument(TextDocumentContext& ctx) -> void;
+
+        // Re-evaluate whether the document should be handled in degraded mode with the given compilation, which is the
+        // latest one or has just finished. The client is notified if the mode changes.
+        auto UpdateDegradedMode(TextDocumentContext& ctx, const BackgroundCompilation& compilation) -> void;
+
+        // Returns true if the document is open and handled in degraded mode.
+        auto IsDegradedDocument(StringView uri) -> bool;
 
-        // Schedule a background diagnostic for the given TextDocumentContext instance.
+        // Returns the semantic token config for the document, which is lexical only in degraded mode.
+        auto GetSemanticTokenConfig(StringView uri) -> SemanticTokenConfig;
+
+        // Schedule a background compilation for the given TextDocumentContext instance. The compilation starts after
+        // the coalescing window of the document, so it could be coalesced into a newer version before that. If it's
+        // restoring an evicted document, it starts right away and the diagnostics are not published again.
+        auto ScheduleBackgroundCompilation(TextDocumentContext& ctx, bool restoring = false) -> void;
+
+        // Schedule a background glslang validation for the given TextDocumentContext instance, if enabled. Diagnostics
+        // reported by glsld itself are published as soon as the background compilation finishes.
         auto ScheduleBackgroundDiagnostic(TextDocumentContext& ctx) -> void;
 
         // Schedule a background destruction for the given TextDocumentContext instance.
         auto ScheduleBackgroundClosingDocument(std::unique_ptr<TextDocumentContext> ctx) -> void;
 
         // Schedule a language query for the given uri in a background thread, which waits for the compilation and then
-        // runs the callback.
+        // runs the callback. The callback is skipped if the request is cancelled or the document is closed by then, in
+        // which case an error is responded instead. If a newer version of the document arrives while the query is
+        // waiting, it's answered by the newer version.
+        //
+        // The callback runs under a `QueryDeadline` of the given time budget in milliseconds, which starts when the
+        // callback starts. Zero means no limit.
         template <typename StateType>
-        auto ScheduleLanguageQuery(StringView uri,
+        auto ScheduleLanguageQuery(int requestId, StringView uri, size_t timeBudgetMs,
                                    std::move_only_function<auto(const LanguageQueryInfo&, StateType&)->void> callback)
             -> void
         {
-            auto& ctx = documentContexts[uri];
-            if (!ctx) {
-                // Bad request. Document is not open.
+            auto itCtx = documentContexts.Find(uri);
+            if (itCtx == documentContexts.end() || !itCtx->second) {
+                // Bad request. Document is not open, but the request still needs a response to be finished.
                 server.LogInfo("Received language query for a document that is not open: {}", uri);
+                server.SendErrorResponse(requestId, lsp::ErrorCodes::InvalidParams, "Document is not open");
                 return;
             }
 
-            // NOTE we need to make a copy of the provider here so it doesn't get released while in analysis
+            auto& ctx = itCtx->second;
             GLSLD_ASSERT(ctx->GetBackgroundCompilation() &&
                          "Background compilation must be present in the document context");
+            TouchDocument(*ctx);
+            RestoreEvictedDocument(*ctx);
+
+            SpawnLanguageQuery<StateType>(*ctx, ctx->GetLanguageFeatureState<StateType>(),
+                                          ctx->GetBackgroundCompilation(), requestId, timeBudgetMs,
+                                          std::move(callback));
+        }
 
-            FeatureStateObject& stateObject = ctx->GetLanguageFeatureState<StateType>();
-            ctx->GetAsyncScope().spawn(
+        // Spawn a language query on the given compilation in the async scope of the document. This may be called from a
+        // background thread to move a query onto the compilation that supersedes the one it was waiting on.
+        template <typename StateType>
+        auto SpawnLanguageQuery(TextDocumentContext& ctx, FeatureStateObject& stateObject,
+                                std::shared_ptr<BackgroundCompilation> backgroundCompilation, int requestId,
+                                size_t timeBudgetMs,
+                                std::move_only_function<auto(const LanguageQueryInfo&, StateType&)->void> callback)
+            -> void
+        {
+            ctx.GetAsyncScope().spawn(
                 // Wait for the background compilation to finish
-                ctx->GetBackgroundCompilation()->AsyncWaitAvailable()
+                backgroundCompilation->AsyncWaitAvailable()
                 // Acquire the state lock if necessary
                 | stdexec::let_value([&stateObject] {
                       if constexpr (std::is_const_v<StateType> || std::is_same_v<StateType, std::monostate>) {
@@ -135,23 +300,107 @@ namespace glsld
                           return stateObject.mutex.AsyncLetLock();
                       }
                   })
+                // Mark when the query is ready to run, so the time spent queueing for a worker could be measured
+                | stdexec::let_value([](std::unique_lock<AsyncMutex>& lock) {
+                      return stdexec::just(std::move(lock), TraceRecorder::Clock::now());
+                  })
                 // Continue on the background worker thread
-                | stdexec::continues_on(backgroundWorkerCtx.get_scheduler())
+                | stdexec::continues_on(executor->backgroundWorkerCtx.get_scheduler())
                 // Finally handle the query
-                | stdexec::then([backgroundCompilation = ctx->GetBackgroundCompilation(), &stateObject,
-                                 callback = std::move(callback)](std::unique_lock<AsyncMutex> /*lock*/) mutable {
-                      callback(backgroundCompilation->GetLanguageQueryInfo(),
-                               std::any_cast<StateType&>(stateObject.state));
-                  }));
+                // NOTE we need to make a copy of the provider here so it doesn't get released while in analysis
+                | stdexec::then([this, &server = server, &ctx, &stateObject, requestId, backgroundCompilation,
+                                 timeBudgetMs,
+                                 callback = std::move(callback)](std::unique_lock<AsyncMutex> /*lock*/,
+                                                                 TraceRecorder::Clock::time_point readyTime) mutable {
+                      auto startTime  = TraceRecorder::Clock::now();
+                      auto statistics = server.GetRequestStatistics(requestId);
+                      if (statistics) {
+                          statistics->queueWait.Record(startTime - readyTime);
+                      }
+                      TraceRecorder::Get().Record("queue", "queueWait", readyTime, startTime);
+
+                      // If the compilation was coalesced into a newer version, the query is answered by that one.
+                      auto& compilation = backgroundCompilation->ResolveCoalesced();
+
+                      // If a newer version arrived after the compilation had started, the query waits for the newer
+                      // one instead of failing. The state lock is released once we return.
+                      if (compilation.IsExpired() && compilation.GetReplacement() &&
+                          !server.GetRequestStopToken(requestId).stop_requested()) {
+                          server.LogInfo("Request {} is moved to version {}", requestId,
+                                         compilation.GetReplacement()->GetVersion());
+                          SpawnLanguageQuery<StateType>(ctx, stateObject, compilation.GetReplacement(), requestId,
+                                                        timeBudgetMs, std::move(callback));
+                          return;
+                      }
+
+                      // The result is stale once a newer version of the document arrives while the query is running.
+                      auto onExpired = [&server, requestId] {
+                          server.CancelRequest(requestId, lsp::ErrorCodes::ContentModified);
+                      };
+                      std::stop_callback expirationCallback{compilation.GetStopToken(), onExpired};
+                      if (compilation.IsExpired() || server.GetRequestStopToken(requestId).stop_requested()) {
+                          server.LogInfo("Request {} is cancelled before processing", requestId);
+                          server.SendCancelledResponse(requestId);
+                          return;
+                      }
+
+                      TraceSpan span{"server", "languageQuery", compilation.GetUri()};
+                      QueryDeadline deadline{std::chrono::milliseconds{timeBudgetMs}};
+                      callback(compilation.GetLanguageQueryInfo(), std::any_cast<StateType&>(stateObject.state));
+                      if (statistics) {
+                          statistics->execution.Record(TraceRecorder::Clock::now() - startTime);
+                      }
+                      if (deadline.IsExpired()) {
+                          server.LogInfo("Request {} ran out of its time budget of {} ms", requestId, timeBudgetMs);
+                      }
+                  })
+                // The async scope is stopped if the document is closed
+                | stdexec::upon_stopped([&server = server, requestId] { server.SendCancelledResponse(requestId); }));
         }
 
+        template <typename StateType>
+        auto ScheduleLanguageQuery(int requestId, StringView uri,
+                                   std::move_only_function<auto(const LanguageQueryInfo&, StateType&)->void> callback)
+            -> void
+        {
+            ScheduleLanguageQuery<StateType>(requestId, uri, 0, std::move(callback));
+        }
+
+        // Cancel the request if the query running on the current thread has been halted by its time budget, so that
+        // its result is replaced by an error. This is for queries whose partial results are misleading, e.g. a document
+        // outline with symbols missing. A query that completes after its deadline still sends the complete result.
+        auto CancelExpiredQuery(int requestId) -> void;
+
         auto PublishInactiveRegions(StringView uri, const LanguageQueryInfo& info) -> void;
 
+        // Returns the memory held by the semantic token cache of the document. The cache is skipped if a query is
+        // using it at the moment.
+        static auto CollectSemanticTokenMemoryUsage(TextDocumentContext& ctx) -> MemoryUsage;
+
+        // Write the latency and compilation statistics of the session to the log.
+        auto LogStatistics() -> void;
+
     public:
-        LanguageService(LanguageServer& server) : server(server)
+        // Registers the service to the process-wide memory accountant.
+        LanguageService(LanguageServer& server, std::shared_ptr<LanguageServiceExecutor> executor);
+
+        // Waits for the tasks of open and closed documents, since they refer to this service and the executor may
+        // outlive it.
+        ~LanguageService();
+
+        // Lock the open documents against background workers while a client message is handled.
+        auto LockDocuments() -> std::unique_lock<std::mutex>
         {
+            return std::unique_lock<std::mutex>{documentMutex};
         }
 
+        // Block until the tasks spawned for open documents are finished, including their background compilations.
+        auto WaitForPendingTasks() -> void;
+
+        // Collect the memory held by each open document, each preamble in use and the stdlib cache. Only the latest
+        // version of each document is counted, since older ones are released once the queries on them finish.
+        auto CollectMemoryUsage() -> lsp::MemoryUsageResult;
+
 #pragma region Lifecycle
 
         auto OnInitialize(int requestId, lsp::InitializeParams params) -> void;
@@ -164,6 +413,8 @@ namespace glsld
 
         auto OnExit(std::nullptr_t) -> void;
 
+        auto OnCancelRequest(lsp::CancelParams params) -> void;
+
 #pragma endregion
 
 #pragma region Document Synchronization
@@ -172,6 +423,8 @@ namespace glsld
 
         auto OnDidChangeTextDocument(lsp::DidChangeTextDocumentParams params) -> void;
 
+        auto OnDidSaveTextDocument(lsp::DidSaveTextDocumentParams params) -> void;
+
         auto OnDidCloseTextDocument(lsp::DidCloseTextDocumentParams params) -> void;
 
 #pragma endregion
@@ -184,8 +437,12 @@ namespace glsld
 
         auto OnSemanticTokensDelta(int requestId, lsp::SemanticTokensDeltaParams params) -> void;
 
+        auto OnSemanticTokensRange(int requestId, lsp::SemanticTokensRangeParams params) -> void;
+
         auto OnCompletion(int requestId, lsp::CompletionParams params) -> void;
 
+        auto OnCompletionResolve(int requestId, lsp::CompletionItem params) -> void;
+
         auto OnSignatureHelp(int requestId, lsp::SignatureHelpParams params) -> void;
 
         auto OnHover(int requestId, lsp::HoverParams params) -> void;
@@ -194,10 +451,20 @@ namespace glsld
 
         auto OnReferences(int requestId, lsp::ReferenceParams params) -> void;
 
+        auto OnDocumentHighlight(int requestId, lsp::DocumentHighlightParams params) -> void;
+
         auto OnInlayHint(int requestId, lsp::InlayHintParams params) -> void;
 
         auto OnFoldingRange(int requestId, lsp::FoldingRangeParams params) -> void;
 
+#pragma endregion
+
+#pragma region Extensions
+
+        auto OnMemoryUsage(int requestId, std::nullptr_t) -> void;
+
+        auto OnStatistics(int requestId, std::nullptr_t) -> void;
+
 #pragma endregion
     };
 } // namespace glsld
\ No newline at end of file
@@ -0,0 +1,86 @@
+#pragma once
+#include "Server/TextTransport.h"
+#include "Support/MpscQueue.h"
+
+#include <atomic>
+#include <functional>
+#include <string>
+#include <thread>
+
+namespace glsld
+{
+    // Writes outgoing LSP messages to the transport from a dedicated thread, so that a worker thread sending a message
+    // never blocks on I/O even if the client is slow to read. Messages are queued without locking, and the writer
+    // thread drains everything queued so far with a single gathered write.
+    class MessageWriter
+    {
+    private:
+        struct OutgoingMessage
+        {
+            OutgoingMessage* next = nullptr;
+
+            // The "Content-Length" header, formatted by the sender.
+            char header[48];
+            size_t headerSize = 0;
+
+            std::string payload;
+        };
+
+        TextTransport& transport;
+
+        // Called in the writer thread if writing to the transport fails. Messages are discarded afterwards.
+        std::function<void()> onWriteFailure;
+
+        MpscQueue<OutgoingMessage> messageQueue;
+
+        // Bumped after every enqueue and on stop, so the writer thread can wait for it to change.
+        std::atomic<uint64_t> wakeSequence = 0;
+        std::atomic<bool> stopRequested    = false;
+
+        // Backpressure metrics. A message is pending from being queued until it's written.
+        std::atomic<size_t> pendingMessageCount     = 0;
+        std::atomic<size_t> pendingBytes            = 0;
+        std::atomic<size_t> peakPendingMessageCount = 0;
+        std::atomic<size_t> peakPendingBytes        = 0;
+
+        std::thread writerThread;
+
+        auto WriterMain() -> void;
+
+    public:
+        MessageWriter(TextTransport& transport, std::function<void()> onWriteFailure);
+
+        // Writes all queued messages before returning.
+        ~MessageWriter();
+
+        MessageWriter(const MessageWriter&)            = delete;
+        MessageWriter& operator=(const MessageWriter&) = delete;
+
+        // Queue a message payload to be written with its header. The payload is moved into the queue without copying.
+        // This never blocks.
+        // This function is thread-safe.
+        auto Enqueue(std::string&& payload) -> void;
+
+        // Returns the number of messages queued but not written yet.
+        auto GetPendingMessageCount() const -> size_t
+        {
+            return pendingMessageCount.load(std::memory_order_relaxed);
+        }
+
+        // Returns the total size of messages queued but not written yet.
+        auto GetPendingBytes() const -> size_t
+        {
+            return pendingBytes.load(std::memory_order_relaxed);
+        }
+
+        auto GetPeakPendingMessageCount() const -> size_t
+        {
+            return peakPendingMessageCount.load(std::memory_order_relaxed);
+        }
+
+        auto GetPeakPendingBytes() const -> size_t
+        {
+            return peakPendingBytes.load(std::memory_order_relaxed);
+        }
+    };
+} // namespace glsld
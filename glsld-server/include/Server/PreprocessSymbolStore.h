@@ -2,6 +2,7 @@
 #include "Compiler/MacroTable.h"
 #include "Compiler/SyntaxToken.h"
 #include "Compiler/PPCallback.h"
+#include "Support/MemoryUsage.h"
 
 #include <memory>
 #include <variant>
@@ -64,6 +65,17 @@ namespace glsld
         {
             return std::get_if<PPMacroSymbol>(&*data);
         }
+
+        // Returns the memory of the symbol data, which is allocated separately.
+        auto GetMemoryUsage() const -> MemoryUsage
+        {
+            MemoryUsage result{.allocatedBytes = sizeof(DataVariant), .committedBytes = sizeof(DataVariant)};
+            if (auto headerName = GetHeaderNameInfo()) {
+                result += MemoryUsage::Of(headerName->headerAbsolutePath);
+            }
+
+            return result;
+        }
     };
 
     struct PPInactiveRegion
@@ -87,6 +99,9 @@ namespace glsld
         std::vector<PPSymbolOccurrence> occurrences;
         std::vector<PPInactiveRegion> inactiveRegions;
 
+        // The names of the macros that occur in the main file, sorted and deduplicated.
+        std::vector<AtomString> macroNames;
+
     public:
         auto CreateCollectionCallback(const MacroTable* preambleMacroTable) -> std::unique_ptr<PPCallback>;
 
@@ -100,7 +115,14 @@ namespace glsld
             return inactiveRegions;
         }
 
+        auto GetMacroNames() const -> ArrayView<AtomString>
+        {
+            return macroNames;
+        }
+
         auto QueryPPSymbol(TextPosition position) const -> const PPSymbolOccurrence*;
+
+        auto GetMemoryUsage() const -> MemoryUsage;
     };
 
 } // namespace glsld
\ No newline at end of file
@@ -1,5 +1,7 @@
 #pragma once
 
+#include "Support/JsonWriter.h"
+#include "Support/SerializerUtils.h"
 #include "Support/StringView.h"
 
 #include <nlohmann/json.hpp>
@@ -7,6 +9,7 @@
 #include <cstdint>
 #include <optional>
 #include <string>
+#include <vector>
 
 namespace glsld::lsp
 {
@@ -32,6 +35,30 @@ namespace glsld::lsp
     using Uri         = std::string;
     using DocumentUri = Uri;
 
+    // /**
+    //  * A type indicating how positions are encoded,
+    //  * specifically what column offsets mean.
+    //  *
+    //  * @since 3.17.0
+    //  */
+    // export type PositionEncodingKind = string;
+    using PositionEncodingKind = std::string;
+
+    // /**
+    //  * Character offsets count UTF-8 code units (e.g bytes).
+    //  */
+    // export const UTF8: PositionEncodingKind = 'utf-8';
+    inline constexpr const char* PositionEncodingKind_UTF8 = "utf-8";
+
+    // /**
+    //  * Character offsets count UTF-16 code units.
+    //  *
+    //  * This is the default and must always be supported
+    //  * by servers
+    //  */
+    // export const UTF16: PositionEncodingKind = 'utf-16';
+    inline constexpr const char* PositionEncodingKind_UTF16 = "utf-16";
+
     struct Position
     {
         // /**
@@ -141,7 +168,7 @@ namespace glsld::lsp
         //  * including undo/redo. The number doesn't need to be consecutive.
         //  */
         //  version: integer | null;
-        std::optional<integer> version;
+        Nullable<integer> version;
     };
 
     struct TextDocumentPositionParams
@@ -261,6 +288,15 @@ namespace glsld::lsp
         {
             return nlohmann::json::object({{"kind", isMarkdown ? "markdown" : "plaintext"}, {"value", value}});
         }
+        auto Serialize(JsonWriter& writer) const -> void
+        {
+            writer.BeginObject();
+            writer.WriteKey("kind");
+            writer.WriteString(isMarkdown ? "markdown" : "plaintext");
+            writer.WriteKey("value");
+            writer.WriteString(StringView{value});
+            writer.EndObject();
+        }
 
         auto Deserialize(const nlohmann::json& j) -> bool
         {
@@ -335,6 +371,7 @@ namespace glsld::lsp
     inline constexpr const char* LSPMethod_DidOpenTextDocument   = "textDocument/didOpen";
     inline constexpr const char* LSPMethod_DidCloseTextDocument  = "textDocument/didClose";
     inline constexpr const char* LSPMethod_DidChangeTextDocument = "textDocument/didChange";
+    inline constexpr const char* LSPMethod_DidSaveTextDocument   = "textDocument/didSave";
 
     // /**
     //  * Defines how the host (editor) should sync document changes to the language
@@ -381,6 +418,13 @@ namespace glsld::lsp
         //  */
         // change?: TextDocumentSyncKind;
         TextDocumentSyncKind change;
+
+        // /**
+        //  * If present save notifications are sent to the server. If omitted the
+        //  * notification should not be sent.
+        //  */
+        // save?: boolean | SaveOptions;
+        bool save;
     };
 
     struct DidOpenTextDocumentParams
@@ -456,6 +500,15 @@ namespace glsld::lsp
         std::vector<TextDocumentContentChangeEvent> contentChanges;
     };
 
+    struct DidSaveTextDocumentParams
+    {
+        // /**
+        //  * The document that was saved.
+        //  */
+        // textDocument: TextDocumentIdentifier;
+        TextDocumentIdentifier textDocument;
+    };
+
     struct DidCloseTextDocumentParams
     {
         // /**
@@ -516,6 +569,23 @@ namespace glsld::lsp
         // message: string;
         std::string message;
     };
+
+    inline constexpr const char* LSPMethod_LogMessage = "window/logMessage";
+
+    struct LogMessageParams
+    {
+        // /**
+        //  * The message type. See {@link MessageType}
+        //  */
+        // type: MessageType;
+        MessageType type;
+
+        // /**
+        //  * The actual message
+        //  */
+        // message: string;
+        std::string message;
+    };
 #pragma endregion
 
 #pragma region Go to Declaration
@@ -599,6 +669,74 @@ namespace glsld::lsp
     };
 #pragma endregion
 
+#pragma region Document Highlight
+    inline constexpr const char* LSPMethod_DocumentHighlight = "textDocument/documentHighlight";
+
+    struct DocumentHighlightOptions
+    {
+    };
+
+    struct DocumentHighlightParams
+    {
+        // /**
+        //  * The text document.
+        //  */
+        // textDocument: TextDocumentIdentifier;
+        TextDocumentIdentifier textDocument;
+
+        // /**
+        //  * The position inside the text document.
+        //  */
+        // position: Position;
+        Position position;
+    };
+
+    // /**
+    //  * A document highlight kind.
+    //  */
+    enum class DocumentHighlightKind
+    {
+        // /**
+        //  * A textual occurrence.
+        //  */
+        // export const Text = 1;
+        Text = 1,
+
+        // /**
+        //  * Read-access of a symbol, like reading a variable.
+        //  */
+        // export const Read = 2;
+        Read = 2,
+
+        // /**
+        //  * Write-access of a symbol, like writing to a variable.
+        //  */
+        // export const Write = 3;
+        Write = 3,
+    };
+
+    // /**
+    //  * A document highlight is a range inside a text document which deserves
+    //  * special attention. Usually a document highlight is visualized by changing
+    //  * the background color of its range.
+    //  *
+    //  */
+    struct DocumentHighlight
+    {
+        // /**
+        //  * The range this highlight applies to.
+        //  */
+        // range: Range;
+        Range range;
+
+        // /**
+        //  * The highlight kind, default is DocumentHighlightKind.Text.
+        //  */
+        // kind?: DocumentHighlightKind;
+        DocumentHighlightKind kind;
+    };
+#pragma endregion
+
 #pragma region Hover
     inline constexpr const char* LSPMethod_Hover = "textDocument/hover";
 
@@ -855,6 +993,7 @@ namespace glsld::lsp
 #pragma region Semantic Tokens
     inline constexpr const char* LSPMethod_SemanticTokensFull      = "textDocument/semanticTokens/full";
     inline constexpr const char* LSPMethod_SemanticTokensFullDelta = "textDocument/semanticTokens/full/delta";
+    inline constexpr const char* LSPMethod_SemanticTokensRange     = "textDocument/semanticTokens/range";
 
     struct SemanticTokensLegend
     {
@@ -885,6 +1024,7 @@ namespace glsld::lsp
         //   */
         //  range?: boolean | {
         //  };
+        bool range;
 
         //  /**
         //   * Server supports providing semantic tokens for a full document.
@@ -949,6 +1089,21 @@ namespace glsld::lsp
         std::string previousResultId;
     };
 
+    struct SemanticTokensRangeParams
+    {
+        // /**
+        //  * The text document.
+        //  */
+        //  textDocument: TextDocumentIdentifier;
+        TextDocumentIdentifier textDocument;
+
+        //  /**
+        //   * The range the semantic tokens are requested for.
+        //   */
+        //  range: Range;
+        Range range;
+    };
+
     struct SemanticTokensEdit
     {
         // /**
@@ -1147,7 +1302,8 @@ namespace glsld::lsp
 #pragma endregion
 
 #pragma region Completion Proposals
-    inline constexpr const char* LSPMethod_Completion = "textDocument/completion";
+    inline constexpr const char* LSPMethod_Completion            = "textDocument/completion";
+    inline constexpr const char* LSPMethod_CompletionItemResolve = "completionItem/resolve";
 
     // /**
     //  * Completion options.
@@ -1188,6 +1344,7 @@ namespace glsld::lsp
         //   * information for a completion item.
         //   */
         //  resolveProvider?: boolean;
+        bool resolveProvider;
 
         //  /**
         //   * The server supports the following `CompletionItem` specific
@@ -1380,6 +1537,7 @@ namespace glsld::lsp
         //   * A human-readable string that represents a doc-comment.
         //   */
         //  documentation?: string | MarkupContent;
+        std::optional<MarkupContent> documentation;
 
         //  /**
         //   * Indicates if this item is deprecated.
@@ -1517,6 +1675,8 @@ namespace glsld::lsp
         //   * a completion and a completion resolve request.
         //   */
         //  data?: LSPAny;
+        // NOTE glsld stores the uri of the document where the completion is requested, if the item could be resolved.
+        std::optional<DocumentUri> data;
     };
 
     // /**
@@ -1776,6 +1936,7 @@ namespace glsld::lsp
         //   * diagnostic, e.g. 'typescript' or 'super lint'.
         //   */
         //  source?: string;
+        std::optional<std::string> source;
 
         //  /**
         //   * The diagnostic's message.
@@ -1845,6 +2006,211 @@ namespace glsld::lsp
 
 #pragma endregion
 
+#pragma region Memory Usage Extension
+    inline constexpr const char* LSPMethod_MemoryUsage = "glsld/memoryUsage";
+
+    struct MemoryUsageInfo
+    {
+        // Bytes that are actually used to store data.
+        size_t allocatedBytes;
+
+        // Bytes that are obtained from the allocator, including the unused capacity and the bookkeeping overhead.
+        size_t committedBytes;
+    };
+
+    struct DocumentMemoryUsage
+    {
+        // The URI of the document.
+        DocumentUri uri;
+
+        // The version of the document.
+        integer version;
+
+        // Whether the latest version is compiled. If not, only the text of the document is counted.
+        bool compiled;
+
+        // Whether the compilation result is dropped to stay within the memory budget. The document is compiled again
+        // when it's queried.
+        bool evicted;
+
+        // The index of the preamble in `MemoryUsageResult::preambles` that the compilation is based on, if any.
+        std::optional<uinteger> preamble;
+
+        // The text of the document.
+        MemoryUsageInfo source;
+
+        // The AST and the atoms of the compilation, excluding the preamble.
+        MemoryUsageInfo ast;
+
+        // The token buffers of the compilation, excluding the preamble.
+        MemoryUsageInfo tokens;
+
+        // The preprocessor info collected during the compilation.
+        MemoryUsageInfo preprocessInfo;
+
+        // The indexes built for language queries.
+        MemoryUsageInfo queryIndex;
+
+        // The cached semantic tokens.
+        MemoryUsageInfo semanticTokens;
+
+        // The sum of all above.
+        MemoryUsageInfo total;
+    };
+
+    struct PreambleMemoryUsage
+    {
+        // The index of the preamble that this one is composed on top of, if any.
+        std::optional<uinteger> base;
+
+        // The number of open documents whose compilation is based on this preamble directly.
+        uinteger documentCount;
+
+        // The text of the preamble.
+        MemoryUsageInfo source;
+
+        // The AST and the atoms of the preamble, excluding the base preamble.
+        MemoryUsageInfo ast;
+
+        // The token buffers of the preamble, excluding the base preamble.
+        MemoryUsageInfo tokens;
+
+        // The sum of all above.
+        MemoryUsageInfo total;
+    };
+
+    struct MemoryUsageResult
+    {
+        // The memory held by each open document.
+        std::vector<DocumentMemoryUsage> documents;
+
+        // The memory held by each preamble in use, which may be shared by documents and other preambles, and by each
+        // stdlib core retained by the process-wide cache.
+        std::vector<PreambleMemoryUsage> preambles;
+
+        // The sum of all documents and preambles.
+        MemoryUsageInfo total;
+    };
+
+#pragma endregion
+
+#pragma region Statistics Extension
+    inline constexpr const char* LSPMethod_Statistics = "glsld/stats";
+
+    // Latencies in microseconds. Percentiles are rounded up to a relative precision of 1/16.
+    struct LatencySummary
+    {
+        uinteger count;
+        uinteger mean;
+        uinteger p50;
+        uinteger p90;
+        uinteger p99;
+        uinteger max;
+    };
+
+    struct RequestStatisticsInfo
+    {
+        // The method of the request.
+        std::string method;
+
+        // The number of requests that are responded with a cancellation error.
+        uinteger cancelled;
+
+        // From when a language query is ready to run to when a worker picks it up. Empty if the request is not a
+        // language query.
+        LatencySummary queueWait;
+
+        // Time spent by the worker running the language query. Empty if the request is not a language query.
+        LatencySummary execution;
+
+        // From when the request is received to when it's responded.
+        LatencySummary total;
+    };
+
+    struct CompilationStatisticsInfo
+    {
+        // Compilations by outcome. A superseded compilation is expired by a newer version of the document. A
+        // cancelled one is abandoned because the document is closed.
+        uinteger completed;
+        uinteger superseded;
+        uinteger cancelled;
+
+        // Completed compilations by whether the preamble is reused instead of being compiled.
+        uinteger preambleCacheHits;
+        uinteger preambleCacheMisses;
+
+        // From when the coalescing window ends to when a worker picks the compilation up.
+        LatencySummary queueWait;
+
+        // Time spent by the worker on completed compilations.
+        LatencySummary execution;
+    };
+
+    struct StatisticsResult
+    {
+        // Statistics of each request method that is received at least once.
+        std::vector<RequestStatisticsInfo> requests;
+
+        // Statistics of background compilations.
+        CompilationStatisticsInfo compilation;
+    };
+
+#pragma endregion
+
+#pragma region Base Protocol
+    inline constexpr const char* LSPMethod_CancelRequest = "$/cancelRequest";
+
+    enum class ErrorCodes : integer
+    {
+        // export const InvalidParams: integer = -32602;
+        InvalidParams = -32602,
+
+        // /**
+        //  * The client has canceled a request and a server has detected
+        //  * the cancel.
+        //  */
+        // export const RequestCancelled: integer = -32800;
+        RequestCancelled = -32800,
+
+        // /**
+        //  * The server detected that the content of a document got
+        //  * modified outside normal conditions. A server should
+        //  * NOT send this error code if it detects a content change
+        //  * in it unprocessed messages. The result even computed
+        //  * on an older state might still be useful for the client.
+        //  *
+        //  * If a client decides that a result is not of any use anymore
+        //  * the client should cancel the request.
+        //  */
+        // export const ContentModified: integer = -32801;
+        ContentModified = -32801,
+    };
+
+    struct ResponseError
+    {
+        // /**
+        //  * A number indicating the error type that occurred.
+        //  */
+        // code: integer;
+        ErrorCodes code;
+
+        // /**
+        //  * A string providing a short description of the error.
+        //  */
+        // message: string;
+        std::string message;
+    };
+
+    struct CancelParams
+    {
+        // /**
+        //  * The request id to cancel.
+        //  */
+        // id: integer | string;
+        integer id;
+    };
+#pragma endregion
+
 #pragma region Lifecycle
     inline constexpr const char* LSPMethod_Initialize  = "initialize";
     inline constexpr const char* LSPMethod_Initialized = "initialized";
@@ -1853,6 +2219,43 @@ namespace glsld::lsp
     inline constexpr const char* LSPMethod_Shutdown    = "shutdown";
     inline constexpr const char* LSPMethod_Exit        = "exit";
 
+    struct GeneralClientCapabilities
+    {
+        // /**
+        //  * The position encodings supported by the client. Client and server
+        //  * have to agree on the same position encoding to ensure that offsets
+        //  * (e.g. character position in a line) are interpreted the same on both
+        //  * side.
+        //  *
+        //  * To keep the protocol backwards compatible the following applies: if
+        //  * the value 'utf-16' is missing from the array of position encodings
+        //  * servers can assume that the client supports UTF-16. UTF-16 is
+        //  * therefore a mandatory encoding.
+        //  *
+        //  * If omitted it defaults to ['utf-16'].
+        //  *
+        //  * Implementation considerations: since the conversion from one encoding
+        //  * into another requires the content of the file / line the conversion
+        //  * is best done where the file is read which is usually on the server
+        //  * side.
+        //  *
+        //  * @since 3.17.0
+        //  */
+        // positionEncodings?: PositionEncodingKind[];
+        std::optional<std::vector<PositionEncodingKind>> positionEncodings;
+    };
+
+    struct ClientCapabilities
+    {
+        // /**
+        //  * General client capabilities.
+        //  *
+        //  * @since 3.16.0
+        //  */
+        // general?: { ... };
+        std::optional<GeneralClientCapabilities> general;
+    };
+
     struct InitializationOptions
     {
         std::optional<bool> supportGlsldExtensions;
@@ -1924,6 +2327,7 @@ namespace glsld::lsp
         //   * The capabilities provided by the client (editor or tool)
         //   */
         //  capabilities: ClientCapabilities;
+        std::optional<ClientCapabilities> capabilities;
 
         //  /**
         //   * The initial trace setting. If omitted trace is disabled ('off').
@@ -1955,6 +2359,7 @@ namespace glsld::lsp
         //  * @since 3.17.0
         //  */
         //  positionEncoding?: PositionEncodingKind;
+        std::optional<PositionEncodingKind> positionEncoding;
 
         //  /**
         //   * Defines how text documents are synced. Is either a detailed structure
@@ -2032,6 +2437,7 @@ namespace glsld::lsp
         //   * The server provides document highlight support.
         //   */
         //  documentHighlightProvider?: boolean | DocumentHighlightOptions;
+        std::optional<DocumentHighlightOptions> documentHighlightProvider;
 
         //  /**
         //   * The server provides document symbol support.
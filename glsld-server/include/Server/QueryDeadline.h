@@ -0,0 +1,99 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+namespace glsld
+{
+    // The time budget of the language query running on the current thread. Queries check it cooperatively, e.g. the
+    // AST traversal of a `LanguageQueryVisitor` halts once it expires, so that a slow query doesn't run to completion.
+    // The query then responds with what it has collected so far, or with an error if a partial result is misleading.
+    // A query that finishes its traversal before anything observes the expiration still has a complete result.
+    class QueryDeadline
+    {
+    private:
+        using Clock = std::chrono::steady_clock;
+
+        // Polling is done for every AST node, which is too frequent to read the clock every time. The clock is only
+        // read once per this number of polls.
+        static constexpr uint32_t PollClockInterval = 64;
+
+        // The deadline of the query running on the current thread, if any.
+        static inline thread_local QueryDeadline* current = nullptr;
+
+        QueryDeadline* previous;
+
+        Clock::time_point deadline;
+
+        // The clock is read on the first poll, so a traversal that starts after the deadline halts right away.
+        uint32_t pollCounter = PollClockInterval - 1;
+
+        bool expired = false;
+
+        // Whether a poll has returned true, after which the polling traversal halts with a partial result.
+        bool truncated = false;
+
+    public:
+        // Installs a deadline for the query running on the current thread until destroyed. A zero budget means no
+        // deadline.
+        explicit QueryDeadline(std::chrono::milliseconds budget)
+            : previous(current), deadline(budget > budget.zero() ? Clock::now() + budget : Clock::time_point::max())
+        {
+            current = this;
+        }
+        ~QueryDeadline()
+        {
+            current = previous;
+        }
+
+        QueryDeadline(const QueryDeadline&)                    = delete;
+        auto operator=(const QueryDeadline&) -> QueryDeadline& = delete;
+
+        // Returns true if the deadline has passed. Once expired, it stays expired.
+        auto IsExpired() -> bool
+        {
+            if (!expired && Clock::now() >= deadline) {
+                expired = true;
+            }
+
+            return expired;
+        }
+
+        // Same as `IsExpired`, but only reads the clock once in a while. This is cheap enough to be called in a loop.
+        // The caller is expected to halt once this returns true, which marks the query as truncated.
+        auto Poll() -> bool
+        {
+            if (!expired && ++pollCounter == PollClockInterval) {
+                pollCounter = 0;
+                IsExpired();
+            }
+
+            truncated = expired;
+            return expired;
+        }
+
+        // Returns true if a traversal has been halted by the deadline, i.e. the result of the query is partial.
+        auto IsTruncated() const -> bool
+        {
+            return truncated;
+        }
+
+        // Returns true if the query running on the current thread has run out of its time budget.
+        static auto IsCurrentExpired() -> bool
+        {
+            return current != nullptr && current->IsExpired();
+        }
+
+        // Same as `IsCurrentExpired`, but only reads the clock once in a while.
+        static auto PollCurrent() -> bool
+        {
+            return current != nullptr && current->Poll();
+        }
+
+        // Returns true if the query running on the current thread has been halted by its deadline.
+        static auto IsCurrentTruncated() -> bool
+        {
+            return current != nullptr && current->IsTruncated();
+        }
+    };
+} // namespace glsld
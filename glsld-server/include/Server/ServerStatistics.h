@@ -0,0 +1,73 @@
+#pragma once
+#include "Server/Protocol.h"
+#include "Support/LatencyHistogram.h"
+#include "Support/StringView.h"
+
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace glsld
+{
+    struct RequestStatistics
+    {
+        // From when a language query is ready to run, i.e. the compilation is available, to when a worker picks it up.
+        LatencyHistogram queueWait;
+
+        // Time spent by the worker running a language query.
+        LatencyHistogram execution;
+
+        // From when the request is received to when it's responded.
+        LatencyHistogram total;
+
+        // The number of requests that are responded with a cancellation error.
+        std::atomic<uint64_t> cancelledCount = 0;
+    };
+
+    struct CompilationStatistics
+    {
+        // From when the coalescing window ends to when a worker picks the compilation up.
+        LatencyHistogram queueWait;
+
+        // Time spent by the worker on compilations that are completed.
+        LatencyHistogram execution;
+
+        // Compilations by outcome. A superseded compilation is expired by a newer version of the document, either
+        // before or while running. A cancelled one is abandoned because the document is closed, either before or
+        // while running.
+        std::atomic<uint64_t> completedCount  = 0;
+        std::atomic<uint64_t> supersededCount = 0;
+        std::atomic<uint64_t> cancelledCount  = 0;
+
+        // Completed compilations by whether the preamble is reused, either from the previous version of the document
+        // or from the shared stdlib cache, instead of being compiled.
+        std::atomic<uint64_t> preambleCacheHitCount  = 0;
+        std::atomic<uint64_t> preambleCacheMissCount = 0;
+    };
+
+    // Aggregated latencies and counters of the server for tuning, which live as long as the server. Statistics are
+    // recorded from different threads, and could be collected at any time.
+    class ServerStatistics
+    {
+    private:
+        // Statistics of each request method. Entries are never removed, so references to them stay valid.
+        std::mutex requestMutex;
+        std::map<std::string, std::unique_ptr<RequestStatistics>, std::less<>> requests;
+
+        CompilationStatistics compilation;
+
+    public:
+        auto GetRequestStatistics(StringView method) -> RequestStatistics&;
+
+        auto GetCompilationStatistics() -> CompilationStatistics&
+        {
+            return compilation;
+        }
+
+        // Summarize the statistics recorded so far. Requests are ordered by method.
+        auto Collect() -> lsp::StatisticsResult;
+    };
+} // namespace glsld
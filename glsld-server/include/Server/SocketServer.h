@@ -0,0 +1,106 @@
+#pragma once
+#include "Server/Config.h"
+#include "Server/Protocol.h"
+#include "Support/StringView.h"
+
+#if defined(GLSLD_OS_LINUX)
+
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace glsld
+{
+    class LanguageServer;
+    struct LanguageServiceExecutor;
+
+    // Serves LSP over a Unix domain socket or a TCP loopback socket with an epoll event loop. Every connection is an
+    // independent client with its own LanguageServer. The worker threads are shared by all clients, and so are
+    // process-wide caches such as the precompiled stdlib preambles.
+    class SocketServer
+    {
+    private:
+        struct Connection
+        {
+            int fd = -1;
+
+            // Bytes received but not yet dispatched as complete messages.
+            std::string inputBuffer;
+
+            std::unique_ptr<LanguageServer> server;
+        };
+
+        LanguageServerConfig config;
+
+        // Background work of all connections runs on this executor.
+        std::shared_ptr<LanguageServiceExecutor> executor;
+
+        int listenFd = -1;
+        int epollFd  = -1;
+
+        // An eventfd that wakes the event loop when stop is requested.
+        int wakeFd = -1;
+
+        std::unordered_map<int, std::unique_ptr<Connection>> connections;
+
+        // Called with the memory held by the server of a connection right before it's closed.
+        std::function<auto(const lsp::MemoryUsageResult&)->void> memoryReportHandler;
+
+        // Closed connections are torn down by a separate thread while `Run` is active. Destroying a server waits for
+        // its pending work, which must not hold up the event loop serving other clients.
+        std::mutex closingMutex;
+        std::condition_variable closingCondition;
+        std::vector<std::unique_ptr<Connection>> closingConnections;
+        bool closingStopRequested = false;
+        std::thread closingThread;
+
+        auto ClosingThreadMain() -> void;
+
+        auto AddToEventLoop(int fd) -> bool;
+
+        auto AcceptConnection() -> void;
+
+        // Reads available data from the connection and dispatches complete messages. Returns false if the connection
+        // should be closed.
+        auto ReadConnection(Connection& connection) -> bool;
+
+        auto CloseConnection(int fd) -> void;
+
+    public:
+        SocketServer(const LanguageServerConfig& config);
+        ~SocketServer();
+
+        SocketServer(const SocketServer&)            = delete;
+        SocketServer& operator=(const SocketServer&) = delete;
+
+        // Listen on a Unix domain socket at the given path. An existing file at the path is removed first.
+        auto ListenUnix(StringView path) -> bool;
+
+        // Listen on the given port of the TCP loopback interface. Port 0 picks an ephemeral port.
+        auto ListenTcp(uint16_t port) -> bool;
+
+        // Returns the port that the server is listening on, or 0 if it isn't listening on TCP.
+        auto GetTcpPort() const -> uint16_t;
+
+        // Set a handler that is called on the event loop with the memory held by the server of each connection, right
+        // before the connection is closed.
+        auto SetMemoryReportHandler(std::function<auto(const lsp::MemoryUsageResult&)->void> handler) -> void
+        {
+            memoryReportHandler = std::move(handler);
+        }
+
+        // Serve clients until Stop() is called. All connections are closed and torn down before returning.
+        auto Run() -> void;
+
+        // This function is thread-safe, and async-signal-safe so it could be called from a signal handler.
+        auto Stop() -> void;
+    };
+} // namespace glsld
+
+#endif
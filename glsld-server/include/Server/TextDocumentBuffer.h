@@ -0,0 +1,86 @@
+#pragma once
+#include "Basic/SourceInfo.h"
+#include "Support/MemoryUsage.h"
+#include "Support/StringView.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace glsld
+{
+    // The text buffer of an open document, which is edited incrementally with LSP positions, i.e. lines and columns in
+    // the negotiated position encoding. Columns count UTF-16 code units by default, or bytes if the client supports
+    // UTF-8 positions.
+    //
+    // The text is stored in chunks of whole lines, so that a line never crosses a chunk boundary and an edit only
+    // rewrites the chunks it touches. Each chunk is immutable and indexes its line breaks, so locating a position
+    // doesn't need to scan the text before it. Copying a buffer shares the chunks, which makes it cheap to snapshot
+    // the buffer for a background compilation. The contiguous text is only assembled when the compilation starts.
+    class TextDocumentBuffer
+    {
+    private:
+        // Chunks are split at the first line break after this size.
+        static constexpr size_t TargetChunkSize = 4096;
+
+        struct Chunk
+        {
+            std::string text;
+
+            // Offsets of the line breaks in the text.
+            std::vector<uint32_t> lineBreaks;
+        };
+
+        // Every chunk except the last one ends with a line break. There's always at least one chunk.
+        std::vector<std::shared_ptr<const Chunk>> chunks;
+
+        size_t totalSize = 0;
+
+        // Whether columns count UTF-16 code units instead of UTF-8 bytes.
+        bool countUtf16Characters = true;
+
+        struct Location
+        {
+            size_t chunkIndex;
+            size_t offset;
+        };
+
+        // Returns the location of the given position. Positions past the end of a line or the document are clamped.
+        auto Locate(TextPosition position) const -> Location;
+
+        static auto CreateChunks(StringView text) -> std::vector<std::shared_ptr<const Chunk>>;
+
+    public:
+        TextDocumentBuffer() : TextDocumentBuffer(StringView{})
+        {
+        }
+        explicit TextDocumentBuffer(StringView text, bool countUtf16Characters = true)
+            : chunks(CreateChunks(text)), totalSize(text.size()), countUtf16Characters(countUtf16Characters)
+        {
+        }
+
+        // Replace the text in the range with the given text.
+        auto ApplyChange(TextRange range, StringView changedText) -> void;
+
+        // Returns the size of the text in bytes.
+        auto GetSize() const -> size_t
+        {
+            return totalSize;
+        }
+
+        // Returns whether columns count UTF-16 code units instead of UTF-8 bytes.
+        auto GetCountUtf16Characters() const -> bool
+        {
+            return countUtf16Characters;
+        }
+
+        // Returns the number of lines. There's always at least one line.
+        auto GetLineCount() const -> size_t;
+
+        // Assemble the contiguous text of the document.
+        auto GetText() const -> std::string;
+
+        // NOTE chunks shared with other snapshots of the buffer are counted in each of them.
+        auto GetMemoryUsage() const -> MemoryUsage;
+    };
+} // namespace glsld
@@ -3,12 +3,41 @@
 
 #include <expected>
 #include <memory>
+#include <span>
 
 namespace glsld
 {
     enum class TextTransportError
     {
         Unknown,
+
+        // The message is larger than `MaxTextTransportMessageSize`.
+        MessageTooLarge,
+
+        // The message header is malformed, or the payload length is missing.
+        InvalidHeader,
+    };
+
+    // Messages larger than this are rejected, so that a bad Content-Length cannot make the server allocate without
+    // bound.
+    inline constexpr size_t MaxTextTransportMessageSize = 10 * 1024 * 1024; // 10 MB
+
+    // Parses the header part of a message framed in the LSP base protocol, one line at a time. This is shared by every
+    // way messages are received, so they are framed and limited the same way.
+    class MessageHeaderParser
+    {
+    private:
+        size_t payloadLength = 0;
+
+    public:
+        // Parses a header line. Returns true if it's the empty line that ends the header, after which the payload
+        // length is known. Unknown header fields are ignored.
+        auto ParseLine(StringView line) -> std::expected<bool, TextTransportError>;
+
+        auto GetPayloadLength() const -> size_t
+        {
+            return payloadLength;
+        }
     };
 
     class TextTransport
@@ -20,16 +49,25 @@ namespace glsld
         // Returns a line of text that should live until the next call to ReadLine/Read.
         virtual auto ReadLine() -> std::expected<StringView, TextTransportError> = 0;
 
-        // Returns a block of text that should live until the next call to ReadLine/Read.
+        // Returns a block of text that should live until the next call to ReadLine/Read. Fails with
+        // `TextTransportError::MessageTooLarge` if the size exceeds `MaxTextTransportMessageSize`.
         virtual auto Read(size_t size) -> std::expected<StringView, TextTransportError> = 0;
 
-        // Writes a block of text. Returns true if the write is successful.
-        virtual auto Write(StringView data) -> bool = 0;
-
-        // Flushes any buffered data. Returns true if the flush is successful.
-        virtual auto Flush() -> bool = 0;
+        // Writes the blocks of text in order, gathered into as few writes as possible. Nothing is buffered after the
+        // call returns. Returns true if the write is successful.
+        virtual auto Write(std::span<const StringView> blocks) -> bool = 0;
     };
 
     auto CreateStdioTextTransport() -> std::unique_ptr<TextTransport>;
 
-} // namespace glsld
\ No newline at end of file
+    // Creates a transport that reads from and writes to the given file descriptors, which are not owned by the
+    // transport.
+    auto CreateFileDescriptorTextTransport(int inputFd, int outputFd) -> std::unique_ptr<TextTransport>;
+
+#if !defined(GLSLD_OS_WIN)
+    // Creates a transport over a connected stream socket, which is not owned by the transport. Writing to a socket that
+    // is closed by the peer fails instead of raising SIGPIPE.
+    auto CreateSocketTextTransport(int socketFd) -> std::unique_ptr<TextTransport>;
+#endif
+
+} // namespace glsld
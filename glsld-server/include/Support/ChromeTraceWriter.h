@@ -0,0 +1,70 @@
+#pragma once
+#include "Support/JsonWriter.h"
+#include "Support/Tracing.h"
+
+#include <span>
+
+namespace glsld
+{
+    // Writes the events in the Chrome JSON trace event format, which could be loaded by `chrome://tracing` or the
+    // Perfetto UI. Spans nested within a thread are written as complete events, and async spans as a pair of
+    // begin/end events keyed by their ID.
+    inline auto WriteChromeTrace(std::span<const TraceEvent> events, JsonWriter& writer) -> void
+    {
+        const auto writeCommonFields = [&writer](const TraceEvent& event, StringView phase, int64_t timestamp) {
+            writer.WriteKey("name");
+            writer.WriteString(event.name);
+            writer.WriteKey("cat");
+            writer.WriteString(event.category);
+            writer.WriteKey("ph");
+            writer.WriteString(phase);
+            writer.WriteKey("ts");
+            writer.WriteInteger(timestamp);
+            writer.WriteKey("pid");
+            writer.WriteInteger(1);
+            writer.WriteKey("tid");
+            writer.WriteInteger(event.threadId);
+        };
+        const auto writeArgs = [&writer](const TraceEvent& event) {
+            if (event.detail[0] != '\0') {
+                writer.WriteKey("args");
+                writer.BeginObject();
+                writer.WriteKey("detail");
+                writer.WriteString(event.detail);
+                writer.EndObject();
+            }
+        };
+
+        writer.BeginObject();
+        writer.WriteKey("displayTimeUnit");
+        writer.WriteString("ms");
+        writer.WriteKey("traceEvents");
+        writer.BeginArray();
+        for (const auto& event : events) {
+            if (event.asyncId) {
+                writer.BeginObject();
+                writeCommonFields(event, "b", event.startUs);
+                writer.WriteKey("id");
+                writer.WriteInteger(*event.asyncId);
+                writeArgs(event);
+                writer.EndObject();
+
+                writer.BeginObject();
+                writeCommonFields(event, "e", event.startUs + event.durationUs);
+                writer.WriteKey("id");
+                writer.WriteInteger(*event.asyncId);
+                writer.EndObject();
+            }
+            else {
+                writer.BeginObject();
+                writeCommonFields(event, "X", event.startUs);
+                writer.WriteKey("dur");
+                writer.WriteInteger(event.durationUs);
+                writeArgs(event);
+                writer.EndObject();
+            }
+        }
+        writer.EndArray();
+        writer.EndObject();
+    }
+} // namespace glsld
@@ -0,0 +1,439 @@
+#pragma once
+#include "Support/StringView.h"
+
+#include <algorithm>
+#include <charconv>
+#include <concepts>
+#include <cstdint>
+#include <string>
+
+namespace glsld
+{
+    enum class JsonValueKind
+    {
+        Null,
+        Boolean,
+        Number,
+        String,
+        Array,
+        Object,
+        Invalid,
+    };
+
+    // A pull-based JSON reader over a contiguous text, which lets a deserializer fill its destination directly from
+    // the token stream without building a DOM. Every Read* function consumes exactly one value and returns false if
+    // the value is malformed or of an unexpected kind, in which case the reader is left in an unspecified state.
+    class JsonReader
+    {
+    private:
+        // Nesting deeper than this is rejected to avoid overflowing the stack.
+        static constexpr int MaxDepth = 256;
+
+        const char* cursor;
+        const char* end;
+        int depth = 0;
+
+        // Storage of the last object key that contains escape sequences.
+        std::string keyBuffer;
+
+        auto SkipWhitespace() -> void
+        {
+            while (cursor != end && (*cursor == ' ' || *cursor == '\t' || *cursor == '\n' || *cursor == '\r')) {
+                ++cursor;
+            }
+        }
+
+        auto TryConsume(char ch) -> bool
+        {
+            SkipWhitespace();
+            if (cursor != end && *cursor == ch) {
+                ++cursor;
+                return true;
+            }
+
+            return false;
+        }
+
+        auto TryConsumeLiteral(StringView literal) -> bool
+        {
+            SkipWhitespace();
+            if (StringView{cursor, static_cast<size_t>(end - cursor)}.StartWith(literal)) {
+                cursor += literal.size();
+                return true;
+            }
+
+            return false;
+        }
+
+        // Scans a string token starting at the cursor. Returns the text between the quotes and whether it contains
+        // escape sequences.
+        auto ScanString(StringView& rawText, bool& hasEscape) -> bool
+        {
+            if (!TryConsume('"')) {
+                return false;
+            }
+
+            hasEscape         = false;
+            const char* begin = cursor;
+            while (true) {
+                cursor = std::find_if(cursor, end, [](char ch) { return ch == '"' || ch == '\\'; });
+                if (cursor == end) {
+                    return false;
+                }
+                else if (*cursor == '"') {
+                    rawText = StringView{begin, static_cast<size_t>(cursor - begin)};
+                    ++cursor;
+                    return true;
+                }
+                else {
+                    // Skip the escaped character. Escape sequences are validated when decoded.
+                    hasEscape = true;
+                    if (end - cursor < 2) {
+                        return false;
+                    }
+                    cursor += 2;
+                }
+            }
+        }
+
+        static auto ParseHex4(const char* p, uint32_t& value) -> bool
+        {
+            return std::from_chars(p, p + 4, value, 16).ptr == p + 4;
+        }
+
+        static auto AppendUtf8(std::string& output, uint32_t codepoint) -> void
+        {
+            if (codepoint < 0x80) {
+                output.push_back(static_cast<char>(codepoint));
+            }
+            else if (codepoint < 0x800) {
+                output.push_back(static_cast<char>(0xC0 | (codepoint >> 6)));
+                output.push_back(static_cast<char>(0x80 | (codepoint & 0x3F)));
+            }
+            else if (codepoint < 0x10000) {
+                output.push_back(static_cast<char>(0xE0 | (codepoint >> 12)));
+                output.push_back(static_cast<char>(0x80 | ((codepoint >> 6) & 0x3F)));
+                output.push_back(static_cast<char>(0x80 | (codepoint & 0x3F)));
+            }
+            else {
+                output.push_back(static_cast<char>(0xF0 | (codepoint >> 18)));
+                output.push_back(static_cast<char>(0x80 | ((codepoint >> 12) & 0x3F)));
+                output.push_back(static_cast<char>(0x80 | ((codepoint >> 6) & 0x3F)));
+                output.push_back(static_cast<char>(0x80 | (codepoint & 0x3F)));
+            }
+        }
+
+        // Decodes the escape sequences in the text between the quotes of a string token.
+        static auto DecodeString(StringView rawText, std::string& output) -> bool
+        {
+            // An escape sequence never decodes to more bytes than itself, so this is the only allocation.
+            output.clear();
+            output.reserve(rawText.size());
+
+            const char* p    = rawText.data();
+            const char* pEnd = rawText.data() + rawText.size();
+            while (p != pEnd) {
+                const char* runEnd = std::find(p, pEnd, '\\');
+                output.append(p, runEnd);
+                if (runEnd == pEnd) {
+                    break;
+                }
+
+                p = runEnd + 1;
+                switch (*p++) {
+                case '"':
+                    output.push_back('"');
+                    break;
+                case '\\':
+                    output.push_back('\\');
+                    break;
+                case '/':
+                    output.push_back('/');
+                    break;
+                case 'b':
+                    output.push_back('\b');
+                    break;
+                case 'f':
+                    output.push_back('\f');
+                    break;
+                case 'n':
+                    output.push_back('\n');
+                    break;
+                case 'r':
+                    output.push_back('\r');
+                    break;
+                case 't':
+                    output.push_back('\t');
+                    break;
+                case 'u':
+                {
+                    uint32_t codepoint = 0;
+                    if (pEnd - p < 4 || !ParseHex4(p, codepoint)) {
+                        return false;
+                    }
+                    p += 4;
+
+                    if (codepoint >= 0xD800 && codepoint < 0xDC00) {
+                        // A high surrogate must be followed by a low surrogate.
+                        uint32_t lowSurrogate = 0;
+                        if (pEnd - p < 6 || p[0] != '\\' || p[1] != 'u' || !ParseHex4(p + 2, lowSurrogate) ||
+                            lowSurrogate < 0xDC00 || lowSurrogate >= 0xE000) {
+                            return false;
+                        }
+                        p += 6;
+
+                        codepoint = 0x10000 + ((codepoint - 0xD800) << 10) + (lowSurrogate - 0xDC00);
+                    }
+                    else if (codepoint >= 0xDC00 && codepoint < 0xE000) {
+                        return false;
+                    }
+
+                    AppendUtf8(output, codepoint);
+                    break;
+                }
+                default:
+                    return false;
+                }
+            }
+
+            return true;
+        }
+
+        // Scans a number token starting at the cursor. The token is validated when converted.
+        auto ScanNumber(StringView& numberText) -> bool
+        {
+            SkipWhitespace();
+            const char* begin = cursor;
+            cursor            = std::find_if_not(cursor, end, [](char ch) {
+                return (ch >= '0' && ch <= '9') || ch == '-' || ch == '+' || ch == '.' || ch == 'e' || ch == 'E';
+            });
+
+            numberText = StringView{begin, static_cast<size_t>(cursor - begin)};
+            return !numberText.empty();
+        }
+
+        template <typename F>
+        auto ReadObjectMembers(F& onMember) -> bool
+        {
+            if (TryConsume('}')) {
+                return true;
+            }
+
+            while (true) {
+                StringView key;
+                bool hasEscape;
+                if (!ScanString(key, hasEscape)) {
+                    return false;
+                }
+                if (hasEscape) {
+                    if (!DecodeString(key, keyBuffer)) {
+                        return false;
+                    }
+                    key = StringView{keyBuffer};
+                }
+
+                if (!TryConsume(':') || !onMember(key)) {
+                    return false;
+                }
+
+                if (TryConsume(',')) {
+                    continue;
+                }
+
+                return TryConsume('}');
+            }
+        }
+
+        template <typename F>
+        auto ReadArrayElements(F& onElement) -> bool
+        {
+            if (TryConsume(']')) {
+                return true;
+            }
+
+            while (true) {
+                if (!onElement()) {
+                    return false;
+                }
+
+                if (TryConsume(',')) {
+                    continue;
+                }
+
+                return TryConsume(']');
+            }
+        }
+
+    public:
+        explicit JsonReader(StringView text) : cursor(text.data()), end(text.data() + text.size())
+        {
+        }
+
+        // Returns the kind of the next value without consuming it.
+        auto PeekKind() -> JsonValueKind
+        {
+            SkipWhitespace();
+            if (cursor == end) {
+                return JsonValueKind::Invalid;
+            }
+
+            switch (*cursor) {
+            case 'n':
+                return JsonValueKind::Null;
+            case 't':
+            case 'f':
+                return JsonValueKind::Boolean;
+            case '"':
+                return JsonValueKind::String;
+            case '[':
+                return JsonValueKind::Array;
+            case '{':
+                return JsonValueKind::Object;
+            default:
+                if (*cursor == '-' || (*cursor >= '0' && *cursor <= '9')) {
+                    return JsonValueKind::Number;
+                }
+                return JsonValueKind::Invalid;
+            }
+        }
+
+        // Returns true if there's nothing but whitespace left.
+        auto IsEnd() -> bool
+        {
+            SkipWhitespace();
+            return cursor == end;
+        }
+
+        auto ReadNull() -> bool
+        {
+            return TryConsumeLiteral("null");
+        }
+
+        auto ReadBoolean(bool& value) -> bool
+        {
+            if (TryConsumeLiteral("true")) {
+                value = true;
+                return true;
+            }
+            else if (TryConsumeLiteral("false")) {
+                value = false;
+                return true;
+            }
+
+            return false;
+        }
+
+        // Reads a number without a fraction or an exponent that fits in T.
+        template <std::integral T>
+        auto ReadInteger(T& value) -> bool
+        {
+            StringView numberText;
+            if (!ScanNumber(numberText)) {
+                return false;
+            }
+
+            const char* numberEnd = numberText.data() + numberText.size();
+            auto [ptr, ec]        = std::from_chars(numberText.data(), numberEnd, value);
+            return ec == std::errc{} && ptr == numberEnd;
+        }
+
+        template <std::floating_point T>
+        auto ReadFloat(T& value) -> bool
+        {
+            StringView numberText;
+            if (!ScanNumber(numberText)) {
+                return false;
+            }
+
+            const char* numberEnd = numberText.data() + numberText.size();
+            auto [ptr, ec]        = std::from_chars(numberText.data(), numberEnd, value);
+            return ec == std::errc{} && ptr == numberEnd;
+        }
+
+        // Reads a string into `value`, which is allocated at most once.
+        auto ReadString(std::string& value) -> bool
+        {
+            StringView rawText;
+            bool hasEscape;
+            if (!ScanString(rawText, hasEscape)) {
+                return false;
+            }
+
+            if (hasEscape) {
+                return DecodeString(rawText, value);
+            }
+
+            value.assign(rawText.data(), rawText.size());
+            return true;
+        }
+
+        // Reads an object, invoking `onMember(StringView key) -> bool` for each member. The callback must consume
+        // exactly one value. The key is only valid until the value is consumed.
+        template <typename F>
+        auto ReadObject(F&& onMember) -> bool
+        {
+            if (depth >= MaxDepth || !TryConsume('{')) {
+                return false;
+            }
+
+            depth += 1;
+            bool result = ReadObjectMembers(onMember);
+            depth -= 1;
+            return result;
+        }
+
+        // Reads an array, invoking `onElement() -> bool` for each element. The callback must consume exactly one
+        // value.
+        template <typename F>
+        auto ReadArray(F&& onElement) -> bool
+        {
+            if (depth >= MaxDepth || !TryConsume('[')) {
+                return false;
+            }
+
+            depth += 1;
+            bool result = ReadArrayElements(onElement);
+            depth -= 1;
+            return result;
+        }
+
+        // Consumes a value of any kind.
+        auto SkipValue() -> bool
+        {
+            StringView text;
+            bool hasEscape;
+            switch (PeekKind()) {
+            case JsonValueKind::Null:
+                return ReadNull();
+            case JsonValueKind::Boolean:
+            {
+                bool value;
+                return ReadBoolean(value);
+            }
+            case JsonValueKind::Number:
+                return ScanNumber(text);
+            case JsonValueKind::String:
+                return ScanString(text, hasEscape);
+            case JsonValueKind::Array:
+                return ReadArray([this] { return SkipValue(); });
+            case JsonValueKind::Object:
+                return ReadObject([this](StringView) { return SkipValue(); });
+            default:
+                return false;
+            }
+        }
+
+        // Consumes a value of any kind and returns its text.
+        auto ReadRawValue(StringView& value) -> bool
+        {
+            SkipWhitespace();
+            const char* begin = cursor;
+            if (!SkipValue()) {
+                return false;
+            }
+
+            value = StringView{begin, static_cast<size_t>(cursor - begin)};
+            return true;
+        }
+    };
+} // namespace glsld
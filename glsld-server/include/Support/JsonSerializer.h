@@ -1,16 +1,43 @@
 #pragma once
+#include "JsonReader.h"
+#include "JsonWriter.h"
 #include "SerializerUtils.h"
 
 #include <boost/pfr.hpp>
 #include <magic_enum/magic_enum.hpp>
 #include <nlohmann/json.hpp>
 
+#include <algorithm>
+#include <array>
 #include <optional>
 #include <cstddef>
 #include <type_traits>
 
 namespace glsld
 {
+    // Optional fields of a reflected struct are omitted when empty, instead of being serialized as null. In the LSP
+    // spec, an optional property `field?: T` may be absent but not null, and some clients reject a null where a value
+    // of the declared type is expected. A property that is required but nullable, i.e. `field: T | null`, is modeled
+    // with `Nullable` instead for this reason. A top-level `std::optional`, e.g. the result of a request, is
+    // still serialized as null.
+    template <typename T>
+    inline constexpr bool IsOptionalField = false;
+    template <typename T>
+    inline constexpr bool IsOptionalField<std::optional<T>> = true;
+
+    // The key token `"name":` of a reflected field, formatted at compile time so that it's written with a single
+    // append.
+    template <typename T, size_t I>
+    inline constexpr auto JsonFieldKey = [] {
+        constexpr std::string_view name = boost::pfr::get_name<I, T>();
+        std::array<char, name.size() + 3> result = {};
+        result[0]                                = '"';
+        std::ranges::copy(name, result.begin() + 1);
+        result[name.size() + 1] = '"';
+        result[name.size() + 2] = ':';
+        return result;
+    }();
+
     template <typename T>
     struct JsonSerializer
     {
@@ -21,13 +48,37 @@ namespace glsld
         {
             nlohmann::json j = nlohmann::json::object();
             boost::pfr::for_each_field(data, [&j]<size_t I>(const auto& field, std::integral_constant<size_t, I>) {
-                using FieldType                 = std::decay_t<decltype(field)>;
+                using FieldType = std::decay_t<decltype(field)>;
+                if constexpr (IsOptionalField<FieldType>) {
+                    if (!field) {
+                        return;
+                    }
+                }
+
                 j[boost::pfr::get_name<I, T>()] = JsonSerializer<FieldType>::Serialize(field);
             });
 
             return j;
         }
 
+        static auto Serialize(const T& data, JsonWriter& writer) -> void
+        {
+            writer.BeginObject();
+            boost::pfr::for_each_field(data, [&writer]<size_t I>(const auto& field, std::integral_constant<size_t, I>) {
+                using FieldType = std::decay_t<decltype(field)>;
+                if constexpr (IsOptionalField<FieldType>) {
+                    if (!field) {
+                        return;
+                    }
+                }
+
+                constexpr const auto& key = JsonFieldKey<T, I>;
+                writer.WritePreEscapedKey(StringView{key.data(), key.size()});
+                JsonSerializer<FieldType>::Serialize(field, writer);
+            });
+            writer.EndObject();
+        }
+
         static auto Deserialize(T& data, const nlohmann::json& j) -> bool
         {
             if (!j.is_object()) {
@@ -50,6 +101,24 @@ namespace glsld
 
             return result;
         }
+
+        static auto Deserialize(T& data, JsonReader& reader) -> bool
+        {
+            return reader.ReadObject([&data, &reader](StringView key) {
+                bool matched = false;
+                bool result  = true;
+                boost::pfr::for_each_field(data, [&]<size_t I>(auto& field, std::integral_constant<size_t, I>) {
+                    using FieldType = std::decay_t<decltype(field)>;
+                    if (!matched && key == StringView{boost::pfr::get_name<I, T>()}) {
+                        matched = true;
+                        result  = JsonSerializer<FieldType>::Deserialize(field, reader);
+                    }
+                });
+
+                // Unknown fields are ignored
+                return matched ? result : reader.SkipValue();
+            });
+        }
     };
 
     template <std::integral T>
@@ -60,6 +129,11 @@ namespace glsld
             return data;
         }
 
+        static auto Serialize(const T& data, JsonWriter& writer) -> void
+        {
+            writer.WriteInteger(data);
+        }
+
         static auto Deserialize(T& data, const nlohmann::json& j) -> bool
         {
             if constexpr (std::is_signed_v<T>) {
@@ -76,6 +150,11 @@ namespace glsld
             data = j.get<T>();
             return true;
         }
+
+        static auto Deserialize(T& data, JsonReader& reader) -> bool
+        {
+            return reader.ReadInteger(data);
+        }
     };
 
     template <std::floating_point T>
@@ -86,6 +165,11 @@ namespace glsld
             return data;
         }
 
+        static auto Serialize(const T& data, JsonWriter& writer) -> void
+        {
+            writer.WriteFloat(data);
+        }
+
         static auto Deserialize(T& data, const nlohmann::json& j) -> bool
         {
             if (!j.is_number_float()) {
@@ -95,6 +179,11 @@ namespace glsld
             data = j.get<T>();
             return true;
         }
+
+        static auto Deserialize(T& data, JsonReader& reader) -> bool
+        {
+            return reader.ReadFloat(data);
+        }
     };
 
     template <typename T>
@@ -106,6 +195,11 @@ namespace glsld
             return static_cast<std::underlying_type_t<T>>(data);
         }
 
+        static auto Serialize(const T& data, JsonWriter& writer) -> void
+        {
+            writer.WriteInteger(static_cast<std::underlying_type_t<T>>(data));
+        }
+
         static auto Deserialize(T& data, const nlohmann::json& j) -> bool
         {
             if (!j.is_number_integer()) {
@@ -121,6 +215,21 @@ namespace glsld
 
             return true;
         }
+
+        static auto Deserialize(T& data, JsonReader& reader) -> bool
+        {
+            std::underlying_type_t<T> value;
+            if (!reader.ReadInteger(value)) {
+                return false;
+            }
+
+            if (auto result = magic_enum::enum_cast<T>(value)) {
+                data = result.value();
+                return true;
+            }
+
+            return false;
+        }
     };
 
     template <typename T>
@@ -131,6 +240,11 @@ namespace glsld
             return magic_enum::enum_name(data.value);
         }
 
+        static auto Serialize(const StringEnum<T>& data, JsonWriter& writer) -> void
+        {
+            writer.WriteString(magic_enum::enum_name(data.value));
+        }
+
         static auto Deserialize(StringEnum<T>& data, const nlohmann::json& j) -> bool
         {
             if (!j.is_string()) {
@@ -146,6 +260,21 @@ namespace glsld
 
             return true;
         }
+
+        static auto Deserialize(StringEnum<T>& data, JsonReader& reader) -> bool
+        {
+            std::string name;
+            if (!reader.ReadString(name)) {
+                return false;
+            }
+
+            if (auto result = magic_enum::enum_cast<T>(name)) {
+                data.value = result.value();
+                return true;
+            }
+
+            return false;
+        }
     };
 
     template <>
@@ -156,6 +285,11 @@ namespace glsld
             return nullptr;
         }
 
+        static auto Serialize(const std::nullptr_t&, JsonWriter& writer) -> void
+        {
+            writer.WriteNull();
+        }
+
         static auto Deserialize(std::nullptr_t& data, const nlohmann::json& j) -> bool
         {
             if (!j.is_null()) {
@@ -165,6 +299,12 @@ namespace glsld
             data = nullptr;
             return true;
         }
+
+        static auto Deserialize(std::nullptr_t& data, JsonReader& reader) -> bool
+        {
+            data = nullptr;
+            return reader.ReadNull();
+        }
     };
 
     template <>
@@ -175,6 +315,11 @@ namespace glsld
             return data;
         }
 
+        static auto Serialize(const bool& data, JsonWriter& writer) -> void
+        {
+            writer.WriteBoolean(data);
+        }
+
         static auto Deserialize(bool& data, const nlohmann::json& j) -> bool
         {
             if (!j.is_boolean()) {
@@ -184,6 +329,11 @@ namespace glsld
             data = j.get<bool>();
             return true;
         }
+
+        static auto Deserialize(bool& data, JsonReader& reader) -> bool
+        {
+            return reader.ReadBoolean(data);
+        }
     };
 
     template <>
@@ -194,6 +344,11 @@ namespace glsld
             return data;
         }
 
+        static auto Serialize(const std::string& data, JsonWriter& writer) -> void
+        {
+            writer.WriteString(StringView{data});
+        }
+
         static auto Deserialize(std::string& data, const nlohmann::json& j) -> bool
         {
             if (!j.is_string()) {
@@ -203,6 +358,11 @@ namespace glsld
             data = j.get<std::string>();
             return true;
         }
+
+        static auto Deserialize(std::string& data, JsonReader& reader) -> bool
+        {
+            return reader.ReadString(data);
+        }
     };
 
     template <typename T>
@@ -217,6 +377,16 @@ namespace glsld
             return JsonSerializer<T>::Serialize(*data);
         }
 
+        static auto Serialize(const std::optional<T>& data, JsonWriter& writer) -> void
+        {
+            if (!data) {
+                writer.WriteNull();
+                return;
+            }
+
+            JsonSerializer<T>::Serialize(*data, writer);
+        }
+
         static auto Deserialize(std::optional<T>& data, const nlohmann::json& j) -> bool
         {
             if (j.is_null()) {
@@ -232,6 +402,40 @@ namespace glsld
             data = std::move(value);
             return true;
         }
+
+        static auto Deserialize(std::optional<T>& data, JsonReader& reader) -> bool
+        {
+            if (reader.PeekKind() == JsonValueKind::Null) {
+                data = std::nullopt;
+                return reader.ReadNull();
+            }
+
+            return JsonSerializer<T>::Deserialize(data.emplace(), reader);
+        }
+    };
+
+    template <typename T>
+    struct JsonSerializer<Nullable<T>>
+    {
+        static auto Serialize(const Nullable<T>& data) -> nlohmann::json
+        {
+            return JsonSerializer<std::optional<T>>::Serialize(data.value);
+        }
+
+        static auto Serialize(const Nullable<T>& data, JsonWriter& writer) -> void
+        {
+            JsonSerializer<std::optional<T>>::Serialize(data.value, writer);
+        }
+
+        static auto Deserialize(Nullable<T>& data, const nlohmann::json& j) -> bool
+        {
+            return JsonSerializer<std::optional<T>>::Deserialize(data.value, j);
+        }
+
+        static auto Deserialize(Nullable<T>& data, JsonReader& reader) -> bool
+        {
+            return JsonSerializer<std::optional<T>>::Deserialize(data.value, reader);
+        }
     };
 
     template <typename T>
@@ -247,6 +451,21 @@ namespace glsld
             return jarray;
         }
 
+        static auto Serialize(const std::vector<T>& data, JsonWriter& writer) -> void
+        {
+            if constexpr (std::is_integral_v<T> && !std::is_same_v<T, bool>) {
+                // Large integer arrays such as semantic tokens are written in a single pass.
+                writer.WriteIntegerArray(std::span<const T>{data});
+            }
+            else {
+                writer.BeginArray();
+                for (const auto& elem : data) {
+                    JsonSerializer<T>::Serialize(elem, writer);
+                }
+                writer.EndArray();
+            }
+        }
+
         static auto Deserialize(std::vector<T>& data, const nlohmann::json& j) -> bool
         {
             if (!j.is_array()) {
@@ -265,6 +484,13 @@ namespace glsld
 
             return true;
         }
+
+        static auto Deserialize(std::vector<T>& data, JsonReader& reader) -> bool
+        {
+            data.clear();
+            return reader.ReadArray(
+                [&data, &reader] { return JsonSerializer<T>::Deserialize(data.emplace_back(), reader); });
+        }
     };
 
     template <typename T>
@@ -282,10 +508,33 @@ namespace glsld
             return data.Serialize();
         }
 
+        static auto Serialize(const T& data, JsonWriter& writer) -> void
+        {
+            if constexpr (requires { data.Serialize(writer); }) {
+                data.Serialize(writer);
+            }
+            else {
+                // User-defined types without a direct serialization are written through a DOM of their own value.
+                writer.WriteRawValue(StringView{data.Serialize().dump()});
+            }
+        }
+
         static auto Deserialize(T& data, const nlohmann::json& j) -> bool
         {
             return data.Deserialize(j);
         }
+
+        static auto Deserialize(T& data, JsonReader& reader) -> bool
+        {
+            // User-defined types only know how to deserialize from a DOM, so one is built for this value alone.
+            StringView rawValue;
+            if (!reader.ReadRawValue(rawValue)) {
+                return false;
+            }
+
+            auto j = nlohmann::json::parse(rawValue.StdStrView(), nullptr, false);
+            return !j.is_discarded() && data.Deserialize(j);
+        }
     };
 
 } // namespace glsld
\ No newline at end of file
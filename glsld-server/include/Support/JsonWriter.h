@@ -0,0 +1,231 @@
+#pragma once
+#include "Support/StringView.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <concepts>
+#include <span>
+#include <string>
+
+namespace glsld
+{
+    // A JSON writer that emits text straight into a reusable buffer, which lets a serializer write its source
+    // directly without building a DOM. Separators are inserted automatically, so the caller only needs to write keys
+    // and values in order.
+    class JsonWriter
+    {
+    private:
+        // When reset, a buffer that has grown beyond this size is released instead of being reused.
+        static constexpr size_t MaxRetainedCapacity = 1024 * 1024;
+
+        std::string buffer;
+
+        // Whether a comma is needed before the next key or value.
+        bool needsComma = false;
+
+        auto WriteSeparator() -> void
+        {
+            if (needsComma) {
+                buffer.push_back(',');
+            }
+        }
+
+        template <typename T>
+        auto AppendNumber(T value) -> void
+        {
+            char text[32];
+            auto [ptr, ec] = std::to_chars(text, text + sizeof(text), value);
+            buffer.append(text, ptr);
+        }
+
+    public:
+        // Clears the buffer for a new document.
+        auto Reset() -> void
+        {
+            if (buffer.capacity() > MaxRetainedCapacity) {
+                buffer = std::string{};
+            }
+            else {
+                buffer.clear();
+            }
+            needsComma = false;
+        }
+
+        auto GetText() const -> StringView
+        {
+            return StringView{buffer};
+        }
+
+        // Moves the text out and clears the writer for a new document. The buffer is reserved again for a document of
+        // the same size, so the next one is written without regrowing.
+        auto TakeText() -> std::string
+        {
+            auto result = std::move(buffer);
+            buffer      = std::string{};
+            buffer.reserve(std::min(result.size(), MaxRetainedCapacity));
+            needsComma = false;
+            return result;
+        }
+
+        auto BeginObject() -> void
+        {
+            WriteSeparator();
+            buffer.push_back('{');
+            needsComma = false;
+        }
+
+        auto EndObject() -> void
+        {
+            buffer.push_back('}');
+            needsComma = true;
+        }
+
+        auto BeginArray() -> void
+        {
+            WriteSeparator();
+            buffer.push_back('[');
+            needsComma = false;
+        }
+
+        auto EndArray() -> void
+        {
+            buffer.push_back(']');
+            needsComma = true;
+        }
+
+        // Writes an object key that doesn't contain characters that need escaping.
+        auto WriteKey(StringView key) -> void
+        {
+            WriteSeparator();
+            buffer.push_back('"');
+            buffer.append(key.StdStrView());
+            buffer.append("\":");
+            needsComma = false;
+        }
+
+        // Writes an object key that is already formatted as `"key":`.
+        auto WritePreEscapedKey(StringView keyToken) -> void
+        {
+            WriteSeparator();
+            buffer.append(keyToken.StdStrView());
+            needsComma = false;
+        }
+
+        auto WriteNull() -> void
+        {
+            WriteSeparator();
+            buffer.append("null");
+            needsComma = true;
+        }
+
+        auto WriteBoolean(bool value) -> void
+        {
+            WriteSeparator();
+            buffer.append(value ? "true" : "false");
+            needsComma = true;
+        }
+
+        template <std::integral T>
+        auto WriteInteger(T value) -> void
+        {
+            WriteSeparator();
+            AppendNumber(value);
+            needsComma = true;
+        }
+
+        template <std::floating_point T>
+        auto WriteFloat(T value) -> void
+        {
+            if (!std::isfinite(value)) {
+                // JSON has no representation of infinity or NaN.
+                WriteNull();
+                return;
+            }
+
+            WriteSeparator();
+            AppendNumber(value);
+            needsComma = true;
+        }
+
+        // Writes an array of integers in a single pass.
+        template <std::integral T>
+        auto WriteIntegerArray(std::span<const T> values) -> void
+        {
+            WriteSeparator();
+            buffer.push_back('[');
+            for (size_t i = 0; i < values.size(); ++i) {
+                if (i != 0) {
+                    buffer.push_back(',');
+                }
+                AppendNumber(values[i]);
+            }
+            buffer.push_back(']');
+            needsComma = true;
+        }
+
+        auto WriteString(StringView value) -> void
+        {
+            WriteSeparator();
+            buffer.push_back('"');
+
+            const char* p   = value.data();
+            const char* end = value.data() + value.size();
+            while (p != end) {
+                const char* runEnd = std::find_if(p, end, [](char ch) {
+                    return static_cast<unsigned char>(ch) < 0x20 || ch == '"' || ch == '\\';
+                });
+                buffer.append(p, runEnd);
+                if (runEnd == end) {
+                    break;
+                }
+
+                switch (*runEnd) {
+                case '"':
+                    buffer.append("\\\"");
+                    break;
+                case '\\':
+                    buffer.append("\\\\");
+                    break;
+                case '\b':
+                    buffer.append("\\b");
+                    break;
+                case '\f':
+                    buffer.append("\\f");
+                    break;
+                case '\n':
+                    buffer.append("\\n");
+                    break;
+                case '\r':
+                    buffer.append("\\r");
+                    break;
+                case '\t':
+                    buffer.append("\\t");
+                    break;
+                default:
+                {
+                    constexpr const char* hexDigits = "0123456789abcdef";
+                    auto ch                         = static_cast<unsigned char>(*runEnd);
+                    buffer.append("\\u00");
+                    buffer.push_back(hexDigits[ch >> 4]);
+                    buffer.push_back(hexDigits[ch & 0xF]);
+                    break;
+                }
+                }
+
+                p = runEnd + 1;
+            }
+
+            buffer.push_back('"');
+            needsComma = true;
+        }
+
+        // Writes a value that is already formatted as JSON.
+        auto WriteRawValue(StringView value) -> void
+        {
+            WriteSeparator();
+            buffer.append(value.StdStrView());
+            needsComma = true;
+        }
+    };
+} // namespace glsld
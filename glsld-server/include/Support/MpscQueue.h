@@ -0,0 +1,62 @@
+#pragma once
+
+#include "Support/IntrusiveQueue.h"
+
+#include <atomic>
+
+namespace glsld
+{
+    // A lock-free multi-producer single-consumer queue of intrusive nodes. Producers push with a single CAS, and the
+    // consumer takes all nodes at once, which suits draining in batches. Since nodes are never popped one by one,
+    // there's no ABA problem.
+    template <typename T, T* T::* NextPtr = &T::next>
+    class MpscQueue
+    {
+    private:
+        // The most recently pushed node, linked to the previous ones.
+        std::atomic<T*> head = nullptr;
+
+    public:
+        MpscQueue() = default;
+
+        MpscQueue(const MpscQueue&)            = delete;
+        MpscQueue& operator=(const MpscQueue&) = delete;
+
+        auto empty() const noexcept -> bool
+        {
+            return head.load(std::memory_order_relaxed) == nullptr;
+        }
+
+        // This function is thread-safe.
+        auto push(T* value) noexcept -> void
+        {
+            T* oldHead = head.load(std::memory_order_relaxed);
+            do {
+                value->*NextPtr = oldHead;
+            } while (!head.compare_exchange_weak(oldHead, value, std::memory_order_release, std::memory_order_relaxed));
+        }
+
+        // Takes all nodes in the order they were pushed. Only the consumer may call this.
+        auto pop_all() noexcept -> IntrusiveQueue<T, NextPtr>
+        {
+            // Nodes are linked from the newest, so reverse them first.
+            T* node     = head.exchange(nullptr, std::memory_order_acquire);
+            T* reversed = nullptr;
+            while (node) {
+                T* next         = node->*NextPtr;
+                node->*NextPtr  = reversed;
+                reversed        = node;
+                node            = next;
+            }
+
+            IntrusiveQueue<T, NextPtr> result;
+            while (reversed) {
+                T* next = reversed->*NextPtr;
+                result.push(reversed);
+                reversed = next;
+            }
+
+            return result;
+        }
+    };
+} // namespace glsld
@@ -1,5 +1,7 @@
 #pragma once
+#include <optional>
 #include <type_traits>
+#include <utility>
 
 namespace glsld
 {
@@ -19,4 +21,22 @@ namespace glsld
             return value;
         }
     };
+
+    // A required property that may be null, i.e. `field: T | null` in the LSP spec. Unlike an empty `std::optional`
+    // field, which is omitted, an empty value is serialized as null.
+    template <typename T>
+    struct Nullable
+    {
+        std::optional<T> value;
+
+        Nullable() = default;
+        Nullable(std::nullopt_t)
+        {
+        }
+        Nullable(T value) : value(std::move(value))
+        {
+        }
+
+        auto operator==(const Nullable& other) const -> bool = default;
+    };
 } // namespace glsld
\ No newline at end of file
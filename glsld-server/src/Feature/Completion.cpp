@@ -2,6 +2,9 @@
 #include "Server/LanguageQueryVisitor.h"
 #include "Support/SourceText.h"
 
+#include <algorithm>
+#include <array>
+#include <cctype>
 #include <unordered_set>
 
 // FIXME: Currently, this is implemented as:
@@ -263,57 +266,128 @@ namespace glsld
         }
     }
 
-    class CompletionCollector : public LanguageQueryVisitor<CompletionCollector>
+    enum class CompletionMatch
+    {
+        None,
+        Prefix,
+        Subsequence,
+    };
+
+    static auto ToLowerChar(char ch) -> char
+    {
+        return static_cast<char>(std::tolower(static_cast<unsigned char>(ch)));
+    }
+    static auto ToUpperChar(char ch) -> char
+    {
+        return static_cast<char>(std::toupper(static_cast<unsigned char>(ch)));
+    }
+
+    // Matches a label against the identifier being typed, ignoring case. A label matches if it starts with the first
+    // character of `pattern`, and the rest of the characters of `pattern` appear in it in order. e.g. "v4" and "Vec"
+    // both match "vec4", but "ec" doesn't. Anchoring the first character allows the sorted indices to be narrowed by
+    // binary search, see `LookupCompletionCandidates`.
+    static auto MatchCompletionLabel(StringView label, StringView pattern) -> CompletionMatch
+    {
+        if (!pattern.empty() && (label.empty() || ToLowerChar(label[0]) != ToLowerChar(pattern[0]))) {
+            return CompletionMatch::None;
+        }
+
+        size_t patternIndex = 0;
+        bool isPrefix       = true;
+        for (char ch : label) {
+            if (patternIndex == pattern.size()) {
+                break;
+            }
+            if (ToLowerChar(ch) == ToLowerChar(pattern[patternIndex])) {
+                patternIndex += 1;
+            }
+            else {
+                isPrefix = false;
+            }
+        }
+
+        if (patternIndex != pattern.size()) {
+            return CompletionMatch::None;
+        }
+        return isPrefix ? CompletionMatch::Prefix : CompletionMatch::Subsequence;
+    }
+
+    static auto IsCompletionMatch(StringView label, StringView pattern) -> bool
+    {
+        return MatchCompletionLabel(label, pattern) != CompletionMatch::None;
+    }
+
+    // Collects the declarations in the user file that are visible at the cursor. Instead of traversing the whole AST,
+    // only the global declarations and the nodes enclosing the cursor are looked into, using the position index.
+    class CompletionCollector
     {
     private:
         std::vector<lsp::CompletionItem>& output;
+        const LanguageQueryInfo& info;
         CompletionTypeResult completionType;
         TextPosition cursorPosition;
 
+        // Only symbols matching this pattern are collected
+        StringView pattern;
+
         std::unordered_map<AtomString, size_t> itemIndexMap;
 
     public:
         CompletionCollector(std::vector<lsp::CompletionItem>& output, const LanguageQueryInfo& info,
-                            CompletionTypeResult completionType, TextPosition cursorPosition)
-            : LanguageQueryVisitor(info), output(output), completionType(completionType), cursorPosition(cursorPosition)
+                            CompletionTypeResult completionType, TextPosition cursorPosition, StringView pattern)
+            : output(output), info(info), completionType(completionType), cursorPosition(cursorPosition),
+              pattern(pattern)
         {
         }
 
-        auto EnterAstNode(const AstNode& node) -> AstVisitPolicy GLSLD_AST_VISITOR_OVERRIDE
+        auto Collect() -> void
         {
-            if (node.Is<AstTranslationUnit>()) {
-                return AstVisitPolicy::Traverse;
+            for (auto decl : info.GetUserFileAst().GetGlobalDecls()) {
+                CollectFromDecl(*decl);
+            }
+
+            auto tokenID = info.LookupTokenIDByPosition(cursorPosition);
+            if (!tokenID) {
+                return;
             }
-            else if (auto decl = node.As<AstDecl>()) {
-                if (decl->Is<AstFunctionDecl>() && GetInfo().ContainsPosition(*decl, cursorPosition)) {
-                    return AstVisitPolicy::Traverse;
+
+            // Local declarations are visible if they are in an enclosing scope and precede the cursor
+            auto precedesCursor = [this](const AstNode& node) {
+                return info.LookupExpandedTextRange(node).end <= cursorPosition;
+            };
+            for (auto entry = info.LookupInnermostNode(*tokenID); entry; entry = info.LookupParentNode(*entry)) {
+                if (auto funcDecl = entry->node->As<AstFunctionDecl>()) {
+                    for (auto paramDecl : funcDecl->GetParams()) {
+                        CollectFromDecl(*paramDecl);
+                    }
                 }
-                else {
-                    return AstVisitPolicy::Visit;
+                else if (auto forStmt = entry->node->As<AstForStmt>()) {
+                    if (auto declStmt = forStmt->GetInitStmt() ? forStmt->GetInitStmt()->As<AstDeclStmt>() : nullptr;
+                        declStmt && precedesCursor(*declStmt)) {
+                        CollectFromDecl(*declStmt->GetDecl());
+                    }
                 }
-            }
-            else if (auto stmt = node.As<AstStmt>()) {
-                if (stmt->Is<AstCompoundStmt>() && GetInfo().PrecedesPosition(*stmt, cursorPosition)) {
-                    return AstVisitPolicy::Leave;
+                else if (auto compoundStmt = entry->node->As<AstCompoundStmt>()) {
+                    for (auto stmt : compoundStmt->GetChildren()) {
+                        if (!precedesCursor(*stmt)) {
+                            break;
+                        }
+                        if (auto declStmt = stmt->As<AstDeclStmt>()) {
+                            CollectFromDecl(*declStmt->GetDecl());
+                        }
+                    }
                 }
-
-                return AstVisitPolicy::Traverse;
-            }
-            else {
-                return AstVisitPolicy::Leave;
             }
         }
 
-        auto VisitAstNode(const AstNode& node) -> void GLSLD_AST_VISITOR_OVERRIDE
+    private:
+        auto CollectFromDecl(const AstDecl& decl) -> void
         {
-            if (auto decl = node.As<AstDecl>()) {
-                CollectCompletionFromDecl([this](const AstSyntaxToken& token,
-                                                 lsp::CompletionItemKind kind) { TryAddCompletionItem(token, kind); },
-                                          *decl);
-            }
+            CollectCompletionFromDecl([this](const AstSyntaxToken& token,
+                                             lsp::CompletionItemKind kind) { TryAddCompletionItem(token, kind); },
+                                      decl);
         }
 
-    private:
         auto TryAddCompletionItem(const AstSyntaxToken& declTok, lsp::CompletionItemKind kind) -> void
         {
             switch (kind) {
@@ -343,7 +417,7 @@ namespace glsld
                 return;
             }
 
-            if (declTok.IsIdentifier()) {
+            if (declTok.IsIdentifier() && IsCompletionMatch(declTok.text.StrView(), pattern)) {
                 if (auto it = itemIndexMap.find(declTok.text); it != itemIndexMap.end()) {
                     output[it->second].kind = kind;
                 }
@@ -358,41 +432,136 @@ namespace glsld
         }
     };
 
-    auto ComputeKeywordCompletionItems() -> std::vector<lsp::CompletionItem>
+    static auto SortCompletionIndex(std::vector<CompletionIndexEntry>& index) -> void
     {
-        std::vector<lsp::CompletionItem> result;
-        result.reserve(GetAllKeywords().size());
-        for (auto [_, keywordText] : GetAllKeywords()) {
-            result.push_back(lsp::CompletionItem{
-                .label = std::string{keywordText},
-                .kind  = lsp::CompletionItemKind::Keyword,
-            });
+        std::ranges::stable_sort(index, {}, [](const CompletionIndexEntry& entry) { return StringView{entry.label}; });
+    }
+
+    // Returns the entries with the specified label.
+    static auto LookupCompletionIndex(ArrayView<CompletionIndexEntry> index, StringView label)
+        -> ArrayView<CompletionIndexEntry>
+    {
+        auto [itBegin, itEnd] = std::ranges::equal_range(
+            index, label, {}, [](const CompletionIndexEntry& entry) { return StringView{entry.label}; });
+        return {itBegin, itEnd};
+    }
+
+    // Returns the items of a sorted index that may match the pattern, which are the ones starting with the first
+    // character of the pattern in either case. See `MatchCompletionLabel`.
+    template <typename T, typename Proj>
+    static auto LookupCompletionCandidates(ArrayView<T> index, StringView pattern, Proj projection)
+        -> std::array<ArrayView<T>, 2>
+    {
+        if (pattern.empty()) {
+            return {index, ArrayView<T>{}};
         }
 
-        return result;
+        auto lookupInitial = [&](char initial) -> ArrayView<T> {
+            // Identifiers are ASCII, so the next character doesn't overflow.
+            char nextInitial = initial + 1;
+            auto itBegin     = std::ranges::lower_bound(index, StringView{&initial, 1}, {}, projection);
+            auto itEnd = std::ranges::lower_bound(itBegin, index.end(), StringView{&nextInitial, 1}, {}, projection);
+            return {itBegin, itEnd};
+        };
+
+        auto lowerInitial = ToLowerChar(pattern[0]);
+        auto upperInitial = ToUpperChar(pattern[0]);
+        return {lookupInitial(lowerInitial),
+                lowerInitial != upperInitial ? lookupInitial(upperInitial) : ArrayView<T>{}};
     }
 
-    auto ComputePreambleCompletionItems(const PrecompiledPreamble& preamble) -> std::vector<lsp::CompletionItem>
+    static auto GetKeywordCompletionIndex() -> ArrayView<CompletionIndexEntry>
     {
-        std::vector<lsp::CompletionItem> result;
+        static const std::vector<CompletionIndexEntry> keywordIndex = [] {
+            std::vector<CompletionIndexEntry> result;
+            result.reserve(GetAllKeywords().size());
+            for (auto [_, keywordText] : GetAllKeywords()) {
+                result.push_back(CompletionIndexEntry{
+                    .label = std::string{keywordText},
+                    .kind  = lsp::CompletionItemKind::Keyword,
+                });
+            }
+
+            SortCompletionIndex(result);
+            return result;
+        }();
+
+        return keywordIndex;
+    }
+
+    static auto ComputePreambleCompletionIndex(const PrecompiledPreamble& preamble) -> std::vector<CompletionIndexEntry>
+    {
+        std::vector<CompletionIndexEntry> result;
         std::unordered_set<AtomString> seenIds;
-        for (const AstDecl* decl : preamble.GetSystemPreambleArtifacts().GetAst()->GetGlobalDecls()) {
-            CollectCompletionFromDecl(
-                [&](const AstSyntaxToken& declTok, lsp::CompletionItemKind kind) {
-                    if (seenIds.find(declTok.text) == seenIds.end()) {
-                        seenIds.insert(declTok.text);
-                        result.push_back(lsp::CompletionItem{
-                            .label = declTok.text.Str(),
-                            .kind  = kind,
-                        });
-                    }
-                },
-                *decl);
+        // The user preamble holds the stdlib segment of the shader stage, if any.
+        for (const CompilerArtifact* artifact :
+             {&preamble.GetSystemPreambleArtifacts(), &preamble.GetUserPreambleArtifacts()}) {
+            if (!artifact->GetAst()) {
+                continue;
+            }
+
+            for (const AstDecl* decl : artifact->GetAst()->GetGlobalDecls()) {
+                CollectCompletionFromDecl(
+                    [&](const AstSyntaxToken& declTok, lsp::CompletionItemKind kind) {
+                        if (seenIds.find(declTok.text) == seenIds.end()) {
+                            seenIds.insert(declTok.text);
+                            result.push_back(CompletionIndexEntry{
+                                .label = declTok.text.Str(),
+                                .kind  = kind,
+                                .decl  = decl,
+                            });
+                        }
+                    },
+                    *decl);
+            }
         }
 
+        SortCompletionIndex(result);
         return result;
     }
 
+    static auto UpdatePreambleCompletionIndex(const LanguageQueryInfo& queryInfo, CompletionState& state) -> void
+    {
+        if (queryInfo.GetCompilerResult().GetPreamble() != state.preamble) {
+            // Recompute the cached completion index if the preamble has changed
+            state.preamble                = queryInfo.GetCompilerResult().GetPreamble();
+            state.preambleCompletionIndex = ComputePreambleCompletionIndex(*state.preamble);
+        }
+    }
+
+    // Returns the part of the identifier before the cursor, if the cursor is at the end or in the middle of one.
+    // e.g. "ve" for "ve^c4".
+    static auto GetCompletionPrefix(const LanguageQueryInfo& queryInfo, TextPosition cursorPosition) -> StringView
+    {
+        auto tokID = queryInfo.LookupTokenIDByPosition(cursorPosition);
+        if (!tokID) {
+            return {};
+        }
+
+        // The token found starts at or before the cursor. If it starts at the cursor, the identifier being typed is the
+        // previous one, e.g. "vec^(".
+        if (queryInfo.LookupToken(*tokID)->expandedRange.start == cursorPosition) {
+            if (tokID->GetTokenIndex() == 0) {
+                return {};
+            }
+
+            tokID = *tokID - 1;
+        }
+
+        // Tokens from macro expansion or included files don't have meaningful text before the cursor.
+        const RawSyntaxToken* token = queryInfo.LookupToken(*tokID);
+        if (!IsIdentifierLikeToken(token->klass) || token->spelledRange != token->expandedRange) {
+            return {};
+        }
+
+        const auto& range = token->expandedRange;
+        if (range.start.line != cursorPosition.line || !(range.start < cursorPosition && cursorPosition <= range.end)) {
+            return {};
+        }
+
+        return token->text.StrView().Take(cursorPosition.character - range.start.character);
+    }
+
     auto GetCompletionOptions(const CompletionConfig& config) -> std::optional<lsp::CompletionOptions>
     {
         if (!config.enable) {
@@ -401,6 +570,7 @@ namespace glsld
 
         return lsp::CompletionOptions{
             .triggerCharacters = {"."},
+            .resolveProvider   = true,
         };
     }
 
@@ -411,8 +581,6 @@ namespace glsld
             return {};
         }
 
-        const auto& compilerResult = queryInfo.GetCompilerResult();
-
         auto cursorPosition = FromLspPosition(params.position);
 
         bool isIncomplete = false;
@@ -475,49 +643,96 @@ namespace glsld
             }
         }
         else {
-            if (compilerResult.GetPreamble() != state.preamble) {
-                // Recompute the cached completion items if the preamble has changed
-                state.preamble                = compilerResult.GetPreamble();
-                state.preambleCompletionItems = ComputePreambleCompletionItems(*state.preamble);
-            }
+            UpdatePreambleCompletionIndex(queryInfo, state);
+
+            // Items are only collected if they fuzzily match the identifier being typed. The client filters the list
+            // further as the user keeps typing. Since the list is filtered, it's marked incomplete so that the client
+            // asks again if the user deletes characters instead.
+            auto prefix  = GetCompletionPrefix(queryInfo, cursorPosition);
+            isIncomplete = !prefix.empty();
+
+            auto isAllowedKind = [&](lsp::CompletionItemKind kind) -> bool {
+                switch (kind) {
+                case lsp::CompletionItemKind::Struct:
+                    return completionType.allowTypeName;
+                case lsp::CompletionItemKind::Function:
+                    return completionType.allowFunctionName;
+                case lsp::CompletionItemKind::Variable:
+                    return completionType.allowVariableName;
+                case lsp::CompletionItemKind::Keyword:
+                case lsp::CompletionItemKind::Text:
+                    return true;
+                default:
+                    return false;
+                }
+            };
+            auto isFull = [&]() { return config.maxItemCount != 0 && result.size() >= config.maxItemCount; };
 
-            result = ComputeKeywordCompletionItems();
+            // Symbols in the user file come first as they are the most relevant ones
             if (completionType.allowTypeName || completionType.allowFunctionName || completionType.allowVariableName) {
-                // Copy the completion items from the language and standard library
-                std::ranges::copy_if(state.preambleCompletionItems, std::back_inserter(result),
-                                     [&](const lsp::CompletionItem& item) -> bool {
-                                         switch (item.kind) {
-                                         case lsp::CompletionItemKind::Struct:
-                                             return completionType.allowTypeName;
-                                         case lsp::CompletionItemKind::Function:
-                                             return completionType.allowFunctionName;
-                                         case lsp::CompletionItemKind::Variable:
-                                             return completionType.allowVariableName;
-                                         default:
-                                             return false;
-                                         }
-                                     });
-
-                // Add the completion items from the AST
-                TraverseAst(CompletionCollector{result, queryInfo, completionType, cursorPosition},
-                            queryInfo.GetUserFileAst());
+                CompletionCollector{result, queryInfo, completionType, cursorPosition, prefix}.Collect();
+            }
+
+            // Then the keywords, the symbols from the language and standard library
+            bool allowPreambleSymbols =
+                completionType.allowTypeName || completionType.allowFunctionName || completionType.allowVariableName;
+            // Only the entries that may match are looked into, which are found by binary search in the sorted indices.
+            std::vector<ArrayView<CompletionIndexEntry>> candidateRanges;
+            for (auto index : {GetKeywordCompletionIndex(),
+                               allowPreambleSymbols ? ArrayView<CompletionIndexEntry>{state.preambleCompletionIndex}
+                                                    : ArrayView<CompletionIndexEntry>{}}) {
+                for (auto candidates : LookupCompletionCandidates(
+                         index, prefix, [](const CompletionIndexEntry& entry) { return StringView{entry.label}; })) {
+                    candidateRanges.push_back(candidates);
+                }
+            }
+
+            // Prefix matches are collected first, so that they are kept if the list is truncated.
+            for (auto expectedMatch : {CompletionMatch::Prefix, CompletionMatch::Subsequence}) {
+                for (auto candidates : candidateRanges) {
+                    for (const auto& entry : candidates) {
+                        if (isFull()) {
+                            break;
+                        }
+
+                        if (isAllowedKind(entry.kind) &&
+                            MatchCompletionLabel(StringView{entry.label}, prefix) == expectedMatch) {
+                            result.push_back(lsp::CompletionItem{
+                                .label = entry.label,
+                                .kind  = entry.kind,
+                                .data  = entry.decl ? std::optional<lsp::DocumentUri>{params.textDocument.uri}
+                                                    : std::nullopt,
+                            });
+                        }
+                    }
+                }
             }
 
             // Technically, macros could be completed anywhere, including `expr.^MACRO`. However, it may be too noisy in
             // the real-world usage. Thus, we only provide macro completion at the global scope for now.
             // TODO: this is really loose and may contain a lot of irrelevant macros. However, it may be useful for
             // users to have all macros which could be used in ifdefs. Should we add some filtering here?
-            std::unordered_set<AtomString> seenMacroNames;
-            for (const auto& ppSymbolOccurrence : queryInfo.GetPreprocessInfo().GetAllOccurrences()) {
-                if (auto macroInfo = ppSymbolOccurrence.GetMacroInfo(); macroInfo) {
-                    if (seenMacroNames.insert(macroInfo->macroName.text).second) {
+            for (auto candidates : LookupCompletionCandidates(queryInfo.GetPreprocessInfo().GetMacroNames(), prefix,
+                                                              &AtomString::StrView)) {
+                for (AtomString macroName : candidates) {
+                    if (isFull()) {
+                        break;
+                    }
+
+                    if (IsCompletionMatch(macroName.StrView(), prefix)) {
                         result.push_back({lsp::CompletionItem{
-                            .label = macroInfo->macroName.text.Str(),
+                            .label = macroName.Str(),
                             .kind  = lsp::CompletionItemKind::Text,
                         }});
                     }
                 }
             }
+
+            if (config.maxItemCount != 0 && result.size() >= config.maxItemCount) {
+                // The list is truncated, so the client must ask again as the user keeps typing
+                result.resize(config.maxItemCount);
+                isIncomplete = true;
+            }
         }
 
         return lsp::CompletionList{
@@ -525,4 +740,26 @@ namespace glsld
             .items        = std::move(result),
         };
     }
+
+    auto HandleCompletionResolve(const CompletionConfig& config, const LanguageQueryInfo& queryInfo,
+                                 CompletionState& state, const lsp::CompletionItem& item) -> lsp::CompletionItem
+    {
+        lsp::CompletionItem result = item;
+        if (!config.enable || result.documentation) {
+            return result;
+        }
+
+        // Documentation is deferred to here since it's only needed for the item the user is looking at
+        UpdatePreambleCompletionIndex(queryInfo, state);
+        for (const auto& entry : LookupCompletionIndex(state.preambleCompletionIndex, item.label)) {
+            if (entry.label == item.label && entry.kind == item.kind && entry.decl) {
+                if (auto description = queryInfo.QueryCommentDescription(*entry.decl); !description.empty()) {
+                    result.documentation = lsp::MarkupContent{true, std::move(description)};
+                }
+                break;
+            }
+        }
+
+        return result;
+    }
 } // namespace glsld
\ No newline at end of file
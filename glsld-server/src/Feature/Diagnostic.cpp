@@ -1,14 +1,75 @@
 #include "Feature/Diagnostic.h"
 #include "Server/Protocol.h"
+#include "Support/SourceText.h"
 #include "Support/StringView.h"
 
+#include <algorithm>
+#include <tuple>
+
+#if defined(GLSLD_ENABLE_GLSLANG)
 #include "glslang/Public/ShaderLang.h"
 #include "glslang/Public/ResourceLimits.h"
 
 #include <regex>
+#endif
 
 namespace glsld
 {
+    // Returns the range of the diagnostic in the main file, or nullopt if it is reported elsewhere, e.g. in a header.
+    static auto GetDiagnosticRange(const LanguageQueryInfo& info, const DiagnosticMessage& message)
+        -> std::optional<TextRange>
+    {
+        if (auto syntaxRange = std::get_if<AstSyntaxRange>(&message.range)) {
+            if (syntaxRange->GetTranslationUnit() != TranslationUnitID::UserFile || syntaxRange->Empty()) {
+                return std::nullopt;
+            }
+
+            // Expanded range is always in the main file, so errors in macro expansions point to the macro usage.
+            return info.LookupExpandedTextRange(*syntaxRange);
+        }
+        else {
+            const auto& fileRange = std::get<FileTextRange>(message.range);
+            if (!info.IsMainFile(fileRange.fileID)) {
+                return std::nullopt;
+            }
+
+            return fileRange.range;
+        }
+    }
+
+    auto HandleDiagnostic(const DiagnosticConfig& config, const LanguageQueryInfo& info)
+        -> std::vector<lsp::Diagnostic>
+    {
+        if (!config.enable) {
+            return {};
+        }
+
+        const auto& diagStream = info.GetCompilerResult().GetDiagnosticStream();
+
+        std::vector<lsp::Diagnostic> result;
+        auto collectDiagnostics = [&](ArrayView<DiagnosticMessage> messages, lsp::DiagnosticSeverity severity) {
+            for (const auto& message : messages) {
+                if (auto range = GetDiagnosticRange(info, message)) {
+                    result.push_back(lsp::Diagnostic{
+                        .range    = ToLspRange(*range),
+                        .severity = severity,
+                        .source   = "glsld",
+                        .message  = message.message,
+                    });
+                }
+            }
+        };
+        collectDiagnostics(diagStream.GetErrors(), lsp::DiagnosticSeverity::Error);
+        collectDiagnostics(diagStream.GetWarnings(), lsp::DiagnosticSeverity::Warning);
+
+        // Report in the order of appearance
+        std::ranges::stable_sort(result, {}, [](const lsp::Diagnostic& diagnostic) {
+            return std::tuple{diagnostic.range.start.line, diagnostic.range.start.character};
+        });
+        return result;
+    }
+
+#if defined(GLSLD_ENABLE_GLSLANG)
     class GlslangLoader
     {
     public:
@@ -99,6 +160,7 @@ namespace glsld
                         .end   = lsp::Position{.line = line, .character = std::numeric_limits<lsp::uinteger>::max()},
                     },
                 .severity = severity,
+                .source   = "glslang",
                 .message  = std::move(message),
             });
         }
@@ -106,10 +168,15 @@ namespace glsld
         return diagnostics;
     }
 
-    auto HandleDiagnostic(const DiagnosticConfig& config, StringView uri, int version,
-                          const LanguageConfig& languageConfig, StringView sourceBuffer) -> lsp::PublishDiagnosticParams
+    auto IsGlslangValidationAvailable() -> bool
     {
-        if (!config.enable) {
+        return true;
+    }
+
+    auto HandleGlslangDiagnostic(const DiagnosticConfig& config, const LanguageConfig& languageConfig,
+                                 StringView sourceBuffer) -> std::vector<lsp::Diagnostic>
+    {
+        if (!config.enable || !config.enableGlslangValidation) {
             return {};
         }
 
@@ -135,10 +202,18 @@ namespace glsld
         shader.setAutoMapLocations(true);
         shader.parse(resources, defaultVersion, defaultProfile, false, false, EShMsgDefault);
 
-        return lsp::PublishDiagnosticParams{
-            .uri         = uri.Str(),
-            .version     = version,
-            .diagnostics = ParseGlslangDiagnostics(shader.getInfoLog()),
-        };
+        return ParseGlslangDiagnostics(shader.getInfoLog());
+    }
+#else
+    auto IsGlslangValidationAvailable() -> bool
+    {
+        return false;
+    }
+
+    auto HandleGlslangDiagnostic(const DiagnosticConfig& config, const LanguageConfig& languageConfig,
+                                 StringView sourceBuffer) -> std::vector<lsp::Diagnostic>
+    {
+        return {};
     }
-} // namespace glsld
\ No newline at end of file
+#endif
+} // namespace glsld
@@ -0,0 +1,69 @@
+#include "Feature/DocumentHighlight.h"
+#include "Support/SourceText.h"
+
+namespace glsld
+{
+    auto GetDocumentHighlightOptions(const DocumentHighlightConfig& config)
+        -> std::optional<lsp::DocumentHighlightOptions>
+    {
+        if (!config.enable) {
+            return std::nullopt;
+        }
+
+        return lsp::DocumentHighlightOptions{};
+    }
+
+    // Declarations are plain text unless they initialize the variable. Other occurrences are writes only if they are
+    // assignment targets.
+    static auto GetHighlightKind(const DeclOccurrence& occurrence) -> lsp::DocumentHighlightKind
+    {
+        if (occurrence.isWrite) {
+            return lsp::DocumentHighlightKind::Write;
+        }
+
+        return occurrence.isDeclaration ? lsp::DocumentHighlightKind::Text : lsp::DocumentHighlightKind::Read;
+    }
+
+    // NOTE: Editors send this request on every cursor move, so it must stay cheap. Occurrences of a declaration are
+    // looked up from the index in `LanguageQueryInfo` instead of walking the AST.
+    auto HandleDocumentHighlight(const DocumentHighlightConfig& config, const LanguageQueryInfo& info,
+                                 const lsp::DocumentHighlightParams& params) -> std::vector<lsp::DocumentHighlight>
+    {
+        if (!config.enable) {
+            return {};
+        }
+
+        auto symbolInfo = info.QuerySymbolByPosition(FromLspPosition(params.position));
+        if (!symbolInfo) {
+            return {};
+        }
+
+        std::vector<lsp::DocumentHighlight> result;
+        if (symbolInfo->symbolType == SymbolDeclType::Macro) {
+            for (const auto& occurrence : info.GetPreprocessInfo().GetAllOccurrences()) {
+                if (auto macroInfo = occurrence.GetMacroInfo(); macroInfo) {
+                    if (macroInfo->definition == symbolInfo->ppSymbolOccurrence->GetMacroInfo()->definition) {
+                        result.push_back(lsp::DocumentHighlight{
+                            .range = ToLspRange(occurrence.GetSpelledRange()),
+                            .kind  = macroInfo->occurrenceType == PPMacroOccurrenceType::Define
+                                         ? lsp::DocumentHighlightKind::Text
+                                         : lsp::DocumentHighlightKind::Read,
+                        });
+                    }
+                }
+            }
+        }
+        else if (symbolInfo->astSymbolOccurrence && symbolInfo->symbolDecl) {
+            for (const auto& occurrence : info.LookupDeclOccurrences(*symbolInfo->symbolDecl)) {
+                if (info.IsSpelledInMainFile(occurrence.tokenID)) {
+                    result.push_back(lsp::DocumentHighlight{
+                        .range = ToLspRange(info.LookupExpandedTextRange(occurrence.tokenID)),
+                        .kind  = GetHighlightKind(occurrence),
+                    });
+                }
+            }
+        }
+
+        return result;
+    }
+} // namespace glsld
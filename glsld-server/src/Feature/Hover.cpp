@@ -142,13 +142,32 @@ namespace glsld
         return std::nullopt;
     }
 
+    // Declarations from the system preamble are builtins. So are those in the user preamble if it's the stdlib segment
+    // of a shader stage, but not those from a preamble given by the user.
+    static auto IsBuiltinDecl(const LanguageQueryInfo& info, const AstDecl& decl) -> bool
+    {
+        switch (decl.GetSyntaxRange().GetTranslationUnit()) {
+        case TranslationUnitID::SystemPreamble:
+            return true;
+        case TranslationUnitID::UserPreamble:
+        {
+            const auto& preamble = info.GetCompilerResult().GetPreamble();
+            return preamble && preamble->HasStdlibStageSegment();
+        }
+        case TranslationUnitID::UserFile:
+            return false;
+        }
+
+        GLSLD_UNREACHABLE();
+    }
+
     static auto CreateHoverContentForAstSymbol(const LanguageQueryInfo& info, const SymbolQueryResult& symbolInfo)
         -> std::optional<HoverContent>
     {
         GLSLD_ASSERT(symbolInfo.astSymbolOccurrence);
 
         const Type* symbolType = nullptr;
-        ConstValue symbolValue;
+        ConstEvalResult symbolValue;
         if (auto expr = symbolInfo.astSymbolOccurrence->As<AstExpr>(); expr) {
             symbolType  = expr->GetDeducedType();
             symbolValue = EvalAstInitializer(*expr);
@@ -202,14 +221,13 @@ namespace glsld
             .name        = symbolInfo.spelledText,
             .symbolType  = symbolType ? symbolType->GetDebugName().Str() : "",
             .parameters  = std::move(reconstructedFuncParams),
-            .symbolValue = !symbolValue.IsError() ? symbolValue.ToString() : "",
+            .symbolValue = !symbolValue->IsError() ? symbolValue->ToString() : "",
             .description = symbolInfo.symbolDecl ? info.QueryCommentDescription(*symbolInfo.symbolDecl) : "",
             .code        = std::move(reconstructedDecl),
             .range       = symbolInfo.spelledRange,
             .unknown     = !symbolInfo.symbolDecl && symbolInfo.symbolType != SymbolDeclType::Swizzle &&
                        symbolInfo.symbolType != SymbolDeclType::LayoutQualifier,
-            .builtin = symbolInfo.symbolDecl && symbolInfo.symbolDecl->GetSyntaxRange().GetTranslationUnit() ==
-                                                    TranslationUnitID::SystemPreamble,
+            .builtin = symbolInfo.symbolDecl && IsBuiltinDecl(info, *symbolInfo.symbolDecl),
         };
     }
 
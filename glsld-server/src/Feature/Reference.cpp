@@ -1,122 +1,9 @@
 
 #include "Feature/Reference.h"
-#include "Server/LanguageQueryVisitor.h"
 #include "Support/SourceText.h"
 
 namespace glsld
 {
-    class CollectReferenceVisitor : public LanguageQueryVisitor<CollectReferenceVisitor, std::vector<lsp::Location>>
-    {
-    private:
-        lsp::DocumentUri documentUri;
-
-        const AstDecl* referenceDecl;
-
-        bool includeDeclaration;
-
-        std::vector<lsp::Location> result;
-
-        auto AddReferenceToken(const AstSyntaxToken& token) -> void
-        {
-            // FIXME: Support reference from included files
-            if (GetInfo().IsSpelledInMainFile(token.id)) {
-                result.push_back(lsp::Location{documentUri, ToLspRange(GetInfo().LookupExpandedTextRange(token))});
-            }
-        }
-
-    public:
-        CollectReferenceVisitor(const LanguageQueryInfo& info, lsp::DocumentUri uri, const AstDecl* referenceDecl,
-                                bool includeDeclaration)
-            : LanguageQueryVisitor(info), documentUri(std::move(uri)), referenceDecl(referenceDecl),
-              includeDeclaration(includeDeclaration)
-        {
-        }
-
-        auto Finish() -> std::vector<lsp::Location> GLSLD_AST_VISITOR_OVERRIDE
-        {
-            return std::move(result);
-        }
-
-        auto VisitAstQualType(const AstQualType& qualType) -> void GLSLD_AST_VISITOR_OVERRIDE
-        {
-            if (auto structDesc = qualType.GetResolvedType()->GetStructDesc()) {
-                if (structDesc->decl == referenceDecl) {
-                    AddReferenceToken(qualType.GetTypeNameTok());
-                }
-            }
-        }
-
-        auto VisitAstNameAccessExpr(const AstNameAccessExpr& expr) -> void GLSLD_AST_VISITOR_OVERRIDE
-        {
-            if (expr.GetResolvedDecl() == referenceDecl) {
-                AddReferenceToken(expr.GetNameToken());
-            }
-        }
-        auto VisitAstFieldAccessExpr(const AstFieldAccessExpr& expr) -> void GLSLD_AST_VISITOR_OVERRIDE
-        {
-            if (expr.GetResolvedDecl() == referenceDecl) {
-                AddReferenceToken(expr.GetNameToken());
-            }
-        }
-        auto VisitAstFunctionCallExpr(const AstFunctionCallExpr& expr) -> void GLSLD_AST_VISITOR_OVERRIDE
-        {
-            if (expr.GetResolvedFunction() == referenceDecl) {
-                AddReferenceToken(expr.GetNameToken());
-            }
-        }
-
-        auto VisitAstFunctionDecl(const AstFunctionDecl& decl) -> void GLSLD_AST_VISITOR_OVERRIDE
-        {
-            if (includeDeclaration && &decl == referenceDecl) {
-                AddReferenceToken(decl.GetNameToken());
-            }
-        }
-        auto VisitAstVariableDeclaratorDecl(const AstVariableDeclaratorDecl& decl) -> void GLSLD_AST_VISITOR_OVERRIDE
-        {
-            if (includeDeclaration && &decl == referenceDecl) {
-                AddReferenceToken(decl.GetNameToken());
-            }
-        }
-        auto VisitAstStructFieldDeclaratorDecl(const AstStructFieldDeclaratorDecl& decl)
-            -> void GLSLD_AST_VISITOR_OVERRIDE
-        {
-            if (includeDeclaration && &decl == referenceDecl) {
-                AddReferenceToken(decl.GetNameToken());
-            }
-        }
-        auto VisitAstParamDecl(const AstParamDecl& decl) -> void GLSLD_AST_VISITOR_OVERRIDE
-        {
-            if (includeDeclaration && &decl == referenceDecl) {
-                if (auto declarator = decl.GetDeclarator()) {
-                    AddReferenceToken(declarator->nameToken);
-                }
-            }
-        }
-        auto VisitAstStructDecl(const AstStructDecl& decl) -> void GLSLD_AST_VISITOR_OVERRIDE
-        {
-            if (includeDeclaration && &decl == referenceDecl) {
-                if (decl.GetNameToken()) {
-                    AddReferenceToken(*decl.GetNameToken());
-                }
-            }
-        }
-        auto VisitAstInterfaceBlockDecl(const AstInterfaceBlockDecl& decl) -> void GLSLD_AST_VISITOR_OVERRIDE
-        {
-            if (includeDeclaration && &decl == referenceDecl) {
-                if (decl.GetDeclarator()) {
-                    AddReferenceToken(decl.GetDeclarator()->nameToken);
-                }
-            }
-        }
-        auto VisitAstBlockFieldDeclaratorDecl(const AstBlockFieldDeclaratorDecl& decl)
-            -> void GLSLD_AST_VISITOR_OVERRIDE
-        {
-            if (includeDeclaration && &decl == referenceDecl) {
-                AddReferenceToken(decl.GetNameToken());
-            }
-        }
-    };
-
     auto GetReferenceOptions(const ReferenceConfig& config) -> std::optional<lsp::ReferenceOptions>
     {
         if (!config.enable) {
@@ -164,9 +51,19 @@ namespace glsld
             }
         }
         else if (symbolInfo->astSymbolOccurrence && symbolInfo->symbolDecl) {
-            result = TraverseAst(CollectReferenceVisitor{info, params.textDocument.uri, symbolInfo->symbolDecl,
-                                                         params.context.includeDeclaration},
-                                 info.GetUserFileAst());
+            for (const auto& occurrence : info.LookupDeclOccurrences(*symbolInfo->symbolDecl)) {
+                if (!params.context.includeDeclaration && occurrence.isDeclaration) {
+                    continue;
+                }
+
+                // FIXME: Support reference from included files
+                if (info.IsSpelledInMainFile(occurrence.tokenID)) {
+                    result.push_back(lsp::Location{
+                        params.textDocument.uri,
+                        ToLspRange(info.LookupExpandedTextRange(occurrence.tokenID)),
+                    });
+                }
+            }
         }
 
         return result;
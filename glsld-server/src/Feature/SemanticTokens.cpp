@@ -1,7 +1,9 @@
 #include "Compiler/SyntaxToken.h"
 #include "Feature/SemanticTokens.h"
 #include "Server/LanguageQueryVisitor.h"
+#include "Server/QueryDeadline.h"
 #include "Support/EnumReflection.h"
+#include "Support/SourceText.h"
 
 namespace glsld
 {
@@ -25,18 +27,56 @@ namespace glsld
         }
     }
 
+    // True if the semantic token overlaps the display range.
+    static auto OverlapsDisplayRange(const SemanticTokenInfo& tokInfo, TextRange displayRange) -> bool
+    {
+        auto tokStart = TextPosition{.line = tokInfo.line, .character = tokInfo.character};
+        auto tokEnd   = TextPosition{.line = tokInfo.line, .character = tokInfo.character + tokInfo.length};
+        return tokStart < displayRange.end && displayRange.start < tokEnd;
+    }
+
+    // Returns the tokens of the main file whose expanded range overlaps the display range, if any.
+    static auto GetLexTokenRange(const LanguageQueryInfo& info, std::optional<TextRange> displayRange)
+        -> AstSyntaxRange
+    {
+        auto astRange = info.GetUserFileAst().GetSyntaxRange();
+        if (!displayRange) {
+            return astRange;
+        }
+
+        // Tokens are sorted by their expanded range, so a binary search is sufficient.
+        auto tokens  = info.GetCompilerResult().GetUserFileArtifacts().GetTokens();
+        auto itBegin = std::ranges::partition_point(
+            tokens, [&](const RawSyntaxToken& tok) { return tok.expandedRange.end <= displayRange->start; });
+        auto itEnd = std::ranges::partition_point(
+            tokens, [&](const RawSyntaxToken& tok) { return tok.expandedRange.start < displayRange->end; });
+
+        auto beginIndex = std::max<uint32_t>(itBegin - tokens.begin(), astRange.GetBeginID().GetTokenIndex());
+        auto endIndex   = std::min<uint32_t>(itEnd - tokens.begin(), astRange.GetEndID().GetTokenIndex());
+        if (beginIndex >= endIndex) {
+            return AstSyntaxRange{};
+        }
+
+        return AstSyntaxRange{SyntaxTokenID{TranslationUnitID::UserFile, beginIndex},
+                              SyntaxTokenID{TranslationUnitID::UserFile, endIndex}};
+    }
+
     // Collect semantic tokens from token stream, including keywords, numbers, etc.
-    auto CollectLexSemanticTokens(const LanguageQueryInfo& info, std::vector<SemanticTokenInfo>& tokenBuffer) -> void
+    auto CollectLexSemanticTokens(const LanguageQueryInfo& info, std::optional<TextRange> displayRange,
+                                  bool lexicalOnly, std::vector<SemanticTokenInfo>& tokenBuffer) -> void
     {
-        for (auto tokID : info.GetUserFileAst().GetSyntaxRange()) {
+        for (auto tokID : GetLexTokenRange(info, displayRange)) {
             auto tok = info.LookupToken(tokID);
 
             std::optional<SemanticTokenType> type;
             if (IsKeywordToken(tok->klass)) {
                 if (!GetGlslBuiltinType(tok->klass)) {
-                    // Type keyword would be handled by traversing Ast
                     type = SemanticTokenType::Keyword;
                 }
+                else if (lexicalOnly) {
+                    // Otherwise, type keyword would be handled by traversing Ast
+                    type = SemanticTokenType::Type;
+                }
             }
             else if (tok->klass == TokenKlass::NumberLiteral) {
                 type = SemanticTokenType::Number;
@@ -76,19 +116,32 @@ namespace glsld
     }
 
     // Collect semantic tokens from AST, including types, structs, functions, etc.
-    auto CollectAstSemanticTokens(const LanguageQueryInfo& info, std::vector<SemanticTokenInfo>& tokenBuffer) -> void
+    auto CollectAstSemanticTokens(const LanguageQueryInfo& info, std::optional<TextRange> displayRange,
+                                  std::vector<SemanticTokenInfo>& tokenBuffer) -> void
     {
         class AstSemanticTokenCollector : public LanguageQueryVisitor<AstSemanticTokenCollector>
         {
         private:
+            std::optional<TextRange> displayRange;
+
             std::vector<SemanticTokenInfo>& output;
 
         public:
-            AstSemanticTokenCollector(const LanguageQueryInfo& info, std::vector<SemanticTokenInfo>& output)
-                : LanguageQueryVisitor(info), output(output)
+            AstSemanticTokenCollector(const LanguageQueryInfo& info, std::optional<TextRange> displayRange,
+                                      std::vector<SemanticTokenInfo>& output)
+                : LanguageQueryVisitor(info), displayRange(displayRange), output(output)
             {
             }
 
+            auto EnterAstNode(const AstNode& node) -> AstVisitPolicy GLSLD_AST_VISITOR_OVERRIDE
+            {
+                if (displayRange) {
+                    return TraverseNodeOverlaps(node, *displayRange);
+                }
+
+                return AstVisitPolicy::Traverse;
+            }
+
             auto VisitAstQualType(const AstQualType& type) -> void GLSLD_AST_VISITOR_OVERRIDE
             {
                 if (type.GetTypeNameTok().klass == TokenKlass::Identifier ||
@@ -216,7 +269,7 @@ namespace glsld
             }
         };
 
-        TraverseAst(AstSemanticTokenCollector{info, tokenBuffer}, info.GetUserFileAst());
+        TraverseAst(AstSemanticTokenCollector{info, displayRange, tokenBuffer}, info.GetUserFileAst());
     }
 
     auto ToLspSemanticTokens(ArrayView<SemanticTokenInfo> tokenBuffer) -> std::vector<lsp::uinteger>
@@ -253,17 +306,27 @@ namespace glsld
         return result;
     }
 
-    auto CollectSemanticTokens(const SemanticTokenConfig& config, const LanguageQueryInfo& info)
-        -> std::vector<SemanticTokenInfo>
+    static auto CollectSemanticTokensImpl(const SemanticTokenConfig& config, const LanguageQueryInfo& info,
+                                          std::optional<TextRange> displayRange) -> std::vector<SemanticTokenInfo>
     {
         if (!config.enable) {
             return {};
         }
 
         std::vector<SemanticTokenInfo> tokenBuffer;
-        CollectLexSemanticTokens(info, tokenBuffer);
+        CollectLexSemanticTokens(info, displayRange, config.lexicalOnly, tokenBuffer);
         CollectPreprocessSemanticTokens(info.GetPreprocessInfo(), tokenBuffer);
-        CollectAstSemanticTokens(info, tokenBuffer);
+        if (!config.lexicalOnly) {
+            CollectAstSemanticTokens(info, displayRange, tokenBuffer);
+        }
+
+        if (displayRange) {
+            // Preprocessor tokens are not filtered while collecting, and tokens expanded from a macro are spelled in
+            // the macro definition. Only keep what actually overlaps the range.
+            std::erase_if(tokenBuffer, [&](const SemanticTokenInfo& tokInfo) {
+                return !OverlapsDisplayRange(tokInfo, *displayRange);
+            });
+        }
 
         std::ranges::sort(tokenBuffer, [](const SemanticTokenInfo& lhs, const SemanticTokenInfo& rhs) {
             return std::tie(lhs.line, lhs.character) < std::tie(rhs.line, rhs.character);
@@ -271,6 +334,18 @@ namespace glsld
         return tokenBuffer;
     }
 
+    auto CollectSemanticTokens(const SemanticTokenConfig& config, const LanguageQueryInfo& info)
+        -> std::vector<SemanticTokenInfo>
+    {
+        return CollectSemanticTokensImpl(config, info, std::nullopt);
+    }
+
+    auto CollectSemanticTokens(const SemanticTokenConfig& config, const LanguageQueryInfo& info, TextRange range)
+        -> std::vector<SemanticTokenInfo>
+    {
+        return CollectSemanticTokensImpl(config, info, range);
+    }
+
     auto GetSemanticTokensOptions(const SemanticTokenConfig& config) -> std::optional<lsp::SemanticTokensOptions>
     {
         if (!config.enable) {
@@ -299,6 +374,7 @@ namespace glsld
                             "declaration",
                         },
                 },
+            .range = true,
             .full =
                 lsp::SemanticTokensOptions::FullOptions{
                     .delta = true,
@@ -309,54 +385,220 @@ namespace glsld
     auto HandleSemanticTokens(const SemanticTokenConfig& config, const LanguageQueryInfo& info,
                               SemanticTokenState& state, const lsp::SemanticTokensParams& params) -> lsp::SemanticTokens
     {
+        auto tokens = ToLspSemanticTokens(CollectSemanticTokens(config, info));
+        if (QueryDeadline::IsCurrentTruncated()) {
+            // The tokens are partial. The request is cancelled, and the cache is kept for the next delta.
+            return lsp::SemanticTokens{};
+        }
+
         state.cachedResultId = state.nextResultId++;
-        state.cachedTokens   = ToLspSemanticTokens(CollectSemanticTokens(config, info));
+        state.cachedTokens   = std::move(tokens);
         return lsp::SemanticTokens{
             .resultId = std::to_string(state.cachedResultId),
             .data     = state.cachedTokens,
         };
     }
 
+    auto HandleSemanticTokensRange(const SemanticTokenConfig& config, const LanguageQueryInfo& info,
+                                   const lsp::SemanticTokensRangeParams& params) -> lsp::SemanticTokens
+    {
+        // NOTE: Range results are not cached, so we don't assign a result id. Deltas are always computed against the
+        // last full result.
+        return lsp::SemanticTokens{
+            .resultId = "",
+            .data     = ToLspSemanticTokens(CollectSemanticTokens(config, info, FromLspRange(params.range))),
+        };
+    }
+
+    // Number of integers that encode a single semantic token in the LSP format.
+    static constexpr size_t LspSemanticTokenSize = 5;
+
+    // A hunk of the semantic token diff, where `deleteCount` tokens starting at `oldIndex` are replaced by
+    // `insertCount` tokens starting at `newIndex`. Indices are in the unit of tokens.
+    struct SemanticTokenDiffHunk
+    {
+        size_t oldIndex;
+        size_t deleteCount;
+        size_t newIndex;
+        size_t insertCount;
+    };
+
+    // Computes the shortest edit script between two encoded token streams with Myers' O(ND) algorithm. Returns nullopt
+    // if the edit distance exceeds `maxEditDistance`, in which case the caller should fall back to a single hunk.
+    static auto ComputeSemanticTokenDiff(ArrayView<lsp::uinteger> oldTokens, ArrayView<lsp::uinteger> newTokens,
+                                         size_t maxEditDistance) -> std::optional<std::vector<SemanticTokenDiffHunk>>
+    {
+        const auto n = static_cast<ptrdiff_t>(oldTokens.size() / LspSemanticTokenSize);
+        const auto m = static_cast<ptrdiff_t>(newTokens.size() / LspSemanticTokenSize);
+
+        auto tokenEquals = [&](ptrdiff_t oldIndex, ptrdiff_t newIndex) {
+            return std::equal(oldTokens.begin() + oldIndex * LspSemanticTokenSize,
+                              oldTokens.begin() + (oldIndex + 1) * LspSemanticTokenSize,
+                              newTokens.begin() + newIndex * LspSemanticTokenSize);
+        };
+
+        // `v[offset + k]` is the furthest x reached on diagonal k. `trace[d]` keeps the diagonals [-(d-1), d-1] of `v`
+        // before step d, which is all that backtracking through step d reads.
+        const auto maxD   = std::min<ptrdiff_t>(n + m, maxEditDistance);
+        const auto offset = maxD + 1;
+        std::vector<ptrdiff_t> v(2 * maxD + 3, 0);
+        std::vector<std::vector<ptrdiff_t>> trace;
+
+        auto editDistance = std::optional<ptrdiff_t>{};
+        for (ptrdiff_t d = 0; d <= maxD && !editDistance; ++d) {
+            trace.emplace_back(v.begin() + offset - std::max<ptrdiff_t>(d - 1, 0),
+                               v.begin() + offset + std::max<ptrdiff_t>(d - 1, -1) + 1);
+
+            for (ptrdiff_t k = -d; k <= d; k += 2) {
+                ptrdiff_t x = (k == -d || (k != d && v[offset + k - 1] < v[offset + k + 1])) ? v[offset + k + 1]
+                                                                                                : v[offset + k - 1] + 1;
+                ptrdiff_t y = x - k;
+                while (x < n && y < m && tokenEquals(x, y)) {
+                    ++x;
+                    ++y;
+                }
+
+                v[offset + k] = x;
+                if (x >= n && y >= m) {
+                    editDistance = d;
+                    break;
+                }
+            }
+        }
+
+        if (!editDistance) {
+            return std::nullopt;
+        }
+
+        // Backtrack to collect the matching runs as (oldIndex, newIndex, length), from the end to the beginning.
+        std::vector<std::tuple<ptrdiff_t, ptrdiff_t, ptrdiff_t>> matches;
+        ptrdiff_t x = n;
+        ptrdiff_t y = m;
+        for (ptrdiff_t d = *editDistance; d > 0; --d) {
+            auto prevV = [&](ptrdiff_t k) { return trace[d][k + d - 1]; };
+
+            ptrdiff_t k          = x - y;
+            bool isInsertion     = k == -d || (k != d && prevV(k - 1) < prevV(k + 1));
+            ptrdiff_t prevK      = isInsertion ? k + 1 : k - 1;
+            ptrdiff_t prevX      = prevV(prevK);
+            ptrdiff_t snakeBegin = isInsertion ? prevX : prevX + 1;
+            if (x > snakeBegin) {
+                matches.emplace_back(snakeBegin, snakeBegin - k, x - snakeBegin);
+            }
+
+            x = prevX;
+            y = prevX - prevK;
+        }
+        if (x > 0) {
+            matches.emplace_back(0, 0, x);
+        }
+        std::ranges::reverse(matches);
+        matches.emplace_back(n, m, 0);
+
+        // Hunks are the gaps between matching runs.
+        std::vector<SemanticTokenDiffHunk> hunks;
+        ptrdiff_t oldCursor = 0;
+        ptrdiff_t newCursor = 0;
+        for (auto [oldIndex, newIndex, length] : matches) {
+            if (oldIndex > oldCursor || newIndex > newCursor) {
+                hunks.push_back(SemanticTokenDiffHunk{
+                    .oldIndex    = static_cast<size_t>(oldCursor),
+                    .deleteCount = static_cast<size_t>(oldIndex - oldCursor),
+                    .newIndex    = static_cast<size_t>(newCursor),
+                    .insertCount = static_cast<size_t>(newIndex - newCursor),
+                });
+            }
+
+            oldCursor = oldIndex + length;
+            newCursor = newIndex + length;
+        }
+
+        return hunks;
+    }
+
+    // Computes the edits that transform the old encoded token stream into the new one.
+    static auto ComputeSemanticTokensEdits(ArrayView<lsp::uinteger> oldTokens, ArrayView<lsp::uinteger> newTokens)
+        -> std::vector<lsp::SemanticTokensEdit>
+    {
+        // Give up on a minimal diff beyond this many inserted or deleted tokens, since Myers' algorithm is quadratic in
+        // the edit distance. Such a large change is likely to be a full rewrite anyway.
+        constexpr size_t maxEditDistance = 512;
+
+        // Trim the common prefix and suffix first, which is the cheap and common case of a single local edit.
+        auto tokenAt = [](ArrayView<lsp::uinteger> tokens, size_t index) {
+            return tokens.Drop(index * LspSemanticTokenSize).Take(LspSemanticTokenSize);
+        };
+
+        size_t numOldTokens    = oldTokens.size() / LspSemanticTokenSize;
+        size_t numNewTokens    = newTokens.size() / LspSemanticTokenSize;
+        size_t numCommonPrefix = 0;
+        while (numCommonPrefix < numOldTokens && numCommonPrefix < numNewTokens &&
+               tokenAt(oldTokens, numCommonPrefix) == tokenAt(newTokens, numCommonPrefix)) {
+            ++numCommonPrefix;
+        }
+        size_t numCommonSuffix = 0;
+        while (numCommonPrefix + numCommonSuffix < numOldTokens && numCommonPrefix + numCommonSuffix < numNewTokens &&
+               tokenAt(oldTokens, numOldTokens - numCommonSuffix - 1) ==
+                   tokenAt(newTokens, numNewTokens - numCommonSuffix - 1)) {
+            ++numCommonSuffix;
+        }
+
+        auto oldMiddle = oldTokens.Drop(numCommonPrefix * LspSemanticTokenSize)
+                             .DropBack(numCommonSuffix * LspSemanticTokenSize);
+        auto newMiddle = newTokens.Drop(numCommonPrefix * LspSemanticTokenSize)
+                             .DropBack(numCommonSuffix * LspSemanticTokenSize);
+        if (oldMiddle.empty() && newMiddle.empty()) {
+            return {};
+        }
+
+        auto hunks = ComputeSemanticTokenDiff(oldMiddle, newMiddle, maxEditDistance);
+        if (!hunks) {
+            hunks = std::vector<SemanticTokenDiffHunk>{
+                SemanticTokenDiffHunk{
+                    .oldIndex    = 0,
+                    .deleteCount = oldMiddle.size() / LspSemanticTokenSize,
+                    .newIndex    = 0,
+                    .insertCount = newMiddle.size() / LspSemanticTokenSize,
+                },
+            };
+        }
+
+        std::vector<lsp::SemanticTokensEdit> edits;
+        for (const auto& hunk : *hunks) {
+            auto insertedTokens =
+                newMiddle.Drop(hunk.newIndex * LspSemanticTokenSize).Take(hunk.insertCount * LspSemanticTokenSize);
+            edits.push_back(lsp::SemanticTokensEdit{
+                .start       = static_cast<lsp::uinteger>((numCommonPrefix + hunk.oldIndex) * LspSemanticTokenSize),
+                .deleteCount = static_cast<lsp::uinteger>(hunk.deleteCount * LspSemanticTokenSize),
+                .data        = std::vector<lsp::uinteger>(insertedTokens.begin(), insertedTokens.end()),
+            });
+        }
+
+        return edits;
+    }
+
     auto HandleSemanticTokensDelta(const SemanticTokenConfig& config, const LanguageQueryInfo& info,
                                    SemanticTokenState& state, const lsp::SemanticTokensDeltaParams& params)
         -> std::variant<lsp::SemanticTokens, lsp::SemanticTokensDelta>
     {
+        auto newTokens = ToLspSemanticTokens(CollectSemanticTokens(config, info));
+        if (QueryDeadline::IsCurrentTruncated()) {
+            // The tokens are partial. The request is cancelled, and the cache is kept so that the client could still
+            // ask for a delta against its previous result.
+            return lsp::SemanticTokensDelta{};
+        }
+
         auto newResultId = state.nextResultId++;
-        auto newTokens   = ToLspSemanticTokens(CollectSemanticTokens(config, info));
         if (params.previousResultId == std::to_string(state.cachedResultId)) {
             // We can compute delta
-            size_t numCommonPrefix =
-                std::distance(state.cachedTokens.begin(), std::ranges::mismatch(state.cachedTokens, newTokens).in1);
-            size_t numCommonSuffix = std::distance(
-                state.cachedTokens.rbegin(),
-                std::ranges::mismatch(state.cachedTokens.rbegin(), state.cachedTokens.rend() - numCommonPrefix,
-                                      newTokens.rbegin(), newTokens.rend() - numCommonPrefix)
-                    .in1);
-            size_t deleteCount = state.cachedTokens.size() - numCommonPrefix - numCommonSuffix;
-
-            state.cachedResultId += newResultId;
-            state.cachedTokens = std::move(newTokens);
-
-            if (numCommonPrefix == state.cachedTokens.size()) {
-                return lsp::SemanticTokensDelta{
-                    .resultId = std::to_string(state.cachedResultId),
-                    .edits    = {},
-                };
-            }
-            else {
-                return lsp::SemanticTokensDelta{
-                    .resultId = std::to_string(state.cachedResultId),
-                    .edits =
-                        {
-                            lsp::SemanticTokensEdit{
-                                .start       = static_cast<lsp::uinteger>(numCommonPrefix),
-                                .deleteCount = static_cast<lsp::uinteger>(deleteCount),
-                                .data        = std::vector<lsp::uinteger>(state.cachedTokens.begin() + numCommonPrefix,
-                                                                          state.cachedTokens.end() - numCommonSuffix),
-                            },
-                        },
-                };
-            }
+            auto edits = ComputeSemanticTokensEdits(state.cachedTokens, newTokens);
+
+            state.cachedResultId = newResultId;
+            state.cachedTokens   = std::move(newTokens);
+            return lsp::SemanticTokensDelta{
+                .resultId = std::to_string(state.cachedResultId),
+                .edits    = std::move(edits),
+            };
         }
         else {
             // The cache is invalid, return full replace
@@ -368,4 +610,4 @@ namespace glsld
             };
         }
     }
-} // namespace glsld
\ No newline at end of file
+} // namespace glsld
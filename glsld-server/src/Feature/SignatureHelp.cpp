@@ -11,13 +11,10 @@ namespace glsld
         : public LanguageQueryVisitor<SignatureHelpLocatingVisitor, const AstFunctionCallExpr*>
     {
     private:
-        TextPosition position;
-
         const AstFunctionCallExpr* functionCallExpr = nullptr;
 
     public:
-        SignatureHelpLocatingVisitor(const LanguageQueryInfo& info, TextPosition position)
-            : LanguageQueryVisitor(info), position(position)
+        SignatureHelpLocatingVisitor(const LanguageQueryInfo& info) : LanguageQueryVisitor(info)
         {
         }
 
@@ -28,7 +25,8 @@ namespace glsld
 
         auto EnterAstNode(const AstNode& node) -> AstVisitPolicy GLSLD_AST_VISITOR_OVERRIDE
         {
-            return TraverseNodeContains(node, position);
+            // Nodes are visited from the innermost one, so the first function call found is the innermost one
+            return functionCallExpr ? AstVisitPolicy::Halt : AstVisitPolicy::Visit;
         }
 
         auto VisitAstFunctionCallExpr(const AstFunctionCallExpr& expr) -> void GLSLD_AST_VISITOR_OVERRIDE
@@ -53,9 +51,16 @@ namespace glsld
         -> std::unordered_multimap<AtomString, const AstFunctionDecl*>
     {
         std::unordered_multimap<AtomString, const AstFunctionDecl*> builtinFunctionDeclMap;
-        for (auto decl : preamble.GetSystemPreambleArtifacts().GetAst()->GetGlobalDecls()) {
-            if (auto funcDecl = decl->As<AstFunctionDecl>()) {
-                builtinFunctionDeclMap.emplace(funcDecl->GetNameToken().text, funcDecl);
+        for (const CompilerArtifact* artifact :
+             {&preamble.GetSystemPreambleArtifacts(), &preamble.GetUserPreambleArtifacts()}) {
+            if (!artifact->GetAst()) {
+                continue;
+            }
+
+            for (auto decl : artifact->GetAst()->GetGlobalDecls()) {
+                if (auto funcDecl = decl->As<AstFunctionDecl>()) {
+                    builtinFunctionDeclMap.emplace(funcDecl->GetNameToken().text, funcDecl);
+                }
             }
         }
 
@@ -73,8 +78,8 @@ namespace glsld
 
         const auto& compilerResult = queryInfo.GetCompilerResult();
 
-        auto expr = TraverseAst(SignatureHelpLocatingVisitor{queryInfo, FromLspPosition(params.position)},
-                                queryInfo.GetUserFileAst());
+        auto expr = TraverseAstAtPosition(SignatureHelpLocatingVisitor{queryInfo}, queryInfo,
+                                          FromLspPosition(params.position));
         if (expr) {
             auto funcName = expr->GetNameToken().text;
 
@@ -3,6 +3,7 @@
 #include "Compiler/CompilerInvocation.h"
 #include "Compiler/PPCallback.h"
 #include "Language/Extension.h"
+#include "Support/Tracing.h"
 #include "Support/Uri.h"
 
 namespace glsld
@@ -32,14 +33,54 @@ namespace glsld
         }
     };
 
+    auto BackgroundCompilation::TryCoalesce(const std::shared_ptr<BackgroundCompilation>& previous,
+                                            const std::shared_ptr<BackgroundCompilation>& next) -> bool
+    {
+        GLSLD_ASSERT(!next->isStarted.load(std::memory_order_relaxed));
+        if (previous->isStarted.exchange(true, std::memory_order_acq_rel)) {
+            // The previous compilation is already running or done.
+            return false;
+        }
+
+        // `Run` of the previous compilation is now a no-op, so it's safe to take over its waiters.
+        previous->successor         = next;
+        next->coalescedCompilations = std::move(previous->coalescedCompilations);
+        next->coalescedCompilations.push_back(previous);
+        previous->SetExpired();
+        return true;
+    }
+
     auto BackgroundCompilation::Run() -> void
     {
+        if (isStarted.exchange(true, std::memory_order_acq_rel)) {
+            // This compilation is coalesced into a newer one, which releases the waiters instead.
+            return;
+        }
+
+        if (!IsExpired()) {
+            Compile();
+        }
+
+        // Signal availability. Waiters of the coalesced compilations are released as well.
+        latchCompilation.CountDown();
+        for (const auto& compilation : coalescedCompilations) {
+            compilation->latchCompilation.CountDown();
+        }
+        coalescedCompilations.clear();
+    }
+
+    auto BackgroundCompilation::Compile() -> void
+    {
+        TraceSpan span{"server", "backgroundCompilation", StringView{uri}};
+
         // First pass:
         std::shared_ptr<PrecompiledPreamble> localPreamble = preamble;
+        preambleCacheHit                                   = localPreamble != nullptr;
         if (localPreamble == nullptr) {
             CompilerInvocation invocation;
             invocation.ApplyLanguageConfig(languageConfig);
-            localPreamble = invocation.CompilePreamble(nullptr);
+            localPreamble    = invocation.CompilePreamble(nullptr);
+            preambleCacheHit = invocation.GetStatistics().preambleCacheHit;
         }
 
         nextPreamble = localPreamble;
@@ -53,18 +94,25 @@ namespace glsld
         auto configCollectorCallback = LanguageConfigCollector{nextConfig};
 
         auto compiler = std::make_unique<CompilerInvocation>(std::move(localPreamble));
-        compiler->SetCountUtf16Characters(true);
+        compiler->SetCountUtf16Characters(buffer.GetCountUtf16Characters());
         compiler->AddIncludePath(std::filesystem::path(Uri::FromString(uri)->GetPath().StdStrView()).parent_path());
+        sourceString = buffer.GetText();
         compiler->SetMainFileFromBuffer(sourceString);
+        compiler->SetStopToken(stopSource.get_token());
 
         auto combinedCallback = CombinedPPCallback{&configCollectorCallback, ppInfoCallback.get()};
         auto result           = compiler->CompileMainFile(&combinedCallback);
 
-        info = std::make_unique<LanguageQueryInfo>(std::move(result), std::move(ppInfoStore));
-        isAvailable.store(true, std::memory_order_release);
+        info = std::make_unique<LanguageQueryInfo>(std::move(result), std::move(ppInfoStore), stopSource.get_token());
 
-        // Signal availability
-        latchCompilation.CountDown();
+        // Measured once here, so the memory budget could be checked without walking the AST arena every time.
+        MemoryUsage resultMemoryUsage = MemoryUsage::Of(sourceString);
+        resultMemoryUsage += info->GetCompilerResult().GetAstMemoryUsage();
+        resultMemoryUsage += info->GetCompilerResult().GetTokenMemoryUsage();
+        resultMemoryUsage += info->GetPreprocessInfo().GetMemoryUsage();
+        resultMemoryUsage += info->GetIndexMemoryUsage();
+        resultMemorySize = resultMemoryUsage.committedBytes;
+        isAvailable.store(true, std::memory_order_release);
     }
 
 } // namespace glsld
\ No newline at end of file
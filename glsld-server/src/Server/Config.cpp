@@ -15,7 +15,13 @@ namespace glsld
                         },
                     .reference =
                         ReferenceConfig{
-                            .enable = true,
+                            .enable       = true,
+                            .timeBudgetMs = 2000,
+                        },
+                    .documentHighlight =
+                        DocumentHighlightConfig{
+                            .enable       = true,
+                            .timeBudgetMs = 500,
                         },
                     .hover =
                         HoverConfig{
@@ -26,15 +32,18 @@ namespace glsld
                             // Although folding range is implemented, it seems it's not better than default VSCode
                             // heuristics.
                             // We disable it by default, and users can enable it in config if needed.
-                            .enable = false,
+                            .enable       = false,
+                            .timeBudgetMs = 1000,
                         },
                     .documentSymbol =
                         DocumentSymbolConfig{
-                            .enable = true,
+                            .enable       = true,
+                            .timeBudgetMs = 1000,
                         },
                     .semanticTokens =
                         SemanticTokenConfig{
-                            .enable = true,
+                            .enable       = true,
+                            .timeBudgetMs = 2000,
                         },
                     .inlayHint =
                         InlayHintConfig{
@@ -45,20 +54,35 @@ namespace glsld
                             .enableImplicitCastHint      = true,
                             .enableBlockEndHint          = true,
                             .blockEndHintLineThreshold   = 2,
+                            .timeBudgetMs                = 500,
                         },
                     .completion =
                         CompletionConfig{
-                            .enable = true,
+                            .enable       = true,
+                            .maxItemCount = 200,
+                            .timeBudgetMs = 500,
                         },
                     .diagnostic =
                         DiagnosticConfig{
                             // This is still experimental, disable by default for now.
-                            .enable = false,
+                            .enable                  = false,
+                            .enableGlslangValidation = false,
                         },
                     .signatureHelp =
                         SignatureHelpConfig{
                             .enable = true,
                         },
+                    .largeDocument =
+                        LargeDocumentConfig{
+                            .maxSize            = 2 * 1024 * 1024,
+                            .maxLineCount       = 50000,
+                            .maxCompileTimeMs   = 2000,
+                            .coalescingWindowMs = 1000,
+                        },
+                    .memoryBudget =
+                        MemoryBudgetConfig{
+                            .maxMemoryMb = 1024,
+                        },
                 },
             .loggingLevel = LoggingLevel::Info,
         };
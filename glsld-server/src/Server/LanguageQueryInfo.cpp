@@ -2,9 +2,253 @@
 #include "Compiler/CompilerArtifacts.h"
 #include "Compiler/SyntaxToken.h"
 #include "Server/LanguageQueryVisitor.h"
+#include "Server/QueryDeadline.h"
+
+#include <algorithm>
 
 namespace glsld
 {
+    namespace
+    {
+        class PositionIndexBuilder : public AstVisitor<PositionIndexBuilder>
+        {
+        private:
+            std::vector<IndexedAstNode>& nodeIndex;
+            std::vector<uint32_t>& tokenNodeIndex;
+
+            // The indices of the nodes being traversed, from the root to the current one.
+            std::vector<uint32_t> pathIndex;
+
+        public:
+            PositionIndexBuilder(std::vector<IndexedAstNode>& nodeIndex, std::vector<uint32_t>& tokenNodeIndex)
+                : nodeIndex(nodeIndex), tokenNodeIndex(tokenNodeIndex)
+            {
+            }
+
+            auto VisitAstNode(const AstNode& node) -> void GLSLD_AST_VISITOR_OVERRIDE
+            {
+                auto index = static_cast<uint32_t>(nodeIndex.size());
+                nodeIndex.push_back(IndexedAstNode{
+                    .node        = &node,
+                    .parentIndex = pathIndex.empty() ? IndexedAstNode::NoParent : pathIndex.back(),
+                });
+                pathIndex.push_back(index);
+
+                // Nodes are visited in pre-order, so tokens are overwritten by inner nodes
+                auto range = node.GetSyntaxRange();
+                if (range.GetTranslationUnit() != TranslationUnitID::UserFile) {
+                    return;
+                }
+
+                std::fill(tokenNodeIndex.begin() + range.GetBeginID().GetTokenIndex(),
+                          tokenNodeIndex.begin() + range.GetEndID().GetTokenIndex(), index);
+            }
+
+            auto ExitAstNode(const AstNode& node) -> void GLSLD_AST_VISITOR_OVERRIDE
+            {
+                pathIndex.pop_back();
+            }
+        };
+
+        class DeclOccurrenceIndexBuilder : public AstVisitor<DeclOccurrenceIndexBuilder>
+        {
+        private:
+            std::unordered_map<const AstDecl*, std::vector<DeclOccurrence>>& declOccurrenceIndex;
+
+            std::stop_token stopToken;
+
+            // Set once the traversal is halted, in which case the index is incomplete.
+            bool halted = false;
+
+            // The expressions written by the assignments, increments or calls being traversed, which are not yet
+            // visited. Nodes are visited in pre-order, so a target is always added before it's visited.
+            std::vector<const AstExpr*> writeTargets;
+
+            auto AddOccurrence(const AstDecl* decl, const AstSyntaxToken& token, bool isDeclaration,
+                               bool isWrite = false) -> void
+            {
+                if (decl) {
+                    declOccurrenceIndex[decl].push_back(DeclOccurrence{
+                        .tokenID       = token.id,
+                        .isDeclaration = isDeclaration,
+                        .isWrite       = isWrite,
+                    });
+                }
+            }
+
+            // Writing to an element or a swizzle of a variable also writes to the variable.
+            auto AddWriteTarget(const AstExpr* expr) -> void
+            {
+                while (true) {
+                    if (auto indexAccessExpr = expr->As<AstIndexAccessExpr>()) {
+                        expr = indexAccessExpr->GetBaseExpr();
+                    }
+                    else if (auto swizzleAccessExpr = expr->As<AstSwizzleAccessExpr>()) {
+                        expr = swizzleAccessExpr->GetBaseExpr();
+                    }
+                    else {
+                        break;
+                    }
+                }
+
+                writeTargets.push_back(expr);
+            }
+
+            // Returns true if the expression is a write target, which is then removed since it's visited only once.
+            auto TakeWriteTarget(const AstExpr* expr) -> bool
+            {
+                if (auto it = std::ranges::find(writeTargets, expr); it != writeTargets.end()) {
+                    writeTargets.erase(it);
+                    return true;
+                }
+
+                return false;
+            }
+
+        public:
+            DeclOccurrenceIndexBuilder(std::unordered_map<const AstDecl*, std::vector<DeclOccurrence>>& index,
+                                       std::stop_token stopToken)
+                : declOccurrenceIndex(index), stopToken(std::move(stopToken))
+            {
+            }
+
+            // The index is built on behalf of a query, so it's halted in the same way as `LanguageQueryVisitor`.
+            auto IsTraversalCancelled() -> bool
+            {
+                if (!halted && (stopToken.stop_requested() || QueryDeadline::PollCurrent())) {
+                    halted = true;
+                }
+
+                return halted;
+            }
+
+            // Returns true if the index is complete.
+            auto Finish() const -> bool
+            {
+                return !halted;
+            }
+
+            auto VisitAstQualType(const AstQualType& qualType) -> void GLSLD_AST_VISITOR_OVERRIDE
+            {
+                if (auto structDesc = qualType.GetResolvedType()->GetStructDesc()) {
+                    AddOccurrence(structDesc->decl, qualType.GetTypeNameTok(), false);
+                }
+            }
+
+            auto VisitAstUnaryExpr(const AstUnaryExpr& expr) -> void GLSLD_AST_VISITOR_OVERRIDE
+            {
+                switch (expr.GetOpcode()) {
+                case UnaryOp::PrefixInc:
+                case UnaryOp::PrefixDec:
+                case UnaryOp::PostfixInc:
+                case UnaryOp::PostfixDec:
+                    AddWriteTarget(expr.GetOperand());
+                    break;
+                default:
+                    break;
+                }
+            }
+            auto VisitAstBinaryExpr(const AstBinaryExpr& expr) -> void GLSLD_AST_VISITOR_OVERRIDE
+            {
+                if (IsAssignmentOp(expr.GetOpcode())) {
+                    AddWriteTarget(expr.GetLhsOperand());
+                }
+            }
+
+            auto VisitAstNameAccessExpr(const AstNameAccessExpr& expr) -> void GLSLD_AST_VISITOR_OVERRIDE
+            {
+                AddOccurrence(expr.GetResolvedDecl(), expr.GetNameToken(), false, TakeWriteTarget(&expr));
+            }
+            auto VisitAstFieldAccessExpr(const AstFieldAccessExpr& expr) -> void GLSLD_AST_VISITOR_OVERRIDE
+            {
+                AddOccurrence(expr.GetResolvedDecl(), expr.GetNameToken(), false, TakeWriteTarget(&expr));
+            }
+            auto VisitAstFunctionCallExpr(const AstFunctionCallExpr& expr) -> void GLSLD_AST_VISITOR_OVERRIDE
+            {
+                AddOccurrence(expr.GetResolvedFunction(), expr.GetNameToken(), false);
+
+                // Arguments passed to `out` or `inout` parameters are written by the call.
+                if (auto funcDecl = expr.GetResolvedFunction()) {
+                    auto params = funcDecl->GetParams();
+                    for (size_t i = 0; i < expr.GetArgs().size() && i < params.size(); ++i) {
+                        if (params[i]->IsOutputParam()) {
+                            AddWriteTarget(expr.GetArgs()[i]);
+                        }
+                    }
+                }
+            }
+
+            auto VisitAstFunctionDecl(const AstFunctionDecl& decl) -> void GLSLD_AST_VISITOR_OVERRIDE
+            {
+                AddOccurrence(&decl, decl.GetNameToken(), true);
+            }
+            auto VisitAstVariableDeclaratorDecl(const AstVariableDeclaratorDecl& decl)
+                -> void GLSLD_AST_VISITOR_OVERRIDE
+            {
+                AddOccurrence(&decl, decl.GetNameToken(), true, decl.GetInitializer() != nullptr);
+            }
+            auto VisitAstStructFieldDeclaratorDecl(const AstStructFieldDeclaratorDecl& decl)
+                -> void GLSLD_AST_VISITOR_OVERRIDE
+            {
+                AddOccurrence(&decl, decl.GetNameToken(), true);
+            }
+            auto VisitAstParamDecl(const AstParamDecl& decl) -> void GLSLD_AST_VISITOR_OVERRIDE
+            {
+                if (auto declarator = decl.GetDeclarator()) {
+                    AddOccurrence(&decl, declarator->nameToken, true);
+                }
+            }
+            auto VisitAstStructDecl(const AstStructDecl& decl) -> void GLSLD_AST_VISITOR_OVERRIDE
+            {
+                if (decl.GetNameToken()) {
+                    AddOccurrence(&decl, *decl.GetNameToken(), true);
+                }
+            }
+            auto VisitAstInterfaceBlockDecl(const AstInterfaceBlockDecl& decl) -> void GLSLD_AST_VISITOR_OVERRIDE
+            {
+                if (decl.GetDeclarator()) {
+                    AddOccurrence(&decl, decl.GetDeclarator()->nameToken, true);
+                }
+            }
+            auto VisitAstBlockFieldDeclaratorDecl(const AstBlockFieldDeclaratorDecl& decl)
+                -> void GLSLD_AST_VISITOR_OVERRIDE
+            {
+                AddOccurrence(&decl, decl.GetNameToken(), true);
+            }
+        };
+    } // namespace
+
+    auto LanguageQueryInfo::BuildPositionIndex() const -> void
+    {
+        const auto& artifact = compilerResult->GetUserFileArtifacts();
+        if (artifact.GetAst()) {
+            tokenNodeIndex.resize(artifact.GetTokens().size(), IndexedAstNode::NoParent);
+            TraverseAst(PositionIndexBuilder{nodeIndex, tokenNodeIndex}, *artifact.GetAst());
+        }
+        hasPositionIndex.store(true, std::memory_order_release);
+    }
+
+    auto LanguageQueryInfo::EnsureDeclOccurrenceIndex() const -> bool
+    {
+        if (hasDeclOccurrenceIndex.load(std::memory_order_acquire)) {
+            return true;
+        }
+
+        std::lock_guard<std::mutex> lock{declOccurrenceIndexMutex};
+        if (hasDeclOccurrenceIndex.load(std::memory_order_relaxed)) {
+            return true;
+        }
+
+        if (const auto ast = compilerResult->GetUserFileArtifacts().GetAst()) {
+            if (!TraverseAst(DeclOccurrenceIndexBuilder{declOccurrenceIndex, stopToken}, *ast)) {
+                declOccurrenceIndex.clear();
+                return false;
+            }
+        }
+        hasDeclOccurrenceIndex.store(true, std::memory_order_release);
+        return true;
+    }
+
     auto LanguageQueryInfo::LookupToken(SyntaxTokenID id) const -> const RawSyntaxToken*
     {
         return &LookupArtifact(id.GetTU())->GetTokens()[id.GetTokenIndex()];
@@ -43,6 +287,60 @@ namespace glsld
             tokens, lineNum, {}, [](const RawSyntaxToken& tok) { return tok.expandedRange.start.line; });
         return {std::to_address(itBegin), std::to_address(itEnd)};
     }
+    auto LanguageQueryInfo::LookupTokenIDByPosition(TextPosition position) const -> std::optional<SyntaxTokenID>
+    {
+        auto tokens = compilerResult->GetUserFileArtifacts().GetTokens();
+        auto it     = std::ranges::upper_bound(tokens, position, {},
+                                               [](const RawSyntaxToken& tok) { return tok.expandedRange.start; });
+        if (it == tokens.begin()) {
+            return std::nullopt;
+        }
+
+        return SyntaxTokenID{TranslationUnitID::UserFile, static_cast<uint32_t>(it - tokens.begin() - 1)};
+    }
+    auto LanguageQueryInfo::LookupInnermostNode(SyntaxTokenID id) const -> const IndexedAstNode*
+    {
+        std::call_once(positionIndexFlag, [this] { BuildPositionIndex(); });
+
+        if (id.GetTU() != TranslationUnitID::UserFile || id.GetTokenIndex() >= tokenNodeIndex.size()) {
+            return nullptr;
+        }
+
+        auto index = tokenNodeIndex[id.GetTokenIndex()];
+        return index != IndexedAstNode::NoParent ? &nodeIndex[index] : nullptr;
+    }
+    auto LanguageQueryInfo::LookupParentNode(const IndexedAstNode& node) const -> const IndexedAstNode*
+    {
+        return node.parentIndex != IndexedAstNode::NoParent ? &nodeIndex[node.parentIndex] : nullptr;
+    }
+    auto LanguageQueryInfo::LookupDeclOccurrences(const AstDecl& decl) const -> ArrayView<DeclOccurrence>
+    {
+        if (!EnsureDeclOccurrenceIndex()) {
+            return {};
+        }
+
+        auto it = declOccurrenceIndex.find(&decl);
+        if (it == declOccurrenceIndex.end()) {
+            return {};
+        }
+
+        return it->second;
+    }
+    auto LanguageQueryInfo::GetIndexMemoryUsage() const -> MemoryUsage
+    {
+        MemoryUsage result;
+        if (hasPositionIndex.load(std::memory_order_acquire)) {
+            result += MemoryUsage::Of(nodeIndex) + MemoryUsage::Of(tokenNodeIndex);
+        }
+        if (hasDeclOccurrenceIndex.load(std::memory_order_acquire)) {
+            result += MemoryUsage::Of(declOccurrenceIndex);
+            for (const auto& [decl, occurrences] : declOccurrenceIndex) {
+                result += MemoryUsage::Of(occurrences);
+            }
+        }
+
+        return result;
+    }
     auto LanguageQueryInfo::LookupPreceedingComment(SyntaxTokenID id) const -> ArrayView<RawCommentToken>
     {
         auto comments         = LookupArtifact(id.GetTU())->GetComments();
@@ -156,7 +454,7 @@ namespace glsld
                     return AstVisitPolicy::Halt;
                 }
 
-                return TraverseNodeContains(node, cursorPos);
+                return AstVisitPolicy::Visit;
             }
 
             auto VisitAstTypeQualifierSeq(const AstTypeQualifierSeq& quals) -> void GLSLD_AST_VISITOR_OVERRIDE
@@ -321,8 +619,8 @@ namespace glsld
             };
         }
 
-        // Then, we traverse the AST to search for the identifier that the cursor is on, if any.
-        return TraverseAst(SymbolQueryVisitor{*this, position}, GetUserFileAst());
+        // Then, we search the AST nodes that contain the cursor for the identifier that the cursor is on, if any.
+        return TraverseAstAtPosition(SymbolQueryVisitor{*this, position}, *this, position);
     }
 
     auto LanguageQueryInfo::QueryCommentDescription(const AstDecl& decl) const -> std::string
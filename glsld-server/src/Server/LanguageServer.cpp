@@ -1,6 +1,7 @@
 #include "Server/LanguageServer.h"
 #include "Server/LanguageService.h"
 #include "Server/Protocol.h"
+#include "Support/JsonReader.h"
 #include "Support/StringView.h"
 
 #include <spdlog/common.h>
@@ -13,6 +14,11 @@ namespace glsld
 {
     static auto CreateLogger(LoggingLevel level) -> std::shared_ptr<spdlog::logger>
     {
+        // Servers of different clients in the same process share the logger.
+        if (auto logger = spdlog::get("glsld_logger")) {
+            return logger;
+        }
+
         auto logger = spdlog::stderr_color_mt("glsld_logger");
         logger->set_pattern("[%H:%M:%S.%e] [%^%l%$] %v");
         switch (level) {
@@ -33,17 +39,30 @@ namespace glsld
         return logger;
     }
 
-    LanguageServer::LanguageServer(const LanguageServerConfig& config) : config(config)
+    LanguageServer::LanguageServer(const LanguageServerConfig& config, std::unique_ptr<TextTransport> transport,
+                                   std::shared_ptr<LanguageServiceExecutor> executor)
+        : config(config), transport(transport ? std::move(transport) : CreateStdioTextTransport())
     {
         logger = CreateLogger(config.loggingLevel);
 
-        language  = std::make_unique<LanguageService>(*this);
-        transport = CreateStdioTextTransport();
+        messageWriter = std::make_unique<MessageWriter>(*this->transport, [this] {
+            LogError("Failed to write LSP message.");
+            Shutdown();
+        });
+
+        language =
+            std::make_unique<LanguageService>(*this, executor ? std::move(executor) : CreateLanguageServiceExecutor());
 
         InitializeClientMessageHandlers();
     }
     LanguageServer::~LanguageServer()
     {
+        // The pending tasks of the language service may still respond to requests, so it's torn down first while the
+        // rest of the server is alive.
+        language = nullptr;
+
+        LogInfo("Outgoing message queue peaked at {} messages ({} bytes)", messageWriter->GetPeakPendingMessageCount(),
+                messageWriter->GetPeakPendingBytes());
     }
 
     auto LanguageServer::InitializeReplayDumpFile(UniqueFile dumpFile) -> void
@@ -52,6 +71,16 @@ namespace glsld
         replayDumpFile = std::move(dumpFile);
     }
 
+    auto LanguageServer::WaitForPendingTasks() -> void
+    {
+        language->WaitForPendingTasks();
+    }
+
+    auto LanguageServer::CollectMemoryUsage() -> lsp::MemoryUsageResult
+    {
+        return language->CollectMemoryUsage();
+    }
+
     auto LanguageServer::Run() -> void
     {
         while (!serverStopSource.stop_requested()) {
@@ -91,49 +120,41 @@ namespace glsld
         // We have a single thread loop here, no need to lock
         // std::lock_guard<std::mutex> lock{transportMutex};
 
-        size_t payloadLength = 0;
+        MessageHeaderParser headerParser;
         while (true) {
-            StringView headerView;
-            if (auto headerLine = transport->ReadLine(); headerLine.has_value()) {
-                headerView = headerLine->Trim();
-            }
-            else {
+            auto headerLine = transport->ReadLine();
+            if (!headerLine.has_value()) {
                 LogError("Failed to read LSP message header.");
                 return false;
             }
 
-            LogDebug("Received LSP message header line: `{}`", headerView);
-            if (headerView.empty()) {
-                // Empty line indicates end of headers, aka. start of payload.
-                break;
-            }
-
-            if (constexpr StringView contentLengthPrefix = "Content-Length: ";
-                headerView.StartWith(contentLengthPrefix)) {
-                auto lengthView = headerView.Drop(contentLengthPrefix.size());
-                if (std::from_chars(lengthView.data(), lengthView.data() + lengthView.size(), payloadLength).ec !=
-                    std::errc()) {
-                    LogError("Failed to parse Content-Length header.");
-                    return false;
+            LogDebug("Received LSP message header line: `{}`", headerLine->Trim());
+            auto headerEnd = headerParser.ParseLine(*headerLine);
+            if (!headerEnd.has_value()) {
+                if (headerEnd.error() == TextTransportError::MessageTooLarge) {
+                    LogError("LSP message payload of {} bytes exceeds the limit of {} bytes.",
+                             headerParser.GetPayloadLength(), MaxTextTransportMessageSize);
                 }
+                else {
+                    LogError("Invalid LSP message header: `{}`", headerLine->Trim());
+                }
+                return false;
             }
-            else if (constexpr StringView contentTypePrefix = "Content-Type: ";
-                     headerView.StartWith(contentTypePrefix)) {
-                // do nothing...
-            }
-            else {
-                LogWarn("Unknown LSP message header: {}", headerView);
-                // We ignore any unknown header fields
+            if (*headerEnd) {
+                break;
             }
         }
 
-        if (payloadLength == 0) {
-            LogError("LSP message payload length is missing or incorrectly set to zero.");
-            return false;
-        }
-        auto payload = transport->Read(payloadLength);
+        auto payloadLength = headerParser.GetPayloadLength();
+        auto payload       = transport->Read(payloadLength);
         if (!payload.has_value()) {
-            LogError("Failed to read LSP message payload.");
+            if (payload.error() == TextTransportError::MessageTooLarge) {
+                LogError("LSP message payload of {} bytes exceeds the limit of {} bytes.", payloadLength,
+                         MaxTextTransportMessageSize);
+            }
+            else {
+                LogError("Failed to read LSP message payload.");
+            }
             return false;
         }
 
@@ -142,92 +163,179 @@ namespace glsld
         return true;
     }
 
-    auto LanguageServer::PushMessage(StringView payload) -> bool
+    auto LanguageServer::PushMessage(std::string&& payload) -> void
     {
-        std::lock_guard<std::mutex> lock{serverOutputMutex};
-
-        // TODO: optimize this
-        std::string header = fmt::format("Content-Length: {}\r\n\r\n", payload.size());
-        LogDebug("Sending LSP message header:\n```\n{}```", header);
         LogDebug("Sending LSP message payload:\n```\n{}\n```", payload);
-
-        if (!transport->Write(header)) {
-            LogError("Failed to write LSP message header.");
-            return false;
-        }
-        if (!transport->Write(payload)) {
-            LogError("Failed to write LSP message payload.");
-            return false;
-        }
-        if (!transport->Flush()) {
-            LogError("Failed to flush LSP message.");
-            return false;
-        }
-
-        return true;
+        messageWriter->Enqueue(std::move(payload));
     }
 
     auto LanguageServer::HandleClientMessage(StringView messagePayload) -> void
     {
+        auto receiveTime = TraceRecorder::Clock::now();
         LogClientMessage(messagePayload);
 
-        auto j = nlohmann::json::parse(messagePayload, nullptr, false);
-        if (j.is_discarded()) {
+        // Only the envelope is parsed here. The params are kept as raw text and deserialized by the handler without
+        // building a DOM, which matters for document sync messages that carry the whole text.
+        ClientMessage message{.receiveTime = receiveTime};
+        bool hasMethod = false;
+        JsonReader reader{messagePayload};
+        bool parsed = reader.ReadObject([&](StringView key) {
+            if (key == "method" && reader.PeekKind() == JsonValueKind::String) {
+                hasMethod = true;
+                return reader.ReadString(message.method);
+            }
+            else if (key == "id" && reader.PeekKind() == JsonValueKind::Number) {
+                StringView idText;
+                if (!reader.ReadRawValue(idText)) {
+                    return false;
+                }
+
+                int requestId     = 0;
+                const char* idEnd = idText.data() + idText.size();
+                auto [ptr, ec]    = std::from_chars(idText.data(), idEnd, requestId);
+                if (ec == std::errc{} && ptr == idEnd) {
+                    message.requestId = requestId;
+                }
+                return true;
+            }
+            else if (key == "params") {
+                return reader.ReadRawValue(message.params);
+            }
+            else {
+                return reader.SkipValue();
+            }
+        });
+        if (!parsed || !reader.IsEnd()) {
             LogError("Client message is not a valid JSON:\n```\n{}```\n", messagePayload);
             return;
         }
 
-        std::string method;
-        if (auto itMethod = j.find("method"); itMethod != j.end() && itMethod->is_string()) {
-            method = *itMethod;
-        }
-        else {
+        if (!hasMethod) {
             LogError("JSON-RPC method must be a valid string.");
             return;
         }
 
-        if (auto it = handlerDispatchMap.Find(method); it != handlerDispatchMap.end()) {
-            std::invoke(it->second, *this, j);
+        if (auto it = handlerDispatchMap.Find(message.method); it != handlerDispatchMap.end()) {
+            auto lock = language->LockDocuments();
+            std::invoke(it->second, *this, message);
         }
         else {
             // Ignore unknown methods
-            LogWarn("Unknown JSON-RPC method: {}", method);
+            LogWarn("Unknown JSON-RPC method: {}", message.method);
         }
     }
 
-    auto LanguageServer::SendTypeErasedServerResponse(int requestId, nlohmann::json result, bool isError) -> void
+    auto LanguageServer::GetRequestStopToken(int requestId) -> std::stop_token
     {
-        nlohmann::json rpcBlob;
-        rpcBlob["jsonrpc"] = "2.0";
-        rpcBlob["id"]      = requestId;
-        if (isError) {
-            rpcBlob["error"] = std::move(result);
+        std::lock_guard<std::mutex> lock{pendingRequestMutex};
+        if (auto it = pendingRequests.find(requestId); it != pendingRequests.end()) {
+            return it->second.stopSource.get_token();
         }
-        else {
-            rpcBlob["result"] = std::move(result);
+
+        return {};
+    }
+
+    auto LanguageServer::GetRequestStatistics(int requestId) -> RequestStatistics*
+    {
+        std::lock_guard<std::mutex> lock{pendingRequestMutex};
+        if (auto it = pendingRequests.find(requestId); it != pendingRequests.end()) {
+            return it->second.statistics;
         }
 
-        auto payload = rpcBlob.dump();
+        return nullptr;
+    }
 
-        if (!PushMessage(payload)) {
-            LogError("Failed to push server response:\n{}", payload);
-            Shutdown();
+    auto LanguageServer::CancelRequest(int requestId, lsp::ErrorCodes reason) -> void
+    {
+        std::lock_guard<std::mutex> lock{pendingRequestMutex};
+        if (auto it = pendingRequests.find(requestId); it != pendingRequests.end()) {
+            if (!it->second.stopSource.stop_requested()) {
+                it->second.cancelReason = reason;
+                it->second.stopSource.request_stop();
+            }
         }
     }
 
-    auto LanguageServer::SendTypeErasedServerNotification(const char* method, nlohmann::json params) -> void
+    auto LanguageServer::SendCancelledResponse(int requestId) -> void
     {
-        nlohmann::json rpcBlob;
-        rpcBlob["jsonrpc"] = "2.0";
-        rpcBlob["method"]  = method;
-        rpcBlob["params"]  = std::move(params);
+        CancelRequest(requestId);
+        SendServerResponse(requestId, nullptr, false);
+    }
 
-        auto payload = rpcBlob.dump();
+    auto LanguageServer::SendErrorResponse(int requestId, lsp::ErrorCodes code, std::string message) -> void
+    {
+        SendServerResponse(requestId, lsp::ResponseError{.code = code, .message = std::move(message)}, true);
+    }
 
-        if (!PushMessage(payload)) {
-            LogError("Failed to push server notification:\n{}", payload);
-            Shutdown();
+    auto LanguageServer::BeginRequest(const ClientMessage& message) -> void
+    {
+        PendingRequest request{
+            .statistics  = &statistics.GetRequestStatistics(StringView{message.method}),
+            .receiveTime = message.receiveTime,
+        };
+        if (TraceRecorder::IsEnabled()) {
+            request.method = TraceRecorder::Get().InternString(message.method);
+        }
+
+        std::lock_guard<std::mutex> lock{pendingRequestMutex};
+        pendingRequests[*message.requestId] = std::move(request);
+    }
+
+    auto LanguageServer::FinishRequest(int requestId) -> std::optional<lsp::ErrorCodes>
+    {
+        std::optional<lsp::ErrorCodes> cancelReason;
+        PendingRequest request;
+        {
+            std::lock_guard<std::mutex> lock{pendingRequestMutex};
+            auto it = pendingRequests.find(requestId);
+            if (it == pendingRequests.end()) {
+                return std::nullopt;
+            }
+
+            if (it->second.stopSource.stop_requested()) {
+                cancelReason = it->second.cancelReason;
+            }
+            request = std::move(it->second);
+            pendingRequests.erase(it);
         }
+
+        auto responseTime = TraceRecorder::Clock::now();
+        request.statistics->total.Record(responseTime - request.receiveTime);
+        if (cancelReason) {
+            request.statistics->cancelledCount.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        // A request may be responded on a different thread than it's received, so it's traced as an async span.
+        TraceRecorder::Get().Record("request", request.method, request.receiveTime, responseTime,
+                                    cancelReason ? "cancelled" : "", requestId);
+        return cancelReason;
+    }
+
+    auto LanguageServer::SendRequestCancelledError(int requestId, lsp::ErrorCodes cancelReason) -> void
+    {
+        LogInfo("Request {} is cancelled. Result is discarded.", requestId);
+        auto error = lsp::ResponseError{
+            .code    = cancelReason,
+            .message = cancelReason == lsp::ErrorCodes::ContentModified ? "Content modified" : "Request cancelled",
+        };
+        SendServerResponse(requestId, error, true);
+    }
+
+    auto LanguageServer::BeginServerMessage() -> JsonWriter&
+    {
+        // Messages may be sent from different threads. Each thread reuses its own buffer.
+        thread_local JsonWriter writer;
+        writer.Reset();
+        writer.BeginObject();
+        writer.WriteKey("jsonrpc");
+        writer.WriteString("2.0");
+        return writer;
+    }
+
+    auto LanguageServer::FinishServerMessage(JsonWriter& writer) -> void
+    {
+        writer.EndObject();
+        PushMessage(writer.TakeText());
     }
 
     template <typename ParamType>
@@ -239,19 +347,16 @@ namespace glsld
     auto LanguageServer::InitializeClientMessageHandlers() -> void
     {
         const auto createRequestHandler = []<typename ParamType>(RequestHandlerType<ParamType> handler) {
-            return [handler](LanguageServer& server, const nlohmann::json& rpcBlob) {
-                int requestId;
-                if (auto itReqId = rpcBlob.find("id"); itReqId != rpcBlob.end() && itReqId->is_number_integer()) {
-                    requestId = *itReqId;
-                }
-                else {
+            return [handler](LanguageServer& server, const ClientMessage& message) {
+                if (!message.requestId) {
                     server.LogError("JSON-RPC request ID must be a valid integer.");
                     return;
                 }
+                int requestId = *message.requestId;
 
                 ParamType params = {};
-                if (auto itParam = rpcBlob.find("params");
-                    JsonSerializer<ParamType>::Deserialize(params, itParam != rpcBlob.end() ? *itParam : nullptr)) {
+                if (JsonReader reader{message.params}; JsonSerializer<ParamType>::Deserialize(params, reader)) {
+                    server.BeginRequest(message);
                     std::invoke(handler, server.language.get(), requestId, std::move(params));
                 }
                 else {
@@ -261,10 +366,11 @@ namespace glsld
         };
 
         const auto createNotificationHandler = []<typename ParamType>(NotificationHandlerType<ParamType> handler) {
-            return [handler](LanguageServer& server, const nlohmann::json& rpcBlob) {
+            return [handler](LanguageServer& server, const ClientMessage& message) {
+                TraceSpan span{"notification",
+                               TraceRecorder::IsEnabled() ? TraceRecorder::Get().InternString(message.method) : ""};
                 ParamType params = {};
-                if (auto itParam = rpcBlob.find("params");
-                    JsonSerializer<ParamType>::Deserialize(params, itParam != rpcBlob.end() ? *itParam : nullptr)) {
+                if (JsonReader reader{message.params}; JsonSerializer<ParamType>::Deserialize(params, reader)) {
                     std::invoke(handler, server.language.get(), std::move(params));
                 }
                 else {
@@ -278,12 +384,16 @@ namespace glsld
         handlerDispatchMap[lsp::LSPMethod_SetTrace]    = createNotificationHandler(&LanguageService::OnSetTrace);
         handlerDispatchMap[lsp::LSPMethod_Shutdown]    = createRequestHandler(&LanguageService::OnShutdown);
         handlerDispatchMap[lsp::LSPMethod_Exit]        = createNotificationHandler(&LanguageService::OnExit);
+        handlerDispatchMap[lsp::LSPMethod_CancelRequest] =
+            createNotificationHandler(&LanguageService::OnCancelRequest);
 
         handlerDispatchMap[lsp::LSPMethod_DocumentSymbol] = createRequestHandler(&LanguageService::OnDocumentSymbol);
         handlerDispatchMap[lsp::LSPMethod_SemanticTokensFull] =
             createRequestHandler(&LanguageService::OnSemanticTokensFull);
         handlerDispatchMap[lsp::LSPMethod_SemanticTokensFullDelta] =
             createRequestHandler(&LanguageService::OnSemanticTokensDelta);
+        handlerDispatchMap[lsp::LSPMethod_SemanticTokensRange] =
+            createRequestHandler(&LanguageService::OnSemanticTokensRange);
         handlerDispatchMap[lsp::LSPMethod_Completion]    = createRequestHandler(&LanguageService::OnCompletion);
         handlerDispatchMap[lsp::LSPMethod_SignatureHelp] = createRequestHandler(&LanguageService::OnSignatureHelp);
         handlerDispatchMap[lsp::LSPMethod_Hover]         = createRequestHandler(&LanguageService::OnHover);
@@ -291,13 +401,22 @@ namespace glsld
         handlerDispatchMap[lsp::LSPMethod_Definition]    = createRequestHandler(&LanguageService::OnDefinition);
         handlerDispatchMap[lsp::LSPMethod_InlayHint]     = createRequestHandler(&LanguageService::OnInlayHint);
         handlerDispatchMap[lsp::LSPMethod_FoldingRange]  = createRequestHandler(&LanguageService::OnFoldingRange);
+        handlerDispatchMap[lsp::LSPMethod_DocumentHighlight] =
+            createRequestHandler(&LanguageService::OnDocumentHighlight);
+        handlerDispatchMap[lsp::LSPMethod_CompletionItemResolve] =
+            createRequestHandler(&LanguageService::OnCompletionResolve);
 
         handlerDispatchMap[lsp::LSPMethod_DidOpenTextDocument] =
             createNotificationHandler(&LanguageService::OnDidOpenTextDocument);
         handlerDispatchMap[lsp::LSPMethod_DidChangeTextDocument] =
             createNotificationHandler(&LanguageService::OnDidChangeTextDocument);
+        handlerDispatchMap[lsp::LSPMethod_DidSaveTextDocument] =
+            createNotificationHandler(&LanguageService::OnDidSaveTextDocument);
         handlerDispatchMap[lsp::LSPMethod_DidCloseTextDocument] =
             createNotificationHandler(&LanguageService::OnDidCloseTextDocument);
+
+        handlerDispatchMap[lsp::LSPMethod_MemoryUsage] = createRequestHandler(&LanguageService::OnMemoryUsage);
+        handlerDispatchMap[lsp::LSPMethod_Statistics]  = createRequestHandler(&LanguageService::OnStatistics);
     }
 
 } // namespace glsld
\ No newline at end of file
@@ -3,6 +3,7 @@
 #include "Feature/Completion.h"
 #include "Feature/Definition.h"
 #include "Feature/Diagnostic.h"
+#include "Feature/DocumentHighlight.h"
 #include "Feature/DocumentSymbol.h"
 #include "Feature/FoldingRange.h"
 #include "Feature/Hover.h"
@@ -16,8 +17,63 @@
 #include "Support/SourceText.h"
 #include "Support/Uri.h"
 
+#include <algorithm>
+#include <iterator>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+
 namespace glsld
 {
+    auto CreateLanguageServiceExecutor() -> std::shared_ptr<LanguageServiceExecutor>
+    {
+        return std::make_shared<LanguageServiceExecutor>();
+    }
+
+    // Accounts the memory of all language services in the process against one budget, since they share the preambles
+    // and the stdlib cache.
+    struct MemoryAccountant
+    {
+        std::mutex mutex;
+        std::vector<LanguageService*> services;
+
+        // Incremented every time a document of any service is used, which orders documents for eviction.
+        std::atomic<uint64_t> accessTick = 0;
+    };
+
+    static auto GetMemoryAccountant() -> MemoryAccountant&
+    {
+        static MemoryAccountant accountant;
+        return accountant;
+    }
+
+    // Returns the committed bytes of the preamble, excluding its base preamble.
+    static auto GetPreambleMemorySize(const PrecompiledPreamble& preamble) -> size_t
+    {
+        return (preamble.GetSourceMemoryUsage() + preamble.GetAstMemoryUsage() + preamble.GetTokenMemoryUsage())
+            .committedBytes;
+    }
+
+    LanguageService::LanguageService(LanguageServer& server, std::shared_ptr<LanguageServiceExecutor> executor)
+        : server(server), executor(std::move(executor))
+    {
+        auto& accountant = GetMemoryAccountant();
+        std::lock_guard<std::mutex> lock{accountant.mutex};
+        accountant.services.push_back(this);
+    }
+
+    LanguageService::~LanguageService()
+    {
+        {
+            auto& accountant = GetMemoryAccountant();
+            std::lock_guard<std::mutex> lock{accountant.mutex};
+            std::erase(accountant.services, this);
+        }
+
+        WaitForPendingTasks();
+        stdexec::sync_wait(closingScope.on_empty());
+    }
+
     auto LanguageService::TextDocumentContext::InferShaderStageFromUri(StringView uri) -> GlslShaderStage
     {
         constexpr auto cases = std::to_array<std::pair<StringView, GlslShaderStage>>({
@@ -50,68 +106,301 @@ namespace glsld
         return GlslShaderStage::Unknown;
     }
 
-    auto LanguageService::TextDocumentContext::InitializeTextDocument(const lsp::DidOpenTextDocumentParams& params)
-        -> void
+    auto LanguageService::TextDocumentContext::InitializeTextDocument(const lsp::DidOpenTextDocumentParams& params,
+                                                                      bool countUtf16Characters) -> void
     {
         backgroundCompilation = std::make_shared<BackgroundCompilation>(
-            params.textDocument.version, UnescapeHttp(params.textDocument.uri), params.textDocument.text,
+            params.textDocument.version, UnescapeHttp(params.textDocument.uri),
+            TextDocumentBuffer{StringView{params.textDocument.text}, countUtf16Characters},
             LanguageConfig{.stage = InferShaderStageFromUri(params.textDocument.uri)}, nullptr);
     }
 
     auto LanguageService::TextDocumentContext::UpdateTextDocument(const lsp::DidChangeTextDocumentParams& params)
         -> void
     {
-        backgroundCompilation->SetExpired();
-
-        // TODO: Could have a buffer manager so we don't keep allocating new buffers if user types faster than
-        // compilation
-        // TODO: Research whether adding a line-offset hints vector speeds up editing
-        auto sourceBuffer = backgroundCompilation->GetBuffer().Str();
+        // The buffer shares unchanged chunks with the previous version, so only the edited lines are copied.
+        auto buffer = backgroundCompilation->GetBuffer();
         for (const auto& change : params.contentChanges) {
             if (change.range) {
-                ApplySourceChange(sourceBuffer, FromLspRange(*change.range), StringView{change.text});
+                buffer.ApplyChange(FromLspRange(*change.range), StringView{change.text});
             }
             else {
-                sourceBuffer = std::move(change.text);
+                buffer = TextDocumentBuffer{StringView{change.text}, buffer.GetCountUtf16Characters()};
             }
         }
 
+        auto previousCompilation =
+            std::exchange(backgroundCompilation, CreateNextCompilation(params.textDocument.version, std::move(buffer)));
+
+        // If the previous compilation is still waiting in the coalescing window, it's merged into the new one.
+        // Otherwise, it's cancelled since its result is no longer useful, and queries waiting on it move to the new
+        // one. An evicted compilation is never scheduled, so it's always merged.
+        if (!BackgroundCompilation::TryCoalesce(previousCompilation, backgroundCompilation)) {
+            previousCompilation->Supersede(backgroundCompilation);
+        }
+        evicted = false;
+    }
+
+    auto LanguageService::TextDocumentContext::CreateNextCompilation(int version, TextDocumentBuffer buffer) const
+        -> std::shared_ptr<BackgroundCompilation>
+    {
         auto nextConfig   = backgroundCompilation->GetNextLanguageConfig();
         auto nextPreamble = backgroundCompilation->GetNextPreamble();
         if (nextPreamble && nextPreamble->GetLanguageConfig() != nextConfig) {
             // Preamble is outdated, discard it
             nextPreamble = nullptr;
         }
+
+        return std::make_shared<BackgroundCompilation>(version, backgroundCompilation->GetUri().Str(),
+                                                       std::move(buffer), nextConfig, nextPreamble);
+    }
+
+    auto LanguageService::TextDocumentContext::Evict() -> void
+    {
+        GLSLD_ASSERT(!evicted && backgroundCompilation->IsAvailable());
         backgroundCompilation =
-            std::make_shared<BackgroundCompilation>(params.textDocument.version, UnescapeHttp(params.textDocument.uri),
-                                                    std::move(sourceBuffer), nextConfig, nextPreamble);
+            CreateNextCompilation(backgroundCompilation->GetVersion(), backgroundCompilation->GetBuffer());
+        evicted = true;
+    }
+
+    auto LanguageService::UpdateDegradedMode(TextDocumentContext& ctx, const BackgroundCompilation& compilation)
+        -> void
+    {
+        const auto& config = server.GetConfig().languageService.largeDocument;
+        auto size          = compilation.GetBuffer().GetSize();
+        auto lineCount     = compilation.GetBuffer().GetLineCount();
+        auto compileTimeMs = std::chrono::duration_cast<std::chrono::milliseconds>(ctx.GetAverageCompileTime()).count();
+
+        bool degraded = (config.maxSize != 0 && size > config.maxSize) ||
+                        (config.maxLineCount != 0 && lineCount > config.maxLineCount) ||
+                        (config.maxCompileTimeMs != 0 && static_cast<size_t>(compileTimeMs) > config.maxCompileTimeMs);
+        if (!ctx.SetDegraded(degraded)) {
+            return;
+        }
+
+        auto message =
+            degraded ? fmt::format("Document {} ({} bytes, {} lines, compiled in {} ms) is too large to be handled "
+                                   "normally. Semantic tokens are lexical only, inlay hints are disabled and glslang "
+                                   "validation only runs on save.",
+                                   compilation.GetUri(), size, lineCount, compileTimeMs)
+                     : fmt::format("Document {} is no longer handled in degraded mode.", compilation.GetUri());
+        server.SendServerNotification(lsp::LSPMethod_LogMessage,
+                                      lsp::LogMessageParams{.type = lsp::MessageType::Info, .message = message});
+        server.LogInfo("{}", message);
+    }
+
+    auto LanguageService::IsDegradedDocument(StringView uri) -> bool
+    {
+        auto itCtx = documentContexts.Find(uri);
+        return itCtx != documentContexts.end() && itCtx->second && itCtx->second->IsDegraded();
+    }
+
+    auto LanguageService::GetSemanticTokenConfig(StringView uri) -> SemanticTokenConfig
+    {
+        auto config = server.GetConfig().languageService.semanticTokens;
+        if (IsDegradedDocument(uri)) {
+            config.lexicalOnly = true;
+        }
+
+        return config;
+    }
+
+    auto LanguageService::TouchDocument(TextDocumentContext& ctx) -> void
+    {
+        ctx.SetLastAccessTick(GetMemoryAccountant().accessTick.fetch_add(1, std::memory_order_relaxed) + 1);
+        EnforceMemoryBudget();
+    }
+
+    auto LanguageService::EnforceMemoryBudget() -> void
+    {
+        const auto& config = server.GetConfig().languageService.memoryBudget;
+        if (config.maxMemoryMb == 0) {
+            return;
+        }
+
+        auto& accountant = GetMemoryAccountant();
+        std::lock_guard<std::mutex> accountantLock{accountant.mutex};
+
+        // The documents of this service are locked by the caller. Other services are skipped if their documents are
+        // locked at the moment, since they may be waiting for the accountant while holding them. They are accounted
+        // again the next time they are used or publish a compilation.
+        std::vector<LanguageService*> services;
+        std::vector<std::unique_lock<std::mutex>> serviceLocks;
+        for (auto service : accountant.services) {
+            if (service != this) {
+                std::unique_lock<std::mutex> lock{service->documentMutex, std::try_to_lock};
+                if (!lock.owns_lock()) {
+                    continue;
+                }
+                serviceLocks.push_back(std::move(lock));
+            }
+            services.push_back(service);
+        }
+
+        // The stdlib cores retained by the process-wide cache can't be evicted, but they still take up the budget.
+        size_t totalSize = 0;
+        std::unordered_set<const PrecompiledPreamble*> countedPreambles;
+        for (const auto& core : GetCachedStdlibCores()) {
+            totalSize += GetPreambleMemorySize(*core);
+            countedPreambles.insert(core.get());
+        }
+
+        // Only the compilations that are done are counted, since they are the only ones that could be evicted. Their
+        // preambles are counted once, as they are shared by documents and other preambles.
+        std::vector<std::pair<LanguageService*, TextDocumentContext*>> candidates;
+        for (auto service : services) {
+            for (const auto& [uri, ctx] : service->documentContexts) {
+                if (!ctx || ctx->GetBackgroundCompilation()->GetResultMemorySize() == 0) {
+                    continue;
+                }
+
+                auto& compilation = *ctx->GetBackgroundCompilation();
+                totalSize += compilation.GetResultMemorySize();
+                candidates.push_back({service, ctx.get()});
+
+                const auto& preamble = compilation.GetLanguageQueryInfo().GetCompilerResult().GetPreamble();
+                for (auto p = preamble.get(); p && countedPreambles.insert(p).second; p = p->GetBasePreamble()) {
+                    totalSize += GetPreambleMemorySize(*p);
+                }
+            }
+        }
+
+        const size_t budget = config.maxMemoryMb * 1024 * 1024;
+        if (totalSize <= budget || candidates.empty()) {
+            return;
+        }
+
+        // Keep the most recently used document even if it alone exceeds the budget, otherwise it would be compiled
+        // again for every query.
+        std::ranges::sort(candidates, {}, [](const auto& candidate) { return candidate.second->GetLastAccessTick(); });
+        candidates.pop_back();
+        for (auto [service, ctx] : candidates) {
+            if (totalSize <= budget) {
+                break;
+            }
+
+            auto size = ctx->GetBackgroundCompilation()->GetResultMemorySize();
+            service->server.LogInfo(
+                "Evicting document {} version {} ({} bytes) to stay within the memory budget of {} MB",
+                ctx->GetBackgroundCompilation()->GetUri(), ctx->GetBackgroundCompilation()->GetVersion(), size,
+                config.maxMemoryMb);
+            ctx->Evict();
+            totalSize -= size;
+        }
     }
 
-    auto LanguageService::ScheduleBackgroundCompilation(TextDocumentContext& ctx) -> void
+    auto LanguageService::RestoreEvictedDocument(TextDocumentContext& ctx) -> void
     {
+        if (ctx.ResetEvicted()) {
+            server.LogInfo("Restoring evicted document {} version {}", ctx.GetBackgroundCompilation()->GetUri(),
+                           ctx.GetBackgroundCompilation()->GetVersion());
+            ScheduleBackgroundCompilation(ctx, true);
+        }
+    }
+
+    auto LanguageService::ScheduleBackgroundCompilation(TextDocumentContext& ctx, bool restoring) -> void
+    {
+        auto coalescingWindow = restoring ? std::chrono::milliseconds::zero() : ctx.GetCoalescingWindow();
+        if (ctx.IsDegraded() && !restoring) {
+            coalescingWindow = std::max(
+                coalescingWindow,
+                std::chrono::milliseconds{server.GetConfig().languageService.largeDocument.coalescingWindowMs});
+        }
+
         ctx.GetAsyncScope().spawn(
+            // Wait for the coalescing window, so that changes arriving in the meantime are merged into one compilation
+            exec::schedule_after(executor->timedSchedulerCtx.get_scheduler(), coalescingWindow) |
+            // Mark when the compilation is ready to run, so the time spent queueing for a worker could be measured
+            stdexec::then([] { return TraceRecorder::Clock::now(); }) |
             // Switch to background worker thread
-            stdexec::schedule(backgroundWorkerCtx.get_scheduler()) |
+            stdexec::continues_on(executor->backgroundWorkerCtx.get_scheduler()) |
             // Do the background compilation work
-            stdexec::then([&server = server, backgroundCompilation = ctx.GetBackgroundCompilation()]() {
+            stdexec::then([this, &server = server, &ctx, restoring,
+                           backgroundCompilation = ctx.GetBackgroundCompilation()](
+                              TraceRecorder::Clock::time_point readyTime) {
+                auto startTime   = TraceRecorder::Clock::now();
+                auto& statistics = server.GetStatistics().GetCompilationStatistics();
+                statistics.queueWait.Record(startTime - readyTime);
+                TraceRecorder::Get().Record("queue", "queueWait", readyTime, startTime,
+                                            backgroundCompilation->GetUri());
+
                 SimpleTimer timer;
                 backgroundCompilation->Run();
+                if (backgroundCompilation->IsExpired()) {
+                    // A compilation abandoned because the document is closed doesn't have a newer version.
+                    if (backgroundCompilation->IsSuperseded()) {
+                        statistics.supersededCount.fetch_add(1, std::memory_order_relaxed);
+                    }
+                    else {
+                        statistics.cancelledCount.fetch_add(1, std::memory_order_relaxed);
+                    }
+                    server.LogInfo("Background compilation of ({} version {}) is coalesced or cancelled after {} ms",
+                                   backgroundCompilation->GetUri(), backgroundCompilation->GetVersion(),
+                                   timer.GetElapsedMilliseconds());
+                    return;
+                }
+                statistics.completedCount.fetch_add(1, std::memory_order_relaxed);
+                statistics.execution.Record(timer.GetElapsedTime<SimpleTimer::Duration>());
+                if (backgroundCompilation->IsPreambleCacheHit()) {
+                    statistics.preambleCacheHitCount.fetch_add(1, std::memory_order_relaxed);
+                }
+                else {
+                    statistics.preambleCacheMissCount.fetch_add(1, std::memory_order_relaxed);
+                }
+                ctx.RecordCompileTime(timer.GetElapsedTime<SimpleTimer::Duration>());
+                UpdateDegradedMode(ctx, *backgroundCompilation);
                 server.LogInfo("Background compilation of ({} version {}) took {} ms", backgroundCompilation->GetUri(),
                                backgroundCompilation->GetVersion(), timer.GetElapsedMilliseconds());
+
+                // The published result counts towards the memory budget, which may be exceeded without any further
+                // message from the client.
+                {
+                    std::lock_guard<std::mutex> lock{documentMutex};
+                    EnforceMemoryBudget();
+                }
+
+                // Publish diagnostics reported by the compilation right away. They are replaced later if the glslang
+                // validation is enabled. A restored document has its diagnostics published already.
+                const auto& diagnosticConfig = server.GetConfig().languageService.diagnostic;
+                if (diagnosticConfig.enable && !restoring) {
+                    server.SendServerNotification(
+                        lsp::LSPMethod_PublishDiagnostic,
+                        lsp::PublishDiagnosticParams{
+                            .uri         = backgroundCompilation->GetUri().Str(),
+                            .version     = backgroundCompilation->GetVersion(),
+                            .diagnostics = HandleDiagnostic(diagnosticConfig,
+                                                            backgroundCompilation->GetLanguageQueryInfo()),
+                        });
+                }
+            }) |
+            // If stopped before running, the compilation is expired. `Run` then only releases its waiters.
+            stdexec::upon_stopped([&server = server, backgroundCompilation = ctx.GetBackgroundCompilation()] {
+                auto& statistics = server.GetStatistics().GetCompilationStatistics();
+                statistics.cancelledCount.fetch_add(1, std::memory_order_relaxed);
+                backgroundCompilation->Run();
             }));
     }
 
     auto LanguageService::ScheduleBackgroundDiagnostic(TextDocumentContext& ctx) -> void
     {
-        if (ctx.GetBackgroundCompilation()->GetLanguageConfig().stage == GlslShaderStage::Unknown) {
+        const auto& diagnosticConfig = server.GetConfig().languageService.diagnostic;
+        if (!diagnosticConfig.enable || !diagnosticConfig.enableGlslangValidation || !IsGlslangValidationAvailable() ||
+            ctx.GetBackgroundCompilation()->GetLanguageConfig().stage == GlslShaderStage::Unknown) {
             return;
         }
 
+        // The diagnostic waits for the compilation, which isn't scheduled for an evicted document.
+        RestoreEvictedDocument(ctx);
+
         ctx.GetAsyncScope().spawn(
             // Wait for long enough to debounce rapid changes
-            exec::schedule_after(timedSchedulerCtx.get_scheduler(), std::chrono::seconds(1)) |
+            exec::schedule_after(executor->timedSchedulerCtx.get_scheduler(), std::chrono::seconds(1)) |
+            // Wait for the background compilation, since its diagnostics are published together
+            stdexec::let_value([backgroundCompilation = ctx.GetBackgroundCompilation()] {
+                return backgroundCompilation->AsyncWaitAvailable();
+            }) |
             // Switch to background worker thread
-            stdexec::continues_on(backgroundWorkerCtx.get_scheduler()) |
+            stdexec::continues_on(executor->backgroundWorkerCtx.get_scheduler()) |
             // Do the background diagnostic work
             stdexec::then([&server = server, backgroundCompilation = ctx.GetBackgroundCompilation()] {
                 if (backgroundCompilation->IsExpired()) {
@@ -120,14 +409,22 @@ namespace glsld
                 }
                 else {
                     SimpleTimer timer;
-                    auto diagnostics = HandleDiagnostic(
-                        server.GetConfig().languageService.diagnostic, backgroundCompilation->GetUri(),
-                        backgroundCompilation->GetVersion(), backgroundCompilation->GetNextLanguageConfig(),
-                        backgroundCompilation->GetBuffer());
+                    const auto& diagnosticConfig = server.GetConfig().languageService.diagnostic;
+                    auto diagnostics =
+                        HandleDiagnostic(diagnosticConfig, backgroundCompilation->GetLanguageQueryInfo());
+                    std::ranges::move(HandleGlslangDiagnostic(diagnosticConfig,
+                                                              backgroundCompilation->GetNextLanguageConfig(),
+                                                              backgroundCompilation->GetSourceText()),
+                                      std::back_inserter(diagnostics));
 
                     if (!backgroundCompilation->IsExpired()) {
                         // Computing diagnostics may consume some time, so we check expiration again before sending
-                        server.SendServerNotification(lsp::LSPMethod_PublishDiagnostic, diagnostics);
+                        server.SendServerNotification(lsp::LSPMethod_PublishDiagnostic,
+                                                      lsp::PublishDiagnosticParams{
+                                                          .uri         = backgroundCompilation->GetUri().Str(),
+                                                          .version     = backgroundCompilation->GetVersion(),
+                                                          .diagnostics = std::move(diagnostics),
+                                                      });
                     }
                     else {
                         server.LogInfo("Diagnostic compilation of ({} version {}) is discarded",
@@ -142,14 +439,26 @@ namespace glsld
 
     auto LanguageService::ScheduleBackgroundClosingDocument(std::unique_ptr<TextDocumentContext> ctx) -> void
     {
-        // FIXME: stop operations that are still running on this context
-        stdexec::start_detached(
-            stdexec::starts_on(backgroundWorkerCtx.get_scheduler(), ctx->GetAsyncScope().on_empty()) |
+        // Stop operations that are still running on this context. The background compilation is abandoned, and
+        // pending language queries are responded with an error.
+        ctx->GetBackgroundCompilation()->SetExpired();
+        ctx->GetAsyncScope().request_stop();
+
+        closingScope.spawn(
+            stdexec::starts_on(executor->backgroundWorkerCtx.get_scheduler(), ctx->GetAsyncScope().on_empty()) |
             stdexec::then([ctx = std::move(ctx)]() {
                 // Do nothing. Just wait for async scope to be empty before destroying the context.
             }));
     }
 
+    auto LanguageService::CancelExpiredQuery(int requestId) -> void
+    {
+        if (QueryDeadline::IsCurrentTruncated()) {
+            server.LogInfo("Request {} is cancelled since its result is partial", requestId);
+            server.CancelRequest(requestId);
+        }
+    }
+
     auto LanguageService::PublishInactiveRegions(StringView uri, const LanguageQueryInfo& queryInfo) -> void
     {
         if (enableGlsldExtensions) {
@@ -166,6 +475,154 @@ namespace glsld
         }
     }
 
+    static auto FormatLatencySummary(const lsp::LatencySummary& summary) -> std::string
+    {
+        return fmt::format("count {}, mean {} us, p50 {} us, p90 {} us, p99 {} us, max {} us", summary.count,
+                           summary.mean, summary.p50, summary.p90, summary.p99, summary.max);
+    }
+
+    auto LanguageService::LogStatistics() -> void
+    {
+        lsp::StatisticsResult statistics = server.GetStatistics().Collect();
+        for (const auto& request : statistics.requests) {
+            server.LogInfo("Request {}: {} cancelled", request.method, request.cancelled);
+            server.LogInfo("    total: {}", FormatLatencySummary(request.total));
+            if (request.execution.count != 0) {
+                server.LogInfo("    queue wait: {}", FormatLatencySummary(request.queueWait));
+                server.LogInfo("    execution: {}", FormatLatencySummary(request.execution));
+            }
+        }
+
+        const auto& compilation = statistics.compilation;
+        server.LogInfo("Compilation: {} completed, {} superseded, {} cancelled, preamble cache {} hits / {} misses",
+                       compilation.completed, compilation.superseded, compilation.cancelled,
+                       compilation.preambleCacheHits, compilation.preambleCacheMisses);
+        server.LogInfo("    queue wait: {}", FormatLatencySummary(compilation.queueWait));
+        server.LogInfo("    execution: {}", FormatLatencySummary(compilation.execution));
+    }
+
+    static auto ToLspMemoryUsage(const MemoryUsage& usage) -> lsp::MemoryUsageInfo
+    {
+        return lsp::MemoryUsageInfo{.allocatedBytes = usage.allocatedBytes, .committedBytes = usage.committedBytes};
+    }
+
+    // Add the preamble and its bases to the result if they are not yet, and return the index of the preamble.
+    static auto CollectPreambleMemoryUsage(lsp::MemoryUsageResult& result,
+                                           std::unordered_map<const PrecompiledPreamble*, lsp::uinteger>& indexLookup,
+                                           const PrecompiledPreamble& preamble) -> lsp::uinteger
+    {
+        if (auto it = indexLookup.find(&preamble); it != indexLookup.end()) {
+            return it->second;
+        }
+
+        std::optional<lsp::uinteger> base;
+        if (auto basePreamble = preamble.GetBasePreamble()) {
+            base = CollectPreambleMemoryUsage(result, indexLookup, *basePreamble);
+        }
+
+        auto source = preamble.GetSourceMemoryUsage();
+        auto ast    = preamble.GetAstMemoryUsage();
+        auto tokens = preamble.GetTokenMemoryUsage();
+        auto index  = static_cast<lsp::uinteger>(result.preambles.size());
+        result.preambles.push_back(lsp::PreambleMemoryUsage{
+            .base          = base,
+            .documentCount = 0,
+            .source        = ToLspMemoryUsage(source),
+            .ast           = ToLspMemoryUsage(ast),
+            .tokens        = ToLspMemoryUsage(tokens),
+            .total         = ToLspMemoryUsage(source + ast + tokens),
+        });
+        indexLookup[&preamble] = index;
+        return index;
+    }
+
+    auto LanguageService::CollectSemanticTokenMemoryUsage(TextDocumentContext& ctx) -> MemoryUsage
+    {
+        auto stateObject = ctx.FindLanguageFeatureState<SemanticTokenState>();
+        if (stateObject == nullptr || !stateObject->mutex.TryLock()) {
+            return {};
+        }
+
+        auto result = MemoryUsage::Of(std::any_cast<SemanticTokenState&>(stateObject->state).cachedTokens);
+        stateObject->mutex.Unlock();
+        return result;
+    }
+
+    auto LanguageService::WaitForPendingTasks() -> void
+    {
+        for (const auto& [uri, ctx] : documentContexts) {
+            if (ctx) {
+                stdexec::sync_wait(ctx->GetAsyncScope().on_empty());
+            }
+        }
+    }
+
+    auto LanguageService::CollectMemoryUsage() -> lsp::MemoryUsageResult
+    {
+        std::lock_guard<std::mutex> lock{documentMutex};
+        lsp::MemoryUsageResult result;
+        std::unordered_map<const PrecompiledPreamble*, lsp::uinteger> preambleIndexLookup;
+
+        MemoryUsage total;
+        for (const auto& [uri, ctx] : documentContexts) {
+            if (!ctx) {
+                continue;
+            }
+
+            auto& compilation = *ctx->GetBackgroundCompilation();
+
+            lsp::DocumentMemoryUsage& entry = result.documents.emplace_back();
+            entry.uri                       = uri;
+            entry.version                   = compilation.GetVersion();
+            entry.compiled                  = compilation.IsAvailable();
+            entry.evicted                   = ctx->IsEvicted();
+
+            MemoryUsage source = compilation.GetSourceMemoryUsage();
+            MemoryUsage ast;
+            MemoryUsage tokens;
+            MemoryUsage preprocessInfo;
+            MemoryUsage queryIndex;
+            MemoryUsage semanticTokens = CollectSemanticTokenMemoryUsage(*ctx);
+            if (entry.compiled) {
+                // The result is immutable once available, so it's safe to inspect while queries are running.
+                const auto& queryInfo      = compilation.GetLanguageQueryInfo();
+                const auto& compilerResult = queryInfo.GetCompilerResult();
+                ast                        = compilerResult.GetAstMemoryUsage();
+                tokens                     = compilerResult.GetTokenMemoryUsage();
+                preprocessInfo             = queryInfo.GetPreprocessInfo().GetMemoryUsage();
+                queryIndex                 = queryInfo.GetIndexMemoryUsage();
+
+                if (const auto& preamble = compilerResult.GetPreamble()) {
+                    entry.preamble = CollectPreambleMemoryUsage(result, preambleIndexLookup, *preamble);
+                    result.preambles[*entry.preamble].documentCount += 1;
+                }
+            }
+
+            auto documentTotal   = source + ast + tokens + preprocessInfo + queryIndex + semanticTokens;
+            entry.source         = ToLspMemoryUsage(source);
+            entry.ast            = ToLspMemoryUsage(ast);
+            entry.tokens         = ToLspMemoryUsage(tokens);
+            entry.preprocessInfo = ToLspMemoryUsage(preprocessInfo);
+            entry.queryIndex     = ToLspMemoryUsage(queryIndex);
+            entry.semanticTokens = ToLspMemoryUsage(semanticTokens);
+            entry.total          = ToLspMemoryUsage(documentTotal);
+            total += documentTotal;
+        }
+
+        // The stdlib cores are retained by the process-wide cache even if no open document uses them.
+        for (const auto& core : GetCachedStdlibCores()) {
+            CollectPreambleMemoryUsage(result, preambleIndexLookup, *core);
+        }
+
+        for (const auto& preamble : result.preambles) {
+            total += MemoryUsage{.allocatedBytes = preamble.total.allocatedBytes,
+                                 .committedBytes = preamble.total.committedBytes};
+        }
+        result.total = ToLspMemoryUsage(total);
+
+        return result;
+    }
+
     auto LanguageService::OnInitialize(int requestId, lsp::InitializeParams params) -> void
     {
         if (params.initializationOptions && params.initializationOptions->supportGlsldExtensions &&
@@ -173,13 +630,25 @@ namespace glsld
             enableGlsldExtensions = true;
         }
 
+        // Prefer UTF-8 positions if the client supports them, since columns are then plain byte offsets. Otherwise,
+        // fall back to UTF-16 which every client supports.
+        if (params.capabilities && params.capabilities->general && params.capabilities->general->positionEncodings) {
+            const auto& encodings = *params.capabilities->general->positionEncodings;
+            if (std::ranges::find(encodings, lsp::PositionEncodingKind_UTF8) != encodings.end()) {
+                countUtf16Characters = false;
+            }
+        }
+
         auto result = lsp::InitializeResult{
             .capabilities =
                 {
+                    .positionEncoding =
+                        countUtf16Characters ? lsp::PositionEncodingKind_UTF16 : lsp::PositionEncodingKind_UTF8,
                     .textDocumentSync =
                         {
                             .openClose = true,
                             .change    = lsp::TextDocumentSyncKind::Incremental,
+                            .save      = true,
                         },
                     .completionProvider    = GetCompletionOptions(server.GetConfig().languageService.completion),
                     .hoverProvider         = GetHoverOptions(server.GetConfig().languageService.hover),
@@ -187,6 +656,8 @@ namespace glsld
                     // .declarationProvider   = GetDeclarationOptions(server.GetConfig().languageService.declaration),
                     .definitionProvider = GetDefinitionOptions(server.GetConfig().languageService.definition),
                     .referencesProvider = GetReferenceOptions(server.GetConfig().languageService.reference),
+                    .documentHighlightProvider =
+                        GetDocumentHighlightOptions(server.GetConfig().languageService.documentHighlight),
                     .documentSymbolProvider =
                         GetDocumentSymbolOptions(server.GetConfig().languageService.documentSymbol),
                     .foldingRangeProvider = GetFoldingRangeOptions(server.GetConfig().languageService.foldingRange),
@@ -201,7 +672,8 @@ namespace glsld
                 },
         };
         server.SendServerResponse(requestId, result, false);
-        server.LogInfo("GLSLD initialized");
+        server.LogInfo("GLSLD initialized with {} positions",
+                       countUtf16Characters ? lsp::PositionEncodingKind_UTF16 : lsp::PositionEncodingKind_UTF8);
     }
 
     auto LanguageService::OnInitialized(lsp::InitializedParams) -> void
@@ -219,6 +691,7 @@ namespace glsld
         // We do nothing on shutdown request but an acknowledgement
         server.SendServerResponse(requestId, nullptr, false);
         server.LogInfo("GLSLD shutting down");
+        LogStatistics();
     }
 
     auto LanguageService::OnExit(std::nullptr_t) -> void
@@ -226,6 +699,14 @@ namespace glsld
         server.Shutdown();
     }
 
+    auto LanguageService::OnCancelRequest(lsp::CancelParams params) -> void
+    {
+        // A pending query is skipped once the request is cancelled. A query that is already running is not interrupted,
+        // but its result is replaced by an error.
+        server.CancelRequest(params.id);
+        server.LogInfo("Cancelling request {}", params.id);
+    }
+
 #pragma region Document Synchronization
 
     auto LanguageService::OnDidOpenTextDocument(lsp::DidOpenTextDocumentParams params) -> void
@@ -237,13 +718,19 @@ namespace glsld
             return;
         }
 
-        ctx = std::make_unique<TextDocumentContext>(params);
+        ctx = std::make_unique<TextDocumentContext>(params, countUtf16Characters);
+        TouchDocument(*ctx);
+        UpdateDegradedMode(*ctx, *ctx->GetBackgroundCompilation());
         ScheduleBackgroundCompilation(*ctx);
-        ScheduleBackgroundDiagnostic(*ctx);
+        if (!ctx->IsDegraded()) {
+            ScheduleBackgroundDiagnostic(*ctx);
+        }
 
         server.LogInfo("Opened document: {}. New version is {}", params.textDocument.uri, params.textDocument.version);
-        server.LogDebug("Document updated: {}\n{}", params.textDocument.uri,
-                        ctx->GetBackgroundCompilation()->GetBuffer());
+        if (server.ShouldLog(LoggingLevel::Debug)) {
+            server.LogDebug("Document updated: {}\n{}", params.textDocument.uri,
+                            ctx->GetBackgroundCompilation()->GetBuffer().GetText());
+        }
     }
 
     auto LanguageService::OnDidChangeTextDocument(lsp::DidChangeTextDocumentParams params) -> void
@@ -255,12 +742,33 @@ namespace glsld
         }
 
         ctx->UpdateTextDocument(params);
+        TouchDocument(*ctx);
+        UpdateDegradedMode(*ctx, *ctx->GetBackgroundCompilation());
         ScheduleBackgroundCompilation(*ctx);
-        ScheduleBackgroundDiagnostic(*ctx);
+        if (!ctx->IsDegraded()) {
+            ScheduleBackgroundDiagnostic(*ctx);
+        }
 
         server.LogInfo("Edited document: {}. New version is {}", params.textDocument.uri, params.textDocument.version);
-        server.LogDebug("Document updated: {}\n{}", params.textDocument.uri,
-                        ctx->GetBackgroundCompilation()->GetBuffer());
+        if (server.ShouldLog(LoggingLevel::Debug)) {
+            server.LogDebug("Document updated: {}\n{}", params.textDocument.uri,
+                            ctx->GetBackgroundCompilation()->GetBuffer().GetText());
+        }
+    }
+
+    auto LanguageService::OnDidSaveTextDocument(lsp::DidSaveTextDocumentParams params) -> void
+    {
+        auto itCtx = documentContexts.Find(params.textDocument.uri);
+        if (itCtx == documentContexts.end() || !itCtx->second) {
+            // Bad notification. Document is not open.
+            return;
+        }
+
+        // Documents in degraded mode skip the glslang validation on edits, so it's only run when they are saved.
+        if (itCtx->second->IsDegraded()) {
+            ScheduleBackgroundDiagnostic(*itCtx->second);
+            server.LogInfo("Scheduled diagnostic of saved document: {}", params.textDocument.uri);
+        }
     }
 
     auto LanguageService::OnDidCloseTextDocument(lsp::DidCloseTextDocumentParams params) -> void
@@ -286,14 +794,17 @@ namespace glsld
     {
         auto uri = params.textDocument.uri;
         server.LogInfo("Received request {} {}: {}", requestId, "documentSymbol", uri);
-        ScheduleLanguageQuery<std::monostate>(uri, [&server = this->server, requestId, params = std::move(params)](
-                                                       const LanguageQueryInfo& queryInfo, std::monostate&) {
-            SimpleTimer timer;
-            auto result = HandleDocumentSymbol(server.GetConfig().languageService.documentSymbol, queryInfo, params);
-            server.SendServerResponse(requestId, result, false);
-            server.LogInfo("Responded to request {} {}. Processing took {} ms", requestId, "documentSymbol",
-                           timer.GetElapsedMilliseconds());
-        });
+        ScheduleLanguageQuery<std::monostate>(
+            requestId, uri, server.GetConfig().languageService.documentSymbol.timeBudgetMs,
+            [this, requestId, params = std::move(params)](const LanguageQueryInfo& queryInfo, std::monostate&) {
+                SimpleTimer timer;
+                auto result =
+                    HandleDocumentSymbol(server.GetConfig().languageService.documentSymbol, queryInfo, params);
+                CancelExpiredQuery(requestId);
+                server.SendServerResponse(requestId, result, false);
+                server.LogInfo("Responded to request {} {}. Processing took {} ms", requestId, "documentSymbol",
+                               timer.GetElapsedMilliseconds());
+            });
     }
 
     auto LanguageService::OnSemanticTokensFull(int requestId, lsp::SemanticTokensParams params) -> void
@@ -301,11 +812,12 @@ namespace glsld
         auto uri = params.textDocument.uri;
         server.LogInfo("Received request {} {}: {}", requestId, "semanticTokensFull", uri);
         ScheduleLanguageQuery<SemanticTokenState>(
-            uri, [this, requestId, params = std::move(params)](const LanguageQueryInfo& queryInfo,
-                                                               SemanticTokenState& state) {
+            requestId, uri, server.GetConfig().languageService.semanticTokens.timeBudgetMs,
+            [this, requestId, config = GetSemanticTokenConfig(uri),
+             params = std::move(params)](const LanguageQueryInfo& queryInfo, SemanticTokenState& state) {
                 SimpleTimer timer;
-                lsp::SemanticTokens result =
-                    HandleSemanticTokens(server.GetConfig().languageService.semanticTokens, queryInfo, state, params);
+                lsp::SemanticTokens result = HandleSemanticTokens(config, queryInfo, state, params);
+                CancelExpiredQuery(requestId);
                 server.SendServerResponse(requestId, result, false);
                 server.LogInfo("Responded to request {} {}. Processing took {} ms", requestId, "semanticTokensFull",
                                timer.GetElapsedMilliseconds());
@@ -318,34 +830,87 @@ namespace glsld
     {
         auto uri = params.textDocument.uri;
         server.LogInfo("Received request {} {}: {}", requestId, "semanticTokensDelta", uri);
-        ScheduleLanguageQuery<SemanticTokenState>(uri, [this, requestId,
-                                                        params = std::move(params)](const LanguageQueryInfo& queryInfo,
-                                                                                    SemanticTokenState& state) {
-            SimpleTimer timer;
-            std::variant<lsp::SemanticTokens, lsp::SemanticTokensDelta> result =
-                HandleSemanticTokensDelta(server.GetConfig().languageService.semanticTokens, queryInfo, state, params);
-            std::visit([&](auto&& arg) { server.SendServerResponse(requestId, arg, false); }, result);
-
-            server.LogInfo("Responded to request {} {}. Processing took {} ms", requestId, "semanticTokensDelta",
-                           timer.GetElapsedMilliseconds());
-
-            PublishInactiveRegions(params.textDocument.uri, queryInfo);
-        });
+        ScheduleLanguageQuery<SemanticTokenState>(
+            requestId, uri, server.GetConfig().languageService.semanticTokens.timeBudgetMs,
+            [this, requestId, config = GetSemanticTokenConfig(uri),
+             params = std::move(params)](const LanguageQueryInfo& queryInfo, SemanticTokenState& state) {
+                SimpleTimer timer;
+                std::variant<lsp::SemanticTokens, lsp::SemanticTokensDelta> result =
+                    HandleSemanticTokensDelta(config, queryInfo, state, params);
+                CancelExpiredQuery(requestId);
+                std::visit([&](auto&& arg) { server.SendServerResponse(requestId, arg, false); }, result);
+
+                server.LogInfo("Responded to request {} {}. Processing took {} ms", requestId, "semanticTokensDelta",
+                               timer.GetElapsedMilliseconds());
+
+                PublishInactiveRegions(params.textDocument.uri, queryInfo);
+            });
+    }
+
+    auto LanguageService::OnSemanticTokensRange(int requestId, lsp::SemanticTokensRangeParams params) -> void
+    {
+        auto uri = params.textDocument.uri;
+        server.LogInfo("Received request {} {}: {}", requestId, "semanticTokensRange", uri);
+        ScheduleLanguageQuery<std::monostate>(
+            requestId, uri, server.GetConfig().languageService.semanticTokens.timeBudgetMs,
+            [this, requestId, config = GetSemanticTokenConfig(uri),
+             params = std::move(params)](const LanguageQueryInfo& queryInfo, std::monostate&) {
+                SimpleTimer timer;
+                lsp::SemanticTokens result = HandleSemanticTokensRange(config, queryInfo, params);
+                CancelExpiredQuery(requestId);
+                server.SendServerResponse(requestId, result, false);
+                server.LogInfo("Responded to request {} {}. Processing took {} ms", requestId, "semanticTokensRange",
+                               timer.GetElapsedMilliseconds());
+            });
     }
 
     auto LanguageService::OnCompletion(int requestId, lsp::CompletionParams params) -> void
     {
         auto uri = params.textDocument.uri;
         server.LogInfo("Received request {} {}: {}", requestId, "completion", uri);
-        ScheduleLanguageQuery<CompletionState>(uri, [this, requestId, params = std::move(params)](
-                                                        const LanguageQueryInfo& queryInfo, CompletionState& state) {
-            SimpleTimer timer;
-            lsp::CompletionList result =
-                HandleCompletion(server.GetConfig().languageService.completion, queryInfo, state, params);
-            server.SendServerResponse(requestId, result, false);
-            server.LogInfo("Responded to request {} {}. Processing took {} ms", requestId, "completion",
-                           timer.GetElapsedMilliseconds());
-        });
+        ScheduleLanguageQuery<CompletionState>(
+            requestId, uri, server.GetConfig().languageService.completion.timeBudgetMs,
+            [this, requestId, params = std::move(params)](const LanguageQueryInfo& queryInfo, CompletionState& state) {
+                SimpleTimer timer;
+                lsp::CompletionList result =
+                    HandleCompletion(server.GetConfig().languageService.completion, queryInfo, state, params);
+                if (QueryDeadline::IsCurrentTruncated()) {
+                    // The client asks again as the user keeps typing, which may complete the list.
+                    result.isIncomplete = true;
+                }
+                server.SendServerResponse(requestId, result, false);
+                server.LogInfo("Responded to request {} {}. Processing took {} ms", requestId, "completion",
+                               timer.GetElapsedMilliseconds());
+            });
+    }
+
+    auto LanguageService::OnCompletionResolve(int requestId, lsp::CompletionItem params) -> void
+    {
+        server.LogInfo("Received request {} {}: {}", requestId, "completionItemResolve", params.label);
+        if (!params.data) {
+            // Nothing to resolve for this item
+            server.SendServerResponse(requestId, params, false);
+            return;
+        }
+
+        auto uri = *params.data;
+        if (documentContexts.Find(uri) == documentContexts.end()) {
+            // The document is closed after the item is listed. The documentation is optional, so the item is returned
+            // unresolved instead of failing the request.
+            server.SendServerResponse(requestId, params, false);
+            return;
+        }
+
+        ScheduleLanguageQuery<CompletionState>(
+            requestId, uri,
+            [this, requestId, params = std::move(params)](const LanguageQueryInfo& queryInfo, CompletionState& state) {
+                SimpleTimer timer;
+                lsp::CompletionItem result =
+                    HandleCompletionResolve(server.GetConfig().languageService.completion, queryInfo, state, params);
+                server.SendServerResponse(requestId, result, false);
+                server.LogInfo("Responded to request {} {}. Processing took {} ms", requestId, "completionItemResolve",
+                               timer.GetElapsedMilliseconds());
+            });
     }
 
     auto LanguageService::OnSignatureHelp(int requestId, lsp::SignatureHelpParams params) -> void
@@ -353,8 +918,9 @@ namespace glsld
         auto uri = params.textDocument.uri;
         server.LogInfo("Received request {} {}: {}", requestId, "signatureHelp", uri);
         ScheduleLanguageQuery<SignatureHelpState>(
-            uri, [this, requestId, params = std::move(params)](const LanguageQueryInfo& queryInfo,
-                                                               SignatureHelpState& state) {
+            requestId, uri,
+            [this, requestId,
+             params = std::move(params)](const LanguageQueryInfo& queryInfo, SignatureHelpState& state) {
                 SimpleTimer timer;
                 std::optional<lsp::SignatureHelp> result =
                     HandleSignatureHelp(server.GetConfig().languageService.signatureHelp, queryInfo, state, params);
@@ -368,14 +934,16 @@ namespace glsld
     {
         auto uri = params.textDocument.uri;
         server.LogInfo("Received request {} {}: {}", requestId, "hover", uri);
-        ScheduleLanguageQuery<std::monostate>(uri, [this, requestId, params = std::move(params)](
-                                                       const LanguageQueryInfo& queryInfo, std::monostate&) {
-            SimpleTimer timer;
-            std::optional<lsp::Hover> result = HandleHover(server.GetConfig().languageService.hover, queryInfo, params);
-            server.SendServerResponse(requestId, result, false);
-            server.LogInfo("Responded to request {} {}. Processing took {} ms", requestId, "hover",
-                           timer.GetElapsedMilliseconds());
-        });
+        ScheduleLanguageQuery<std::monostate>(
+            requestId, uri,
+            [this, requestId, params = std::move(params)](const LanguageQueryInfo& queryInfo, std::monostate&) {
+                SimpleTimer timer;
+                std::optional<lsp::Hover> result =
+                    HandleHover(server.GetConfig().languageService.hover, queryInfo, params);
+                server.SendServerResponse(requestId, result, false);
+                server.LogInfo("Responded to request {} {}. Processing took {} ms", requestId, "hover",
+                               timer.GetElapsedMilliseconds());
+            });
     }
 
     auto LanguageService::OnDefinition(int requestId, lsp::DefinitionParams params) -> void
@@ -383,7 +951,8 @@ namespace glsld
         auto uri = params.textDocument.uri;
         server.LogInfo("Received request {} {}: {}", requestId, "definition", uri);
         ScheduleLanguageQuery<std::monostate>(
-            uri, [this, requestId, params = std::move(params)](const LanguageQueryInfo& queryInfo, std::monostate&) {
+            requestId, uri,
+            [this, requestId, params = std::move(params)](const LanguageQueryInfo& queryInfo, std::monostate&) {
                 SimpleTimer timer;
                 std::vector<lsp::Location> result =
                     HandleDefinition(server.GetConfig().languageService.definition, queryInfo, params);
@@ -398,25 +967,53 @@ namespace glsld
         auto uri = params.textDocument.uri;
         server.LogInfo("Received request {} {}: {}", requestId, "references", uri);
         ScheduleLanguageQuery<std::monostate>(
-            uri, [this, requestId, params = std::move(params)](const LanguageQueryInfo& queryInfo, std::monostate&) {
+            requestId, uri, server.GetConfig().languageService.reference.timeBudgetMs,
+            [this, requestId, params = std::move(params)](const LanguageQueryInfo& queryInfo, std::monostate&) {
                 SimpleTimer timer;
                 std::vector<lsp::Location> result =
                     HandleReferences(server.GetConfig().languageService.reference, queryInfo, params);
+                CancelExpiredQuery(requestId);
                 server.SendServerResponse(requestId, result, false);
                 server.LogInfo("Responded to request {} {}. Processing took {} ms", requestId, "references",
                                timer.GetElapsedMilliseconds());
             });
     }
 
+    auto LanguageService::OnDocumentHighlight(int requestId, lsp::DocumentHighlightParams params) -> void
+    {
+        auto uri = params.textDocument.uri;
+        server.LogInfo("Received request {} {}: {}", requestId, "documentHighlight", uri);
+        ScheduleLanguageQuery<std::monostate>(
+            requestId, uri, server.GetConfig().languageService.documentHighlight.timeBudgetMs,
+            [this, requestId, params = std::move(params)](const LanguageQueryInfo& queryInfo, std::monostate&) {
+                SimpleTimer timer;
+                std::vector<lsp::DocumentHighlight> result =
+                    HandleDocumentHighlight(server.GetConfig().languageService.documentHighlight, queryInfo, params);
+                CancelExpiredQuery(requestId);
+                server.SendServerResponse(requestId, result, false);
+                server.LogInfo("Responded to request {} {}. Processing took {} ms", requestId, "documentHighlight",
+                               timer.GetElapsedMilliseconds());
+            });
+    }
+
     auto LanguageService::OnInlayHint(int requestId, lsp::InlayHintParams params) -> void
     {
         auto uri = params.textDocument.uri;
         server.LogInfo("Received request {} {}: {}", requestId, "inlayHint", uri);
+        if (IsDegradedDocument(uri)) {
+            // Inlay hints are disabled in degraded mode, which saves traversing the AST of a large document.
+            server.SendServerResponse(requestId, std::vector<lsp::InlayHint>{}, false);
+            server.LogInfo("Responded to request {} {}. Skipped in degraded mode", requestId, "inlayHint");
+            return;
+        }
+
         ScheduleLanguageQuery<std::monostate>(
-            uri, [this, requestId, params = std::move(params)](const LanguageQueryInfo& queryInfo, std::monostate&) {
+            requestId, uri, server.GetConfig().languageService.inlayHint.timeBudgetMs,
+            [this, requestId, params = std::move(params)](const LanguageQueryInfo& queryInfo, std::monostate&) {
                 SimpleTimer timer;
                 std::vector<lsp::InlayHint> result =
                     HandleInlayHints(server.GetConfig().languageService.inlayHint, queryInfo, params);
+                CancelExpiredQuery(requestId);
                 server.SendServerResponse(requestId, result, false);
                 server.LogInfo("Responded to request {} {}. Processing took {} ms", requestId, "inlayHint",
                                timer.GetElapsedMilliseconds());
@@ -428,10 +1025,12 @@ namespace glsld
         auto uri = params.textDocument.uri;
         server.LogInfo("Received request {} {}: {}", requestId, "foldingRange", uri);
         ScheduleLanguageQuery<std::monostate>(
-            uri, [this, requestId, params = std::move(params)](const LanguageQueryInfo& queryInfo, std::monostate&) {
+            requestId, uri, server.GetConfig().languageService.foldingRange.timeBudgetMs,
+            [this, requestId, params = std::move(params)](const LanguageQueryInfo& queryInfo, std::monostate&) {
                 SimpleTimer timer;
                 std::vector<lsp::FoldingRange> result =
                     HandleFoldingRange(server.GetConfig().languageService.foldingRange, queryInfo, params);
+                CancelExpiredQuery(requestId);
                 server.SendServerResponse(requestId, result, false);
                 server.LogInfo("Responded to request {} {}. Processing took {} ms", requestId, "foldingRange",
                                timer.GetElapsedMilliseconds());
@@ -440,4 +1039,25 @@ namespace glsld
 
 #pragma endregion
 
+#pragma region Extensions
+
+    auto LanguageService::OnStatistics(int requestId, std::nullptr_t) -> void
+    {
+        server.LogInfo("Received request {} {}", requestId, "statistics");
+        lsp::StatisticsResult result = server.GetStatistics().Collect();
+        server.SendServerResponse(requestId, result, false);
+    }
+
+    auto LanguageService::OnMemoryUsage(int requestId, std::nullptr_t) -> void
+    {
+        server.LogInfo("Received request {} {}", requestId, "memoryUsage");
+        SimpleTimer timer;
+        lsp::MemoryUsageResult result = CollectMemoryUsage();
+        server.SendServerResponse(requestId, result, false);
+        server.LogInfo("Responded to request {} {}. Processing took {} ms", requestId, "memoryUsage",
+                       timer.GetElapsedMilliseconds());
+    }
+
+#pragma endregion
+
 } // namespace glsld
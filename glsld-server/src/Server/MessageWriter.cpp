@@ -0,0 +1,91 @@
+#include "Server/MessageWriter.h"
+
+#include <fmt/format.h>
+
+#include <memory>
+#include <vector>
+
+namespace glsld
+{
+    static auto UpdatePeak(std::atomic<size_t>& peak, size_t value) -> void
+    {
+        size_t oldPeak = peak.load(std::memory_order_relaxed);
+        while (value > oldPeak && !peak.compare_exchange_weak(oldPeak, value, std::memory_order_relaxed)) {
+        }
+    }
+
+    MessageWriter::MessageWriter(TextTransport& transport, std::function<void()> onWriteFailure)
+        : transport(transport), onWriteFailure(std::move(onWriteFailure))
+    {
+        writerThread = std::thread{[this] { WriterMain(); }};
+    }
+
+    MessageWriter::~MessageWriter()
+    {
+        stopRequested.store(true, std::memory_order_release);
+        wakeSequence.fetch_add(1, std::memory_order_release);
+        wakeSequence.notify_one();
+        writerThread.join();
+    }
+
+    auto MessageWriter::Enqueue(std::string&& payload) -> void
+    {
+        auto message = std::make_unique<OutgoingMessage>();
+        auto header  = fmt::format_to_n(message->header, sizeof(message->header), "Content-Length: {}\r\n\r\n",
+                                        payload.size());
+        message->headerSize = static_cast<size_t>(header.out - message->header);
+        message->payload    = std::move(payload);
+
+        auto messageSize = message->headerSize + message->payload.size();
+        UpdatePeak(peakPendingMessageCount, pendingMessageCount.fetch_add(1, std::memory_order_relaxed) + 1);
+        UpdatePeak(peakPendingBytes, pendingBytes.fetch_add(messageSize, std::memory_order_relaxed) + messageSize);
+
+        messageQueue.push(message.release());
+        wakeSequence.fetch_add(1, std::memory_order_release);
+        wakeSequence.notify_one();
+    }
+
+    auto MessageWriter::WriterMain() -> void
+    {
+        bool writeFailed = false;
+        std::vector<StringView> blocks;
+        while (true) {
+            // Load the sequence before draining, so a message queued after draining always wakes us up.
+            auto sequence = wakeSequence.load(std::memory_order_acquire);
+            auto batch    = messageQueue.pop_all();
+            if (batch.empty()) {
+                if (stopRequested.load(std::memory_order_acquire)) {
+                    break;
+                }
+
+                wakeSequence.wait(sequence, std::memory_order_acquire);
+                continue;
+            }
+
+            // Write the whole batch with a single gathered write.
+            size_t batchMessageCount = 0;
+            size_t batchBytes        = 0;
+            blocks.clear();
+            for (auto& message : batch) {
+                blocks.push_back(StringView{message.header, message.headerSize});
+                blocks.push_back(StringView{message.payload});
+                batchMessageCount += 1;
+                batchBytes += message.headerSize + message.payload.size();
+            }
+
+            if (!writeFailed && !transport.Write(blocks)) {
+                writeFailed = true;
+                if (onWriteFailure) {
+                    onWriteFailure();
+                }
+            }
+
+            while (auto message = batch.pop()) {
+                delete message;
+            }
+
+            pendingMessageCount.fetch_sub(batchMessageCount, std::memory_order_relaxed);
+            pendingBytes.fetch_sub(batchBytes, std::memory_order_relaxed);
+        }
+    }
+} // namespace glsld
@@ -38,6 +38,17 @@ namespace glsld
                 return nullptr;
             }
 
+            auto AddMacroOccurrence(const PPToken& macroName, PPMacroSymbol symbol) -> void
+            {
+                store.occurrences.push_back(PPSymbolOccurrence{macroName.spelledRange, std::move(symbol)});
+
+                auto it =
+                    std::ranges::lower_bound(store.macroNames, macroName.text.StrView(), {}, &AtomString::StrView);
+                if (it == store.macroNames.end() || *it != macroName.text) {
+                    store.macroNames.insert(it, macroName.text);
+                }
+            }
+
             auto EnterInactiveRange(int startLine) -> void
             {
                 inactiveRegionStartLine = startLine;
@@ -84,18 +95,15 @@ namespace glsld
                 macroLookup[macroName.text.StrView()] = &store.macroDefinitions.back();
 
                 if (includeDepth == 0) {
-                    store.occurrences.push_back(PPSymbolOccurrence{
-                        macroName.spelledRange,
-                        PPMacroSymbol{macroName, {}, &store.macroDefinitions.back(), PPMacroOccurrenceType::Define}});
+                    AddMacroOccurrence(macroName, PPMacroSymbol{macroName, {}, &store.macroDefinitions.back(),
+                                                                PPMacroOccurrenceType::Define});
                 }
             }
             auto OnUndefDirective(ArrayView<PPToken> tokens, const PPToken& macroName) -> void override
             {
                 if (includeDepth == 0) {
-                    store.occurrences.push_back(PPSymbolOccurrence{
-                        macroName.spelledRange,
-                        PPMacroSymbol{
-                            macroName, {}, FindMacro(macroName.text.StrView()), PPMacroOccurrenceType::Undef}});
+                    AddMacroOccurrence(macroName, PPMacroSymbol{macroName, {}, FindMacro(macroName.text.StrView()),
+                                                                PPMacroOccurrenceType::Undef});
                 }
 
                 // While macros in included files are not relevant to user interaction, we still need record them for
@@ -106,10 +114,8 @@ namespace glsld
                 -> void override
             {
                 if (includeDepth == 0) {
-                    store.occurrences.push_back(PPSymbolOccurrence{
-                        macroName.spelledRange,
-                        PPMacroSymbol{
-                            macroName, {}, FindMacro(macroName.text.StrView()), PPMacroOccurrenceType::IfDef}});
+                    AddMacroOccurrence(macroName, PPMacroSymbol{macroName, {}, FindMacro(macroName.text.StrView()),
+                                                                PPMacroOccurrenceType::IfDef});
 
                     if (!isActive) {
                         EnterInactiveRange(tokens.back().spelledRange.end.line + 1);
@@ -160,19 +166,18 @@ namespace glsld
             auto OnMacroExpansion(const PPToken& macroNameTok, AstSyntaxRange expansionRange) -> void override
             {
                 if (includeDepth == 0 && !macroNameTok.spelledRange.IsEmpty()) {
-                    store.occurrences.push_back(PPSymbolOccurrence{macroNameTok.spelledRange,
-                                                                   PPMacroSymbol{macroNameTok, expansionRange,
-                                                                                 FindMacro(macroNameTok.text.StrView()),
-                                                                                 PPMacroOccurrenceType::Expand}});
+                    AddMacroOccurrence(macroNameTok, PPMacroSymbol{macroNameTok, expansionRange,
+                                                                   FindMacro(macroNameTok.text.StrView()),
+                                                                   PPMacroOccurrenceType::Expand});
                 }
             }
             auto OnDefinedOperator(const PPToken& macroNameTok, bool isDefined) -> void override
             {
                 if (includeDepth == 0 && !macroNameTok.spelledRange.IsEmpty()) {
-                    store.occurrences.push_back(PPSymbolOccurrence{
-                        macroNameTok.spelledRange,
-                        PPMacroSymbol{
-                            macroNameTok, {}, FindMacro(macroNameTok.text.StrView()), PPMacroOccurrenceType::IfDef}});
+                    AddMacroOccurrence(macroNameTok, PPMacroSymbol{macroNameTok,
+                                                                   {},
+                                                                   FindMacro(macroNameTok.text.StrView()),
+                                                                   PPMacroOccurrenceType::IfDef});
                 }
             }
         };
@@ -191,4 +196,18 @@ namespace glsld
 
         return nullptr;
     }
+
+    auto PreprocessInfoStore::GetMemoryUsage() const -> MemoryUsage
+    {
+        auto result = MemoryUsage::Of(macroDefinitions) + MemoryUsage::Of(occurrences) +
+                      MemoryUsage::Of(inactiveRegions) + MemoryUsage::Of(macroNames);
+        for (const auto& macroDefinition : macroDefinitions) {
+            result += MemoryUsage::Of(macroDefinition.paramTokens) + MemoryUsage::Of(macroDefinition.expansionTokens);
+        }
+        for (const auto& occurrence : occurrences) {
+            result += occurrence.GetMemoryUsage();
+        }
+
+        return result;
+    }
 } // namespace glsld
\ No newline at end of file
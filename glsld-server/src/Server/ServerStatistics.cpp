@@ -0,0 +1,64 @@
+#include "Server/ServerStatistics.h"
+
+namespace glsld
+{
+    static auto LoadCount(const std::atomic<uint64_t>& counter) -> lsp::uinteger
+    {
+        return static_cast<lsp::uinteger>(counter.load(std::memory_order_relaxed));
+    }
+
+    static auto ToLspLatencySummary(const LatencyHistogram& histogram) -> lsp::LatencySummary
+    {
+        const auto toMicroseconds = [](LatencyHistogram::Duration duration) {
+            return static_cast<lsp::uinteger>(duration.count());
+        };
+
+        return lsp::LatencySummary{
+            .count = static_cast<lsp::uinteger>(histogram.GetCount()),
+            .mean  = toMicroseconds(histogram.GetMean()),
+            .p50   = toMicroseconds(histogram.GetPercentile(0.5)),
+            .p90   = toMicroseconds(histogram.GetPercentile(0.9)),
+            .p99   = toMicroseconds(histogram.GetPercentile(0.99)),
+            .max   = toMicroseconds(histogram.GetMax()),
+        };
+    }
+
+    auto ServerStatistics::GetRequestStatistics(StringView method) -> RequestStatistics&
+    {
+        std::lock_guard<std::mutex> lock{requestMutex};
+        auto it = requests.find(method.StdStrView());
+        if (it == requests.end()) {
+            it = requests.emplace(method.Str(), std::make_unique<RequestStatistics>()).first;
+        }
+
+        return *it->second;
+    }
+
+    auto ServerStatistics::Collect() -> lsp::StatisticsResult
+    {
+        lsp::StatisticsResult result;
+        {
+            std::lock_guard<std::mutex> lock{requestMutex};
+            for (const auto& [method, statistics] : requests) {
+                result.requests.push_back(lsp::RequestStatisticsInfo{
+                    .method    = method,
+                    .cancelled = LoadCount(statistics->cancelledCount),
+                    .queueWait = ToLspLatencySummary(statistics->queueWait),
+                    .execution = ToLspLatencySummary(statistics->execution),
+                    .total     = ToLspLatencySummary(statistics->total),
+                });
+            }
+        }
+
+        result.compilation = lsp::CompilationStatisticsInfo{
+            .completed           = LoadCount(compilation.completedCount),
+            .superseded          = LoadCount(compilation.supersededCount),
+            .cancelled           = LoadCount(compilation.cancelledCount),
+            .preambleCacheHits   = LoadCount(compilation.preambleCacheHitCount),
+            .preambleCacheMisses = LoadCount(compilation.preambleCacheMissCount),
+            .queueWait           = ToLspLatencySummary(compilation.queueWait),
+            .execution           = ToLspLatencySummary(compilation.execution),
+        };
+        return result;
+    }
+} // namespace glsld
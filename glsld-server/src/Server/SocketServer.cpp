@@ -0,0 +1,295 @@
+#include "Server/SocketServer.h"
+
+#if defined(GLSLD_OS_LINUX)
+
+#include "Basic/Common.h"
+#include "Server/LanguageServer.h"
+#include "Server/TextTransport.h"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+
+namespace glsld
+{
+    // A header section larger than this is considered garbage.
+    static constexpr size_t MaxHeaderSize = 64 * 1024;
+
+    enum class MessageFrameResult
+    {
+        Complete,
+        Incomplete,
+        Invalid,
+    };
+
+    // Parses a "Content-Length" framed message at the beginning of the buffer.
+    static auto ParseMessageFrame(StringView buffer, StringView& payload, size_t& frameSize) -> MessageFrameResult
+    {
+        MessageHeaderParser headerParser;
+        size_t offset = 0;
+        while (true) {
+            auto lineEnd = buffer.StdStrView().find('\n', offset);
+            if (lineEnd == std::string_view::npos) {
+                return buffer.size() > MaxHeaderSize ? MessageFrameResult::Invalid : MessageFrameResult::Incomplete;
+            }
+
+            auto headerEnd = headerParser.ParseLine(buffer.Drop(offset).Take(lineEnd - offset));
+            offset         = lineEnd + 1;
+            if (!headerEnd.has_value()) {
+                return MessageFrameResult::Invalid;
+            }
+            if (*headerEnd) {
+                break;
+            }
+        }
+
+        // The payload length is capped by the header parser, so the input buffer is bounded as well.
+        auto payloadLength = headerParser.GetPayloadLength();
+        if (buffer.size() - offset < payloadLength) {
+            return MessageFrameResult::Incomplete;
+        }
+
+        payload   = buffer.Drop(offset).Take(payloadLength);
+        frameSize = offset + payloadLength;
+        return MessageFrameResult::Complete;
+    }
+
+    SocketServer::SocketServer(const LanguageServerConfig& config)
+        : config(config), executor(CreateLanguageServiceExecutor())
+    {
+        epollFd = epoll_create1(EPOLL_CLOEXEC);
+        wakeFd  = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+        AddToEventLoop(wakeFd);
+    }
+
+    SocketServer::~SocketServer()
+    {
+        // Connections are only accepted in `Run`, which closes all of them before returning.
+        GLSLD_ASSERT(connections.empty() && closingConnections.empty());
+        for (int fd : {listenFd, epollFd, wakeFd}) {
+            if (fd != -1) {
+                close(fd);
+            }
+        }
+    }
+
+    auto SocketServer::AddToEventLoop(int fd) -> bool
+    {
+        // Level-triggered, so a single read per event never blocks and leftover data is reported again.
+        epoll_event event = {};
+        event.events      = EPOLLIN | EPOLLRDHUP;
+        event.data.fd     = fd;
+        return epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &event) == 0;
+    }
+
+    auto SocketServer::ListenUnix(StringView path) -> bool
+    {
+        sockaddr_un address = {};
+        address.sun_family  = AF_UNIX;
+        if (path.size() >= sizeof(address.sun_path)) {
+            return false;
+        }
+        std::memcpy(address.sun_path, path.data(), path.size());
+
+        listenFd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (listenFd == -1) {
+            return false;
+        }
+
+        unlink(address.sun_path);
+        return bind(listenFd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0 &&
+               listen(listenFd, SOMAXCONN) == 0 && AddToEventLoop(listenFd);
+    }
+
+    auto SocketServer::ListenTcp(uint16_t port) -> bool
+    {
+        sockaddr_in address     = {};
+        address.sin_family      = AF_INET;
+        address.sin_port        = htons(port);
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+        listenFd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (listenFd == -1) {
+            return false;
+        }
+
+        int reuseAddress = 1;
+        setsockopt(listenFd, SOL_SOCKET, SO_REUSEADDR, &reuseAddress, sizeof(reuseAddress));
+        return bind(listenFd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0 &&
+               listen(listenFd, SOMAXCONN) == 0 && AddToEventLoop(listenFd);
+    }
+
+    auto SocketServer::GetTcpPort() const -> uint16_t
+    {
+        sockaddr_in address   = {};
+        socklen_t addressSize = sizeof(address);
+        if (listenFd == -1 || getsockname(listenFd, reinterpret_cast<sockaddr*>(&address), &addressSize) != 0 ||
+            address.sin_family != AF_INET) {
+            return 0;
+        }
+
+        return ntohs(address.sin_port);
+    }
+
+    auto SocketServer::Run() -> void
+    {
+        constexpr int MaxEventCount = 64;
+        epoll_event events[MaxEventCount];
+
+        closingStopRequested = false;
+        closingThread        = std::thread{[this] { ClosingThreadMain(); }};
+
+        bool stopRequested = false;
+        while (!stopRequested) {
+            int eventCount = epoll_wait(epollFd, events, MaxEventCount, -1);
+            if (eventCount < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                break;
+            }
+
+            for (int i = 0; i < eventCount; ++i) {
+                int fd = events[i].data.fd;
+                if (fd == wakeFd) {
+                    stopRequested = true;
+                }
+                else if (fd == listenFd) {
+                    AcceptConnection();
+                }
+                else if (auto it = connections.find(fd); it != connections.end()) {
+                    if (!ReadConnection(*it->second)) {
+                        CloseConnection(fd);
+                    }
+                }
+            }
+        }
+
+        while (!connections.empty()) {
+            CloseConnection(connections.begin()->first);
+        }
+
+        // Wait for every closed connection to be torn down.
+        {
+            std::lock_guard<std::mutex> lock{closingMutex};
+            closingStopRequested = true;
+        }
+        closingCondition.notify_one();
+        closingThread.join();
+    }
+
+    auto SocketServer::Stop() -> void
+    {
+        // The write only fails if the counter would overflow, in which case stop is already requested.
+        uint64_t value = 1;
+
+        [[maybe_unused]] auto result = write(wakeFd, &value, sizeof(value));
+    }
+
+    auto SocketServer::ClosingThreadMain() -> void
+    {
+        std::unique_lock<std::mutex> lock{closingMutex};
+        while (true) {
+            closingCondition.wait(lock, [this] { return !closingConnections.empty() || closingStopRequested; });
+            if (closingConnections.empty()) {
+                // Stop is requested, and everything is torn down.
+                break;
+            }
+
+            auto connection = std::move(closingConnections.back());
+            closingConnections.pop_back();
+            lock.unlock();
+
+            // Destroying the server finishes pending work and writes queued messages before the socket is closed.
+            connection->server = nullptr;
+            close(connection->fd);
+
+            lock.lock();
+        }
+    }
+
+    auto SocketServer::AcceptConnection() -> void
+    {
+        int fd = accept4(listenFd, nullptr, nullptr, SOCK_CLOEXEC);
+        if (fd == -1) {
+            return;
+        }
+
+        if (!AddToEventLoop(fd)) {
+            close(fd);
+            return;
+        }
+
+        // Responses are written by the message writer thread of the server, while requests are read by this loop.
+        auto connection    = std::make_unique<Connection>();
+        connection->fd     = fd;
+        connection->server = std::make_unique<LanguageServer>(config, CreateSocketTextTransport(fd), executor);
+        connection->server->LogInfo("Client connected on socket {}", fd);
+        connections[fd] = std::move(connection);
+    }
+
+    auto SocketServer::ReadConnection(Connection& connection) -> bool
+    {
+        char buffer[64 * 1024];
+        auto bytesRead = read(connection.fd, buffer, sizeof(buffer));
+        if (bytesRead < 0 && (errno == EINTR || errno == EAGAIN)) {
+            return true;
+        }
+        if (bytesRead <= 0) {
+            return false;
+        }
+        connection.inputBuffer.append(buffer, bytesRead);
+
+        size_t consumed = 0;
+        while (!connection.server->IsShutdownRequested()) {
+            StringView payload;
+            size_t frameSize = 0;
+            auto result = ParseMessageFrame(StringView{connection.inputBuffer}.Drop(consumed), payload, frameSize);
+            if (result == MessageFrameResult::Incomplete) {
+                break;
+            }
+            else if (result == MessageFrameResult::Invalid) {
+                connection.server->LogError("Invalid LSP message framing on socket {}", connection.fd);
+                return false;
+            }
+
+            connection.server->HandleClientMessage(payload);
+            consumed += frameSize;
+        }
+
+        connection.inputBuffer.erase(0, consumed);
+        return !connection.server->IsShutdownRequested();
+    }
+
+    auto SocketServer::CloseConnection(int fd) -> void
+    {
+        auto it = connections.find(fd);
+        if (it == connections.end()) {
+            return;
+        }
+
+        epoll_ctl(epollFd, EPOLL_CTL_DEL, fd, nullptr);
+        it->second->server->LogInfo("Client disconnected on socket {}", fd);
+        if (memoryReportHandler) {
+            memoryReportHandler(it->second->server->CollectMemoryUsage());
+        }
+
+        // The socket stays open until the server is torn down, so its descriptor isn't reused by a new connection in
+        // the meantime.
+        {
+            std::lock_guard<std::mutex> lock{closingMutex};
+            closingConnections.push_back(std::move(it->second));
+        }
+        closingCondition.notify_one();
+        connections.erase(it);
+    }
+} // namespace glsld
+
+#endif
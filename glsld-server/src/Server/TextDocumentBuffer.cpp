@@ -0,0 +1,181 @@
+#include "Server/TextDocumentBuffer.h"
+
+#include <algorithm>
+#include <string_view>
+
+namespace glsld
+{
+    // Returns the length of the UTF-8 sequence starting with the given byte.
+    static auto GetUtf8SequenceLength(char leadingByte) -> size_t
+    {
+        auto ch = static_cast<unsigned char>(leadingByte);
+        if (ch < 0xC0) {
+            // ASCII, or a stray continuation byte which is counted as a character by itself.
+            return 1;
+        }
+        else if (ch < 0xE0) {
+            return 2;
+        }
+        else if (ch < 0xF0) {
+            return 3;
+        }
+        else {
+            return 4;
+        }
+    }
+
+    auto TextDocumentBuffer::CreateChunks(StringView text) -> std::vector<std::shared_ptr<const Chunk>>
+    {
+        std::vector<std::shared_ptr<const Chunk>> result;
+
+        auto textView = text.StdStrView();
+        size_t begin  = 0;
+        while (begin < textView.size()) {
+            size_t end = textView.size();
+            if (begin + TargetChunkSize < textView.size()) {
+                // Split after a line break, so that a line never crosses a chunk boundary.
+                if (auto lineBreak = textView.find('\n', begin + TargetChunkSize - 1); lineBreak != std::string::npos) {
+                    end = lineBreak + 1;
+                }
+            }
+
+            auto chunk  = std::make_shared<Chunk>();
+            chunk->text = textView.substr(begin, end - begin);
+            for (size_t i = 0; i < chunk->text.size(); ++i) {
+                if (chunk->text[i] == '\n') {
+                    chunk->lineBreaks.push_back(static_cast<uint32_t>(i));
+                }
+            }
+
+            result.push_back(std::move(chunk));
+            begin = end;
+        }
+
+        if (result.empty()) {
+            result.push_back(std::make_shared<Chunk>());
+        }
+
+        return result;
+    }
+
+    auto TextDocumentBuffer::Locate(TextPosition position) const -> Location
+    {
+        // Find the chunk where the line starts.
+        size_t chunkIndex     = 0;
+        size_t offset         = 0;
+        size_t remainingLines = std::max(position.line, 0);
+        while (remainingLines > chunks[chunkIndex]->lineBreaks.size()) {
+            remainingLines -= chunks[chunkIndex]->lineBreaks.size();
+            if (chunkIndex + 1 == chunks.size()) {
+                // The line is past the end of the document.
+                return Location{.chunkIndex = chunkIndex, .offset = chunks[chunkIndex]->text.size()};
+            }
+
+            chunkIndex += 1;
+        }
+
+        if (remainingLines > 0) {
+            offset = chunks[chunkIndex]->lineBreaks[remainingLines - 1] + 1;
+            if (offset == chunks[chunkIndex]->text.size() && chunkIndex + 1 < chunks.size()) {
+                // The line starts at the next chunk.
+                chunkIndex += 1;
+                offset = 0;
+            }
+        }
+
+        // Find the offset of the column. The line never crosses a chunk boundary.
+        const auto& text = chunks[chunkIndex]->text;
+        if (!countUtf16Characters) {
+            // The column is a byte offset, which only needs to be clamped to the end of the line.
+            auto column = std::min<size_t>(std::max(position.character, 0), text.size() - offset);
+            if (auto lineBreak = std::string_view{text}.substr(offset, column).find('\n');
+                lineBreak != std::string_view::npos) {
+                column = lineBreak;
+            }
+
+            offset += column;
+            if (offset > 0 && offset < text.size() && text[offset] == '\n' && text[offset - 1] == '\r') {
+                offset -= 1;
+            }
+            return Location{.chunkIndex = chunkIndex, .offset = offset};
+        }
+
+        int remainingColumns = position.character;
+        while (remainingColumns > 0 && offset < text.size() && text[offset] != '\n') {
+            if (text[offset] == '\r' && offset + 1 < text.size() && text[offset + 1] == '\n') {
+                break;
+            }
+
+            // Characters outside the BMP are encoded as surrogate pairs in UTF-16.
+            auto sequenceLength = GetUtf8SequenceLength(text[offset]);
+            remainingColumns -= sequenceLength == 4 ? 2 : 1;
+            offset = std::min(offset + sequenceLength, text.size());
+        }
+
+        return Location{.chunkIndex = chunkIndex, .offset = offset};
+    }
+
+    auto TextDocumentBuffer::ApplyChange(TextRange range, StringView changedText) -> void
+    {
+        auto begin = Locate(range.start);
+        auto end   = Locate(std::max(range.start, range.end));
+
+        // Rewrite the chunks from the beginning to the end of the range. Small chunks are merged with the next one, so
+        // that the number of chunks doesn't grow with the number of edits.
+        std::string text;
+        text.append(chunks[begin.chunkIndex]->text, 0, begin.offset);
+        text.append(changedText.StdStrView());
+        text.append(chunks[end.chunkIndex]->text, end.offset);
+        size_t endChunkIndex = end.chunkIndex + 1;
+        if (text.size() < TargetChunkSize / 2 && endChunkIndex < chunks.size()) {
+            text.append(chunks[endChunkIndex]->text);
+            endChunkIndex += 1;
+        }
+
+        for (size_t i = begin.chunkIndex; i < endChunkIndex; ++i) {
+            totalSize -= chunks[i]->text.size();
+        }
+        totalSize += text.size();
+
+        auto newChunks = CreateChunks(StringView{text});
+        if (text.empty() && chunks.size() > endChunkIndex - begin.chunkIndex) {
+            // Don't leave an empty chunk in the middle.
+            newChunks.clear();
+        }
+
+        chunks.erase(chunks.begin() + begin.chunkIndex, chunks.begin() + endChunkIndex);
+        chunks.insert(chunks.begin() + begin.chunkIndex, newChunks.begin(), newChunks.end());
+    }
+
+    auto TextDocumentBuffer::GetLineCount() const -> size_t
+    {
+        size_t result = 1;
+        for (const auto& chunk : chunks) {
+            result += chunk->lineBreaks.size();
+        }
+
+        return result;
+    }
+
+    auto TextDocumentBuffer::GetText() const -> std::string
+    {
+        std::string result;
+        result.reserve(totalSize);
+        for (const auto& chunk : chunks) {
+            result.append(chunk->text);
+        }
+
+        return result;
+    }
+
+    auto TextDocumentBuffer::GetMemoryUsage() const -> MemoryUsage
+    {
+        auto result = MemoryUsage::Of(chunks);
+        for (const auto& chunk : chunks) {
+            result += MemoryUsage{.allocatedBytes = sizeof(Chunk), .committedBytes = sizeof(Chunk)};
+            result += MemoryUsage::Of(chunk->text) + MemoryUsage::Of(chunk->lineBreaks);
+        }
+
+        return result;
+    }
+} // namespace glsld
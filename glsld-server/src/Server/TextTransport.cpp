@@ -1,105 +1,260 @@
 #include "Server/TextTransport.h"
 
+#include <algorithm>
+#include <cerrno>
+#include <charconv>
+#include <climits>
 #include <cstdio>
+#include <cstring>
 #include <vector>
 
 #if defined(GLSLD_OS_WIN)
 #include <io.h>
 #include <fcntl.h>
+#else
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <unistd.h>
 #endif
 
 namespace glsld
 {
-    class StdioTransport : public TextTransport
+    auto MessageHeaderParser::ParseLine(StringView line) -> std::expected<bool, TextTransportError>
     {
-    private:
-        static constexpr size_t MaxBufferSize = 10 * 1024 * 1024; // 10 MB
+        auto headerView = line.Trim();
+        if (headerView.empty()) {
+            // Empty line indicates end of headers, aka. start of payload.
+            if (payloadLength == 0) {
+                return std::unexpected(TextTransportError::InvalidHeader);
+            }
+            return true;
+        }
 
-        std::vector<char> buffer;
+        if (constexpr StringView contentLengthPrefix = "Content-Length: "; headerView.StartWith(contentLengthPrefix)) {
+            auto lengthView = headerView.Drop(contentLengthPrefix.size());
+            if (std::from_chars(lengthView.data(), lengthView.data() + lengthView.size(), payloadLength).ec !=
+                std::errc()) {
+                return std::unexpected(TextTransportError::InvalidHeader);
+            }
+            if (payloadLength > MaxTextTransportMessageSize) {
+                return std::unexpected(TextTransportError::MessageTooLarge);
+            }
+        }
 
-    public:
-        StdioTransport()
-        {
+        // We ignore any other header fields, e.g. "Content-Type".
+        return false;
+    }
+
+    // Reads from the file descriptor. Returns the number of bytes read, 0 at the end of file, or -1 on error.
+    static auto ReadFileDescriptor(int fd, char* data, size_t size) -> ptrdiff_t
+    {
+        while (true) {
 #if defined(GLSLD_OS_WIN)
-            // Use binary mode for stdin/stdout. We handle "\r\n" conversion inhouse.
-            _setmode(_fileno(stdout), O_BINARY);
-            _setmode(_fileno(stdin), O_BINARY);
+            auto bytesRead = _read(fd, data, static_cast<unsigned>(std::min<size_t>(size, INT_MAX)));
 #else
-            // FIXME: not sure if this is needed
-            // freopen(nullptr, "rb", stdout);
-            // freopen(nullptr, "wb", stdin);
+            auto bytesRead = read(fd, data, size);
 #endif
+            if (bytesRead < 0 && errno == EINTR) {
+                continue;
+            }
 
-            setvbuf(stdin, nullptr, _IOFBF, 64 * 1024);
+            return bytesRead;
         }
+    }
 
-        auto ReadLine() -> std::expected<StringView, TextTransportError> override
-        {
-            // TODO: optimize this
-            buffer.clear();
-            while (true) {
-                int ch = fgetc(stdin);
-                if (ch == EOF) {
-                    return std::unexpected(TextTransportError::Unknown);
-                }
-                else {
-                    buffer.push_back(static_cast<char>(ch));
-                    if (ch == '\n') {
-                        break;
-                    }
+    // Writes all blocks to the file descriptor, retrying on partial writes. Sockets are written with MSG_NOSIGNAL, so
+    // a peer that has gone away is reported as a failure instead of a SIGPIPE.
+    static auto WriteFileDescriptor(int fd, [[maybe_unused]] bool isSocket, std::span<const StringView> blocks) -> bool
+    {
+#if defined(GLSLD_OS_WIN)
+        for (auto block : blocks) {
+            size_t totalWritten = 0;
+            while (totalWritten < block.size()) {
+                auto writeSize    = std::min<size_t>(block.size() - totalWritten, INT_MAX);
+                auto bytesWritten = _write(fd, block.data() + totalWritten, static_cast<unsigned>(writeSize));
+                if (bytesWritten <= 0) {
+                    return false;
                 }
+                totalWritten += bytesWritten;
+            }
+        }
+        return true;
+#else
+        std::vector<iovec> iov;
+        iov.reserve(blocks.size());
+        for (auto block : blocks) {
+            if (!block.empty()) {
+                iov.push_back(iovec{const_cast<char*>(block.data()), block.size()});
+            }
+        }
 
-                if (buffer.size() >= MaxBufferSize) {
-                    return std::unexpected(TextTransportError::Unknown);
+        iovec* iovBegin = iov.data();
+        iovec* iovEnd   = iov.data() + iov.size();
+        while (iovBegin != iovEnd) {
+            auto iovCount = static_cast<int>(std::min<ptrdiff_t>(iovEnd - iovBegin, IOV_MAX));
+            ssize_t bytesWritten;
+            if (isSocket) {
+                msghdr message     = {};
+                message.msg_iov    = iovBegin;
+                message.msg_iovlen = iovCount;
+                bytesWritten       = sendmsg(fd, &message, MSG_NOSIGNAL);
+            }
+            else {
+                bytesWritten = writev(fd, iovBegin, iovCount);
+            }
+            if (bytesWritten < 0) {
+                if (errno == EINTR) {
+                    continue;
                 }
+                return false;
             }
 
-            return StringView{buffer.data(), buffer.size()};
+            // Skip what's written in case of a partial write.
+            auto remaining = static_cast<size_t>(bytesWritten);
+            while (iovBegin != iovEnd && remaining >= iovBegin->iov_len) {
+                remaining -= iovBegin->iov_len;
+                ++iovBegin;
+            }
+            if (iovBegin != iovEnd) {
+                iovBegin->iov_base = static_cast<char*>(iovBegin->iov_base) + remaining;
+                iovBegin->iov_len -= remaining;
+            }
         }
+        return true;
+#endif
+    }
 
-        auto Read(size_t size) -> std::expected<StringView, TextTransportError> override
+    // A transport over raw file descriptors. Input is read in large blocks into a buffer, and lines and payloads are
+    // returned as views into it without copying. Output bypasses the C stdio buffering, so each message is written
+    // with a single system call where the platform allows.
+    class FileDescriptorTransport : public TextTransport
+    {
+    private:
+        static constexpr size_t ReadBlockSize = 64 * 1024;
+
+        // A header line longer than this is considered garbage.
+        static constexpr size_t MaxLineSize = 64 * 1024;
+
+        // After a large message is consumed, the buffer shrinks back if it has grown beyond this size.
+        static constexpr size_t MaxRetainedBufferSize = 4 * 1024 * 1024;
+
+        int inputFd;
+        int outputFd;
+        bool isSocket;
+
+        // Bytes in [readBegin, readEnd) are received but not consumed yet.
+        std::vector<char> buffer;
+        size_t readBegin = 0;
+        size_t readEnd   = 0;
+
+        // Reads more data into the buffer, making room for at least `requiredSize` unconsumed bytes.
+        // Views returned previously are invalidated. Fails on error or end of file, or if the required size exceeds
+        // the message size limit.
+        auto FillBuffer(size_t requiredSize) -> std::expected<void, TextTransportError>
         {
-            if (size > buffer.size()) {
-                if (size > MaxBufferSize) {
-                    return std::unexpected(TextTransportError::Unknown);
-                }
-                buffer.resize(size);
+            if (requiredSize > MaxTextTransportMessageSize) {
+                return std::unexpected(TextTransportError::MessageTooLarge);
+            }
+
+            if (readBegin == readEnd && buffer.size() > MaxRetainedBufferSize) {
+                buffer    = std::vector<char>(ReadBlockSize);
+                readBegin = 0;
+                readEnd   = 0;
+            }
+
+            // Move the unconsumed bytes to the front, so a line or a payload is always contiguous.
+            if (readBegin > 0) {
+                std::memmove(buffer.data(), buffer.data() + readBegin, readEnd - readBegin);
+                readEnd -= readBegin;
+                readBegin = 0;
+            }
+
+            auto requiredCapacity = std::max(requiredSize, readEnd + ReadBlockSize);
+            if (buffer.size() < requiredCapacity) {
+                buffer.resize(requiredCapacity);
             }
 
-            size_t totalRead = 0;
-            while (totalRead < size) {
-                size_t bytesRead = fread(buffer.data() + totalRead, 1, size - totalRead, stdin);
-                if (bytesRead == 0) {
+            auto bytesRead = ReadFileDescriptor(inputFd, buffer.data() + readEnd, buffer.size() - readEnd);
+            if (bytesRead <= 0) {
+                return std::unexpected(TextTransportError::Unknown);
+            }
+
+            readEnd += bytesRead;
+            return {};
+        }
+
+    public:
+        FileDescriptorTransport(int inputFd, int outputFd, bool isSocket = false)
+            : inputFd(inputFd), outputFd(outputFd), isSocket(isSocket), buffer(ReadBlockSize)
+        {
+        }
+
+        auto ReadLine() -> std::expected<StringView, TextTransportError> override
+        {
+            size_t searchBegin = readBegin;
+            while (true) {
+                auto lineEnd = std::find(buffer.data() + searchBegin, buffer.data() + readEnd, '\n');
+                if (lineEnd != buffer.data() + readEnd) {
+                    auto lineSize = static_cast<size_t>(lineEnd + 1 - (buffer.data() + readBegin));
+                    StringView result{buffer.data() + readBegin, lineSize};
+                    readBegin += lineSize;
+                    return result;
+                }
+
+                if (readEnd - readBegin >= MaxLineSize) {
                     return std::unexpected(TextTransportError::Unknown);
                 }
-                totalRead += bytesRead;
-            }
 
-            return StringView{buffer.data(), size};
+                // Only search the new data after refilling. Note the buffer may be compacted.
+                auto searchedSize = readEnd - readBegin;
+                if (auto filled = FillBuffer(0); !filled) {
+                    return std::unexpected(filled.error());
+                }
+                searchBegin = readBegin + searchedSize;
+            }
         }
 
-        auto Write(StringView data) -> bool override
+        auto Read(size_t size) -> std::expected<StringView, TextTransportError> override
         {
-            size_t totalWritten = 0;
-            while (totalWritten < data.size()) {
-                size_t bytesWritten = fwrite(data.data() + totalWritten, 1, data.size() - totalWritten, stdout);
-                if (bytesWritten == 0) {
-                    return false;
+            while (readEnd - readBegin < size) {
+                if (auto filled = FillBuffer(size); !filled) {
+                    return std::unexpected(filled.error());
                 }
-                totalWritten += bytesWritten;
             }
-            return true;
+
+            StringView result{buffer.data() + readBegin, size};
+            readBegin += size;
+            return result;
         }
 
-        auto Flush() -> bool override
+        auto Write(std::span<const StringView> blocks) -> bool override
         {
-            return fflush(stdout) == 0;
+            return WriteFileDescriptor(outputFd, isSocket, blocks);
         }
     };
 
     auto CreateStdioTextTransport() -> std::unique_ptr<TextTransport>
     {
-        return std::make_unique<StdioTransport>();
+#if defined(GLSLD_OS_WIN)
+        // Use binary mode for stdin/stdout. We handle "\r\n" conversion inhouse.
+        _setmode(_fileno(stdout), O_BINARY);
+        _setmode(_fileno(stdin), O_BINARY);
+        return std::make_unique<FileDescriptorTransport>(_fileno(stdin), _fileno(stdout));
+#else
+        return std::make_unique<FileDescriptorTransport>(STDIN_FILENO, STDOUT_FILENO);
+#endif
+    }
+
+    auto CreateFileDescriptorTextTransport(int inputFd, int outputFd) -> std::unique_ptr<TextTransport>
+    {
+        return std::make_unique<FileDescriptorTransport>(inputFd, outputFd);
     }
 
-} // namespace glsld
\ No newline at end of file
+#if !defined(GLSLD_OS_WIN)
+    auto CreateSocketTextTransport(int socketFd) -> std::unique_ptr<TextTransport>
+    {
+        return std::make_unique<FileDescriptorTransport>(socketFd, socketFd, true);
+    }
+#endif
+
+} // namespace glsld
@@ -95,12 +95,22 @@ namespace glsld
             return TextRange{GetLabelledPosition(labelBegin), GetLabelledPosition(labelEnd)};
         }
 
-        auto CompileLabelledSource(SourceTextView labeledSourceText) -> void
+        // The stdlib is disabled unless `withStdlib` is set, in which case the source is compiled on top of a preamble
+        // like the language server does. The builtins of `stage` are only declared by the stdlib if it's known.
+        auto CompileLabelledSource(SourceTextView labeledSourceText, bool withStdlib = false,
+                                   GlslShaderStage stage = GlslShaderStage::Unknown) -> void
         {
             auto [sourceText, labels] = ParseLabelledSource(labeledSourceText);
             auto ppInfoStore          = std::make_unique<PreprocessInfoStore>();
             auto compiler             = std::make_unique<CompilerInvocation>();
-            compiler->SetNoStdlib(true);
+            if (withStdlib) {
+                CompilerInvocation preambleCompiler;
+                preambleCompiler.SetShaderStage(stage);
+                compiler = std::make_unique<CompilerInvocation>(preambleCompiler.CompilePreamble(nullptr));
+            }
+            else {
+                compiler->SetNoStdlib(true);
+            }
             compiler->SetMainFileFromBuffer(sourceText);
 
             auto ppCallback = ppInfoStore->CreateCollectionCallback(nullptr);
@@ -0,0 +1,63 @@
+#include "CompilerTestFixture.h"
+
+#include <stop_token>
+
+using namespace glsld;
+
+TEST_CASE_METHOD(CompilerTestFixture, "Compiler::CancellationTest")
+{
+    SourceTextView sourceText = R"(
+        int x;
+        void main() {}
+    )";
+
+    auto compileWithStopToken = [&](std::stop_token stopToken) {
+        auto compiler = std::make_unique<CompilerInvocation>();
+        compiler->SetNoStdlib(true);
+        compiler->SetMainFileFromBuffer(sourceText);
+        compiler->SetStopToken(std::move(stopToken));
+        return compiler->CompileMainFile(nullptr, CompileMode::ParseOnly);
+    };
+
+    SECTION("NotCancelled")
+    {
+        std::stop_source stopSource;
+        auto result = compileWithStopToken(stopSource.get_token());
+        CheckAst(result->GetUserFileArtifacts().GetAst(),
+                 TranslationUnit({
+                     VariableDecl(AnyQualType(), {AnyAst()}),
+                     FunctionDecl(AnyQualType(), IdTok("main"), {}, AnyStmt()),
+                 }));
+    }
+
+    SECTION("Cancelled")
+    {
+        std::stop_source stopSource;
+        stopSource.request_stop();
+
+        // Parsing is abandoned, but the translation unit should still be well-formed
+        auto result = compileWithStopToken(stopSource.get_token());
+        CheckAst(result->GetUserFileArtifacts().GetAst(), TranslationUnit({}));
+        CheckTokens(result->GetUserFileArtifacts().GetTokens(),
+                    {KeywordTok(TokenKlass::K_int), IdTok("x"), AnyTok(), KeywordTok(TokenKlass::K_void), IdTok("main"),
+                     AnyTok(), AnyTok(), AnyTok(), AnyTok(), EofTok()});
+    }
+
+    SECTION("CancelledWithUserPreamble")
+    {
+        std::stop_source stopSource;
+        stopSource.request_stop();
+
+        // Only the main file is abandoned. The user preamble compiled along with it is still complete.
+        auto compiler = std::make_unique<CompilerInvocation>();
+        compiler->SetNoStdlib(true);
+        compiler->SetUserPreamble("int y;");
+        compiler->SetMainFileFromBuffer(sourceText);
+        compiler->SetStopToken(stopSource.get_token());
+        auto result = compiler->CompileMainFile(nullptr, CompileMode::ParseOnly);
+        CheckAst(result->GetUserPreambleArtifacts().GetAst(), TranslationUnit({
+                                                                  VariableDecl(AnyQualType(), {AnyAst()}),
+                                                              }));
+        CheckAst(result->GetUserFileArtifacts().GetAst(), TranslationUnit({}));
+    }
+}
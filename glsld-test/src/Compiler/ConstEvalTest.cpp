@@ -84,6 +84,13 @@ TEST_CASE_METHOD(CompilerTestFixture, "Compiler::ConstEvalTest")
         CheckAst("1 + 2u", checkScalar(3u));
         CheckAst("1 + 2.0", checkScalar(3.0f));
         CheckAst("vec2(1) + vec2(2)", checkVector(3.f, 3.f));
+        CheckAst("vec2(1, 2) * 2", checkVector(2.f, 4.f));
+        CheckAst("2 - vec2(1, 2)", checkVector(1.f, 0.f));
+        CheckAst("1 << 3", checkScalar(8));
+        CheckAst("16u >> 2", checkScalar(4u));
+        CheckAst("mat2(1, 2, 3, 4) * vec2(1, 1)", checkVector(4.f, 6.f));
+        CheckAst("vec2(1, 1) * mat2(1, 2, 3, 4)", checkVector(3.f, 7.f));
+        CheckAst("(mat2(1, 2, 3, 4) * mat2(1, 2, 3, 4))[1]", checkVector(15.f, 22.f));
     }
 
     SECTION("SelectExpr")
@@ -96,6 +103,15 @@ TEST_CASE_METHOD(CompilerTestFixture, "Compiler::ConstEvalTest")
     {
         CheckAst("const int x = 1; x", checkScalar(1));
         CheckAst("const vec4 x = vec4(1); x", checkVector(1.f, 1.f, 1.f, 1.f));
+        CheckAst("const mat4 x = mat4(2); int(x)", checkScalar(2));
+        CheckAst("const mat4 x[2] = mat4[2](mat4(1), mat4(2)); int(x[1])", checkScalar(2));
+        CheckAst("const int n = 2; const int x[n + 1] = int[](1, 2, 3); x.length()", checkScalar(3));
+
+        // The folded value is looked up without copying the arena-backed buffer.
+        CheckAst("const dmat4 x = dmat4(2); x", AnyExpr()->CheckValue([](const ConstValue& value) {
+            return value.IsBufferBorrowed() && value == ConstValue::ConstructMatrix(ConstValue::CreateScalar(2.0),
+                                                                                    ScalarKind::Double, 4, 4);
+        }));
     }
 
     SECTION("FieldAccessExpr")
@@ -1,6 +1,10 @@
 #include "Language/ConstValue.h"
 #include <catch2/catch_test_macros.hpp>
 #include <catch2/catch_approx.hpp>
+#include <catch2/benchmark/catch_benchmark.hpp>
+
+#include <array>
+#include <limits>
 
 using namespace glsld;
 
@@ -173,6 +177,57 @@ TEST_CASE("Compiler::ConstValueTest")
         }
     }
 
+    SECTION("Broadcast")
+    {
+        ConstValue vec3 = ConstValue::CreateVector<int32_t>({1, 2, 3});
+        ConstValue i2   = ConstValue::CreateScalar(2);
+
+        REQUIRE(vec3.ElemwiseMul(i2) == ConstValue::CreateVector<int32_t>({2, 4, 6}));
+        REQUIRE(i2.ElemwiseMinus(vec3) == ConstValue::CreateVector<int32_t>({1, 0, -1}));
+        REQUIRE(vec3.ElemwiseLessThan(i2) == ConstValue::CreateVector<bool>({true, false, false}));
+        REQUIRE(vec3.ElemwisePlus(ConstValue::CreateVector<int32_t>({1, 2})).IsError());
+    }
+
+    SECTION("IntegerDivisionByZero")
+    {
+        ConstValue i7 = ConstValue::CreateScalar(7);
+        ConstValue i0 = ConstValue::CreateScalar(0);
+
+        // The result is undefined in GLSL, but folding must not trap.
+        REQUIRE(i7.ElemwiseDiv(i0).IsScalarInt32());
+        REQUIRE(i7.ElemwiseMod(i0).IsScalarInt32());
+        REQUIRE(ConstValue::CreateScalar(std::numeric_limits<int32_t>::min())
+                    .ElemwiseDiv(ConstValue::CreateScalar(-1))
+                    .IsScalarInt32());
+    }
+
+    SECTION("Shift")
+    {
+        REQUIRE(ConstValue::CreateScalar(1).ElemwiseShiftLeft(ConstValue::CreateScalar(4u)) ==
+                ConstValue::CreateScalar(16));
+        REQUIRE(ConstValue::CreateScalar(-16).ElemwiseShiftRight(ConstValue::CreateScalar(2)) ==
+                ConstValue::CreateScalar(-4));
+        REQUIRE(ConstValue::CreateScalar(1.0f).ElemwiseShiftLeft(ConstValue::CreateScalar(1)).IsError());
+    }
+
+    SECTION("MatrixMul")
+    {
+        // Matrices are column-major: mat2(1, 2, 3, 4) has columns (1, 2) and (3, 4).
+        std::array<ConstValue, 2> columns = {ConstValue::CreateVector<float>({1, 2}),
+                                             ConstValue::CreateVector<float>({3, 4})};
+        ConstValue mat2 = ConstValue::ComposeMatrix(columns, ScalarKind::Float, 2, 2);
+        ConstValue vec2 = ConstValue::CreateVector<float>({1, 1});
+
+        REQUIRE(mat2.MatrixMul(vec2) == ConstValue::CreateVector<float>({4, 6}));
+        REQUIRE(vec2.MatrixMul(mat2) == ConstValue::CreateVector<float>({3, 7}));
+
+        ConstValue product = mat2.MatrixMul(mat2);
+        REQUIRE(product.IsMatrix());
+        REQUIRE(std::ranges::equal(product.GetBufferAs<float>(), std::initializer_list<float>{7, 10, 15, 22}));
+
+        REQUIRE(mat2.MatrixMul(ConstValue::CreateVector<float>({1, 1, 1})).IsError());
+    }
+
     SECTION("Comparison")
     {
         ConstValue lhs    = ConstValue::CreateScalar(5);
@@ -208,5 +263,52 @@ TEST_CASE("Compiler::ConstValueTest")
         REQUIRE(uvec4.GetSwizzle(SwizzleDesc::Parse("yy")) == ConstValue::CreateVector<uint32_t>({1, 1}));
     }
 
+    SECTION("CloneToArena")
+    {
+        MemoryArena arena;
+
+        ConstValue vec4  = ConstValue::CreateVector<float>({1.0f, 2.0f, 3.0f, 4.0f});
+        ConstValue dvec4 = ConstValue::CreateVector<double>({1.0, 2.0, 3.0, 4.0});
+
+        ConstValue smallValue = vec4.CloneToArena(arena);
+        REQUIRE(smallValue == vec4);
+
+        ConstValue largeValue = dvec4.CloneToArena(arena);
+        REQUIRE(largeValue == dvec4);
+
+        // A clone of a borrowed value owns a copy of the buffer, so it may outlive the arena.
+        ConstValue clonedValue = largeValue.Clone();
+        REQUIRE(clonedValue == dvec4);
+        REQUIRE(clonedValue.GetBufferAsBlob().data() != largeValue.GetBufferAsBlob().data());
+    }
+
     // FIXME: add more tests
 }
+
+TEST_CASE("Compiler::ConstValueBenchmark", "[.benchmark]")
+{
+    ConstValue dmat4 = ConstValue::ConstructMatrix(ConstValue::CreateScalar(2.0), ScalarKind::Double, 4, 4);
+    ConstValue mat4  = ConstValue::ConstructMatrix(ConstValue::CreateScalar(2.0f), ScalarKind::Float, 4, 4);
+    ConstValue vec4  = ConstValue::CreateVector<float>({1, 2, 3, 4});
+
+    BENCHMARK("ElemwisePlus dmat4")
+    {
+        return dmat4.ElemwisePlus(dmat4);
+    };
+    BENCHMARK("ElemwiseLessThan dmat4")
+    {
+        return dmat4.ElemwiseLessThan(dmat4);
+    };
+    BENCHMARK("CastScalar dmat4")
+    {
+        return dmat4.CastScalar(ScalarKind::Float);
+    };
+    BENCHMARK("MatrixMul mat4 * mat4")
+    {
+        return mat4.MatrixMul(mat4);
+    };
+    BENCHMARK("MatrixMul mat4 * vec4")
+    {
+        return mat4.MatrixMul(vec4);
+    };
+}
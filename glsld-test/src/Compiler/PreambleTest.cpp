@@ -1,5 +1,8 @@
 #include "CompilerTestFixture.h"
 
+#include <array>
+#include <thread>
+
 using namespace glsld;
 
 TEST_CASE_METHOD(CompilerTestFixture, "Compiler::PreambleTest")
@@ -75,4 +78,136 @@ TEST_CASE_METHOD(CompilerTestFixture, "Compiler::PreambleTest")
                                   })),
                  }));
     }
-}
\ No newline at end of file
+
+    SECTION("Stdlib")
+    {
+        SourceTextView mainFileText = R"(
+            void main() {
+                sin(1.0);
+                clamp(1, 0.0, 1.0);
+                mix(vec2(0), vec2(1), 0.5);
+            }
+        )";
+
+        // Builtin calls resolve to the prototypes in the system preamble
+        CompilerInvocation compiler;
+        compiler.SetMainFileFromBuffer(mainFileText);
+        auto result = compiler.CompileMainFile(nullptr, CompileMode::ParseOnly);
+
+        auto isBuiltinCall = [](const AstExpr& expr) {
+            auto callExpr = expr.As<AstFunctionCallExpr>();
+            return callExpr && callExpr->GetResolvedFunction() &&
+                   callExpr->GetResolvedFunction()->GetSyntaxRange().GetTranslationUnit() ==
+                       TranslationUnitID::SystemPreamble;
+        };
+        for (auto decl : result->GetUserFileArtifacts().GetAst()->GetGlobalDecls()) {
+            if (auto funcDecl = decl->As<AstFunctionDecl>(); funcDecl && funcDecl->GetBody()) {
+                for (auto stmt : funcDecl->GetBody()->As<AstCompoundStmt>()->GetChildren()) {
+                    REQUIRE(isBuiltinCall(*stmt->As<AstExprStmt>()->GetExpr()));
+                }
+            }
+        }
+
+        CheckAst(result->GetUserFileArtifacts().GetAst(),
+                 TranslationUnit({
+                     FunctionDecl(AnyAst(), IdTok("main"), {},
+                                  CompoundStmt({
+                                      ExprStmt(FunctionCallExpr("sin", {AnyExpr()})
+                                                   ->CheckType(GlslBuiltinType::Ty_float)),
+                                      ExprStmt(FunctionCallExpr("clamp", {AnyExpr(), AnyExpr(), AnyExpr()})
+                                                   ->CheckType(GlslBuiltinType::Ty_float)),
+                                      ExprStmt(FunctionCallExpr("mix", {AnyExpr(), AnyExpr(), AnyExpr()})
+                                                   ->CheckType(GlslBuiltinType::Ty_vec2)),
+                                  })),
+                 }));
+    }
+
+    SECTION("StdlibSharedPreamble")
+    {
+        SourceTextView mainFileText = R"(
+            void main() {
+                sin(1.0);
+            }
+        )";
+
+        // Builtin functions are looked up from the shared preamble by concurrent compilations
+        CompilerInvocation preambleCompiler;
+        auto preamble = preambleCompiler.CompilePreamble(nullptr);
+
+        auto findResolvedFunction = [&]() -> const AstFunctionDecl* {
+            CompilerInvocation compiler{preamble};
+            compiler.SetMainFileFromBuffer(mainFileText);
+            auto result = compiler.CompileMainFile(nullptr, CompileMode::ParseOnly);
+
+            auto mainDecl = result->GetUserFileArtifacts().GetAst()->GetGlobalDecls()[0]->As<AstFunctionDecl>();
+            auto callStmt = mainDecl->GetBody()->As<AstCompoundStmt>()->GetChildren()[0]->As<AstExprStmt>();
+            return callStmt->GetExpr()->As<AstFunctionCallExpr>()->GetResolvedFunction();
+        };
+
+        std::array<const AstFunctionDecl*, 4> resolvedFunctions = {};
+        {
+            std::vector<std::jthread> threads;
+            for (auto& resolvedFunction : resolvedFunctions) {
+                threads.emplace_back([&] { resolvedFunction = findResolvedFunction(); });
+            }
+        }
+
+        REQUIRE(resolvedFunctions[0] != nullptr);
+        REQUIRE(std::ranges::all_of(resolvedFunctions, [&](auto decl) { return decl == resolvedFunctions[0]; }));
+    }
+
+    SECTION("StdlibSegments")
+    {
+        SourceTextView mainFileText = R"(
+            void main() {
+                gl_DrawID;
+            }
+        )";
+
+        // Preambles of all shader stages are composed on top of the same stdlib core, and are reused across
+        // invocations with the same language config
+        auto compilePreamble = [](GlslShaderStage stage) {
+            CompilerInvocation compiler;
+            compiler.SetShaderStage(stage);
+            return compiler.CompilePreamble(nullptr);
+        };
+        auto vertexPreamble   = compilePreamble(GlslShaderStage::Vertex);
+        auto fragmentPreamble = compilePreamble(GlslShaderStage::Fragment);
+        REQUIRE(vertexPreamble->GetSystemPreambleArtifacts().GetAst() ==
+                fragmentPreamble->GetSystemPreambleArtifacts().GetAst());
+        REQUIRE(compilePreamble(GlslShaderStage::Vertex) == vertexPreamble);
+
+        // Builtin variables of a shader stage are declared in its own stage segment
+        auto findResolvedDecl = [&](std::shared_ptr<PrecompiledPreamble> preamble) -> const AstDecl* {
+            CompilerInvocation compiler{std::move(preamble)};
+            compiler.SetMainFileFromBuffer(mainFileText);
+            auto result = compiler.CompileMainFile(nullptr, CompileMode::ParseOnly);
+
+            auto mainDecl = result->GetUserFileArtifacts().GetAst()->GetGlobalDecls()[0]->As<AstFunctionDecl>();
+            auto exprStmt = mainDecl->GetBody()->As<AstCompoundStmt>()->GetChildren()[0]->As<AstExprStmt>();
+            return exprStmt->GetExpr()->As<AstNameAccessExpr>()->GetResolvedDecl();
+        };
+
+        auto vertexDecl = findResolvedDecl(vertexPreamble);
+        REQUIRE(vertexDecl != nullptr);
+        REQUIRE(vertexDecl->GetSyntaxRange().GetTranslationUnit() == TranslationUnitID::UserPreamble);
+        REQUIRE(findResolvedDecl(fragmentPreamble) == nullptr);
+    }
+
+    SECTION("StdlibCompilerConfig")
+    {
+        // Stdlib segments are only shared across invocations with the same compiler config
+        auto compilePreamble = [](bool countUtf16Characters) {
+            CompilerInvocation compiler;
+            compiler.SetShaderStage(GlslShaderStage::Vertex);
+            compiler.SetCountUtf16Characters(countUtf16Characters);
+            return compiler.CompilePreamble(nullptr);
+        };
+        auto utf8Preamble  = compilePreamble(false);
+        auto utf16Preamble = compilePreamble(true);
+        REQUIRE(utf8Preamble != utf16Preamble);
+        REQUIRE(utf8Preamble->GetSystemPreambleArtifacts().GetAst() !=
+                utf16Preamble->GetSystemPreambleArtifacts().GetAst());
+        REQUIRE(compilePreamble(true) == utf16Preamble);
+    }
+}
@@ -0,0 +1,102 @@
+#include "Server/BackgroundCompilation.h"
+
+#include <catch2/catch_test_macros.hpp>
+
+using namespace glsld;
+
+static auto CreateCompilation(int version, std::string sourceString) -> std::shared_ptr<BackgroundCompilation>
+{
+    return std::make_shared<BackgroundCompilation>(version, "file:///test.glsl",
+                                                   TextDocumentBuffer{StringView{sourceString}},
+                                                   LanguageConfig{.noStdlib = true}, nullptr);
+}
+
+TEST_CASE("Server::BackgroundCompilationTest")
+{
+    SECTION("Coalesce")
+    {
+        auto previous = CreateCompilation(1, "int x;");
+        auto next     = CreateCompilation(2, "int x; int y;");
+
+        REQUIRE(BackgroundCompilation::TryCoalesce(previous, next));
+        REQUIRE(previous->IsExpired());
+        REQUIRE(previous->IsSuperseded());
+        REQUIRE(!next->IsExpired());
+
+        // The previous compilation never runs, but its waiters are released by the next one
+        previous->Run();
+        next->Run();
+        stdexec::sync_wait(previous->AsyncWaitAvailable());
+
+        REQUIRE(!previous->IsAvailable());
+        REQUIRE(&previous->ResolveCoalesced() == next.get());
+        REQUIRE(next->GetLanguageQueryInfo().GetUserFileAst().GetGlobalDecls().size() == 2);
+    }
+
+    SECTION("CoalesceChain")
+    {
+        auto first  = CreateCompilation(1, "int x;");
+        auto second = CreateCompilation(2, "int x; int y;");
+        auto third  = CreateCompilation(3, "int x; int y; int z;");
+
+        REQUIRE(BackgroundCompilation::TryCoalesce(first, second));
+        REQUIRE(BackgroundCompilation::TryCoalesce(second, third));
+
+        third->Run();
+        stdexec::sync_wait(first->AsyncWaitAvailable());
+        stdexec::sync_wait(second->AsyncWaitAvailable());
+
+        REQUIRE(&first->ResolveCoalesced() == third.get());
+        REQUIRE(&second->ResolveCoalesced() == third.get());
+    }
+
+    SECTION("AlreadyStarted")
+    {
+        auto previous = CreateCompilation(1, "int x;");
+        auto next     = CreateCompilation(2, "int x; int y;");
+
+        previous->Run();
+        REQUIRE(!BackgroundCompilation::TryCoalesce(previous, next));
+        REQUIRE(previous->IsAvailable());
+        REQUIRE(&previous->ResolveCoalesced() == previous.get());
+    }
+
+    SECTION("Supersede")
+    {
+        auto previous = CreateCompilation(1, "int x;");
+        auto next     = CreateCompilation(2, "int x; int y;");
+
+        // A started compilation is expired, and queries waiting on it move to the next one
+        previous->Run();
+        REQUIRE(!BackgroundCompilation::TryCoalesce(previous, next));
+        previous->Supersede(next);
+        REQUIRE(previous->IsExpired());
+        REQUIRE(previous->IsSuperseded());
+        REQUIRE(previous->GetReplacement() == next);
+
+        next->Run();
+        REQUIRE(next->GetLanguageQueryInfo().GetUserFileAst().GetGlobalDecls().size() == 2);
+    }
+
+    SECTION("ResultMemorySize")
+    {
+        auto compilation = CreateCompilation(1, "int x;");
+        REQUIRE(compilation->GetResultMemorySize() == 0);
+
+        compilation->Run();
+        REQUIRE(compilation->GetResultMemorySize() > 0);
+    }
+
+    SECTION("Expired")
+    {
+        auto compilation = CreateCompilation(1, "int x;");
+        compilation->SetExpired();
+
+        // An expired compilation only releases its waiters
+        compilation->Run();
+        stdexec::sync_wait(compilation->AsyncWaitAvailable());
+        REQUIRE(!compilation->IsAvailable());
+        REQUIRE(compilation->GetReplacement() == nullptr);
+        REQUIRE(!compilation->IsSuperseded());
+    }
+}
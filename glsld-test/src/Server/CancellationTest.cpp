@@ -0,0 +1,86 @@
+#include "Server/LanguageServer.h"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#if !defined(GLSLD_OS_WIN)
+#include <unistd.h>
+
+using namespace glsld;
+
+TEST_CASE("Server::CancellationTest")
+{
+    int outputPipe[2];
+    REQUIRE(pipe(outputPipe) == 0);
+
+    // Collect the messages sent by the server as they are written.
+    std::mutex outputMutex;
+    std::condition_variable outputChanged;
+    std::string output;
+    std::thread reader{[&] {
+        char buffer[4096];
+        while (true) {
+            auto bytesRead = read(outputPipe[0], buffer, sizeof(buffer));
+            if (bytesRead <= 0) {
+                break;
+            }
+
+            std::lock_guard<std::mutex> lock{outputMutex};
+            output.append(buffer, bytesRead);
+            outputChanged.notify_all();
+        }
+    }};
+
+    {
+        // The document is handled in degraded mode once it's opened, so its compilation waits for the coalescing
+        // window. The cancellation is guaranteed to arrive before the query could run.
+        auto config                                             = GetDefaultLanguageServerConfig();
+        config.loggingLevel                                     = LoggingLevel::Error;
+        config.languageService.largeDocument.maxLineCount       = 1;
+        config.languageService.largeDocument.coalescingWindowMs = 200;
+        LanguageServer server{config, CreateFileDescriptorTextTransport(-1, outputPipe[1])};
+
+        server.HandleClientMessage(
+            R"({"jsonrpc":"2.0","method":"textDocument/didOpen","params":{"textDocument":)"
+            R"({"uri":"file:///cancel.glsl","languageId":"glsl","version":1,"text":"int x;\nvoid main() {}\n"}}})");
+        server.HandleClientMessage(
+            R"({"jsonrpc":"2.0","id":2,"method":"textDocument/documentSymbol",)"
+            R"("params":{"textDocument":{"uri":"file:///cancel.glsl"}}})");
+        server.HandleClientMessage(R"({"jsonrpc":"2.0","method":"$/cancelRequest","params":{"id":2}})");
+
+        // The request is still responded to, but with an error instead of the result.
+        {
+            std::unique_lock<std::mutex> lock{outputMutex};
+            REQUIRE(outputChanged.wait_for(lock, std::chrono::seconds(10), [&] {
+                return output.find(R"("id":2,)") != std::string::npos;
+            }));
+            REQUIRE(output.find(R"({"jsonrpc":"2.0","id":2,"error":{"code":-32800,)") != std::string::npos);
+            REQUIRE(output.find(R"("id":2,"result")") == std::string::npos);
+        }
+
+        // A query on a document that is not open is responded to with an error, including after it's closed.
+        server.HandleClientMessage(
+            R"({"jsonrpc":"2.0","method":"textDocument/didClose",)"
+            R"("params":{"textDocument":{"uri":"file:///cancel.glsl"}}})");
+        server.HandleClientMessage(
+            R"({"jsonrpc":"2.0","id":3,"method":"textDocument/documentSymbol",)"
+            R"("params":{"textDocument":{"uri":"file:///cancel.glsl"}}})");
+        {
+            std::unique_lock<std::mutex> lock{outputMutex};
+            REQUIRE(outputChanged.wait_for(lock, std::chrono::seconds(10), [&] {
+                return output.find(R"("id":3,)") != std::string::npos;
+            }));
+            REQUIRE(output.find(R"({"jsonrpc":"2.0","id":3,"error":{"code":-32602,)") != std::string::npos);
+        }
+    }
+
+    close(outputPipe[1]);
+    reader.join();
+    close(outputPipe[0]);
+}
+#endif
@@ -115,9 +115,11 @@ TEST_CASE_METHOD(ServerTestFixture, "Server::CompletionTest")
     {
         CompileLabelledSource(R"(
             #define HELLO 123
+            #define WORLD 456
 
             void main() {
                 int x = ^[macro.use];
+                int y = he^[macro.prefix];
                 vec4 v = vec4(1.0);
                 v.^[field.use];
             }
@@ -127,8 +129,17 @@ TEST_CASE_METHOD(ServerTestFixture, "Server::CompletionTest")
                                          .items =
                                              {
                                                  {.label = "HELLO", .kind = lsp::CompletionItemKind::Text},
+                                                 {.label = "WORLD", .kind = lsp::CompletionItemKind::Text},
                                              },
                                      });
+        checkCompletion("macro.prefix", CompletionExpectedResult{
+                                            .isIncomplete = true,
+                                            .items =
+                                                {
+                                                    {.label = "HELLO", .kind = lsp::CompletionItemKind::Text},
+                                                    {.label = "WORLD", .checkNotExist = true},
+                                                },
+                                        });
 
         // Currently, macro completion is disabled in access chain context
         checkCompletion("field.use", CompletionExpectedResult{
@@ -292,4 +303,135 @@ TEST_CASE_METHOD(ServerTestFixture, "Server::CompletionTest")
                                                 },
                                         });
     }
+
+    SECTION("Prefix")
+    {
+        CompileLabelledSource(R"(
+            float value;
+            void main() {
+                float x = si^[prefix.use1];
+                val^[prefix.use2]
+            }
+        )",
+                              true);
+
+        checkCompletion("prefix.use1", CompletionExpectedResult{
+                                           .items =
+                                               {
+                                                   {.label = "sin", .kind = lsp::CompletionItemKind::Function},
+                                                   {.label = "sinh", .kind = lsp::CompletionItemKind::Function},
+                                                   {.label = "cos", .checkNotExist = true},
+                                                   {.label = "value", .checkNotExist = true},
+                                               },
+                                       });
+        checkCompletion("prefix.use2", CompletionExpectedResult{
+                                           .items =
+                                               {
+                                                   {.label = "value", .kind = lsp::CompletionItemKind::Variable},
+                                                   {.label = "void", .checkNotExist = true},
+                                                   {.label = "sin", .checkNotExist = true},
+                                               },
+                                       });
+    }
+
+    SECTION("FuzzyMatch")
+    {
+        CompileLabelledSource(R"(
+            float myValue;
+            void main() {
+                float x = SI^[fuzzy.use1];
+                mV^[fuzzy.use2]
+            }
+        )",
+                              true);
+
+        // Symbols are matched by subsequence ignoring case, anchored at the first character, and the filtered list is
+        // incomplete
+        checkCompletion("fuzzy.use1", CompletionExpectedResult{
+                                          .isIncomplete = true,
+                                          .items =
+                                              {
+                                                  {.label = "sin", .kind = lsp::CompletionItemKind::Function},
+                                                  {.label = "sign", .kind = lsp::CompletionItemKind::Function},
+                                                  {.label = "asin", .checkNotExist = true},
+                                                  {.label = "cos", .checkNotExist = true},
+                                              },
+                                      });
+        checkCompletion("fuzzy.use2", CompletionExpectedResult{
+                                          .isIncomplete = true,
+                                          .items =
+                                              {
+                                                  {.label = "myValue", .kind = lsp::CompletionItemKind::Variable},
+                                              },
+                                      });
+    }
+
+    SECTION("LocalScope")
+    {
+        CompileLabelledSource(R"(
+            float global;
+            void main(int param) {
+                int before = 1;
+                {
+                    int sibling = 2;
+                }
+                for (int i = 0; i < 10; ++i) {
+                    ^[cursor.pos]
+                }
+                int after = 3;
+            }
+        )");
+
+        // Only declarations in enclosing scopes that precede the cursor are visible
+        checkCompletion("cursor.pos", CompletionExpectedResult{
+                                          .items =
+                                              {
+                                                  {.label = "global", .kind = lsp::CompletionItemKind::Variable},
+                                                  {.label = "param", .kind = lsp::CompletionItemKind::Variable},
+                                                  {.label = "before", .kind = lsp::CompletionItemKind::Variable},
+                                                  {.label = "i", .kind = lsp::CompletionItemKind::Variable},
+                                                  {.label = "sibling", .checkNotExist = true},
+                                                  {.label = "after", .checkNotExist = true},
+                                              },
+                                      });
+    }
+
+    SECTION("MaxItemCount")
+    {
+        CompileLabelledSource(R"(
+            void main() { ^[cursor.pos] }
+        )");
+
+        auto completionList =
+            MockCompletion(*this, GetLabelledPosition("cursor.pos"), {.enable = true, .maxItemCount = 10});
+        REQUIRE(completionList.items.size() == 10);
+        REQUIRE(completionList.isIncomplete);
+    }
+
+    SECTION("Resolve")
+    {
+        CompileLabelledSource(R"(
+            void main() { sin^[cursor.pos] }
+        )",
+                              true);
+
+        CompletionConfig config{.enable = true};
+        CompletionState state;
+        auto completionList = HandleCompletion(config, GetLanguageQueryInfo(), state,
+                                               lsp::CompletionParams{
+                                                   .textDocument = {"MockDocument"},
+                                                   .position     = ToLspPosition(GetLabelledPosition("cursor.pos")),
+                                               });
+
+        // Documentation is not sent with the completion list
+        auto it = std::ranges::find_if(completionList.items,
+                                       [](const lsp::CompletionItem& item) { return item.label == "sin"; });
+        REQUIRE(it != completionList.items.end());
+        REQUIRE(!it->documentation.has_value());
+        REQUIRE(it->data == "MockDocument");
+
+        auto resolvedItem = HandleCompletionResolve(config, GetLanguageQueryInfo(), state, *it);
+        REQUIRE(resolvedItem.documentation.has_value());
+        REQUIRE(resolvedItem.documentation->GetValue().Contains("sine function"));
+    }
 }
@@ -42,6 +42,13 @@ TEST_CASE("Server::ConfigTest")
         },
         "signatureHelp": {
             "enable": true
+        },
+        "largeDocument": {
+            "maxSize": 1048576,
+            "maxCompileTimeMs": 500
+        },
+        "memoryBudget": {
+            "maxMemoryMb": 256
         }
     },
     "loggingLevel": "Debug"
@@ -56,6 +63,15 @@ TEST_CASE("Server::ConfigTest")
     REQUIRE(parsedConfig->languageService.inlayHint.enableBlockEndHint);
     REQUIRE(parsedConfig->languageService.inlayHint.blockEndHintLineThreshold == 4);
 
+    // Large document
+    REQUIRE(parsedConfig->languageService.largeDocument.maxSize == 1048576);
+    REQUIRE(parsedConfig->languageService.largeDocument.maxCompileTimeMs == 500);
+    REQUIRE(parsedConfig->languageService.largeDocument.maxLineCount ==
+            GetDefaultLanguageServerConfig().languageService.largeDocument.maxLineCount);
+
+    // Memory budget
+    REQUIRE(parsedConfig->languageService.memoryBudget.maxMemoryMb == 256);
+
     // Logging
     REQUIRE(parsedConfig->loggingLevel == LoggingLevel::Debug);
 }
\ No newline at end of file
@@ -0,0 +1,153 @@
+#include "ServerTestFixture.h"
+
+#include "Feature/Diagnostic.h"
+#include "Support/SourceText.h"
+
+#include <algorithm>
+
+using namespace glsld;
+
+static auto MockDiagnostic(const ServerTestFixture& fixture, const DiagnosticConfig& config = {.enable = true})
+    -> std::vector<lsp::Diagnostic>
+{
+    return HandleDiagnostic(config, fixture.GetLanguageQueryInfo());
+}
+
+TEST_CASE_METHOD(ServerTestFixture, "Server::DiagnosticTest")
+{
+    auto checkDiagnostic = [this](const std::vector<lsp::Diagnostic>& diagnostics, StringView labelBegin,
+                                  StringView labelEnd, lsp::DiagnosticSeverity severity, StringView message) {
+        auto it = std::ranges::find(diagnostics, message.Str(), &lsp::Diagnostic::message);
+        REQUIRE(it != diagnostics.end());
+        REQUIRE(FromLspRange(it->range) == GetLabelledRange(labelBegin, labelEnd));
+        REQUIRE(it->severity == severity);
+    };
+
+    SECTION("Config")
+    {
+        CompileLabelledSource(R"(
+            int x = y;
+        )");
+
+        REQUIRE(MockDiagnostic(*this, DiagnosticConfig{.enable = false}).empty());
+        REQUIRE(!MockDiagnostic(*this).empty());
+    }
+
+    SECTION("NoError")
+    {
+        CompileLabelledSource(R"(
+            #define N 4
+            struct S { float a[N]; };
+
+            float foo(S s) {
+                return s.a[0];
+            }
+
+            void main() {
+                S s;
+                float x = foo(s);
+            }
+        )");
+
+        REQUIRE(MockDiagnostic(*this).empty());
+    }
+
+    SECTION("Parser")
+    {
+        CompileLabelledSource(R"(
+            void main() {
+                int x = 1
+            ^[error.begin]}^[error.end]
+        )");
+
+        auto diagnostics = MockDiagnostic(*this);
+        checkDiagnostic(diagnostics, "error.begin", "error.end", lsp::DiagnosticSeverity::Error, "expecting ';'");
+    }
+
+    SECTION("Preprocessor")
+    {
+        CompileLabelledSource(R"(
+            ^[unknown.begin]#foo^[unknown.end]
+            ^[error.begin]#error bad thing^[error.end]
+            ^[define.begin]#define^[define.end]
+        )");
+
+        auto diagnostics = MockDiagnostic(*this);
+        checkDiagnostic(diagnostics, "unknown.begin", "unknown.end", lsp::DiagnosticSeverity::Warning,
+                        "unknown preprocessor directive 'foo'");
+        checkDiagnostic(diagnostics, "error.begin", "error.end", lsp::DiagnosticSeverity::Error, "#error bad thing");
+        checkDiagnostic(diagnostics, "define.begin", "define.end", lsp::DiagnosticSeverity::Error,
+                        "expected a macro name");
+    }
+
+    SECTION("UnterminatedConditional")
+    {
+        CompileLabelledSource(R"(
+            #ifdef FOO
+            int x;
+        )");
+
+        auto diagnostics = MockDiagnostic(*this);
+        REQUIRE(diagnostics.size() == 1);
+        REQUIRE(diagnostics[0].message == "unterminated conditional directive");
+        REQUIRE(diagnostics[0].severity == lsp::DiagnosticSeverity::Error);
+    }
+
+    SECTION("UndeclaredIdentifier")
+    {
+        CompileLabelledSource(R"(
+            #define USE_Z z
+
+            void main() {
+                int x = ^[y.begin]y^[y.end];
+                int w = ^[z.begin]USE_Z^[z.end];
+
+                // Builtin variables are not diagnosed without the stdlib
+                gl_Position = vec4(x);
+            }
+        )");
+
+        auto diagnostics = MockDiagnostic(*this);
+        REQUIRE(diagnostics.size() == 2);
+        checkDiagnostic(diagnostics, "y.begin", "y.end", lsp::DiagnosticSeverity::Error,
+                        "use of undeclared identifier 'y'");
+        checkDiagnostic(diagnostics, "z.begin", "z.end", lsp::DiagnosticSeverity::Error,
+                        "use of undeclared identifier 'z'");
+    }
+
+    SECTION("UnmodeledBuiltin")
+    {
+        // Builtins of extensions and profiles that the stdlib doesn't model are only warned about.
+        CompileLabelledSource(R"(
+            uniform sampler2D tex;
+
+            void main() {
+                float x = ^[subgroupAdd.begin]subgroupAdd^[subgroupAdd.end](1.0);
+                uint id = ^[subgroupId.begin]gl_SubgroupInvocationID^[subgroupId.end];
+                vec4 color = ^[texture2D.begin]texture2D^[texture2D.end](tex, gl_FragCoord.xy);
+                ^[fragColor.begin]gl_FragColor^[fragColor.end] = color;
+
+                int y = ^[y.begin]y^[y.end];
+                float z = ^[sin.begin]sin^[sin.end](1, 2, 3);
+            }
+        )",
+                              true, GlslShaderStage::Fragment);
+
+        auto diagnostics = MockDiagnostic(*this);
+        REQUIRE(diagnostics.size() == 6);
+        checkDiagnostic(diagnostics, "subgroupAdd.begin", "subgroupAdd.end", lsp::DiagnosticSeverity::Warning,
+                        "no known builtin function matches the call to 'subgroupAdd'");
+        checkDiagnostic(diagnostics, "subgroupId.begin", "subgroupId.end", lsp::DiagnosticSeverity::Warning,
+                        "use of unknown builtin identifier 'gl_SubgroupInvocationID'");
+        checkDiagnostic(diagnostics, "texture2D.begin", "texture2D.end", lsp::DiagnosticSeverity::Warning,
+                        "no known builtin function matches the call to 'texture2D'");
+        checkDiagnostic(diagnostics, "fragColor.begin", "fragColor.end", lsp::DiagnosticSeverity::Warning,
+                        "use of unknown builtin identifier 'gl_FragColor'");
+
+        // Other names are still errors with the stdlib.
+        checkDiagnostic(diagnostics, "y.begin", "y.end", lsp::DiagnosticSeverity::Error,
+                        "use of undeclared identifier 'y'");
+        checkDiagnostic(diagnostics, "sin.begin", "sin.end", lsp::DiagnosticSeverity::Error,
+                        "no matching function for call to 'sin'");
+    }
+}
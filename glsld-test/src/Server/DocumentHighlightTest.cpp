@@ -0,0 +1,161 @@
+#include "ServerTestFixture.h"
+
+#include "Feature/DocumentHighlight.h"
+#include "Support/SourceText.h"
+
+#include <ranges>
+#include <tuple>
+
+using namespace glsld;
+
+static auto MockDocumentHighlight(const ServerTestFixture& fixture, TextPosition pos,
+                                  const DocumentHighlightConfig& config = {.enable = true})
+    -> std::vector<lsp::DocumentHighlight>
+{
+    return HandleDocumentHighlight(config, fixture.GetLanguageQueryInfo(),
+                                   lsp::DocumentHighlightParams{
+                                       .textDocument = {"MockDocument"},
+                                       .position     = ToLspPosition(pos),
+                                   });
+}
+
+TEST_CASE_METHOD(ServerTestFixture, "Server::DocumentHighlightTest")
+{
+    using HighlightKind = lsp::DocumentHighlightKind;
+
+    auto checkNoHighlight = [this](StringView labelPos, const DocumentHighlightConfig& config = {.enable = true}) {
+        auto highlights = MockDocumentHighlight(*this, GetLabelledPosition(labelPos), config);
+        REQUIRE(highlights.empty());
+    };
+
+    auto checkHighlight = [this](StringView labelPos,
+                                 const std::vector<std::tuple<StringView, StringView, HighlightKind>>& expected) {
+        auto highlights = MockDocumentHighlight(*this, GetLabelledPosition(labelPos));
+        REQUIRE(highlights.size() == expected.size());
+        for (auto [highlight, expectedItem] : std::views::zip(highlights, expected)) {
+            auto [labelBegin, labelEnd, kind] = expectedItem;
+            REQUIRE(FromLspRange(highlight.range) == GetLabelledRange(labelBegin, labelEnd));
+            REQUIRE(highlight.kind == kind);
+        }
+    };
+
+    SECTION("Config")
+    {
+        CompileLabelledSource(R"(
+            float ^[var.decl]var;
+
+            void foo() {
+                ^[var.use]var = 1.0;
+            }
+        )");
+
+        checkNoHighlight("var.decl", DocumentHighlightConfig{.enable = false});
+        checkNoHighlight("var.use", DocumentHighlightConfig{.enable = false});
+    }
+
+    SECTION("Macro")
+    {
+        CompileLabelledSource(R"(
+            #define ^[MACRO.def.begin]MACRO^[MACRO.def.end] 1
+
+            int x = ^[MACRO.use.begin]MACRO^[MACRO.use.end];
+        )");
+
+        checkHighlight("MACRO.use.begin", {
+                                              {"MACRO.def.begin", "MACRO.def.end", HighlightKind::Text},
+                                              {"MACRO.use.begin", "MACRO.use.end", HighlightKind::Read},
+                                          });
+    }
+
+    SECTION("Variable")
+    {
+        CompileLabelledSource(R"(
+            float ^[global.decl.begin]global^[global.decl.end];
+
+            void foo() {
+                ^[global.use1.begin]global^[global.use1.end] = 1.0;
+                float ^[local.decl.begin]local^[local.decl.end] = ^[global.use2.begin]global^[global.use2.end];
+                ^[local.use.begin]local^[local.use.end] += 2.0;
+            }
+        )");
+
+        checkHighlight("global.decl.begin", {
+                                                {"global.decl.begin", "global.decl.end", HighlightKind::Text},
+                                                {"global.use1.begin", "global.use1.end", HighlightKind::Write},
+                                                {"global.use2.begin", "global.use2.end", HighlightKind::Read},
+                                            });
+        checkHighlight("local.use.begin", {
+                                              {"local.decl.begin", "local.decl.end", HighlightKind::Write},
+                                              {"local.use.begin", "local.use.end", HighlightKind::Write},
+                                          });
+    }
+
+    SECTION("WriteAccess")
+    {
+        CompileLabelledSource(R"(
+            void foo() {
+                vec4 ^[v.decl.begin]v^[v.decl.end];
+                ^[v.use1.begin]v^[v.use1.end].xy = vec2(1.0);
+                ^[v.use2.begin]v^[v.use2.end][0]++;
+                float x = ^[v.use3.begin]v^[v.use3.end].x;
+            }
+        )");
+
+        // Only assignment targets are writes, including a swizzle or an element of the variable
+        checkHighlight("v.decl.begin", {
+                                           {"v.decl.begin", "v.decl.end", HighlightKind::Text},
+                                           {"v.use1.begin", "v.use1.end", HighlightKind::Write},
+                                           {"v.use2.begin", "v.use2.end", HighlightKind::Write},
+                                           {"v.use3.begin", "v.use3.end", HighlightKind::Read},
+                                       });
+    }
+
+    SECTION("OutParam")
+    {
+        CompileLabelledSource(R"(
+            void bar(out float a, inout float b, float c) {
+            }
+
+            void foo() {
+                vec4 ^[v.decl.begin]v^[v.decl.end];
+                bar(^[v.use1.begin]v^[v.use1.end].x, ^[v.use2.begin]v^[v.use2.end][1], ^[v.use3.begin]v^[v.use3.end].z);
+            }
+        )");
+
+        // Arguments passed to `out` or `inout` parameters are writes
+        checkHighlight("v.decl.begin", {
+                                           {"v.decl.begin", "v.decl.end", HighlightKind::Text},
+                                           {"v.use1.begin", "v.use1.end", HighlightKind::Write},
+                                           {"v.use2.begin", "v.use2.end", HighlightKind::Write},
+                                           {"v.use3.begin", "v.use3.end", HighlightKind::Read},
+                                       });
+    }
+
+    SECTION("Function")
+    {
+        CompileLabelledSource(R"(
+            void ^[foo.decl.begin]foo^[foo.decl.end]() {
+            }
+
+            void main() {
+                ^[foo.use.begin]foo^[foo.use.end]();
+            }
+        )");
+
+        checkHighlight("foo.use.begin", {
+                                            {"foo.decl.begin", "foo.decl.end", HighlightKind::Text},
+                                            {"foo.use.begin", "foo.use.end", HighlightKind::Read},
+                                        });
+    }
+
+    SECTION("NoSymbol")
+    {
+        CompileLabelledSource(R"(
+            void main() {
+                ^[literal]1.0;
+            }
+        )");
+
+        checkNoHighlight("literal");
+    }
+}
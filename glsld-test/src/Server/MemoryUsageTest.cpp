@@ -0,0 +1,116 @@
+#include "Server/LanguageServer.h"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <algorithm>
+#include <string>
+
+#if !defined(GLSLD_OS_WIN)
+#include <fcntl.h>
+#include <unistd.h>
+
+using namespace glsld;
+
+TEST_CASE("Server::MemoryUsageTest")
+{
+    // Responses are not checked here.
+    int outputFd = open("/dev/null", O_WRONLY);
+    REQUIRE(outputFd >= 0);
+
+    auto config         = GetDefaultLanguageServerConfig();
+    config.loggingLevel = LoggingLevel::Error;
+
+    SECTION("Replay")
+    {
+        LanguageServer server{config, CreateFileDescriptorTextTransport(-1, outputFd)};
+        server.Replay(R"({"jsonrpc":"2.0","method":"textDocument/didOpen","params":{"textDocument":)"
+                      R"({"uri":"file:///a.glsl","languageId":"glsl","version":1,"text":"void main() {}\n"}}},)");
+
+        // The compilation is scheduled in the background, so the report is only complete after waiting for it.
+        server.WaitForPendingTasks();
+        auto report = server.CollectMemoryUsage();
+        REQUIRE(report.documents.size() == 1);
+        REQUIRE(report.documents[0].compiled);
+        REQUIRE(report.documents[0].ast.allocatedBytes > 0);
+
+        // The stdlib core is retained by the process-wide cache after the document is closed, so it's still counted.
+        server.Replay(R"({"jsonrpc":"2.0","method":"textDocument/didClose",)"
+                      R"("params":{"textDocument":{"uri":"file:///a.glsl"}}},)");
+        server.WaitForPendingTasks();
+        report = server.CollectMemoryUsage();
+        REQUIRE(report.documents.empty());
+        REQUIRE(!report.preambles.empty());
+        REQUIRE(report.total.allocatedBytes > 0);
+    }
+
+    SECTION("MemoryBudget")
+    {
+        // Each document alone holds more than the budget once compiled.
+        config.languageService.memoryBudget.maxMemoryMb = 1;
+        LanguageServer server{config, CreateFileDescriptorTextTransport(-1, outputFd)};
+
+        auto openDocument = [&](StringView uri) {
+            std::string text;
+            for (int i = 0; i < 20000; ++i) {
+                text += fmt::format("float value{} = {}.0;\\n", i, i);
+            }
+            server.Replay(fmt::format(R"({{"jsonrpc":"2.0","method":"textDocument/didOpen","params":{{"textDocument":)"
+                                      R"({{"uri":"{}","languageId":"glsl","version":1,"text":"{}"}}}}}},)",
+                                      uri, text));
+            server.WaitForPendingTasks();
+        };
+        auto findDocument = [](const lsp::MemoryUsageResult& report, StringView uri) {
+            auto it = std::ranges::find(report.documents, uri.Str(), &lsp::DocumentMemoryUsage::uri);
+            REQUIRE(it != report.documents.end());
+            return *it;
+        };
+
+        openDocument("file:///a.glsl");
+        REQUIRE(findDocument(server.CollectMemoryUsage(), "file:///a.glsl").compiled);
+
+        // The least recently used document is evicted once the other compilation is published.
+        openDocument("file:///b.glsl");
+        auto report = server.CollectMemoryUsage();
+        REQUIRE(findDocument(report, "file:///a.glsl").evicted);
+        REQUIRE(!findDocument(report, "file:///a.glsl").compiled);
+        REQUIRE(findDocument(report, "file:///b.glsl").compiled);
+
+        // Querying the evicted document compiles it again, which in turn evicts the other one.
+        server.Replay(R"({"jsonrpc":"2.0","id":1,"method":"textDocument/documentSymbol",)"
+                      R"("params":{"textDocument":{"uri":"file:///a.glsl"}}},)");
+        server.WaitForPendingTasks();
+        report = server.CollectMemoryUsage();
+        REQUIRE(!findDocument(report, "file:///a.glsl").evicted);
+        REQUIRE(findDocument(report, "file:///a.glsl").compiled);
+        REQUIRE(findDocument(report, "file:///b.glsl").evicted);
+    }
+
+    SECTION("SharedMemoryBudget")
+    {
+        // The budget is accounted across all servers in the process, so documents of one may evict those of another.
+        config.languageService.memoryBudget.maxMemoryMb = 1;
+        LanguageServer firstServer{config, CreateFileDescriptorTextTransport(-1, outputFd)};
+        LanguageServer secondServer{config, CreateFileDescriptorTextTransport(-1, outputFd)};
+
+        auto openDocument = [&](LanguageServer& server, StringView uri) {
+            std::string text;
+            for (int i = 0; i < 20000; ++i) {
+                text += fmt::format("float value{} = {}.0;\\n", i, i);
+            }
+            server.Replay(fmt::format(R"({{"jsonrpc":"2.0","method":"textDocument/didOpen","params":{{"textDocument":)"
+                                      R"({{"uri":"{}","languageId":"glsl","version":1,"text":"{}"}}}}}},)",
+                                      uri, text));
+            server.WaitForPendingTasks();
+        };
+
+        openDocument(firstServer, "file:///a.glsl");
+        REQUIRE(firstServer.CollectMemoryUsage().documents[0].compiled);
+
+        openDocument(secondServer, "file:///b.glsl");
+        REQUIRE(firstServer.CollectMemoryUsage().documents[0].evicted);
+        REQUIRE(secondServer.CollectMemoryUsage().documents[0].compiled);
+    }
+
+    close(outputFd);
+}
+#endif
@@ -0,0 +1,86 @@
+#include "Server/MessageWriter.h"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <atomic>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#if !defined(GLSLD_OS_WIN)
+#include <unistd.h>
+
+using namespace glsld;
+
+TEST_CASE("Server::MessageWriterTest")
+{
+    int outputPipe[2];
+    REQUIRE(pipe(outputPipe) == 0);
+
+    constexpr int SenderCount  = 4;
+    constexpr int MessageCount = 1000;
+
+    // Drain the pipe concurrently, since the writer blocks once the pipe is full.
+    std::string output;
+    std::thread reader{[&] {
+        char buffer[4096];
+        while (true) {
+            auto bytesRead = read(outputPipe[0], buffer, sizeof(buffer));
+            if (bytesRead <= 0) {
+                break;
+            }
+            output.append(buffer, bytesRead);
+        }
+    }};
+
+    {
+        auto transport = CreateFileDescriptorTextTransport(-1, outputPipe[1]);
+        std::atomic<bool> writeFailed = false;
+        MessageWriter writer{*transport, [&] { writeFailed = true; }};
+
+        std::vector<std::thread> senders;
+        for (int sender = 0; sender < SenderCount; ++sender) {
+            senders.emplace_back([&, sender] {
+                for (int i = 0; i < MessageCount; ++i) {
+                    writer.Enqueue(std::to_string(sender) + ":" + std::to_string(i));
+                }
+            });
+        }
+        for (auto& sender : senders) {
+            sender.join();
+        }
+
+        // The destructor writes all queued messages.
+        REQUIRE(writer.GetPeakPendingMessageCount() > 0);
+        REQUIRE(!writeFailed);
+    }
+
+    close(outputPipe[1]);
+    reader.join();
+    close(outputPipe[0]);
+
+    // Every message is framed, and messages from the same sender are written in order.
+    std::vector<int> nextIndex(SenderCount, 0);
+    std::string_view remaining = output;
+    while (!remaining.empty()) {
+        constexpr std::string_view headerPrefix = "Content-Length: ";
+        REQUIRE(remaining.starts_with(headerPrefix));
+        auto headerEnd = remaining.find("\r\n\r\n");
+        REQUIRE(headerEnd != std::string_view::npos);
+
+        auto lengthText    = remaining.substr(headerPrefix.size(), headerEnd - headerPrefix.size());
+        auto payloadLength = std::stoul(std::string{lengthText});
+        auto payload       = std::string{remaining.substr(headerEnd + 4, payloadLength)};
+        remaining          = remaining.substr(headerEnd + 4 + payloadLength);
+
+        auto separator = payload.find(':');
+        auto sender    = std::stoi(payload.substr(0, separator));
+        auto index     = std::stoi(payload.substr(separator + 1));
+        REQUIRE(index == nextIndex[sender]);
+        nextIndex[sender] += 1;
+    }
+
+    REQUIRE(nextIndex == std::vector<int>(SenderCount, MessageCount));
+}
+#endif
@@ -0,0 +1,80 @@
+#include "Server/QueryDeadline.h"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <thread>
+
+using namespace glsld;
+
+TEST_CASE("Server::QueryDeadlineTest")
+{
+    SECTION("NoDeadline")
+    {
+        REQUIRE(!QueryDeadline::IsCurrentExpired());
+        REQUIRE(!QueryDeadline::PollCurrent());
+
+        QueryDeadline deadline{std::chrono::milliseconds{0}};
+        std::this_thread::sleep_for(std::chrono::milliseconds{1});
+        REQUIRE(!deadline.IsExpired());
+        REQUIRE(!QueryDeadline::IsCurrentExpired());
+    }
+
+    SECTION("Expired")
+    {
+        QueryDeadline deadline{std::chrono::milliseconds{1}};
+        std::this_thread::sleep_for(std::chrono::milliseconds{5});
+        REQUIRE(QueryDeadline::IsCurrentExpired());
+        REQUIRE(QueryDeadline::PollCurrent());
+        REQUIRE(deadline.IsExpired());
+    }
+
+    SECTION("Poll")
+    {
+        QueryDeadline deadline{std::chrono::milliseconds{1}};
+        std::this_thread::sleep_for(std::chrono::milliseconds{5});
+
+        // The clock is only read once in a while, but the expiration is eventually observed.
+        bool expired = false;
+        for (int i = 0; i < 1000 && !expired; ++i) {
+            expired = QueryDeadline::PollCurrent();
+        }
+        REQUIRE(expired);
+    }
+
+    SECTION("Truncated")
+    {
+        QueryDeadline deadline{std::chrono::milliseconds{1}};
+        std::this_thread::sleep_for(std::chrono::milliseconds{5});
+
+        // Expiration alone doesn't make the result partial, only a traversal that halts on a poll does.
+        REQUIRE(QueryDeadline::IsCurrentExpired());
+        REQUIRE(!QueryDeadline::IsCurrentTruncated());
+        REQUIRE(QueryDeadline::PollCurrent());
+        REQUIRE(QueryDeadline::IsCurrentTruncated());
+    }
+
+    SECTION("Nested")
+    {
+        QueryDeadline outer{std::chrono::milliseconds{0}};
+        {
+            QueryDeadline inner{std::chrono::milliseconds{1}};
+            std::this_thread::sleep_for(std::chrono::milliseconds{5});
+            REQUIRE(QueryDeadline::IsCurrentExpired());
+        }
+
+        // The outer deadline is restored once the inner one is destroyed.
+        REQUIRE(!QueryDeadline::IsCurrentExpired());
+    }
+
+    SECTION("PerThread")
+    {
+        QueryDeadline deadline{std::chrono::milliseconds{1}};
+        std::this_thread::sleep_for(std::chrono::milliseconds{5});
+        REQUIRE(QueryDeadline::IsCurrentExpired());
+
+        // A deadline only applies to the thread it's installed on.
+        bool otherThreadExpired = true;
+        std::thread{[&] { otherThreadExpired = QueryDeadline::IsCurrentExpired(); }}.join();
+        REQUIRE(!otherThreadExpired);
+    }
+}
@@ -1,9 +1,11 @@
 #include "ServerTestFixture.h"
 
 #include "Feature/Reference.h"
+#include "Server/QueryDeadline.h"
 #include "Support/SourceText.h"
 
 #include <ranges>
+#include <thread>
 
 using namespace glsld;
 
@@ -298,4 +300,25 @@ TEST_CASE_METHOD(ServerTestFixture, "Server::ReferenceTest")
                        },
                        true);
     }
+
+    SECTION("DeadlineExpired")
+    {
+        CompileLabelledSource(R"(
+            float ^[var.decl.begin]var^[var.decl.end];
+
+            void foo() {
+                ^[var.use.begin]var^[var.use.end] = 1.0;
+            }
+        )");
+
+        // The occurrence index isn't built once the deadline expires.
+        {
+            QueryDeadline deadline{std::chrono::milliseconds{1}};
+            std::this_thread::sleep_for(std::chrono::milliseconds{5});
+            checkNoReference("var.decl.begin");
+        }
+
+        // A partial index isn't cached, so the next query still finds every reference.
+        checkReference("var.decl.begin", {{"var.use.begin", "var.use.end"}});
+    }
 }
\ No newline at end of file
@@ -1,6 +1,11 @@
 #include "ServerTestFixture.h"
 
 #include "Feature/SemanticTokens.h"
+#include "Server/QueryDeadline.h"
+
+#include <algorithm>
+#include <ranges>
+#include <thread>
 
 using namespace glsld;
 
@@ -36,6 +41,28 @@ TEST_CASE_METHOD(ServerTestFixture, "Server::SemanticTokenTest")
         REQUIRE(semanticTokens.empty());
     }
 
+    SECTION("LexicalOnly")
+    {
+        CompileLabelledSource(R"(
+            #define ^[MACRO.def.begin]MACRO^[MACRO.def.end] 1
+            ^[void.begin]void^[void.end] ^[foo.decl.begin]foo^[foo.decl.end]()
+            {
+                ^[return.begin]return^[return.end];
+            }
+        )");
+
+        auto semanticTokens = MockSemanticTokens(*this, SemanticTokenConfig{.enable = true, .lexicalOnly = true});
+        checkSemanticToken(semanticTokens, "MACRO.def.begin", "MACRO.def.end", SemanticTokenType::Macro);
+        checkSemanticToken(semanticTokens, "void.begin", "void.end", SemanticTokenType::Type);
+        checkSemanticToken(semanticTokens, "return.begin", "return.end", SemanticTokenType::Keyword);
+
+        // Names are only resolved by traversing the AST.
+        auto fooBegin = GetLabelledPosition("foo.decl.begin");
+        REQUIRE(std::ranges::none_of(semanticTokens, [=](const SemanticTokenInfo& token) {
+            return token.line == fooBegin.line && token.character == fooBegin.character;
+        }));
+    }
+
     SECTION("HeaderName")
     {
         CompileLabelledSource(R"(
@@ -161,10 +188,43 @@ TEST_CASE_METHOD(ServerTestFixture, "Server::SemanticTokenTest")
     }
 }
 
+TEST_CASE_METHOD(ServerTestFixture, "Server::SemanticTokenRangeTest")
+{
+    SemanticTokenConfig config{.enable = true};
+
+    CompileLabelledSource(R"(
+        #define MACRO 1
+        void foo() { }
+        ^[range.begin]int bar() {
+            return MACRO;
+        }
+        ^[range.end]void baz() { }
+    )");
+
+    auto range       = TextRange{GetLabelledPosition("range.begin"), GetLabelledPosition("range.end")};
+    auto rangeTokens = CollectSemanticTokens(config, GetLanguageQueryInfo(), range);
+    auto fullTokens  = CollectSemanticTokens(config, GetLanguageQueryInfo());
+
+    // Range tokens should be exactly the full tokens that lie in the range
+    std::vector<SemanticTokenInfo> expectedTokens;
+    std::ranges::copy_if(fullTokens, std::back_inserter(expectedTokens), [&](const SemanticTokenInfo& token) {
+        return token.line >= range.start.line && token.line < range.end.line;
+    });
+    REQUIRE(!rangeTokens.empty());
+    REQUIRE(rangeTokens.size() == expectedTokens.size());
+    for (auto [token, expectedToken] : std::views::zip(rangeTokens, expectedTokens)) {
+        REQUIRE(token.line == expectedToken.line);
+        REQUIRE(token.character == expectedToken.character);
+        REQUIRE(token.length == expectedToken.length);
+        REQUIRE(token.type == expectedToken.type);
+    }
+}
+
 TEST_CASE_METHOD(ServerTestFixture, "Server::SemanticTokenDeltaTest")
 {
     // TODO: Have a more comprehensive/expressive set of delta tests
-    auto checkSemanticTokensDelta = [this](SourceTextView sourceText, SourceTextView modifiedSourceText) {
+    auto checkSemanticTokensDelta = [this](SourceTextView sourceText, SourceTextView modifiedSourceText,
+                                           std::optional<size_t> expectedNumEdits) {
         SemanticTokenState state;
         SemanticTokenConfig config{.enable = true};
 
@@ -185,21 +245,24 @@ TEST_CASE_METHOD(ServerTestFixture, "Server::SemanticTokenDeltaTest")
         REQUIRE(std::holds_alternative<lsp::SemanticTokensDelta>(deltaTokens));
         const auto& edits = std::get<lsp::SemanticTokensDelta>(deltaTokens).edits;
 
-        std::vector<lsp::uinteger> reconstructedTokens;
-        if (edits.empty()) {
-            // No change
-            reconstructedTokens = previousTokens.data;
+        if (expectedNumEdits) {
+            REQUIRE(edits.size() == *expectedNumEdits);
         }
-        else {
-            // We only do at most one edit for now
-            REQUIRE(edits.size() == 1);
-            reconstructedTokens.insert(reconstructedTokens.end(), previousTokens.data.begin(),
-                                       previousTokens.data.begin() + edits[0].start);
-            reconstructedTokens.insert(reconstructedTokens.end(), edits[0].data.begin(), edits[0].data.end());
-            reconstructedTokens.insert(reconstructedTokens.end(),
-                                       previousTokens.data.begin() + edits[0].start + edits[0].deleteCount,
-                                       previousTokens.data.end());
+
+        // Edits are sorted and all relative to the previous tokens
+        std::vector<lsp::uinteger> reconstructedTokens;
+        size_t previousCursor = 0;
+        for (const auto& edit : edits) {
+            REQUIRE(edit.start >= previousCursor);
+            REQUIRE(edit.start % 5 == 0);
+            REQUIRE(edit.deleteCount % 5 == 0);
+            reconstructedTokens.insert(reconstructedTokens.end(), previousTokens.data.begin() + previousCursor,
+                                       previousTokens.data.begin() + edit.start);
+            reconstructedTokens.insert(reconstructedTokens.end(), edit.data.begin(), edit.data.end());
+            previousCursor = edit.start + edit.deleteCount;
         }
+        reconstructedTokens.insert(reconstructedTokens.end(), previousTokens.data.begin() + previousCursor,
+                                   previousTokens.data.end());
 
         // Verify reconstructed tokens match full tokens
         auto fullTokens = HandleSemanticTokens(config, GetLanguageQueryInfo(), state, lsp::SemanticTokensParams{});
@@ -224,9 +287,32 @@ TEST_CASE_METHOD(ServerTestFixture, "Server::SemanticTokenDeltaTest")
             REQUIRE(std::holds_alternative<lsp::SemanticTokens>(result));
         }
 
+        SECTION("Deadline Expired")
+        {
+            SemanticTokenState state;
+            SemanticTokenConfig config{.enable = true};
+            CompileLabelledSource(source1);
+            auto previousTokens = HandleSemanticTokens(config, GetLanguageQueryInfo(), state, {});
+            auto previousState  = state;
+
+            // A result computed after the deadline is partial, so the cached tokens are kept for the next delta.
+            {
+                QueryDeadline deadline{std::chrono::milliseconds{1}};
+                std::this_thread::sleep_for(std::chrono::milliseconds{5});
+                HandleSemanticTokensDelta(config, GetLanguageQueryInfo(), state,
+                                          lsp::SemanticTokensDeltaParams{
+                                              .previousResultId = previousTokens.resultId,
+                                          });
+                HandleSemanticTokens(config, GetLanguageQueryInfo(), state, {});
+            }
+            REQUIRE(state.nextResultId == previousState.nextResultId);
+            REQUIRE(state.cachedResultId == previousState.cachedResultId);
+            REQUIRE(state.cachedTokens == previousTokens.data);
+        }
+
         SECTION("No Change")
         {
-            checkSemanticTokensDelta(source1, source1);
+            checkSemanticTokensDelta(source1, source1, 0);
         }
 
         SECTION("Append")
@@ -234,14 +320,14 @@ TEST_CASE_METHOD(ServerTestFixture, "Server::SemanticTokenDeltaTest")
             auto source2 = source1 + R"(
                 void foo() { }
             )";
-            checkSemanticTokensDelta(source1, source2);
+            checkSemanticTokensDelta(source1, source2, 1);
         }
 
         SECTION("Modify One")
         {
             std::string source3 = source1;
             source3.replace(source3.find("main"), 4, "foo");
-            checkSemanticTokensDelta(source1, source3);
+            checkSemanticTokensDelta(source1, source3, 1);
         }
 
         SECTION("Modify Many")
@@ -253,7 +339,22 @@ TEST_CASE_METHOD(ServerTestFixture, "Server::SemanticTokenDeltaTest")
                     S local;
                 }
             )";
-            checkSemanticTokensDelta(source1, source4);
+            checkSemanticTokensDelta(source1, source4, std::nullopt);
+        }
+
+        SECTION("Modify Separated")
+        {
+            const std::string source5 = R"(
+                void foo() { }
+                void bar() { }
+                void baz() { }
+            )";
+            std::string source6 = source5;
+            source6.replace(source6.find("foo"), 3, "foo2");
+            source6.replace(source6.find("baz"), 3, "baz2");
+
+            // Only the two modified function names should be re-sent
+            checkSemanticTokensDelta(source5, source6, 2);
         }
     }
 
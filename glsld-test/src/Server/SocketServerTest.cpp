@@ -0,0 +1,166 @@
+#include "Server/SocketServer.h"
+#include "Server/TextTransport.h"
+#include "Support/ScopeExit.h"
+
+#include <catch2/catch_test_macros.hpp>
+#include <fmt/format.h>
+
+#if defined(GLSLD_OS_LINUX)
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <thread>
+
+using namespace glsld;
+
+static auto ConnectUnix(const std::string& path) -> int
+{
+    sockaddr_un address = {};
+    address.sun_family  = AF_UNIX;
+    std::strncpy(address.sun_path, path.c_str(), sizeof(address.sun_path) - 1);
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+static auto ConnectTcp(uint16_t port) -> int
+{
+    sockaddr_in address     = {};
+    address.sin_family      = AF_INET;
+    address.sin_port        = htons(port);
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+static auto SendMessage(int fd, const std::string& payload) -> void
+{
+    auto message = "Content-Length: " + std::to_string(payload.size()) + "\r\n\r\n" + payload;
+    REQUIRE(write(fd, message.data(), message.size()) == static_cast<ssize_t>(message.size()));
+}
+
+// Reads everything until the server closes the connection.
+static auto ReadUntilClosed(int fd) -> std::string
+{
+    std::string result;
+    char buffer[4096];
+    while (true) {
+        auto bytesRead = read(fd, buffer, sizeof(buffer));
+        if (bytesRead <= 0) {
+            break;
+        }
+        result.append(buffer, bytesRead);
+    }
+    return result;
+}
+
+static auto ExpectedShutdownResponse(int requestId) -> std::string
+{
+    auto payload = R"({"jsonrpc":"2.0","id":)" + std::to_string(requestId) + R"(,"result":null})";
+    return "Content-Length: " + std::to_string(payload.size()) + "\r\n\r\n" + payload;
+}
+
+TEST_CASE("Server::SocketServerTest")
+{
+    auto config         = GetDefaultLanguageServerConfig();
+    config.loggingLevel = LoggingLevel::Error;
+    auto socketPath = (std::filesystem::temp_directory_path() / fmt::format("glsld-test-{}.sock", getpid())).string();
+
+    SocketServer server{config};
+    REQUIRE(server.ListenUnix(socketPath));
+    std::thread serverThread{[&] { server.Run(); }};
+
+    // The server thread must be joined even if a check fails.
+    ScopeExit stopServer{[&] {
+        server.Stop();
+        serverThread.join();
+        std::filesystem::remove(socketPath);
+    }};
+
+    SECTION("MultipleClients")
+    {
+        // Each client gets the response to its own request, and is disconnected after its exit notification.
+        int clientA = ConnectUnix(socketPath);
+        int clientB = ConnectUnix(socketPath);
+        REQUIRE(clientA != -1);
+        REQUIRE(clientB != -1);
+
+        SendMessage(clientB, R"({"jsonrpc":"2.0","id":2,"method":"shutdown"})");
+        SendMessage(clientA, R"({"jsonrpc":"2.0","id":1,"method":"shutdown"})");
+        SendMessage(clientA, R"({"jsonrpc":"2.0","method":"exit"})");
+        SendMessage(clientB, R"({"jsonrpc":"2.0","method":"exit"})");
+
+        REQUIRE(ReadUntilClosed(clientA) == ExpectedShutdownResponse(1));
+        REQUIRE(ReadUntilClosed(clientB) == ExpectedShutdownResponse(2));
+        close(clientA);
+        close(clientB);
+    }
+
+    SECTION("SplitMessages")
+    {
+        // Messages may arrive in arbitrary pieces, or several in one piece.
+        int client = ConnectUnix(socketPath);
+        REQUIRE(client != -1);
+
+        std::string shutdown = R"({"jsonrpc":"2.0","id":3,"method":"shutdown"})";
+        std::string exit     = R"({"jsonrpc":"2.0","method":"exit"})";
+        auto messages        = "Content-Length: " + std::to_string(shutdown.size()) + "\r\n\r\n" + shutdown +
+                        "Content-Length: " + std::to_string(exit.size()) + "\r\n\r\n" + exit;
+        for (char ch : messages) {
+            REQUIRE(write(client, &ch, 1) == 1);
+        }
+
+        REQUIRE(ReadUntilClosed(client) == ExpectedShutdownResponse(3));
+        close(client);
+    }
+
+    SECTION("MessageTooLarge")
+    {
+        // The connection is closed once the header is parsed, without waiting for the payload.
+        int client = ConnectUnix(socketPath);
+        REQUIRE(client != -1);
+
+        std::string header = "Content-Length: " + std::to_string(MaxTextTransportMessageSize + 1) + "\r\n\r\n";
+        REQUIRE(write(client, header.data(), header.size()) == static_cast<ssize_t>(header.size()));
+        REQUIRE(ReadUntilClosed(client).empty());
+        close(client);
+    }
+}
+
+TEST_CASE("Server::SocketServerTcpTest")
+{
+    auto config         = GetDefaultLanguageServerConfig();
+    config.loggingLevel = LoggingLevel::Error;
+
+    SocketServer server{config};
+    REQUIRE(server.ListenTcp(0));
+    REQUIRE(server.GetTcpPort() != 0);
+    std::thread serverThread{[&] { server.Run(); }};
+    ScopeExit stopServer{[&] {
+        server.Stop();
+        serverThread.join();
+    }};
+
+    int client = ConnectTcp(server.GetTcpPort());
+    REQUIRE(client != -1);
+    SendMessage(client, R"({"jsonrpc":"2.0","id":4,"method":"shutdown"})");
+    SendMessage(client, R"({"jsonrpc":"2.0","method":"exit"})");
+    REQUIRE(ReadUntilClosed(client) == ExpectedShutdownResponse(4));
+    close(client);
+}
+#endif
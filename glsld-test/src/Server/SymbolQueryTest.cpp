@@ -569,4 +569,29 @@ TEST_CASE_METHOD(ServerTestFixture, "Server::SymbolQueryTest")
                                                   },
                                           });
     }
-}
\ No newline at end of file
+
+    SECTION("PositionIndex")
+    {
+        CompileLabelledSource(R"(
+            void foo()
+            {
+                int x = 1;
+                int y = ^[x.use.begin]x + 1;
+            }
+        )");
+
+        const auto& info = GetLanguageQueryInfo();
+        auto tokenID     = info.LookupTokenIDByPosition(GetLabelledPosition("x.use.begin"));
+        REQUIRE(tokenID.has_value());
+
+        // The innermost node of a token is found by the index, and the parent walk ends at the translation unit
+        auto node = info.LookupInnermostNode(*tokenID);
+        REQUIRE(node != nullptr);
+        REQUIRE(node->node->GetTag() == AstNodeTag::AstNameAccessExpr);
+        REQUIRE(info.LookupParentNode(*node)->node->GetTag() == AstNodeTag::AstBinaryExpr);
+        while (info.LookupParentNode(*node)) {
+            node = info.LookupParentNode(*node);
+        }
+        REQUIRE(node->node == &info.GetUserFileAst());
+    }
+}
@@ -0,0 +1,155 @@
+#include "Server/TextDocumentBuffer.h"
+
+#include <catch2/catch_test_macros.hpp>
+
+using namespace glsld;
+
+static auto ApplyChange(TextDocumentBuffer& buffer, int startLine, int startColumn, int endLine, int endColumn,
+                        StringView text) -> void
+{
+    buffer.ApplyChange(TextRange{TextPosition{startLine, startColumn}, TextPosition{endLine, endColumn}}, text);
+}
+
+TEST_CASE("Server::TextDocumentBufferTest")
+{
+    SECTION("Empty")
+    {
+        TextDocumentBuffer buffer;
+        REQUIRE(buffer.GetText() == "");
+        REQUIRE(buffer.GetSize() == 0);
+        REQUIRE(buffer.GetLineCount() == 1);
+
+        ApplyChange(buffer, 0, 0, 0, 0, "int x;");
+        REQUIRE(buffer.GetText() == "int x;");
+    }
+
+    SECTION("Insert")
+    {
+        TextDocumentBuffer buffer{"int x;\nint y;\n"};
+        ApplyChange(buffer, 1, 4, 1, 4, "yy");
+        REQUIRE(buffer.GetText() == "int x;\nint yyy;\n");
+
+        ApplyChange(buffer, 2, 0, 2, 0, "int z;");
+        REQUIRE(buffer.GetText() == "int x;\nint yyy;\nint z;");
+        REQUIRE(buffer.GetSize() == buffer.GetText().size());
+    }
+
+    SECTION("Delete")
+    {
+        TextDocumentBuffer buffer{"int x;\nint y;\n"};
+        ApplyChange(buffer, 0, 3, 1, 3, "");
+        REQUIRE(buffer.GetText() == "int y;\n");
+        REQUIRE(buffer.GetLineCount() == 2);
+    }
+
+    SECTION("MultiLine")
+    {
+        TextDocumentBuffer buffer{"a\nb\nc\n"};
+        ApplyChange(buffer, 1, 0, 2, 1, "x\ny\nz");
+        REQUIRE(buffer.GetText() == "a\nx\ny\nz\n");
+        REQUIRE(buffer.GetLineCount() == 5);
+    }
+
+    SECTION("Clamp")
+    {
+        TextDocumentBuffer buffer{"ab\ncd"};
+        ApplyChange(buffer, 0, 100, 0, 100, "!");
+        REQUIRE(buffer.GetText() == "ab!\ncd");
+
+        ApplyChange(buffer, 100, 0, 100, 0, "?");
+        REQUIRE(buffer.GetText() == "ab!\ncd?");
+    }
+
+    SECTION("Utf16")
+    {
+        // U+00E9 takes 1 UTF-16 unit and 2 UTF-8 bytes. U+1F600 takes 2 UTF-16 units and 4 UTF-8 bytes.
+        TextDocumentBuffer buffer{"\xC3\xA9\xF0\x9F\x98\x80x"};
+        ApplyChange(buffer, 0, 3, 0, 4, "y");
+        REQUIRE(buffer.GetText() == "\xC3\xA9\xF0\x9F\x98\x80y");
+
+        ApplyChange(buffer, 0, 1, 0, 3, "");
+        REQUIRE(buffer.GetText() == "\xC3\xA9y");
+    }
+
+    SECTION("Utf8")
+    {
+        // With UTF-8 positions, columns are byte offsets.
+        TextDocumentBuffer buffer{"\xC3\xA9\xF0\x9F\x98\x80x\nab\r\n", false};
+        ApplyChange(buffer, 0, 6, 0, 7, "y");
+        REQUIRE(buffer.GetText() == "\xC3\xA9\xF0\x9F\x98\x80y\nab\r\n");
+
+        ApplyChange(buffer, 0, 2, 0, 6, "");
+        REQUIRE(buffer.GetText() == "\xC3\xA9y\nab\r\n");
+
+        // Columns past the end of the line are clamped before the line break.
+        ApplyChange(buffer, 1, 10, 1, 10, "!");
+        REQUIRE(buffer.GetText() == "\xC3\xA9y\nab!\r\n");
+
+        ApplyChange(buffer, 0, 100, 0, 100, "?");
+        REQUIRE(buffer.GetText() == "\xC3\xA9y?\nab!\r\n");
+
+        // Edits keep the position encoding.
+        REQUIRE(!buffer.GetCountUtf16Characters());
+    }
+
+    SECTION("CarriageReturn")
+    {
+        TextDocumentBuffer buffer{"ab\r\ncd\r\n"};
+        ApplyChange(buffer, 0, 10, 0, 10, "!");
+        REQUIRE(buffer.GetText() == "ab!\r\ncd\r\n");
+
+        ApplyChange(buffer, 1, 0, 1, 2, "x");
+        REQUIRE(buffer.GetText() == "ab!\r\nx\r\n");
+    }
+
+    SECTION("LargeDocument")
+    {
+        // Build a document spanning many chunks, and mirror every edit on a plain string.
+        std::string expected;
+        for (int i = 0; i < 2000; ++i) {
+            expected += "int variable" + std::to_string(i) + ";\n";
+        }
+
+        TextDocumentBuffer buffer{StringView{expected}};
+        REQUIRE(buffer.GetLineCount() == 2001);
+
+        auto lineOffset = [&](int line) {
+            size_t offset = 0;
+            for (int i = 0; i < line; ++i) {
+                offset = expected.find('\n', offset) + 1;
+            }
+            return offset;
+        };
+
+        // Edit across chunk boundaries
+        ApplyChange(buffer, 100, 4, 1900, 4, "merged");
+        expected.replace(lineOffset(100) + 4, lineOffset(1900) + 4 - lineOffset(100) - 4, "merged");
+        REQUIRE(buffer.GetText() == expected);
+        REQUIRE(buffer.GetSize() == expected.size());
+        REQUIRE(buffer.GetLineCount() == 201);
+
+        // Many small edits at the end of the document
+        for (int i = 0; i < 100; ++i) {
+            ApplyChange(buffer, 150, 0, 150, 0, "x");
+            expected.insert(lineOffset(150), "x");
+        }
+        REQUIRE(buffer.GetText() == expected);
+
+        // Split a line into many lines
+        std::string manyLines(10000, '\n');
+        ApplyChange(buffer, 50, 0, 50, 0, StringView{manyLines});
+        expected.insert(lineOffset(50), manyLines);
+        REQUIRE(buffer.GetText() == expected);
+        REQUIRE(buffer.GetLineCount() == 10201);
+    }
+
+    SECTION("SharedChunks")
+    {
+        TextDocumentBuffer buffer{"int x;\n"};
+        auto snapshot = buffer;
+        ApplyChange(buffer, 0, 4, 0, 5, "y");
+
+        REQUIRE(buffer.GetText() == "int y;\n");
+        REQUIRE(snapshot.GetText() == "int x;\n");
+    }
+}
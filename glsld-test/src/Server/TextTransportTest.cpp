@@ -0,0 +1,107 @@
+#include "Server/TextTransport.h"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <string>
+#include <thread>
+
+#if !defined(GLSLD_OS_WIN)
+#include <unistd.h>
+
+using namespace glsld;
+
+TEST_CASE("Server::TextTransportTest")
+{
+    int inputPipe[2];
+    int outputPipe[2];
+    REQUIRE(pipe(inputPipe) == 0);
+    REQUIRE(pipe(outputPipe) == 0);
+
+    auto transport = CreateFileDescriptorTextTransport(inputPipe[0], outputPipe[1]);
+
+    auto closeFd = [](int& fd) {
+        if (fd != -1) {
+            close(fd);
+            fd = -1;
+        }
+    };
+
+    SECTION("Read")
+    {
+        // The payload is larger than both the pipe capacity and the read block size.
+        std::string largePayload(1024 * 1024, 'x');
+        std::string input = "Content-Length: 5\r\n\r\nhello" + ("Content-Length: 1048576\r\n\r\n" + largePayload);
+
+        std::thread writer{[&] {
+            for (size_t offset = 0; offset < input.size();) {
+                auto bytesWritten = write(inputPipe[1], input.data() + offset, input.size() - offset);
+                if (bytesWritten <= 0) {
+                    break;
+                }
+                offset += bytesWritten;
+            }
+            closeFd(inputPipe[1]);
+        }};
+
+        REQUIRE(transport->ReadLine().value() == StringView{"Content-Length: 5\r\n"});
+        REQUIRE(transport->ReadLine().value() == StringView{"\r\n"});
+        REQUIRE(transport->Read(5).value() == StringView{"hello"});
+        REQUIRE(transport->ReadLine().value() == StringView{"Content-Length: 1048576\r\n"});
+        REQUIRE(transport->ReadLine().value() == StringView{"\r\n"});
+        REQUIRE(transport->Read(largePayload.size()).value() == StringView{largePayload});
+
+        // End of file
+        REQUIRE(!transport->ReadLine().has_value());
+        writer.join();
+    }
+
+    SECTION("HeaderParser")
+    {
+        MessageHeaderParser parser;
+        REQUIRE(parser.ParseLine("Content-Length: 5\r\n").value() == false);
+        REQUIRE(parser.ParseLine("Content-Type: application/vscode-jsonrpc; charset=utf-8\r\n").value() == false);
+        REQUIRE(parser.ParseLine("\r\n").value() == true);
+        REQUIRE(parser.GetPayloadLength() == 5);
+
+        REQUIRE(MessageHeaderParser{}.ParseLine("\r\n").error() == TextTransportError::InvalidHeader);
+        REQUIRE(MessageHeaderParser{}.ParseLine("Content-Length: abc\r\n").error() ==
+                TextTransportError::InvalidHeader);
+        REQUIRE(MessageHeaderParser{}
+                    .ParseLine("Content-Length: " + std::to_string(MaxTextTransportMessageSize + 1) + "\r\n")
+                    .error() == TextTransportError::MessageTooLarge);
+    }
+
+    SECTION("MessageTooLarge")
+    {
+        // The size is rejected before anything is read or allocated.
+        auto payload = transport->Read(MaxTextTransportMessageSize + 1);
+        REQUIRE(!payload.has_value());
+        REQUIRE(payload.error() == TextTransportError::MessageTooLarge);
+    }
+
+    SECTION("Write")
+    {
+        const StringView blocks[] = {"Content-Length: 5\r\n\r\n", "", "hello"};
+        REQUIRE(transport->Write(blocks));
+        closeFd(outputPipe[1]);
+
+        std::string output;
+        char buffer[256];
+        while (true) {
+            auto bytesRead = read(outputPipe[0], buffer, sizeof(buffer));
+            REQUIRE(bytesRead >= 0);
+            if (bytesRead == 0) {
+                break;
+            }
+            output.append(buffer, bytesRead);
+        }
+
+        REQUIRE(output == "Content-Length: 5\r\n\r\nhello");
+    }
+
+    transport = nullptr;
+    for (int* fd : {&inputPipe[0], &inputPipe[1], &outputPipe[0], &outputPipe[1]}) {
+        closeFd(*fd);
+    }
+}
+#endif
@@ -0,0 +1,102 @@
+#include "Support/JsonReader.h"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <vector>
+
+using namespace glsld;
+
+TEST_CASE("Support::JsonReaderTest")
+{
+    SECTION("Scalar")
+    {
+        JsonReader reader{R"([null, true, false, -42, 3.5, "hello"])"};
+        bool boolValue     = false;
+        int intValue       = 0;
+        double doubleValue = 0;
+        std::string stringValue;
+
+        int index = 0;
+        REQUIRE(reader.ReadArray([&] {
+            switch (index++) {
+            case 0:
+                return reader.ReadNull();
+            case 1:
+                return reader.ReadBoolean(boolValue) && boolValue;
+            case 2:
+                return reader.ReadBoolean(boolValue) && !boolValue;
+            case 3:
+                return reader.ReadInteger(intValue);
+            case 4:
+                return reader.ReadFloat(doubleValue);
+            default:
+                return reader.ReadString(stringValue);
+            }
+        }));
+        REQUIRE(reader.IsEnd());
+        REQUIRE(intValue == -42);
+        REQUIRE(doubleValue == 3.5);
+        REQUIRE(stringValue == "hello");
+    }
+
+    SECTION("Integer")
+    {
+        int value = 0;
+        REQUIRE(!JsonReader{"1.5"}.ReadInteger(value));
+        REQUIRE(!JsonReader{"1e3"}.ReadInteger(value));
+        REQUIRE(!JsonReader{"4294967296"}.ReadInteger(value));
+
+        unsigned unsignedValue = 0;
+        REQUIRE(!JsonReader{"-1"}.ReadInteger(unsignedValue));
+    }
+
+    SECTION("Escape")
+    {
+        std::string value;
+        REQUIRE(JsonReader{R"("a\"b\\c\/d\n\r\t")"}.ReadString(value));
+        REQUIRE(value == "a\"b\\c/d\n\r\t");
+
+        REQUIRE(JsonReader{R"("Aé中😀")"}.ReadString(value));
+        REQUIRE(value == "A\xC3\xA9\xE4\xB8\xAD\xF0\x9F\x98\x80");
+
+        // Unpaired surrogates and unknown escapes are rejected
+        REQUIRE(!JsonReader{R"("\ud83d")"}.ReadString(value));
+        REQUIRE(!JsonReader{R"("\ude00")"}.ReadString(value));
+        REQUIRE(!JsonReader{R"("\x")"}.ReadString(value));
+        REQUIRE(!JsonReader{R"("abc)"}.ReadString(value));
+    }
+
+    SECTION("Object")
+    {
+        JsonReader reader{R"({ "a" : 1, "bc" : [1, 2], "d": {} })"};
+        std::vector<std::string> keys;
+        REQUIRE(reader.ReadObject([&](StringView key) {
+            keys.push_back(key.Str());
+            return reader.SkipValue();
+        }));
+        REQUIRE(reader.IsEnd());
+        REQUIRE(keys == std::vector<std::string>{"a", "bc", "d"});
+
+        REQUIRE(!JsonReader{R"({"a" 1})"}.ReadObject([](StringView) { return true; }));
+        REQUIRE(!JsonReader{R"({"a": 1,})"}.ReadObject([](StringView) { return true; }));
+    }
+
+    SECTION("RawValue")
+    {
+        JsonReader reader{R"({"method": "x", "params": {"text": "}\"]", "list": [1, {}]}, "id": 1})"};
+        StringView params;
+        REQUIRE(reader.ReadObject([&](StringView key) {
+            if (key == "params") {
+                return reader.ReadRawValue(params);
+            }
+            return reader.SkipValue();
+        }));
+        REQUIRE(params == R"({"text": "}\"]", "list": [1, {}]})");
+    }
+
+    SECTION("Depth")
+    {
+        std::string text = std::string(1000, '[') + std::string(1000, ']');
+        REQUIRE(!JsonReader{StringView{text}}.SkipValue());
+    }
+}
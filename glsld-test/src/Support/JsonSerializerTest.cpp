@@ -12,6 +12,22 @@ TEST_CASE("Support::JsonSerializerTest")
         ObjectType deserializedObject;
         REQUIRE(JsonSerializer<ObjectType>::Deserialize(deserializedObject, json));
         REQUIRE(object == deserializedObject);
+
+        // The same text should deserialize identically without building a DOM
+        auto text = json.dump();
+        JsonReader reader{StringView{text}};
+        ObjectType streamedObject;
+        REQUIRE(JsonSerializer<ObjectType>::Deserialize(streamedObject, reader));
+        REQUIRE(reader.IsEnd());
+        REQUIRE(object == streamedObject);
+
+        // Serializing without a DOM should produce an equivalent text
+        JsonWriter writer;
+        JsonSerializer<ObjectType>::Serialize(object, writer);
+        JsonReader writtenReader{writer.GetText()};
+        ObjectType writtenObject;
+        REQUIRE(JsonSerializer<ObjectType>::Deserialize(writtenObject, writtenReader));
+        REQUIRE(object == writtenObject);
     };
 
     SECTION("Scalar")
@@ -20,6 +36,7 @@ TEST_CASE("Support::JsonSerializerTest")
         testSerialization(42);
         testSerialization(3.14f);
         testSerialization(std::string{"Hello, World!"});
+        testSerialization(std::string{"\"Quoted\"\r\n\t\\\x01"});
     }
 
     SECTION("Enum")
@@ -57,6 +74,55 @@ TEST_CASE("Support::JsonSerializerTest")
         testSerialization(std::optional<int>{42});
     }
 
+    SECTION("OptionalField")
+    {
+        struct TestStruct
+        {
+            int a;
+            std::optional<int> b;
+
+            auto operator==(const TestStruct& other) const -> bool = default;
+        };
+
+        testSerialization(TestStruct{1, std::nullopt});
+        testSerialization(TestStruct{1, 2});
+
+        // Empty optional fields are omitted rather than serialized as null
+        REQUIRE(!JsonSerializer<TestStruct>::Serialize(TestStruct{1, std::nullopt}).contains("b"));
+        REQUIRE(JsonSerializer<TestStruct>::Serialize(TestStruct{1, 2})["b"] == 2);
+
+        JsonWriter writer;
+        JsonSerializer<TestStruct>::Serialize(TestStruct{1, std::nullopt}, writer);
+        REQUIRE(writer.GetText() == R"({"a":1})");
+
+        // Clients may still send null for an optional field, which clears it
+        TestStruct object{1, 2};
+        REQUIRE(JsonSerializer<TestStruct>::Deserialize(object, nlohmann::json::parse(R"({"a":3,"b":null})")));
+        REQUIRE(object == TestStruct{3, std::nullopt});
+    }
+
+    SECTION("NullableField")
+    {
+        struct TestStruct
+        {
+            int a;
+            Nullable<int> b;
+
+            auto operator==(const TestStruct& other) const -> bool = default;
+        };
+
+        testSerialization(TestStruct{1, std::nullopt});
+        testSerialization(TestStruct{1, 2});
+
+        // Empty nullable fields are serialized as null rather than omitted
+        REQUIRE(JsonSerializer<TestStruct>::Serialize(TestStruct{1, std::nullopt})["b"].is_null());
+        REQUIRE(JsonSerializer<TestStruct>::Serialize(TestStruct{1, 2})["b"] == 2);
+
+        JsonWriter writer;
+        JsonSerializer<TestStruct>::Serialize(TestStruct{1, std::nullopt}, writer);
+        REQUIRE(writer.GetText() == R"({"a":1,"b":null})");
+    }
+
     SECTION("CustomType")
     {
         struct CustomType
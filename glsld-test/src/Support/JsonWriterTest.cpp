@@ -0,0 +1,72 @@
+#include "Support/JsonWriter.h"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+using namespace glsld;
+
+TEST_CASE("Support::JsonWriterTest")
+{
+    JsonWriter writer;
+
+    SECTION("Object")
+    {
+        writer.BeginObject();
+        writer.WriteKey("a");
+        writer.WriteInteger(-1);
+        writer.WritePreEscapedKey("\"b\":");
+        writer.BeginArray();
+        writer.WriteNull();
+        writer.WriteBoolean(true);
+        writer.BeginObject();
+        writer.EndObject();
+        writer.EndArray();
+        writer.WriteKey("c");
+        writer.WriteFloat(0.5);
+        writer.EndObject();
+        REQUIRE(writer.GetText() == R"({"a":-1,"b":[null,true,{}],"c":0.5})");
+    }
+
+    SECTION("IntegerArray")
+    {
+        std::vector<uint32_t> values = {0, 1, std::numeric_limits<uint32_t>::max()};
+        writer.BeginArray();
+        writer.WriteIntegerArray(std::span<const uint32_t>{values});
+        writer.WriteIntegerArray(std::span<const uint32_t>{});
+        writer.EndArray();
+        REQUIRE(writer.GetText() == "[[0,1,4294967295],[]]");
+    }
+
+    SECTION("String")
+    {
+        writer.WriteString("a\"b\\c\n\x1F\xC3\xA9");
+        REQUIRE(writer.GetText() == "\"a\\\"b\\\\c\\n\\u001f\xC3\xA9\"");
+    }
+
+    SECTION("NonFinite")
+    {
+        writer.WriteFloat(std::numeric_limits<double>::infinity());
+        REQUIRE(writer.GetText() == "null");
+    }
+
+    SECTION("Reset")
+    {
+        writer.WriteInteger(1);
+        writer.Reset();
+        writer.WriteInteger(2);
+        REQUIRE(writer.GetText() == "2");
+    }
+
+    SECTION("TakeText")
+    {
+        writer.WriteInteger(1);
+        REQUIRE(writer.TakeText() == "1");
+        REQUIRE(writer.GetText() == "");
+
+        writer.WriteInteger(2);
+        REQUIRE(writer.GetText() == "2");
+    }
+}
@@ -0,0 +1,81 @@
+#include "Support/LatencyHistogram.h"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <chrono>
+#include <thread>
+#include <vector>
+
+using namespace glsld;
+using std::chrono::microseconds;
+
+TEST_CASE("Support::LatencyHistogramTest")
+{
+    LatencyHistogram histogram;
+
+    SECTION("Empty")
+    {
+        REQUIRE(histogram.GetCount() == 0);
+        REQUIRE(histogram.GetMean() == microseconds::zero());
+        REQUIRE(histogram.GetMax() == microseconds::zero());
+        REQUIRE(histogram.GetPercentile(0.5) == microseconds::zero());
+    }
+
+    SECTION("SmallValues")
+    {
+        // Small values are counted exactly.
+        for (int i = 1; i <= 10; ++i) {
+            histogram.Record(microseconds{i});
+        }
+
+        REQUIRE(histogram.GetCount() == 10);
+        REQUIRE(histogram.GetMean() == microseconds{5});
+        REQUIRE(histogram.GetMax() == microseconds{10});
+        REQUIRE(histogram.GetPercentile(0) == microseconds{1});
+        REQUIRE(histogram.GetPercentile(0.5) == microseconds{5});
+        REQUIRE(histogram.GetPercentile(0.9) == microseconds{9});
+        REQUIRE(histogram.GetPercentile(1) == microseconds{10});
+    }
+
+    SECTION("LargeValues")
+    {
+        // Large values are rounded up to the bucket boundary, within 1/16 of the value.
+        histogram.Record(std::chrono::milliseconds{100});
+        histogram.Record(std::chrono::seconds{1});
+
+        auto p50 = histogram.GetPercentile(0.5);
+        REQUIRE(p50 >= microseconds{100'000});
+        REQUIRE(p50 <= microseconds{100'000 + 100'000 / 16});
+        REQUIRE(histogram.GetPercentile(0.99) == microseconds{1'000'000});
+        REQUIRE(histogram.GetMax() == microseconds{1'000'000});
+    }
+
+    SECTION("Clamp")
+    {
+        histogram.Record(microseconds{-1});
+        histogram.Record(std::chrono::hours{24});
+
+        REQUIRE(histogram.GetCount() == 2);
+        REQUIRE(histogram.GetPercentile(0.5) == microseconds::zero());
+        REQUIRE(histogram.GetMax() < std::chrono::hours{24});
+        REQUIRE(histogram.GetPercentile(1) == histogram.GetMax());
+    }
+
+    SECTION("Concurrent")
+    {
+        std::vector<std::thread> threads;
+        for (int i = 0; i < 4; ++i) {
+            threads.emplace_back([&histogram, i] {
+                for (int j = 0; j < 1000; ++j) {
+                    histogram.Record(microseconds{i * 1000 + j});
+                }
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+
+        REQUIRE(histogram.GetCount() == 4000);
+        REQUIRE(histogram.GetMax() == microseconds{3999});
+    }
+}
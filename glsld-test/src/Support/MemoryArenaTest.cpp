@@ -0,0 +1,62 @@
+#include "Support/MemoryArena.h"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <string>
+
+using namespace glsld;
+
+TEST_CASE("Support::MemoryArenaTest")
+{
+    SECTION("Empty")
+    {
+        BasicMemoryArena<false> arena;
+        REQUIRE(arena.GetMemoryUsage() == MemoryUsage{});
+    }
+
+    SECTION("SmallAllocation")
+    {
+        BasicMemoryArena<false> arena;
+        arena.Allocate(1);
+        arena.Allocate(alignof(std::max_align_t));
+
+        // Allocations are rounded up to the alignment, and share a single page.
+        auto usage = arena.GetMemoryUsage();
+        REQUIRE(usage.allocatedBytes == 2 * alignof(std::max_align_t));
+        REQUIRE(usage.committedBytes > usage.allocatedBytes);
+
+        arena.Allocate(alignof(std::max_align_t));
+        REQUIRE(arena.GetMemoryUsage().allocatedBytes == 3 * alignof(std::max_align_t));
+        REQUIRE(arena.GetMemoryUsage().committedBytes == usage.committedBytes);
+    }
+
+    SECTION("LargeAllocation")
+    {
+        BasicMemoryArena<false> arena;
+        arena.Allocate(64 * 1024);
+
+        auto usage = arena.GetMemoryUsage();
+        REQUIRE(usage.allocatedBytes == 64 * 1024);
+        REQUIRE(usage.committedBytes > usage.allocatedBytes);
+    }
+
+    SECTION("DestructHandle")
+    {
+        MemoryArena arena;
+        arena.Construct<std::string>("hello");
+
+        // The handle to destruct the object is counted as well.
+        REQUIRE(arena.GetMemoryUsage().allocatedBytes > sizeof(std::string));
+    }
+
+    SECTION("Move")
+    {
+        BasicMemoryArena<false> arena;
+        arena.Allocate(64);
+        auto usage = arena.GetMemoryUsage();
+
+        BasicMemoryArena<false> other = std::move(arena);
+        REQUIRE(other.GetMemoryUsage() == usage);
+        REQUIRE(arena.GetMemoryUsage() == MemoryUsage{});
+    }
+}
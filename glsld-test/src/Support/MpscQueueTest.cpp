@@ -0,0 +1,74 @@
+#include "Support/MpscQueue.h"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <thread>
+#include <vector>
+
+using namespace glsld;
+
+namespace
+{
+    struct Node
+    {
+        Node* next = nullptr;
+        int producer;
+        int sequence;
+    };
+} // namespace
+
+TEST_CASE("Support::MpscQueueTest")
+{
+    MpscQueue<Node> queue;
+
+    SECTION("Order")
+    {
+        std::vector<Node> nodes(3);
+        for (int i = 0; i < 3; ++i) {
+            nodes[i].sequence = i;
+            queue.push(&nodes[i]);
+        }
+
+        auto batch = queue.pop_all();
+        REQUIRE(queue.empty());
+        REQUIRE(batch.pop()->sequence == 0);
+        REQUIRE(batch.pop()->sequence == 1);
+        REQUIRE(batch.pop()->sequence == 2);
+        REQUIRE(batch.empty());
+    }
+
+    SECTION("Concurrent")
+    {
+        constexpr int ProducerCount = 4;
+        constexpr int NodeCount     = 10000;
+
+        std::vector<std::vector<Node>> nodes(ProducerCount, std::vector<Node>(NodeCount));
+        std::vector<std::thread> producers;
+        for (int producer = 0; producer < ProducerCount; ++producer) {
+            producers.emplace_back([&, producer] {
+                for (int i = 0; i < NodeCount; ++i) {
+                    nodes[producer][i].producer = producer;
+                    nodes[producer][i].sequence = i;
+                    queue.push(&nodes[producer][i]);
+                }
+            });
+        }
+
+        // Nodes from the same producer must be received in order.
+        std::vector<int> nextSequence(ProducerCount, 0);
+        int receivedCount = 0;
+        while (receivedCount < ProducerCount * NodeCount) {
+            auto batch = queue.pop_all();
+            while (auto node = batch.pop()) {
+                REQUIRE(node->sequence == nextSequence[node->producer]);
+                nextSequence[node->producer] += 1;
+                receivedCount += 1;
+            }
+        }
+
+        for (auto& producer : producers) {
+            producer.join();
+        }
+        REQUIRE(queue.empty());
+    }
+}
@@ -0,0 +1,104 @@
+#include "Support/ChromeTraceWriter.h"
+#include "Support/Tracing.h"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace glsld;
+
+TEST_CASE("Support::TracingTest")
+{
+    SECTION("Disabled")
+    {
+        REQUIRE(!TraceRecorder::IsEnabled());
+        REQUIRE(TraceRecorder::Now() == TraceRecorder::Clock::time_point{});
+
+        {
+            TraceSpan span{"test", "disabled"};
+        }
+        REQUIRE(TraceRecorder::Get().TakeEvents().empty());
+    }
+
+    SECTION("Record")
+    {
+        auto& recorder = TraceRecorder::Get();
+        recorder.Enable();
+        {
+            TraceSpan outer{"test", "outer", "detail"};
+            TraceSpan inner{"test", "inner"};
+        }
+        auto start = TraceRecorder::Now();
+        std::thread{[&] { recorder.Record("test", "async", start, TraceRecorder::Now(), {}, 42); }}.join();
+        recorder.Disable();
+
+        // Spans are recorded when they end, so the inner one comes first.
+        auto events = recorder.TakeEvents();
+        REQUIRE(events.size() == 3);
+        REQUIRE(StringView{events[0].name} == "inner");
+        REQUIRE(StringView{events[1].name} == "outer");
+        REQUIRE(StringView{events[1].detail} == "detail");
+        REQUIRE(StringView{events[0].detail}.empty());
+        REQUIRE(events[0].startUs >= events[1].startUs);
+        REQUIRE(events[0].durationUs <= events[1].durationUs);
+        REQUIRE(events[0].threadId == events[1].threadId);
+        REQUIRE(!events[0].asyncId);
+
+        REQUIRE(StringView{events[2].name} == "async");
+        REQUIRE(events[2].threadId != events[0].threadId);
+        REQUIRE(events[2].asyncId == 42);
+
+        REQUIRE(recorder.TakeEvents().empty());
+    }
+
+    SECTION("InternString")
+    {
+        auto& recorder = TraceRecorder::Get();
+        std::string text     = "file:///a.glsl";
+        const char* interned = recorder.InternString(text);
+        text.clear();
+        REQUIRE(StringView{interned} == "file:///a.glsl");
+        REQUIRE(recorder.InternString("file:///a.glsl") == interned);
+
+        // Strings interned by another thread are shared.
+        const char* otherInterned = nullptr;
+        std::thread{[&] { otherInterned = recorder.InternString("file:///a.glsl"); }}.join();
+        REQUIRE(otherInterned == interned);
+        REQUIRE(StringView{recorder.InternString("")}.empty());
+    }
+
+    SECTION("ChromeTrace")
+    {
+        std::vector<TraceEvent> events = {
+            TraceEvent{
+                .category   = "compiler",
+                .name       = "parse",
+                .detail     = "main file",
+                .startUs    = 10,
+                .durationUs = 5,
+                .threadId   = 2,
+                .asyncId    = std::nullopt,
+            },
+            TraceEvent{
+                .category   = "request",
+                .name       = "textDocument/hover",
+                .detail     = "",
+                .startUs    = 1,
+                .durationUs = 20,
+                .threadId   = 1,
+                .asyncId    = 7,
+            },
+        };
+
+        JsonWriter writer;
+        WriteChromeTrace(events, writer);
+        REQUIRE(writer.GetText() ==
+                R"({"displayTimeUnit":"ms","traceEvents":[)"
+                R"({"name":"parse","cat":"compiler","ph":"X","ts":10,"pid":1,"tid":2,"dur":5,)"
+                R"("args":{"detail":"main file"}},)"
+                R"({"name":"textDocument/hover","cat":"request","ph":"b","ts":1,"pid":1,"tid":1,"id":7},)"
+                R"({"name":"textDocument/hover","cat":"request","ph":"e","ts":21,"pid":1,"tid":1,"id":7}]})");
+    }
+}
@@ -1,10 +1,15 @@
 #include "AppVersion.h"
 #include "Support/StringView.h"
 #include "Support/File.h"
+#include "Support/ChromeTraceWriter.h"
+#include "Support/ScopeExit.h"
 #include "Server/LanguageServer.h"
+#include "Server/SocketServer.h"
 
 #include <argparse/argparse.hpp>
+#include <atomic>
 #include <chrono>
+#include <csignal>
 #include <filesystem>
 #include <fstream>
 
@@ -66,6 +71,14 @@ namespace glsld
             std::string replayFile;
             // Path to the directory to dump replay files
             std::string replayDumpDir;
+            // Path to a Unix domain socket to serve clients on, instead of stdio
+            std::string socketPath;
+            // Port on the TCP loopback interface to serve clients on, instead of stdio
+            int port = 0;
+            // Print the memory held by open documents and preambles to stderr when the server exits
+            bool memoryReport;
+            // Path to write a trace of compilations and requests in the Chrome JSON trace event format on exit
+            std::string traceFile;
 #if defined(GLSLD_DEBUG)
             // Wait for a debugger to attach before starting the server
             bool waitDebugger;
@@ -94,6 +107,23 @@ namespace glsld
             .help("Directory to dump the replay file (for reproducing client messages)")
             .default_value(std::string{})
             .store_into(result.replayDumpDir);
+        program.add_argument("--socket")
+            .help("Serve clients on a Unix domain socket at the given path instead of stdio")
+            .default_value(std::string{})
+            .store_into(result.socketPath);
+        program.add_argument("--port")
+            .help("Serve clients on the given port of the TCP loopback interface instead of stdio")
+            .default_value(0)
+            .store_into(result.port);
+        program.add_argument("--memoryReport")
+            .help("Print the memory held by open documents and preambles to stderr when the server exits")
+            .flag()
+            .default_value(false)
+            .store_into(result.memoryReport);
+        program.add_argument("--traceFile")
+            .help("Record compilations and requests, and write the trace in the Chrome JSON format on exit")
+            .default_value(std::string{})
+            .store_into(result.traceFile);
 #if defined(GLSLD_DEBUG)
         program.add_argument("--waitDebugger")
             .help("Wait for a debugger to attach before starting the server")
@@ -174,6 +204,108 @@ namespace glsld
         return UniqueFile::Open(path.string().c_str(), "wb").value_or(UniqueFile{});
     }
 
+    static auto FormatBytes(size_t bytes) -> std::string
+    {
+        if (bytes >= 1024 * 1024) {
+            return fmt::format("{:.1f} MiB", bytes / (1024.0 * 1024.0));
+        }
+        else if (bytes >= 1024) {
+            return fmt::format("{:.1f} KiB", bytes / 1024.0);
+        }
+        else {
+            return fmt::format("{} B", bytes);
+        }
+    }
+
+    static auto FormatMemoryUsage(const lsp::MemoryUsageInfo& usage) -> std::string
+    {
+        return fmt::format("{} / {}", FormatBytes(usage.allocatedBytes), FormatBytes(usage.committedBytes));
+    }
+
+    static auto PrintMemoryReport(const lsp::MemoryUsageResult& report) -> void
+    {
+        fmt::print(stderr, "Memory usage (allocated / committed): {}\n", FormatMemoryUsage(report.total));
+        for (const auto& document : report.documents) {
+            std::string status = document.evicted ? ", evicted" : document.compiled ? "" : ", not compiled";
+            if (document.preamble) {
+                status += fmt::format(", preamble #{}", *document.preamble);
+            }
+
+            fmt::print(stderr, "  {} (version {}{}): {}\n", document.uri, document.version, status,
+                       FormatMemoryUsage(document.total));
+            fmt::print(stderr,
+                       "    source {}, ast {}, tokens {}, preprocess info {}, query index {}, semantic tokens {}\n",
+                       FormatMemoryUsage(document.source), FormatMemoryUsage(document.ast),
+                       FormatMemoryUsage(document.tokens), FormatMemoryUsage(document.preprocessInfo),
+                       FormatMemoryUsage(document.queryIndex), FormatMemoryUsage(document.semanticTokens));
+        }
+        for (size_t i = 0; i < report.preambles.size(); ++i) {
+            const auto& preamble = report.preambles[i];
+            fmt::print(stderr, "  preamble #{} ({} documents{}): {}\n", i, preamble.documentCount,
+                       preamble.base ? fmt::format(", base #{}", *preamble.base) : "",
+                       FormatMemoryUsage(preamble.total));
+            fmt::print(stderr, "    source {}, ast {}, tokens {}\n", FormatMemoryUsage(preamble.source),
+                       FormatMemoryUsage(preamble.ast), FormatMemoryUsage(preamble.tokens));
+        }
+    }
+
+    static auto WriteTraceFile(const std::string& path) -> void
+    {
+        JsonWriter writer;
+        WriteChromeTrace(TraceRecorder::Get().TakeEvents(), writer);
+
+        auto file = UniqueFile::Open(path.c_str(), "wb");
+        if (!file || file->Write(writer.GetText()) != Status::Ok) {
+            fmt::print(stderr, "Failed to write trace file: {}\n", path);
+        }
+    }
+
+#if defined(GLSLD_OS_LINUX)
+    // The socket server that is stopped on SIGINT or SIGTERM.
+    static std::atomic<SocketServer*> signalledSocketServer = nullptr;
+
+    static auto HandleStopSignal(int /*signal*/) -> void
+    {
+        if (auto server = signalledSocketServer.load(); server) {
+            server->Stop();
+        }
+    }
+#endif
+
+    static auto RunSocketServer(const LanguageServerConfig& config, const ProgramArgs& args) -> int
+    {
+#if defined(GLSLD_OS_LINUX)
+        SocketServer server{config};
+        if (args.memoryReport) {
+            server.SetMemoryReportHandler([](const lsp::MemoryUsageResult& report) { PrintMemoryReport(report); });
+        }
+        if (!args.socketPath.empty()) {
+            if (!server.ListenUnix(args.socketPath)) {
+                fmt::print(stderr, "Failed to listen on socket: {}\n", args.socketPath);
+                return 1;
+            }
+        }
+        else if (args.port <= 0 || args.port > 65535 || !server.ListenTcp(static_cast<uint16_t>(args.port))) {
+            fmt::print(stderr, "Failed to listen on port: {}\n", args.port);
+            return 1;
+        }
+
+        // Unlike stdio, there's no end of input to stop a socket server. It's stopped by a signal instead, so that
+        // connections are torn down and the trace is written on the way out.
+        signalledSocketServer = &server;
+        std::signal(SIGINT, HandleStopSignal);
+        std::signal(SIGTERM, HandleStopSignal);
+        server.Run();
+        std::signal(SIGINT, SIG_DFL);
+        std::signal(SIGTERM, SIG_DFL);
+        signalledSocketServer = nullptr;
+        return 0;
+#else
+        fmt::print(stderr, "Serving clients on a socket is only supported on Linux\n");
+        return 1;
+#endif
+    }
+
     static auto DoMain(ProgramArgs args) -> int
     {
 #if defined(GLSLD_DEBUG)
@@ -182,7 +314,22 @@ namespace glsld
         }
 #endif
 
+        // The trace is written after the server is destroyed, so spans finished by its workers are included.
+        if (!args.traceFile.empty()) {
+            TraceRecorder::Get().Enable();
+        }
+        ScopeExit traceFileWriter{[&args] {
+            if (!args.traceFile.empty()) {
+                WriteTraceFile(args.traceFile);
+            }
+        }};
+
         auto config = LoadConfig(args.configFile);
+
+        if (!args.socketPath.empty() || args.port != 0) {
+            return RunSocketServer(config, args);
+        }
+
         glsld::LanguageServer server{config};
 
         if (!args.replayFile.empty()) {
@@ -193,6 +340,11 @@ namespace glsld
             }
 
             server.Replay(*replayCommands);
+            if (args.memoryReport) {
+                // Replayed messages only schedule the compilations, so wait for them before reporting.
+                server.WaitForPendingTasks();
+                PrintMemoryReport(server.CollectMemoryUsage());
+            }
             return 1;
         }
         else {
@@ -206,6 +358,10 @@ namespace glsld
                 server.InitializeReplayDumpFile(std::move(replayDumpFile));
             }
             server.Run();
+            if (args.memoryReport) {
+                server.WaitForPendingTasks();
+                PrintMemoryReport(server.CollectMemoryUsage());
+            }
         }
         return 0;
     }